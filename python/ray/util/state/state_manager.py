@@ -314,6 +314,20 @@ class StateDataSourceClient:
 
         request = GetTaskEventsRequest(limit=limit, filters=req_filters)
         reply = await self._gcs_task_info_stub.GetTaskEvents(request, timeout=timeout)
+        # GCS caps the number of task events per reply, so the rest of them are
+        # fetched page by page.
+        while reply.HasField("next_cursor") and len(reply.events_by_task) < limit:
+            request.limit = limit - len(reply.events_by_task)
+            request.cursor = reply.next_cursor
+            page = await self._gcs_task_info_stub.GetTaskEvents(
+                request, timeout=timeout
+            )
+            reply.events_by_task.extend(page.events_by_task)
+            reply.num_filtered_on_gcs += page.num_filtered_on_gcs
+            if page.HasField("next_cursor"):
+                reply.next_cursor = page.next_cursor
+            else:
+                reply.ClearField("next_cursor")
         return reply
 
     @handle_grpc_network_errors
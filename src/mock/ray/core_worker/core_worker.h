@@ -45,6 +45,18 @@ class MockCoreWorker : public CoreWorker {
                rpc::PushTaskReply *reply,
                rpc::SendReplyCallback send_reply_callback),
               (override));
+  MOCK_METHOD(void,
+              HandlePushTaskBatch,
+              (rpc::PushTaskBatchRequest request,
+               rpc::PushTaskBatchReply *reply,
+               rpc::SendReplyCallback send_reply_callback),
+              (override));
+  MOCK_METHOD(void,
+              HandlePushActorTaskBatch,
+              (rpc::PushActorTaskBatchRequest request,
+               rpc::PushActorTaskBatchReply *reply,
+               rpc::SendReplyCallback send_reply_callback),
+              (override));
   MOCK_METHOD(void,
               HandleDirectActorCallArgWaitComplete,
               (rpc::DirectActorCallArgWaitCompleteRequest request,
@@ -33,7 +33,8 @@ class MockRayletClientInterface : public RayletClientInterface {
        bool grant_or_reject,
        const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
        const int64_t backlog_size,
-       const bool is_selected_based_on_locality),
+       const bool is_selected_based_on_locality,
+       const int64_t num_workers),
       (override));
   MOCK_METHOD(ray::Status,
               ReturnWorker,
@@ -29,6 +29,11 @@ class MockCoreWorkerClientInterface : public ray::pubsub::MockSubscriberClientIn
               (std::unique_ptr<PushTaskRequest> request,
                const ClientCallback<PushTaskReply> &callback),
               (override));
+  MOCK_METHOD(void,
+              PushNormalTaskBatch,
+              (std::unique_ptr<PushTaskBatchRequest> request,
+               const ClientCallback<PushTaskBatchReply> &callback),
+              (override));
   MOCK_METHOD(void,
               NumPendingTasks,
               (std::unique_ptr<NumPendingTasksRequest> request,
@@ -27,15 +27,8 @@ void instrumented_io_context::post(std::function<void()> handler,
                                    const std::string name,
                                    int64_t delay_us) {
   if (RayConfig::instance().event_stats()) {
-    // References are only invalidated upon deletion of the corresponding item from the
-    // table, which we won't do until this io_context is deleted. Provided that
-    // GuardedHandlerStats synchronizes internal access, we can concurrently write to the
-    // handler stats it->second from multiple threads without acquiring a table-level
-    // readers lock in the callback.
-    const auto stats_handle = event_stats_->RecordStart(name);
-    handler = [handler = std::move(handler), stats_handle = std::move(stats_handle)]() {
-      EventTracker::RecordExecution(handler, std::move(stats_handle));
-    };
+    post(std::move(handler), event_stats_->RegisterEvent(name), delay_us);
+    return;
   }
   delay_us += ray::asio::testing::get_delay_us(name);
   if (delay_us == 0) {
@@ -46,6 +39,36 @@ void instrumented_io_context::post(std::function<void()> handler,
   }
 }
 
+void instrumented_io_context::post(std::function<void()> handler,
+                                   const EventHandle &event,
+                                   int64_t delay_us) {
+  delay_us += ray::asio::testing::get_delay_us(event.stats->name());
+  if (!RayConfig::instance().event_stats()) {
+    if (delay_us == 0) {
+      boost::asio::io_context::post(std::move(handler));
+    } else {
+      execute_after(*this, std::move(handler), std::chrono::microseconds(delay_us));
+    }
+    return;
+  }
+  // The stats of a registered event live as long as the event tracker, so the handler
+  // only captures the event and the queueing start time, and it's posted without being
+  // wrapped in another std::function.
+  const auto start_time = event_stats_->RecordQueued(event);
+  auto wrapped_handler = [handler = std::move(handler),
+                          event,
+                          start_time,
+                          event_stats = event_stats_.get()]() {
+    event_stats->RecordExecution(handler, event, start_time);
+  };
+  if (delay_us == 0) {
+    boost::asio::io_context::post(std::move(wrapped_handler));
+  } else {
+    RAY_LOG(DEBUG) << "Deferring " << event.stats->name() << " by " << delay_us << "us";
+    execute_after(*this, std::move(wrapped_handler), std::chrono::microseconds(delay_us));
+  }
+}
+
 void instrumented_io_context::dispatch(std::function<void()> handler,
                                        const std::string name) {
   if (!RayConfig::instance().event_stats()) {
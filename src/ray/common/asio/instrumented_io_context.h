@@ -39,6 +39,16 @@ class instrumented_io_context : public boost::asio::io_context {
   /// \param delay_us Delay time before the handler will be executed.
   void post(std::function<void()> handler, const std::string name, int64_t delay_us = 0);
 
+  /// Same as above, for an event registered with stats().RegisterEvent(), which isn't
+  /// looked up by name. Use it on hot paths.
+  ///
+  /// \param handler The handler to be posted to the event loop.
+  /// \param event The registered event of the handler.
+  /// \param delay_us Delay time before the handler will be executed.
+  void post(std::function<void()> handler,
+            const EventHandle &event,
+            int64_t delay_us = 0);
+
   /// A proxy post function that collects count, queueing, and execution statistics for
   /// the given handler.
   ///
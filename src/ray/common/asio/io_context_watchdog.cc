@@ -0,0 +1,189 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/asio/io_context_watchdog.h"
+
+#include <sstream>
+
+#include "absl/time/clock.h"
+#include "ray/common/ray_config.h"
+#include "ray/stats/metric_defs.h"
+#include "ray/util/stack_trace.h"
+#include "ray/util/util.h"
+
+namespace ray {
+
+namespace {
+
+/// How long to wait for the thread running the loop to get its stack trace.
+constexpr absl::Duration kStackTraceTimeout = absl::Milliseconds(100);
+
+}  // namespace
+
+std::string IoContextWatchdog::Stall::DebugString() const {
+  std::ostringstream result;
+  result << "stall at " << absl::FormatTime(start_time) << ": lag "
+         << absl::ToInt64Milliseconds(lag) << " ms";
+  if (duration.has_value()) {
+    result << ", duration " << absl::ToInt64Milliseconds(*duration) << " ms";
+  } else {
+    result << ", ongoing";
+  }
+  if (!handler.empty()) {
+    result << ", running " << handler << " for "
+           << absl::ToInt64Milliseconds(handler_execution_time) << " ms";
+  }
+  if (!stack_trace.empty()) {
+    result << "\n" << stack_trace;
+  }
+  return result.str();
+}
+
+IoContextWatchdog::IoContextWatchdog(instrumented_io_context &io_context,
+                                     std::string name,
+                                     uint64_t period_ms,
+                                     uint64_t stall_threshold_ms,
+                                     size_t max_num_stalls)
+    : io_context_(io_context),
+      name_(std::move(name)),
+      period_(absl::Milliseconds(period_ms)),
+      stall_threshold_ns_(stall_threshold_ms * 1000 * 1000),
+      max_num_stalls_(max_num_stalls),
+      heartbeat_event_(io_context.stats().RegisterEvent("IoContextWatchdog.Heartbeat")),
+      heartbeat_(std::make_shared<Heartbeat>()),
+      lag_metric_(stats::STATS_io_context_lag_ms.Bind(name_)) {
+  RAY_CHECK(period_ms > 0);
+  thread_ = std::thread([this]() {
+    SetThreadName("watchdog." + name_);
+    while (!stop_.WaitForNotificationWithTimeout(period_)) {
+      CheckHeartbeat();
+    }
+  });
+}
+
+IoContextWatchdog::~IoContextWatchdog() {
+  stop_.Notify();
+  thread_.join();
+}
+
+std::unique_ptr<IoContextWatchdog> IoContextWatchdog::Create(
+    instrumented_io_context &io_context, std::string name) {
+  const auto period_ms = RayConfig::instance().event_loop_watchdog_period_ms();
+  if (period_ms == 0) {
+    return nullptr;
+  }
+  return std::make_unique<IoContextWatchdog>(
+      io_context,
+      std::move(name),
+      period_ms,
+      RayConfig::instance().event_loop_stall_threshold_ms());
+}
+
+void IoContextWatchdog::CheckHeartbeat() {
+  if (io_context_.stopped()) {
+    // The queued heartbeat won't be handled.
+    return;
+  }
+  const int64_t now = absl::GetCurrentTimeNanos();
+  absl::optional<int64_t> post_time_ns;
+  absl::optional<int64_t> lag_ns;
+  int64_t thread_id;
+  {
+    absl::MutexLock lock(&heartbeat_->mutex);
+    post_time_ns = heartbeat_->post_time_ns;
+    lag_ns = heartbeat_->lag_ns;
+    thread_id = heartbeat_->thread_id;
+    if (!post_time_ns.has_value()) {
+      heartbeat_->post_time_ns = now;
+    }
+  }
+
+  if (post_time_ns.has_value()) {
+    // The heartbeat is still queued.
+    const int64_t queued_ns = now - *post_time_ns;
+    if (!stalled_ && queued_ns >= stall_threshold_ns_) {
+      stalled_ = true;
+      RecordStall(*post_time_ns, queued_ns, thread_id);
+    }
+    return;
+  }
+
+  if (lag_ns.has_value()) {
+    lag_metric_.Record(*lag_ns / 1e6);
+  }
+  if (stalled_) {
+    stalled_ = false;
+    RAY_LOG(WARNING) << "The event loop " << name_ << " recovered from a stall of "
+                     << *lag_ns / 1000 / 1000 << " ms.";
+    absl::MutexLock lock(&mutex_);
+    if (!stalls_.empty()) {
+      stalls_.back().duration = absl::Nanoseconds(*lag_ns);
+    }
+  }
+  io_context_.post(
+      [heartbeat = heartbeat_]() {
+        absl::MutexLock lock(&heartbeat->mutex);
+        heartbeat->lag_ns = absl::GetCurrentTimeNanos() - *heartbeat->post_time_ns;
+        heartbeat->post_time_ns.reset();
+        heartbeat->thread_id = GetNativeThreadId();
+      },
+      heartbeat_event_);
+}
+
+void IoContextWatchdog::RecordStall(int64_t post_time_ns,
+                                    int64_t lag_ns,
+                                    int64_t thread_id) {
+  Stall stall;
+  stall.start_time = absl::FromUnixNanos(post_time_ns);
+  stall.lag = absl::Nanoseconds(lag_ns);
+  auto running_event = io_context_.stats().GetRunningEvent();
+  if (running_event.has_value()) {
+    stall.handler = running_event->first;
+    stall.handler_execution_time =
+        absl::Nanoseconds(absl::GetCurrentTimeNanos() - running_event->second);
+  }
+  // The thread running the loop is known once it handled a heartbeat.
+  if (thread_id != 0) {
+    stall.stack_trace =
+        FormatStackTrace(GetThreadStackTrace(thread_id, kStackTraceTimeout));
+  }
+  RAY_LOG(WARNING) << "The event loop " << name_ << " is stalled, "
+                   << stall.DebugString();
+  stats::STATS_io_context_stalls.Record(1, name_);
+
+  absl::MutexLock lock(&mutex_);
+  num_stalls_++;
+  stalls_.push_back(std::move(stall));
+  if (stalls_.size() > max_num_stalls_) {
+    stalls_.pop_front();
+  }
+}
+
+std::vector<IoContextWatchdog::Stall> IoContextWatchdog::GetStalls() const {
+  absl::MutexLock lock(&mutex_);
+  return std::vector<Stall>(stalls_.begin(), stalls_.end());
+}
+
+std::string IoContextWatchdog::DebugString() const {
+  absl::MutexLock lock(&mutex_);
+  std::ostringstream result;
+  result << "IoContextWatchdog " << name_ << ":";
+  result << "\n- num stalls: " << num_stalls_;
+  for (const auto &stall : stalls_) {
+    result << "\n- " << stall.DebugString();
+  }
+  return result.str();
+}
+
+}  // namespace ray
@@ -0,0 +1,140 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/stats/bound_metric.h"
+
+namespace ray {
+
+/// A watchdog detecting the stalls of an event loop while they happen.
+///
+/// Its thread posts a heartbeat to the event loop every period, and the lag of the loop
+/// is the queueing time of the heartbeats. When a heartbeat is queued for longer than
+/// the stall threshold, the loop is stalled: the watchdog records the handler being
+/// executed by the loop and the stack trace of the thread running it, logs them and
+/// keeps them in a buffer of the latest stalls. The lag and the stalls are also
+/// recorded as metrics tagged with the name of the loop.
+///
+/// The event loop must be run by a single thread. This class is thread-safe.
+class IoContextWatchdog {
+ public:
+  /// A stall of the event loop.
+  struct Stall {
+    /// When the stalled heartbeat was posted.
+    absl::Time start_time;
+    /// The lag of the loop when the stall was detected.
+    absl::Duration lag;
+    /// The total lag of the stalled heartbeat, or nullopt if the loop is still stalled.
+    absl::optional<absl::Duration> duration;
+    /// The handler being executed when the stall was detected, and for how long it was
+    /// executed. The name is empty if it's unknown, i.e. if the handler isn't posted
+    /// with the event stats.
+    std::string handler;
+    absl::Duration handler_execution_time;
+    /// The stack trace of the thread running the loop when the stall was detected, or
+    /// empty if it couldn't be captured.
+    std::string stack_trace;
+
+    std::string DebugString() const;
+  };
+
+  /// Start watching an event loop.
+  ///
+  /// \param io_context The event loop. It must outlive the watchdog.
+  /// \param name The name of the loop in the logs and the metrics.
+  /// \param period_ms The period of the heartbeats.
+  /// \param stall_threshold_ms The lag after which the loop is stalled.
+  /// \param max_num_stalls The number of latest stalls which are kept.
+  IoContextWatchdog(instrumented_io_context &io_context,
+                    std::string name,
+                    uint64_t period_ms,
+                    uint64_t stall_threshold_ms,
+                    size_t max_num_stalls = 16);
+
+  /// Stop watching the event loop.
+  ~IoContextWatchdog();
+
+  /// Start watching an event loop with the period and the stall threshold of the
+  /// config.
+  ///
+  /// \return The watchdog, or null if the watchdogs are disabled.
+  static std::unique_ptr<IoContextWatchdog> Create(instrumented_io_context &io_context,
+                                                   std::string name);
+
+  /// Get the latest stalls, from the oldest one.
+  std::vector<Stall> GetStalls() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  std::string DebugString() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  /// The state shared with the heartbeats, which may outlive the watchdog in the queue
+  /// of the loop.
+  struct Heartbeat {
+    absl::Mutex mutex;
+    /// When the heartbeat in the queue was posted, or nullopt if there is none.
+    absl::optional<int64_t> post_time_ns ABSL_GUARDED_BY(mutex);
+    /// The lag of the last handled heartbeat.
+    absl::optional<int64_t> lag_ns ABSL_GUARDED_BY(mutex);
+    /// The thread running the loop, see GetNativeThreadId.
+    int64_t thread_id ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  /// Check the last heartbeat, and post the next one if it was handled. It's called by
+  /// the thread of the watchdog every period.
+  void CheckHeartbeat();
+
+  /// Record a stall of the loop, whose heartbeat posted at post_time_ns is queued for
+  /// lag_ns.
+  void RecordStall(int64_t post_time_ns, int64_t lag_ns, int64_t thread_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  instrumented_io_context &io_context_;
+  const std::string name_;
+  const absl::Duration period_;
+  const int64_t stall_threshold_ns_;
+  const size_t max_num_stalls_;
+  const EventHandle heartbeat_event_;
+  const std::shared_ptr<Heartbeat> heartbeat_;
+  stats::BoundMetric &lag_metric_;
+
+  /// Whether the last stall is ongoing. It's only accessed by the thread of the
+  /// watchdog.
+  bool stalled_ = false;
+
+  mutable absl::Mutex mutex_;
+
+  /// The latest stalls, from the oldest one.
+  std::deque<Stall> stalls_ ABSL_GUARDED_BY(mutex_);
+
+  /// The total number of stalls.
+  int64_t num_stalls_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  absl::Notification stop_;
+  std::thread thread_;
+};
+
+}  // namespace ray
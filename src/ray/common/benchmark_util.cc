@@ -0,0 +1,278 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/benchmark_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <thread>
+
+#include "absl/strings/match.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "boost/asio/ip/host_name.hpp"
+#include "nlohmann/json.hpp"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace benchmark {
+
+namespace {
+
+/// The max number of iterations of a benchmark.
+constexpr int64_t kMaxIterations = 1000 * 1000 * 1000;
+
+int64_t RealTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// The CPU time of the thread running the benchmark. The CPU time of the other
+/// threads, e.g. of a store, isn't counted.
+int64_t CpuTimeNs() {
+#ifdef _WIN32
+  return static_cast<int64_t>(std::clock()) * 1000 * 1000 * 1000 / CLOCKS_PER_SEC;
+#else
+  struct timespec spec;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &spec);
+  return static_cast<int64_t>(spec.tv_sec) * 1000 * 1000 * 1000 + spec.tv_nsec;
+#endif
+}
+
+std::vector<std::unique_ptr<Benchmark>> &Benchmarks() {
+  static auto *benchmarks = new std::vector<std::unique_ptr<Benchmark>>();
+  return *benchmarks;
+}
+
+struct Result {
+  std::string name;
+  int64_t iterations;
+  double real_time_ns;
+  double cpu_time_ns;
+  int64_t items_processed;
+  double real_time_s;
+};
+
+/// Run a benchmark with more and more iterations, until it runs for the min time.
+Result RunBenchmark(const std::string &name,
+                    const Benchmark &benchmark,
+                    const std::vector<int64_t> &args,
+                    double min_time_s) {
+  int64_t iterations = 1;
+  while (true) {
+    State state(iterations, args);
+    benchmark.function()(state);
+    const double real_time_s = state.real_time_ns() / 1e9;
+    if (real_time_s >= min_time_s || iterations >= kMaxIterations) {
+      return Result{name,
+                    iterations,
+                    static_cast<double>(state.real_time_ns()) / iterations,
+                    static_cast<double>(state.cpu_time_ns()) / iterations,
+                    state.items_processed(),
+                    real_time_s};
+    }
+    // Aim a bit above the min time, and don't grow more than 10x from a run too short
+    // to be representative.
+    double multiplier = min_time_s * 1.4 / std::max(real_time_s, 1e-9);
+    if (real_time_s / min_time_s <= 0.1) {
+      multiplier = std::min(multiplier, 10.0);
+    }
+    iterations = std::min(
+        kMaxIterations,
+        std::max(iterations + 1, static_cast<int64_t>(iterations * multiplier)));
+  }
+}
+
+nlohmann::json ToJson(const std::vector<Result> &results, const char *executable) {
+  nlohmann::json json;
+  json["context"] = {
+      {"date",
+       absl::FormatTime("%Y-%m-%dT%H:%M:%S%Ez", absl::Now(), absl::LocalTimeZone())},
+      {"host_name", boost::asio::ip::host_name()},
+      {"executable", executable},
+      {"num_cpus", std::thread::hardware_concurrency()},
+#ifdef NDEBUG
+      {"library_build_type", "release"},
+#else
+      {"library_build_type", "debug"},
+#endif
+  };
+  json["benchmarks"] = nlohmann::json::array();
+  for (const auto &result : results) {
+    nlohmann::json benchmark = {
+        {"name", result.name},
+        {"run_name", result.name},
+        {"run_type", "iteration"},
+        {"iterations", result.iterations},
+        {"real_time", result.real_time_ns},
+        {"cpu_time", result.cpu_time_ns},
+        {"time_unit", "ns"},
+    };
+    if (result.items_processed > 0) {
+      benchmark["items_per_second"] = result.items_processed / result.real_time_s;
+    }
+    json["benchmarks"].push_back(std::move(benchmark));
+  }
+  return json;
+}
+
+void PrintConsoleResult(const Result &result) {
+  std::cout << std::left << std::setw(60) << result.name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << result.real_time_ns << " ns"
+            << std::setw(14) << result.cpu_time_ns << " ns" << std::setw(12)
+            << result.iterations;
+  if (result.items_processed > 0) {
+    std::cout << "  items_per_second=" << std::setprecision(0)
+              << result.items_processed / result.real_time_s;
+  }
+  std::cout << std::endl;
+}
+
+}  // namespace
+
+State::State(int64_t max_iterations, std::vector<int64_t> args)
+    : max_iterations_(max_iterations), args_(std::move(args)) {}
+
+bool State::KeepRunning() {
+  if (!started_) {
+    started_ = true;
+    StartTimer();
+  }
+  if (num_iterations_ < max_iterations_) {
+    num_iterations_++;
+    return true;
+  }
+  if (running_) {
+    StopTimer();
+  }
+  return false;
+}
+
+void State::PauseTiming() {
+  RAY_CHECK(running_) << "The timer isn't running.";
+  StopTimer();
+}
+
+void State::ResumeTiming() {
+  RAY_CHECK(!running_) << "The timer is already running.";
+  StartTimer();
+}
+
+int64_t State::range(size_t index) const {
+  RAY_CHECK(index < args_.size()) << "The benchmark has " << args_.size()
+                                  << " arguments, but argument " << index
+                                  << " is read.";
+  return args_[index];
+}
+
+void State::StartTimer() {
+  running_ = true;
+  real_start_ns_ = RealTimeNs();
+  cpu_start_ns_ = CpuTimeNs();
+}
+
+void State::StopTimer() {
+  real_time_ns_ += RealTimeNs() - real_start_ns_;
+  cpu_time_ns_ += CpuTimeNs() - cpu_start_ns_;
+  running_ = false;
+}
+
+Benchmark *RegisterBenchmark(const std::string &name, BenchmarkFunction function) {
+  Benchmarks().push_back(std::make_unique<Benchmark>(name, std::move(function)));
+  return Benchmarks().back().get();
+}
+
+int RunBenchmarks(int argc, char **argv) {
+  std::string filter = ".";
+  double min_time_s = 0.5;
+  std::string format = "console";
+  std::string out_path;
+  for (int i = 1; i < argc; ++i) {
+    const std::string flag = argv[i];
+    auto value_of = [&flag](const std::string &name, std::string *value) {
+      const std::string prefix = "--" + name + "=";
+      if (!absl::StartsWith(flag, prefix)) {
+        return false;
+      }
+      *value = flag.substr(prefix.size());
+      return true;
+    };
+    std::string value;
+    if (value_of("benchmark_filter", &value)) {
+      filter = value;
+    } else if (value_of("benchmark_min_time", &value)) {
+      min_time_s = std::stod(value);
+    } else if (value_of("benchmark_format", &value) &&
+               (value == "console" || value == "json")) {
+      format = value;
+    } else if (value_of("benchmark_out", &value)) {
+      out_path = value;
+    } else {
+      std::cerr << "Unrecognized flag " << flag << ". See benchmark_util.h for the flags."
+                << std::endl;
+      return 1;
+    }
+  }
+
+  const std::regex filter_regex(filter);
+  if (format == "console") {
+    std::cout << std::left << std::setw(60) << "Benchmark" << std::right
+              << std::setw(17) << "Time" << std::setw(17) << "CPU" << std::setw(12)
+              << "Iterations" << std::endl;
+  }
+  std::vector<Result> results;
+  for (const auto &benchmark : Benchmarks()) {
+    auto args = benchmark->args();
+    if (args.empty()) {
+      args.push_back({});
+    }
+    for (const auto &run_args : args) {
+      std::string name = benchmark->name();
+      for (const auto arg : run_args) {
+        name += "/" + std::to_string(arg);
+      }
+      if (!std::regex_search(name, filter_regex)) {
+        continue;
+      }
+      results.push_back(RunBenchmark(name, *benchmark, run_args, min_time_s));
+      if (format == "console") {
+        PrintConsoleResult(results.back());
+      }
+    }
+  }
+
+  const auto json = ToJson(results, argv[0]);
+  if (format == "json") {
+    std::cout << json.dump(2) << std::endl;
+  }
+  if (!out_path.empty()) {
+    std::ofstream out(out_path);
+    out << json.dump(2) << std::endl;
+    if (!out) {
+      std::cerr << "Failed to write the results to " << out_path << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace benchmark
+}  // namespace ray
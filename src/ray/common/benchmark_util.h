@@ -0,0 +1,159 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ray {
+namespace benchmark {
+
+/// Microbenchmarks of the C++ data paths
+/// =====================================
+/// A benchmark is a function which runs its loop as long as `State::KeepRunning`
+/// returns true, and is registered with RAY_BENCHMARK, optionally once per argument:
+///
+///   void BM_ObjectIdHash(State &state) {
+///     const auto id = ObjectID::FromRandom();
+///     while (state.KeepRunning()) {
+///       DoNotOptimize(ObjectID(id).Hash());
+///     }
+///   }
+///   RAY_BENCHMARK(BM_ObjectIdHash);
+///   RAY_BENCHMARK(BM_Schedule)->Arg(10)->Arg(1000);
+///
+/// Every benchmark binary links benchmark_main, and is run with e.g.
+///   bazel run -c opt //:hybrid_scheduling_policy_benchmark -- \
+///     --benchmark_filter=BM_Schedule --benchmark_out=/tmp/scheduling.json
+///
+/// The flags and the JSON results are a subset of Google Benchmark's, so that the
+/// results can be compared across releases with its tools.
+
+/// The state of a run of a benchmark, which times a number of iterations of its loop.
+class State {
+ public:
+  State(int64_t max_iterations, std::vector<int64_t> args);
+
+  /// Whether to run the loop once more. The timer starts at the first call, and stops
+  /// at the call which returns false.
+  bool KeepRunning();
+
+  /// Stop the timer, e.g. to clean up between the iterations.
+  void PauseTiming();
+
+  /// Restart the timer stopped by PauseTiming.
+  void ResumeTiming();
+
+  /// The argument of the benchmark registered with Arg.
+  int64_t range(size_t index = 0) const;
+
+  /// The number of iterations of the loop.
+  int64_t iterations() const { return max_iterations_; }
+
+  /// Report the number of items processed by all the iterations, e.g. when an
+  /// iteration processes a batch of them.
+  void SetItemsProcessed(int64_t items_processed) { items_processed_ = items_processed; }
+
+  int64_t items_processed() const { return items_processed_; }
+
+  /// The time of the iterations, excluding the time paused.
+  int64_t real_time_ns() const { return real_time_ns_; }
+  int64_t cpu_time_ns() const { return cpu_time_ns_; }
+
+ private:
+  void StartTimer();
+  void StopTimer();
+
+  const int64_t max_iterations_;
+  const std::vector<int64_t> args_;
+  int64_t num_iterations_ = 0;
+  bool started_ = false;
+  bool running_ = false;
+  int64_t real_start_ns_ = 0;
+  int64_t cpu_start_ns_ = 0;
+  int64_t real_time_ns_ = 0;
+  int64_t cpu_time_ns_ = 0;
+  int64_t items_processed_ = 0;
+};
+
+using BenchmarkFunction = std::function<void(State &)>;
+
+/// A registered benchmark, which is run once per argument.
+class Benchmark {
+ public:
+  Benchmark(std::string name, BenchmarkFunction function)
+      : name_(std::move(name)), function_(std::move(function)) {}
+
+  /// Run the benchmark with an argument, which it reads with `State::range`.
+  Benchmark *Arg(int64_t arg) {
+    args_.push_back({arg});
+    return this;
+  }
+
+  /// Run the benchmark with several arguments.
+  Benchmark *Args(std::vector<int64_t> args) {
+    args_.push_back(std::move(args));
+    return this;
+  }
+
+  const std::string &name() const { return name_; }
+  const BenchmarkFunction &function() const { return function_; }
+  const std::vector<std::vector<int64_t>> &args() const { return args_; }
+
+ private:
+  const std::string name_;
+  const BenchmarkFunction function_;
+  std::vector<std::vector<int64_t>> args_;
+};
+
+/// Register a benchmark to be run by RunBenchmarks.
+Benchmark *RegisterBenchmark(const std::string &name, BenchmarkFunction function);
+
+/// Run the benchmarks registered, and print their results.
+///
+/// The flags are:
+///   --benchmark_filter=<regex>: Only run the benchmarks whose names match.
+///   --benchmark_min_time=<seconds>: The min time of a benchmark, 0.5 by default.
+///   --benchmark_format=<console|json>: The format of the results printed.
+///   --benchmark_out=<file>: Also write the results as JSON to the file.
+///
+/// \return The exit code of the benchmark binary.
+int RunBenchmarks(int argc, char **argv);
+
+/// Prevent the compiler from optimizing away a value computed by a benchmark.
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const void *volatile sink;
+  sink = &value;
+#endif
+}
+
+}  // namespace benchmark
+}  // namespace ray
+
+#define RAY_BENCHMARK_CONCAT(a, b) a##b
+#define RAY_BENCHMARK_NAME(function, line) \
+  RAY_BENCHMARK_CONCAT(ray_benchmark_##function##_, line)
+
+/// Register a benchmark function. Arguments are added by chaining Arg calls.
+#define RAY_BENCHMARK(function)                                                      \
+  static ::ray::benchmark::Benchmark *const RAY_BENCHMARK_NAME(function, __LINE__) = \
+      ::ray::benchmark::RegisterBenchmark(#function, function)
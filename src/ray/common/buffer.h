@@ -118,6 +118,42 @@ class LocalMemoryBuffer : public Buffer {
   uint8_t *buffer_ = NULL;
 };
 
+/// A buffer which aliases memory owned by another object, e.g., the bytes of a
+/// received protobuf message. It holds a reference to the owner, so that the data stays
+/// valid for as long as the buffer is used, without being copied.
+class AliasedBuffer : public Buffer {
+ public:
+  /// Constructor.
+  ///
+  /// \param data The data pointer, which must be valid while the owner is alive.
+  /// \param size The size of the data.
+  /// \param owner The object that owns the data.
+  AliasedBuffer(const uint8_t *data, size_t size, std::shared_ptr<const void> owner)
+      : data_(const_cast<uint8_t *>(data)), size_(size), owner_(std::move(owner)) {
+    RAY_CHECK(owner_ != nullptr);
+  }
+
+  uint8_t *Data() const override { return data_; }
+
+  size_t Size() const override { return size_; }
+
+  /// The data is kept valid by the owner, so it doesn't need to be copied.
+  bool OwnsData() const override { return true; }
+
+  bool IsPlasmaBuffer() const override { return false; }
+
+ private:
+  AliasedBuffer &operator=(const AliasedBuffer &) = delete;
+  AliasedBuffer(const AliasedBuffer &) = delete;
+
+  /// Pointer to the data.
+  uint8_t *data_;
+  /// Size of the data.
+  size_t size_;
+  /// Keep the owner of the data alive.
+  std::shared_ptr<const void> owner_;
+};
+
 /// Represents a byte buffer in shared memory.
 class SharedMemoryBuffer : public Buffer {
  public:
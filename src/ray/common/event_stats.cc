@@ -25,20 +25,11 @@
 
 namespace {
 
-/// A helper for creating a snapshot view of the global stats.
-/// This acquires a reader lock on the provided global stats, and creates a
-/// lockless copy of the stats.
-GlobalStats to_global_stats_view(std::shared_ptr<GuardedGlobalStats> stats) {
-  absl::MutexLock lock(&(stats->mutex));
-  return GlobalStats(stats->stats);
-}
-
-/// A helper for creating a snapshot view of the stats for a event.
-/// This acquires a lock on the provided guarded event stats, and creates a
-/// lockless copy of the stats.
-EventStats to_event_stats_view(std::shared_ptr<GuardedEventStats> stats) {
-  absl::MutexLock lock(&(stats->mutex));
-  return EventStats(stats->stats);
+/// A helper for getting the index of the stats shards of the calling thread.
+size_t GetThreadShardIndex() {
+  static std::atomic<size_t> next_index{0};
+  thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
 }
 
 /// A helper for converting a duration into a human readable string, such as "5.346 ms".
@@ -59,41 +50,91 @@ std::string to_human_readable(int64_t duration) {
 
 }  // namespace
 
+void ShardedEventStats::Shard::RecordQueueTime(int64_t queue_time_ns) {
+  cum_queue_time.fetch_add(queue_time_ns, std::memory_order_relaxed);
+  auto min = min_queue_time.load(std::memory_order_relaxed);
+  while (queue_time_ns < min &&
+         !min_queue_time.compare_exchange_weak(
+             min, queue_time_ns, std::memory_order_relaxed)) {
+  }
+  auto max = max_queue_time.load(std::memory_order_relaxed);
+  while (queue_time_ns > max &&
+         !max_queue_time.compare_exchange_weak(
+             max, queue_time_ns, std::memory_order_relaxed)) {
+  }
+}
+
+ShardedEventStats::Shard &ShardedEventStats::LocalShard() {
+  return shards_[GetThreadShardIndex() % kNumShards];
+}
+
+EventStats ShardedEventStats::Snapshot() const {
+  EventStats stats;
+  for (const auto &shard : shards_) {
+    stats.cum_count += shard.cum_count.load(std::memory_order_relaxed);
+    stats.curr_count += shard.curr_count.load(std::memory_order_relaxed);
+    stats.cum_execution_time += shard.cum_execution_time.load(std::memory_order_relaxed);
+    stats.cum_queue_time += shard.cum_queue_time.load(std::memory_order_relaxed);
+    stats.min_queue_time = std::min(stats.min_queue_time,
+                                    shard.min_queue_time.load(std::memory_order_relaxed));
+    stats.max_queue_time = std::max(stats.max_queue_time,
+                                    shard.max_queue_time.load(std::memory_order_relaxed));
+    stats.running_count += shard.running_count.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+EventHandle EventTracker::RegisterEvent(const std::string &name) {
+  return EventHandle{GetOrCreate(name).get()};
+}
+
 std::shared_ptr<StatsHandle> EventTracker::RecordStart(
     const std::string &name, int64_t expected_queueing_delay_ns) {
   auto stats = GetOrCreate(name);
-  int64_t cum_count = 0;
-  int64_t curr_count = 0;
-  {
-    absl::MutexLock lock(&(stats->mutex));
-    cum_count = ++stats->stats.cum_count;
-    curr_count = ++stats->stats.curr_count;
-  }
+  const auto start_time = RecordQueuedImpl(*stats, expected_queueing_delay_ns);
+  return std::make_shared<StatsHandle>(std::move(stats), start_time, global_stats_);
+}
+
+std::shared_ptr<StatsHandle> EventTracker::RecordStart(
+    const EventHandle &event, int64_t expected_queueing_delay_ns) {
+  const auto start_time = RecordQueuedImpl(*event.stats, expected_queueing_delay_ns);
+  return std::make_shared<StatsHandle>(
+      event.stats->shared_from_this(), start_time, global_stats_);
+}
+
+int64_t EventTracker::RecordQueued(const EventHandle &event) {
+  return RecordQueuedImpl(*event.stats, /*expected_queueing_delay_ns=*/0);
+}
+
+int64_t EventTracker::RecordQueuedImpl(ShardedEventStats &stats,
+                                       int64_t expected_queueing_delay_ns) {
+  auto &shard = stats.LocalShard();
+  shard.cum_count.fetch_add(1, std::memory_order_relaxed);
+  shard.curr_count.fetch_add(1, std::memory_order_relaxed);
 
   if (RayConfig::instance().event_stats_metrics()) {
-    ray::stats::STATS_operation_count.Record(cum_count, name);
-    ray::stats::STATS_operation_active_count.Record(curr_count, name);
+    const auto snapshot = stats.Snapshot();
+    ray::stats::STATS_operation_count.Record(snapshot.cum_count, stats.name());
+    ray::stats::STATS_operation_active_count.Record(snapshot.curr_count, stats.name());
   }
 
-  return std::make_shared<StatsHandle>(
-      name,
-      absl::GetCurrentTimeNanos() + expected_queueing_delay_ns,
-      std::move(stats),
-      global_stats_);
+  return absl::GetCurrentTimeNanos() + expected_queueing_delay_ns;
 }
 
 void EventTracker::RecordEnd(std::shared_ptr<StatsHandle> handle) {
   RAY_CHECK(!handle->end_or_execution_recorded);
-  absl::MutexLock lock(&(handle->handler_stats->mutex));
-  const auto curr_count = --handle->handler_stats->stats.curr_count;
+  auto &stats = *handle->handler_stats;
+  auto &shard = stats.LocalShard();
+  shard.curr_count.fetch_sub(1, std::memory_order_relaxed);
   const auto execution_time_ns = absl::GetCurrentTimeNanos() - handle->start_time;
-  handle->handler_stats->stats.cum_execution_time += execution_time_ns;
+  shard.cum_execution_time.fetch_add(execution_time_ns, std::memory_order_relaxed);
 
   if (RayConfig::instance().event_stats_metrics()) {
     // Update event-specific stats.
     ray::stats::STATS_operation_run_time_ms.Record(execution_time_ns / 1000000,
                                                    handle->event_name);
-    ray::stats::STATS_operation_active_count.Record(curr_count, handle->event_name);
+    ray::stats::STATS_operation_active_count.Record(stats.Snapshot().curr_count,
+                                                    handle->event_name);
   }
 
   handle->end_or_execution_recorded = true;
@@ -102,66 +143,70 @@ void EventTracker::RecordEnd(std::shared_ptr<StatsHandle> handle) {
 void EventTracker::RecordExecution(const std::function<void()> &fn,
                                    std::shared_ptr<StatsHandle> handle) {
   RAY_CHECK(!handle->end_or_execution_recorded);
+  RecordExecutionImpl(
+      fn, *handle->handler_stats, *handle->global_stats, handle->start_time);
+  handle->end_or_execution_recorded = true;
+}
+
+void EventTracker::RecordExecution(const std::function<void()> &fn,
+                                   const EventHandle &event,
+                                   int64_t start_time) {
+  RecordExecutionImpl(fn, *event.stats, *global_stats_, start_time);
+}
+
+void EventTracker::RecordExecutionImpl(const std::function<void()> &fn,
+                                       ShardedEventStats &stats,
+                                       ShardedEventStats &global_stats,
+                                       int64_t start_time) {
   int64_t start_execution = absl::GetCurrentTimeNanos();
   // Update running count
-  {
-    auto &stats = handle->handler_stats;
-    absl::MutexLock lock(&(stats->mutex));
-    stats->stats.running_count++;
-  }
+  stats.LocalShard().running_count.fetch_add(1, std::memory_order_relaxed);
+  // Track the running event. The previous one is restored after, since a handler may
+  // run other handlers, e.g. with run_one().
+  const auto *previous_event = global_stats.running_event.load(std::memory_order_relaxed);
+  const auto previous_start_time =
+      global_stats.running_event_start_time.load(std::memory_order_relaxed);
+  global_stats.running_event_start_time.store(start_execution,
+                                              std::memory_order_relaxed);
+  global_stats.running_event.store(&stats, std::memory_order_release);
   // Execute actual function.
   fn();
+  global_stats.running_event_start_time.store(previous_start_time,
+                                              std::memory_order_relaxed);
+  global_stats.running_event.store(previous_event, std::memory_order_release);
   int64_t end_execution = absl::GetCurrentTimeNanos();
   // Update execution time stats.
   const auto execution_time_ns = end_execution - start_execution;
-  int64_t curr_count;
-  const auto queue_time_ns = start_execution - handle->start_time;
+  const auto queue_time_ns = start_execution - start_time;
   {
-    auto &stats = handle->handler_stats;
-    absl::MutexLock lock(&(stats->mutex));
+    auto &shard = stats.LocalShard();
     // Event-specific execution stats.
-    stats->stats.cum_execution_time += execution_time_ns;
-    stats->stats.cum_queue_time += queue_time_ns;
-    if (stats->stats.min_queue_time > queue_time_ns) {
-      stats->stats.min_queue_time = queue_time_ns;
-    }
-    if (stats->stats.max_queue_time < queue_time_ns) {
-      stats->stats.max_queue_time = queue_time_ns;
-    }
+    shard.cum_execution_time.fetch_add(execution_time_ns, std::memory_order_relaxed);
+    shard.RecordQueueTime(queue_time_ns);
     // Event-specific current count.
-    curr_count = --stats->stats.curr_count;
+    shard.curr_count.fetch_sub(1, std::memory_order_relaxed);
     // Event-specific running count.
-    stats->stats.running_count--;
+    shard.running_count.fetch_sub(1, std::memory_order_relaxed);
   }
 
   if (RayConfig::instance().event_stats_metrics()) {
     // Update event-specific stats.
     ray::stats::STATS_operation_run_time_ms.Record(execution_time_ns / 1000000,
-                                                   handle->event_name);
-    ray::stats::STATS_operation_active_count.Record(curr_count, handle->event_name);
+                                                   stats.name());
+    ray::stats::STATS_operation_active_count.Record(stats.Snapshot().curr_count,
+                                                    stats.name());
     // Update global stats.
     ray::stats::STATS_operation_queue_time_ms.Record(queue_time_ns / 1000000,
-                                                     handle->event_name);
+                                                     stats.name());
   }
 
-  {
-    auto global_stats = handle->global_stats;
-    absl::MutexLock lock(&(global_stats->mutex));
-    // Global queue stats.
-    global_stats->stats.cum_queue_time += queue_time_ns;
-    if (global_stats->stats.min_queue_time > queue_time_ns) {
-      global_stats->stats.min_queue_time = queue_time_ns;
-    }
-    if (global_stats->stats.max_queue_time < queue_time_ns) {
-      global_stats->stats.max_queue_time = queue_time_ns;
-    }
-  }
-  handle->end_or_execution_recorded = true;
+  // Global queue stats.
+  global_stats.LocalShard().RecordQueueTime(queue_time_ns);
 }
 
-std::shared_ptr<GuardedEventStats> EventTracker::GetOrCreate(const std::string &name) {
+std::shared_ptr<ShardedEventStats> EventTracker::GetOrCreate(const std::string &name) {
   // Get this event's stats.
-  std::shared_ptr<GuardedEventStats> result;
+  std::shared_ptr<ShardedEventStats> result;
   mutex_.ReaderLock();
   auto it = post_handler_stats_.find(name);
   if (it == post_handler_stats_.end()) {
@@ -171,9 +216,11 @@ std::shared_ptr<GuardedEventStats> EventTracker::GetOrCreate(const std::string &
     // this allows the common path, in which the handler already exists in the hash table,
     // to only require the readers lock.
     absl::WriterMutexLock lock(&mutex_);
-    const auto pair =
-        post_handler_stats_.try_emplace(name, std::make_shared<GuardedEventStats>());
+    const auto pair = post_handler_stats_.try_emplace(name, nullptr);
     it = pair.first;
+    if (pair.second) {
+      it->second = std::make_shared<ShardedEventStats>(name);
+    }
     result = it->second;
   } else {
     result = it->second;
@@ -183,7 +230,12 @@ std::shared_ptr<GuardedEventStats> EventTracker::GetOrCreate(const std::string &
 }
 
 GlobalStats EventTracker::get_global_stats() const {
-  return to_global_stats_view(global_stats_);
+  const auto snapshot = global_stats_->Snapshot();
+  GlobalStats stats;
+  stats.cum_queue_time = snapshot.cum_queue_time;
+  stats.min_queue_time = snapshot.min_queue_time;
+  stats.max_queue_time = snapshot.max_queue_time;
+  return stats;
 }
 
 absl::optional<EventStats> EventTracker::get_event_stats(
@@ -193,7 +245,7 @@ absl::optional<EventStats> EventTracker::get_event_stats(
   if (it == post_handler_stats_.end()) {
     return {};
   }
-  return to_event_stats_view(it->second);
+  return it->second->Snapshot();
 }
 
 std::vector<std::pair<std::string, EventStats>> EventTracker::get_event_stats() const {
@@ -204,12 +256,22 @@ std::vector<std::pair<std::string, EventStats>> EventTracker::get_event_stats()
   std::transform(post_handler_stats_.begin(),
                  post_handler_stats_.end(),
                  std::back_inserter(stats),
-                 [](const std::pair<std::string, std::shared_ptr<GuardedEventStats>> &p) {
-                   return std::make_pair(p.first, to_event_stats_view(p.second));
+                 [](const std::pair<std::string, std::shared_ptr<ShardedEventStats>> &p) {
+                   return std::make_pair(p.first, p.second->Snapshot());
                  });
   return stats;
 }
 
+absl::optional<std::pair<std::string, int64_t>> EventTracker::GetRunningEvent() const {
+  const auto *event = global_stats_->running_event.load(std::memory_order_acquire);
+  if (event == nullptr) {
+    return absl::nullopt;
+  }
+  return std::make_pair(
+      event->name(),
+      global_stats_->running_event_start_time.load(std::memory_order_relaxed));
+}
+
 std::string EventTracker::StatsString() const {
   if (!RayConfig::instance().event_stats()) {
     return "Stats collection disabled, turn on "
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <limits>
+#include <memory>
+#include <string>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
@@ -43,44 +47,69 @@ struct GlobalStats {
   int64_t max_queue_time = -1;
 };
 
-/// A mutex wrapper around a handler stats struct.
-struct GuardedEventStats {
-  // Stats for some handler.
-  EventStats stats ABSL_GUARDED_BY(mutex);
+/// The stats of an event, which are updated without locks. They're sharded by thread,
+/// so that the threads recording the event don't contend on the same cache lines, and
+/// the shards are merged when the stats are read.
+class ShardedEventStats : public std::enable_shared_from_this<ShardedEventStats> {
+ public:
+  struct alignas(64) Shard {
+    std::atomic<int64_t> cum_count{0};
+    std::atomic<int64_t> curr_count{0};
+    std::atomic<int64_t> cum_execution_time{0};
+    std::atomic<int64_t> cum_queue_time{0};
+    std::atomic<int64_t> min_queue_time{std::numeric_limits<int64_t>::max()};
+    std::atomic<int64_t> max_queue_time{-1};
+    std::atomic<int64_t> running_count{0};
 
-  // The mutex protecting the reading and writing of these stats.
-  // This mutex should be acquired with a reader lock before reading, and should be
-  // acquired with a writer lock before writing.
-  mutable absl::Mutex mutex;
-};
+    /// Add the queueing time of an event.
+    void RecordQueueTime(int64_t queue_time_ns);
+  };
+
+  explicit ShardedEventStats(std::string name) : name_(std::move(name)) {}
+
+  const std::string &name() const { return name_; }
 
-/// A mutex wrapper around a handler stats struct.
-struct GuardedGlobalStats {
-  // Stats over all handlers.
-  GlobalStats stats ABSL_GUARDED_BY(mutex);
+  /// Get the shard of the calling thread.
+  Shard &LocalShard();
 
-  // The mutex protecting the reading and writing of these stats.
-  // This mutex should be acquired with a reader lock before reading, and should be
-  // acquired with a writer lock before writing.
-  mutable absl::Mutex mutex;
+  /// Merge the shards into a snapshot view of the stats.
+  EventStats Snapshot() const;
+
+  /// The event being executed and the time its execution started, or null if no event
+  /// is being executed. They're only tracked in the global stats of an EventTracker,
+  /// see EventTracker::GetRunningEvent().
+  std::atomic<const ShardedEventStats *> running_event{nullptr};
+  std::atomic<int64_t> running_event_start_time{0};
+
+ private:
+  static constexpr size_t kNumShards = 8;
+
+  const std::string name_;
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+/// A pre-registered event, see EventTracker::RegisterEvent. Recording a registered
+/// event doesn't look it up by name. It's valid as long as the EventTracker.
+struct EventHandle {
+  ShardedEventStats *stats = nullptr;
 };
 
 /// An opaque stats handle, used to manually instrument event handlers.
 struct StatsHandle {
-  const std::string event_name;
+  const std::shared_ptr<ShardedEventStats> handler_stats;
+  const std::string &event_name;
   const int64_t start_time;
-  const std::shared_ptr<GuardedEventStats> handler_stats;
-  const std::shared_ptr<GuardedGlobalStats> global_stats;
+  const std::shared_ptr<ShardedEventStats> global_stats;
   // Whether RecordEnd or RecordExecution is called.
   std::atomic<bool> end_or_execution_recorded;
 
-  StatsHandle(std::string event_name_,
+  StatsHandle(std::shared_ptr<ShardedEventStats> handler_stats_,
               int64_t start_time_,
-              std::shared_ptr<GuardedEventStats> handler_stats_,
-              std::shared_ptr<GuardedGlobalStats> global_stats_)
-      : event_name(std::move(event_name_)),
+              std::shared_ptr<ShardedEventStats> global_stats_)
+      : handler_stats(std::move(handler_stats_)),
+        event_name(handler_stats->name()),
         start_time(start_time_),
-        handler_stats(std::move(handler_stats_)),
         global_stats(std::move(global_stats_)),
         end_or_execution_recorded(false) {}
 
@@ -88,8 +117,7 @@ struct StatsHandle {
     if (!end_or_execution_recorded) {
       // If handler execution was never recorded, we need to clean up some queueing
       // stats in order to prevent those stats from leaking.
-      absl::MutexLock lock(&(handler_stats->mutex));
-      handler_stats->stats.curr_count--;
+      handler_stats->LocalShard().curr_count.fetch_sub(1, std::memory_order_relaxed);
     }
   }
 };
@@ -97,7 +125,15 @@ struct StatsHandle {
 class EventTracker {
  public:
   /// Initializes the global stats struct after calling the base constructor.
-  EventTracker() : global_stats_(std::make_shared<GuardedGlobalStats>()) {}
+  EventTracker() : global_stats_(std::make_shared<ShardedEventStats>("")) {}
+
+  /// Registers an event, so that it can be recorded without looking it up by name.
+  /// Registering the same name again returns the same event.
+  ///
+  /// \param name A human-readable name to which collected stats will be associated.
+  /// \return The handle of the event, to be given to RecordStart() or
+  /// RecordQueued().
+  EventHandle RegisterEvent(const std::string &name);
 
   /// Sets the queueing start time, increments the current and cumulative counts and
   /// returns an opaque handle for these stats. This is used in conjunction with
@@ -113,6 +149,19 @@ class EventTracker {
   std::shared_ptr<StatsHandle> RecordStart(const std::string &name,
                                            int64_t expected_queueing_delay_ns = 0);
 
+  /// Same as above, for a registered event.
+  std::shared_ptr<StatsHandle> RecordStart(const EventHandle &event,
+                                           int64_t expected_queueing_delay_ns = 0);
+
+  /// Records that a handler of a registered event is queued. This is a lighter
+  /// version of RecordStart() for the event loop, which doesn't allocate a stats
+  /// handle. The returned queueing start time MUST be given to a subsequent
+  /// RecordExecution() call.
+  ///
+  /// \param event The registered event.
+  /// \return The queueing start time.
+  int64_t RecordQueued(const EventHandle &event);
+
   /// Records stats about the provided function's execution. This is used in conjunction
   /// with RecordStart() to manually instrument an event loop handler that calls .post().
   ///
@@ -121,6 +170,16 @@ class EventTracker {
   static void RecordExecution(const std::function<void()> &fn,
                               std::shared_ptr<StatsHandle> handle);
 
+  /// Records stats about the provided function's execution. This is used in conjunction
+  /// with RecordQueued().
+  ///
+  /// \param fn The function to execute and instrument.
+  /// \param event The registered event.
+  /// \param start_time The queueing start time returned by RecordQueued().
+  void RecordExecution(const std::function<void()> &fn,
+                       const EventHandle &event,
+                       int64_t start_time);
+
   /// Records the end of an event. This is used in conjunction
   /// with RecordStart() to manually instrument an event.
   ///
@@ -148,6 +207,13 @@ class EventTracker {
   std::vector<std::pair<std::string, EventStats>> get_event_stats() const
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  /// Returns the name of the event being executed and the time its execution started
+  /// in nanoseconds, e.g. to find the handler blocking an event loop. If the events are
+  /// executed by several threads, the latest started one is returned.
+  ///
+  /// \return The running event, or nullopt if no event is being executed.
+  absl::optional<std::pair<std::string, int64_t>> GetRunningEvent() const;
+
   /// Builds and returns a statistics summary string. Used by the DebugString() of
   /// objects that used this io_context wrapper, such as the raylet and the core worker.
   ///
@@ -157,16 +223,26 @@ class EventTracker {
 
  private:
   using EventStatsTable =
-      absl::flat_hash_map<std::string, std::shared_ptr<GuardedEventStats>>;
-  /// Get the mutex-guarded stats for this event if it exists, otherwise create the
-  /// stats for this handler and return an iterator pointing to it.
+      absl::flat_hash_map<std::string, std::shared_ptr<ShardedEventStats>>;
+  /// Get the stats for this event if it exists, otherwise create the stats for this
+  /// handler and return them.
   ///
   /// \param name A human-readable name for the handler, to be used for viewing stats
   /// for the provided handler.
-  std::shared_ptr<GuardedEventStats> GetOrCreate(const std::string &name);
+  std::shared_ptr<ShardedEventStats> GetOrCreate(const std::string &name);
+
+  /// Records the start of an event in the stats, and returns the queueing start time.
+  static int64_t RecordQueuedImpl(ShardedEventStats &stats,
+                                  int64_t expected_queueing_delay_ns);
+
+  /// Records the execution of an event in the stats.
+  static void RecordExecutionImpl(const std::function<void()> &fn,
+                                  ShardedEventStats &stats,
+                                  ShardedEventStats &global_stats,
+                                  int64_t start_time);
 
-  /// Global stats, across all handlers.
-  std::shared_ptr<GuardedGlobalStats> global_stats_;
+  /// Global stats, across all handlers. Only the queueing stats are recorded.
+  std::shared_ptr<ShardedEventStats> global_stats_;
 
   /// Table of per-handler post stats.
   /// We use a std::shared_ptr value in order to ensure pointer stability.
@@ -43,6 +43,31 @@ RAY_CONFIG(bool, enable_cluster_auth, true)
 /// NOTE: This requires event_stats=1.
 RAY_CONFIG(int64_t, event_stats_print_interval_ms, 60000)
 
+/// The frequency in Hz of the sampling profiler of the main threads of the raylet and
+/// the GCS, or 0 to disable it. The profile of the raylet is returned by GetNodeStats,
+/// and the profile of the GCS is written to profile_gcs.txt with the event loop stats.
+/// 100 Hz costs less than 1% of the profiled threads.
+RAY_CONFIG(uint64_t, sampling_profiler_frequency_hz, 0)
+
+/// The period of the heartbeats posted by the watchdogs of the event loops of the
+/// raylet and the GCS to measure the lag of the loops, or 0 to disable the watchdogs.
+RAY_CONFIG(uint64_t, event_loop_watchdog_period_ms, 100)
+
+/// Whether the core workers also run a watchdog of their event loop. It's disabled by
+/// default since it takes a thread in every worker.
+RAY_CONFIG(bool, core_worker_event_loop_watchdog_enabled, false)
+
+/// The lag after which the watchdog of an event loop considers it stalled, and records
+/// the running handler and the stack trace of the thread running the loop.
+RAY_CONFIG(uint64_t, event_loop_stall_threshold_ms, 2000)
+
+/// The fraction of the task traces which are sampled, or 0 to disable tracing. A trace
+/// starts when a task is submitted outside of a traced task. The sampling decision is
+/// made when the trace starts and is propagated with its context, so a trace is either
+/// fully recorded or not at all. The spans are written to
+/// traces_<component>_<pid>.jsonl in the log directory.
+RAY_CONFIG(float, tracing_sample_ratio, 0)
+
 /// In theory, this is used to detect Ray cookie mismatches.
 /// This magic number (hex for "RAY") is used instead of zero, rationale is
 /// that it could still be possible that some random program sends an int64_t
@@ -258,6 +283,45 @@ RAY_CONFIG(int64_t, object_timeout_milliseconds, 100)
 /// for direct task submission until it must be returned to the raylet.
 RAY_CONFIG(int64_t, worker_lease_timeout_milliseconds, 500)
 
+/// The maximum number of queued normal tasks to push to a leased worker in one
+/// PushTaskBatch request. Batching is only used when there are more queued tasks than
+/// idle workers. 1 disables batching.
+RAY_CONFIG(int64_t, max_tasks_per_push_batch, 1)
+
+/// The maximum number of workers to ask for in one worker lease request. A request
+/// asks for a worker for every queued task of its scheduling key without a pending
+/// lease, and the raylet grants the ones it has available right away. 1 disables
+/// leasing multiple workers per request.
+RAY_CONFIG(int64_t, max_workers_per_lease_request, 1)
+
+/// Whether a worker leased for a scheduling key is kept when it becomes idle, to run
+/// the tasks of other scheduling keys with the same resources, scheduling strategy and
+/// runtime env without a new lease. The idle workers are returned once their leases
+/// expire, see worker_lease_timeout_milliseconds.
+RAY_CONFIG(bool, worker_lease_reuse_across_scheduling_keys, false)
+
+/// The maximum number of actor tasks to push to an actor in one PushActorTaskBatch
+/// request. The replies of the tasks are coalesced too. 1 disables batching.
+RAY_CONFIG(int64_t, max_actor_tasks_per_push_batch, 1)
+
+/// How long a partial batch of actor tasks waits for more tasks while another batch
+/// to the same actor is in flight.
+RAY_CONFIG(int64_t, actor_task_push_batch_window_us, 100)
+
+/// The maximum number of queued actor tasks whose plasma arguments an actor gets and
+/// pins in the background once they're local, so that the tasks don't get them when
+/// they start to execute. 0 disables the prefetching.
+RAY_CONFIG(int64_t, actor_task_args_prefetch_max_tasks, 0)
+
+/// The maximum total size of the prefetched arguments of the queued actor tasks.
+RAY_CONFIG(int64_t, actor_task_args_prefetch_max_bytes, 256 * 1024 * 1024)
+
+/// The maximum number of task spec templates a worker caches for the normal tasks it
+/// submits. A template holds the fields shared by the calls of a remote function with
+/// the same options, which are built once and sent once per PushTaskBatch request.
+/// 0 disables the cache.
+RAY_CONFIG(int64_t, task_spec_template_cache_size, 1000)
+
 /// The interval at which the workers will check if their raylet has gone down.
 /// When this happens, they will kill themselves.
 RAY_CONFIG(uint64_t, raylet_death_check_interval_milliseconds, 1000)
@@ -481,6 +545,17 @@ RAY_CONFIG(int64_t, ray_syncer_message_refresh_interval_ms, 3000)
 /// requests can run in flight for syncing.
 RAY_CONFIG(int64_t, ray_syncer_polling_buffer, 5)
 
+/// The number of raylets per relay group of ray syncer. When it's 0, every
+/// raylet syncs with GCS directly. Otherwise raylets are partitioned into groups of
+/// about this size, and only one relay raylet per group connects to GCS. The relay
+/// forwards the messages between GCS and the rest of its group, so the fan-out of GCS
+/// is reduced from the number of nodes to the number of groups.
+RAY_CONFIG(int64_t, ray_syncer_relay_group_size, 0)
+
+/// The interval at which a raylet tries a relay of ray syncer again after the
+/// connection to it is broken.
+RAY_CONFIG(uint64_t, ray_syncer_relay_retry_interval_ms, 10000)
+
 /// The interval at which the gcs client will check if the address of gcs service has
 /// changed. When the address changed, we will resubscribe again.
 RAY_CONFIG(uint64_t, gcs_service_address_check_interval_milliseconds, 1000)
@@ -504,6 +579,25 @@ RAY_CONFIG(int64_t, task_events_report_interval_ms, 1000)
 /// Setting the value to -1 allows for unlimited task events stored in GCS.
 RAY_CONFIG(int64_t, task_events_max_num_task_in_gcs, 100000)
 
+/// The number of terminated task attempts whose task events are compressed together in
+/// GCS. The task events of the finished task attempts are kept uncompressed until there
+/// are more than this number of them, then the oldest ones are compressed into a
+/// columnar segment, which takes a fraction of their memory.
+/// Setting the value to 0 disables the compression.
+RAY_CONFIG(uint64_t, task_events_compressed_segment_size_in_gcs, 1024)
+
+/// The max number of bytes taken by the compressed task events in GCS. The compressed
+/// task attempts aren't counted in `task_events_max_num_task_in_gcs`, which only bounds
+/// the uncompressed ones, and the oldest of them are evicted once their segments take
+/// more than this number of bytes.
+/// Setting the value to -1 allows for unlimited compressed task events stored in GCS.
+RAY_CONFIG(int64_t, task_events_max_compressed_bytes_in_gcs, 100 * 1024 * 1024)
+
+/// The max number of task events returned by a GetTaskEvents request to GCS, whatever
+/// the limit of the request. The rest of them are returned by the next pages.
+/// Setting the value to -1 allows for returning all the task events at once.
+RAY_CONFIG(int64_t, task_events_max_num_returned_in_gcs, 10000)
+
 /// The number of task attempts being dropped per job tracked at GCS. When GCS is forced
 /// to stop tracking some task attempts that are lost, this will incur potential partial
 /// data loss for a single task attempt (e.g. some task events were dropped, but some were
@@ -570,6 +664,20 @@ RAY_CONFIG(int64_t, task_rpc_inlined_bytes_limit, 10 * 1024 * 1024)
 /// the cluster.
 RAY_CONFIG(int64_t, max_pending_lease_requests_per_scheduling_category, -1)
 
+/// Whether to adapt the max number of pending lease requests per scheduling category
+/// to the lease replies, when it's set automatically. The limit starts from the
+/// number of nodes, grows while the leases are granted in time, and is halved when
+/// they're rejected, failed or slow.
+RAY_CONFIG(bool, adaptive_lease_request_rate_limiter_enabled, false)
+
+/// The adaptive max number of pending lease requests per scheduling category is at
+/// most this many times the number of nodes.
+RAY_CONFIG(uint64_t, adaptive_lease_request_rate_limit_per_node, 4)
+
+/// Leases granted slower than this are seen as congestion by the adaptive lease
+/// request rate limiter.
+RAY_CONFIG(int64_t, adaptive_lease_request_target_latency_ms, 5000)
+
 /// Wait timeout for dashboard agent register.
 #ifdef _WIN32
 // agent startup time can involve creating conda environments
@@ -701,6 +809,25 @@ RAY_CONFIG(int, publish_batch_size, 5000)
 /// Maximum size in bytes of buffered messages per entity, in Ray publisher.
 RAY_CONFIG(int, publisher_entity_buffer_max_bytes, 10 << 20)
 
+/// The number of subscription shards of the GCS publisher. Publishes and subscriptions
+/// of different shards don't contend on the same lock.
+RAY_CONFIG(uint32_t, gcs_publisher_num_shards, 16)
+
+/// The number of threads the GCS publisher uses to queue published messages to
+/// subscribers. If 0, messages are queued in the publishing thread. With more than one
+/// thread, only messages of the same key are guaranteed to be delivered in order.
+RAY_CONFIG(uint32_t, gcs_publisher_fanout_threads, 1)
+
+/// Comma separated GCS pubsub channels, e.g. "GCS_ACTOR_CHANNEL,GCS_NODE_INFO_CHANNEL",
+/// which GCS clients receive through a long-lived stream instead of long polling. The
+/// stream saves a round trip and a request per batch of messages.
+RAY_CONFIG(std::string, gcs_pubsub_streaming_channels, "")
+
+/// The initial and the maximum backoff before a subscriber opens a pubsub stream again,
+/// after the previous one failed before any reply.
+RAY_CONFIG(uint64_t, pubsub_stream_reconnect_initial_backoff_ms, 100)
+RAY_CONFIG(uint64_t, pubsub_stream_reconnect_max_backoff_ms, 5000)
+
 /// The maximum command batch size.
 RAY_CONFIG(int64_t, max_command_batch_size, 2000)
 
@@ -853,6 +980,14 @@ RAY_CONFIG(int64_t, health_check_period_ms, 3000)
 RAY_CONFIG(int64_t, health_check_timeout_ms, 10000)
 /// The threshold to consider a node dead.
 RAY_CONFIG(int64_t, health_check_failure_threshold, 5)
+/// The max interval between two health checks of a healthy node. The interval
+/// doubles from health_check_period_ms after each passed check up to this value, and
+/// resets after a failed one. If it's not larger than health_check_period_ms, the
+/// interval is fixed.
+RAY_CONFIG(int64_t, health_check_max_period_ms, 0)
+/// The ratio of the random jitter applied to the health check intervals. It spreads
+/// the health checks of different nodes over time.
+RAY_CONFIG(double, health_check_jitter_ratio, 0.1)
 
 /// The pool size for grpc server call.
 RAY_CONFIG(int64_t,
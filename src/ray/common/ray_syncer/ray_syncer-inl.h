@@ -369,7 +369,7 @@ class RayServerBidiReactor : public RaySyncerBidiReactorBase<ServerBidiReactor>
       instrumented_io_context &io_context,
       const std::string &local_node_id,
       std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor,
-      std::function<void(const std::string &, bool)> cleanup_cb);
+      std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb);
 
   ~RayServerBidiReactor() override = default;
 
@@ -378,8 +378,9 @@ class RayServerBidiReactor : public RaySyncerBidiReactorBase<ServerBidiReactor>
   void OnCancel() override;
   void OnDone() override;
 
-  /// Cleanup callback when the call ends.
-  const std::function<void(const std::string &, bool)> cleanup_cb_;
+  /// Cleanup callback when the call ends. It's called with this reactor and whether
+  /// the connection should be restarted.
+  const std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb_;
 
   /// grpc callback context
   grpc::CallbackServerContext *server_context_;
@@ -395,7 +396,7 @@ class RayClientBidiReactor : public RaySyncerBidiReactorBase<ClientBidiReactor>
       const std::string &local_node_id,
       instrumented_io_context &io_context,
       std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor,
-      std::function<void(const std::string &, bool)> cleanup_cb,
+      std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb,
       std::unique_ptr<ray::rpc::syncer::RaySyncer::Stub> stub);
 
   ~RayClientBidiReactor() override = default;
@@ -405,8 +406,9 @@ class RayClientBidiReactor : public RaySyncerBidiReactorBase<ClientBidiReactor>
   /// Callback from gRPC
   void OnDone(const grpc::Status &status) override;
 
-  /// Cleanup callback when the call ends.
-  const std::function<void(const std::string &, bool)> cleanup_cb_;
+  /// Cleanup callback when the call ends. It's called with this reactor and whether
+  /// the connection should be restarted.
+  const std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb_;
 
   /// grpc callback context
   grpc::ClientContext client_context_;
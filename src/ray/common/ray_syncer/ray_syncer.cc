@@ -14,10 +14,13 @@
 
 #include "ray/common/ray_syncer/ray_syncer.h"
 
+#include <algorithm>
 #include <functional>
 
 #include "ray/common/asio/asio_util.h"
 #include "ray/common/ray_config.h"
+#include "ray/stats/metric_defs.h"
+#include "ray/util/util.h"
 
 namespace ray {
 namespace syncer {
@@ -95,7 +98,7 @@ RayServerBidiReactor::RayServerBidiReactor(
     instrumented_io_context &io_context,
     const std::string &local_node_id,
     std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor,
-    std::function<void(const std::string &, bool)> cleanup_cb)
+    std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb)
     : RaySyncerBidiReactorBase<ServerBidiReactor>(
           io_context,
           GetNodeIDFromServerContext(server_context),
@@ -120,8 +123,8 @@ void RayServerBidiReactor::OnCancel() {
 
 void RayServerBidiReactor::OnDone() {
   io_context_.dispatch(
-      [this, cleanup_cb = cleanup_cb_, remote_node_id = GetRemoteNodeID()]() {
-        cleanup_cb(remote_node_id, false);
+      [this, cleanup_cb = cleanup_cb_]() {
+        cleanup_cb(this, false);
         delete this;
       },
       "");
@@ -132,7 +135,7 @@ RayClientBidiReactor::RayClientBidiReactor(
     const std::string &local_node_id,
     instrumented_io_context &io_context,
     std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor,
-    std::function<void(const std::string &, bool)> cleanup_cb,
+    std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb,
     std::unique_ptr<ray::rpc::syncer::RaySyncer::Stub> stub)
     : RaySyncerBidiReactorBase<ClientBidiReactor>(
           io_context, remote_node_id, std::move(message_processor)),
@@ -150,7 +153,7 @@ RayClientBidiReactor::RayClientBidiReactor(
 void RayClientBidiReactor::OnDone(const grpc::Status &status) {
   io_context_.dispatch(
       [this, status]() {
-        cleanup_cb_(GetRemoteNodeID(), !status.ok());
+        cleanup_cb_(this, !status.ok());
         delete this;
       },
       "");
@@ -170,6 +173,7 @@ RaySyncer::RaySyncer(instrumented_io_context &io_context,
                      const std::string &local_node_id)
     : io_context_(io_context),
       local_node_id_(local_node_id),
+      keep_views_on_disconnect_(RayConfig::instance().ray_syncer_relay_group_size() > 0),
       node_state_(std::make_unique<NodeState>()),
       timer_(io_context) {
   stopped_ = std::make_shared<bool>(false);
@@ -177,11 +181,17 @@ RaySyncer::RaySyncer(instrumented_io_context &io_context,
 
 RaySyncer::~RaySyncer() {
   *stopped_ = true;
-  boost::asio::dispatch(io_context_.get_executor(), [reactors = sync_reactors_]() {
-    for (auto [_, reactor] : reactors) {
-      reactor->Disconnect();
-    }
-  });
+  boost::asio::dispatch(io_context_.get_executor(),
+                        [reactors = sync_reactors_, replaced = replaced_reactors_]() {
+                          for (auto [_, reactor] : reactors) {
+                            reactor->Disconnect();
+                          }
+                          for (const auto &[_, replaced_reactors] : replaced) {
+                            for (auto *reactor : replaced_reactors) {
+                              reactor->Disconnect();
+                            }
+                          }
+                        });
 }
 
 std::shared_ptr<const RaySyncMessage> RaySyncer::GetSyncMessage(
@@ -209,8 +219,10 @@ std::vector<std::string> RaySyncer::GetAllConnectedNodeIDs() const {
   return boost::asio::dispatch(io_context_.get_executor(), std::move(task)).get();
 }
 
-void RaySyncer::Connect(const std::string &node_id,
-                        std::shared_ptr<grpc::Channel> channel) {
+void RaySyncer::Connect(
+    const std::string &node_id,
+    std::shared_ptr<grpc::Channel> channel,
+    std::function<void(const std::string &)> on_connection_failure) {
   boost::asio::dispatch(
       io_context_.get_executor(), std::packaged_task<void()>([=]() {
         auto stub = ray::rpc::syncer::RaySyncer::NewStub(channel);
@@ -220,9 +232,18 @@ void RaySyncer::Connect(const std::string &node_id,
             /* io_context */ io_context_,
             /* message_processor */ [this](auto msg) { BroadcastRaySyncMessage(msg); },
             /* cleanup_cb */
-            [this, channel](const std::string &node_id, bool restart) {
-              sync_reactors_.erase(node_id);
-              if (restart) {
+            [this, channel, on_connection_failure](RaySyncerBidiReactor *reactor,
+                                                   bool restart) {
+              const auto node_id = reactor->GetRemoteNodeID();
+              if (!RemoveReactor(reactor)) {
+                return;
+              }
+              if (restart && on_connection_failure) {
+                RAY_LOG(INFO) << "Connection is broken to node: "
+                              << NodeID::FromBinary(node_id);
+                RemoveNodeView(node_id);
+                on_connection_failure(node_id);
+              } else if (restart) {
                 execute_after(
                     io_context_,
                     [this, node_id, channel]() {
@@ -232,7 +253,7 @@ void RaySyncer::Connect(const std::string &node_id,
                     },
                     /* delay_microseconds = */ std::chrono::milliseconds(2000));
               } else {
-                node_state_->RemoveNode(node_id);
+                RemoveNodeView(node_id);
               }
             },
             /* stub */ std::move(stub));
@@ -245,26 +266,36 @@ void RaySyncer::Connect(const std::string &node_id,
 void RaySyncer::Connect(RaySyncerBidiReactor *reactor) {
   boost::asio::dispatch(
       io_context_.get_executor(), std::packaged_task<void()>([this, reactor]() {
-        RAY_CHECK(sync_reactors_.find(reactor->GetRemoteNodeID()) ==
-                  sync_reactors_.end());
-        sync_reactors_[reactor->GetRemoteNodeID()] = reactor;
-        // Send the view for new connections.
-        for (const auto &[_, messages] : node_state_->GetClusterView()) {
-          for (const auto &message : messages) {
-            if (!message) {
-              continue;
-            }
-            RAY_LOG(DEBUG) << "Push init view from: "
-                           << NodeID::FromBinary(GetLocalNodeID()) << " to "
-                           << NodeID::FromBinary(reactor->GetRemoteNodeID()) << " about "
-                           << NodeID::FromBinary(message->node_id());
-            reactor->PushToSendingQueue(message);
-          }
+        auto &current = sync_reactors_[reactor->GetRemoteNodeID()];
+        if (current != nullptr) {
+          // The node connects again before its previous connection is done, e.g.
+          // because it switched its relay back and forth. The connections don't
+          // necessarily arrive in order, so the previous one isn't disconnected here,
+          // but it's kept until it's done in case the new one is the stale one.
+          RAY_LOG(INFO) << "Replace the connection of node: "
+                        << NodeID::FromBinary(reactor->GetRemoteNodeID());
+          replaced_reactors_[reactor->GetRemoteNodeID()].push_back(current);
         }
+        current = reactor;
+        PushClusterView(reactor);
       }))
       .get();
 }
 
+void RaySyncer::PushClusterView(RaySyncerBidiReactor *reactor) {
+  for (const auto &[_, messages] : node_state_->GetClusterView()) {
+    for (const auto &message : messages) {
+      if (!message) {
+        continue;
+      }
+      RAY_LOG(DEBUG) << "Push init view from: " << NodeID::FromBinary(GetLocalNodeID())
+                     << " to " << NodeID::FromBinary(reactor->GetRemoteNodeID())
+                     << " about " << NodeID::FromBinary(message->node_id());
+      reactor->PushToSendingQueue(message);
+    }
+  }
+}
+
 void RaySyncer::Disconnect(const std::string &node_id) {
   auto task = std::packaged_task<void()>([&]() {
     auto iter = sync_reactors_.find(node_id);
@@ -276,11 +307,70 @@ void RaySyncer::Disconnect(const std::string &node_id) {
     if (iter != sync_reactors_.end()) {
       sync_reactors_.erase(iter);
     }
+    disconnected_reactors_.insert(reactor);
     reactor->Disconnect();
+    if (auto replaced = replaced_reactors_.extract(node_id)) {
+      for (auto *replaced_reactor : replaced.mapped()) {
+        disconnected_reactors_.insert(replaced_reactor);
+        replaced_reactor->Disconnect();
+      }
+    }
+    RemoveNodeView(node_id);
   });
   boost::asio::dispatch(io_context_.get_executor(), std::move(task)).get();
 }
 
+bool RaySyncer::RemoveReactor(RaySyncerBidiReactor *reactor) {
+  if (disconnected_reactors_.erase(reactor) > 0) {
+    // It's cleaned up by Disconnect already, and it's done however the call ends, e.g.
+    // the node might have connected again meanwhile.
+    return false;
+  }
+  const auto &node_id = reactor->GetRemoteNodeID();
+  auto replaced_iter = replaced_reactors_.find(node_id);
+  if (replaced_iter != replaced_reactors_.end()) {
+    auto &replaced = replaced_iter->second;
+    auto iter = std::find(replaced.begin(), replaced.end(), reactor);
+    if (iter != replaced.end()) {
+      replaced.erase(iter);
+      if (replaced.empty()) {
+        replaced_reactors_.erase(replaced_iter);
+      }
+      return false;
+    }
+  }
+
+  auto iter = sync_reactors_.find(node_id);
+  if (iter == sync_reactors_.end() || iter->second != reactor) {
+    return true;
+  }
+  if (replaced_iter != replaced_reactors_.end()) {
+    // The connection which replaced the previous ones is done first, so it was the
+    // stale one. Fall back to the latest previous connection, and send it the view
+    // again since the messages weren't sent to it meanwhile.
+    iter->second = replaced_iter->second.back();
+    replaced_iter->second.pop_back();
+    if (replaced_iter->second.empty()) {
+      replaced_reactors_.erase(replaced_iter);
+    }
+    PushClusterView(iter->second);
+    return false;
+  }
+  sync_reactors_.erase(iter);
+  return true;
+}
+
+void RaySyncer::RemoveNodeView(const std::string &node_id) {
+  if (!keep_views_on_disconnect_) {
+    node_state_->RemoveNode(node_id);
+  }
+}
+
+void RaySyncer::RemoveNode(const std::string &node_id) {
+  io_context_.dispatch([this, node_id]() { node_state_->RemoveNode(node_id); },
+                       "RaySyncer.RemoveNode");
+}
+
 void RaySyncer::Register(MessageType message_type,
                          const ReporterInterface *reporter,
                          ReceiverInterface *receiver,
@@ -316,6 +406,9 @@ bool RaySyncer::OnDemandBroadcasting(MessageType message_type) {
   auto msg = node_state_->CreateSyncMessage(message_type);
   if (msg) {
     RAY_CHECK(msg->node_id() == GetLocalNodeID());
+    if (msg->create_time_ms() == 0) {
+      msg->set_create_time_ms(current_sys_time_ms());
+    }
     BroadcastMessage(std::make_shared<RaySyncMessage>(std::move(*msg)));
     return true;
   }
@@ -336,6 +429,13 @@ void RaySyncer::BroadcastMessage(std::shared_ptr<const RaySyncMessage> message)
         if (!node_state_->ConsumeSyncMessage(message)) {
           return;
         }
+        if (message->node_id() != GetLocalNodeID() && message->create_time_ms() > 0) {
+          // The clocks of the nodes are not synchronized, so it's only accurate up to
+          // the clock skew.
+          ray::stats::STATS_ray_syncer_propagation_latency_ms.Record(
+              std::max<int64_t>(0, current_sys_time_ms() - message->create_time_ms()),
+              ray::rpc::syncer::MessageType_Name(message->message_type()));
+        }
         for (auto &reactor : sync_reactors_) {
           reactor.second->PushToSendingQueue(message);
         }
@@ -349,11 +449,12 @@ ServerBidiReactor *RaySyncerService::StartSync(grpc::CallbackServerContext *cont
       syncer_.GetIOContext(),
       syncer_.GetLocalNodeID(),
       [this](auto msg) mutable { syncer_.BroadcastMessage(msg); },
-      [this](const std::string &node_id, bool reconnect) mutable {
+      [this](RaySyncerBidiReactor *reactor, bool reconnect) mutable {
         // No need to reconnect for server side.
         RAY_CHECK(!reconnect);
-        syncer_.sync_reactors_.erase(node_id);
-        syncer_.node_state_->RemoveNode(node_id);
+        if (syncer_.RemoveReactor(reactor)) {
+          syncer_.RemoveNodeView(reactor->GetRemoteNodeID());
+        }
       });
   RAY_LOG(DEBUG) << "Get connection from "
                  << NodeID::FromBinary(reactor->GetRemoteNodeID()) << " to "
@@ -100,10 +100,29 @@ class RaySyncer {
   ///
   /// \param node_id The id of the node connect to.
   /// \param channel The gRPC channel.
-  void Connect(const std::string &node_id, std::shared_ptr<grpc::Channel> channel);
-
+  /// \param on_connection_failure If set, it'll be called when the connection is
+  /// broken instead of reconnecting to the same node. It's used by the hierarchical
+  /// topology to fail over to another relay.
+  void Connect(const std::string &node_id,
+               std::shared_ptr<grpc::Channel> channel,
+               std::function<void(const std::string &)> on_connection_failure = nullptr);
+
+  /// Disconnect from a node on purpose, e.g. to switch to another relay. Unlike a
+  /// broken connection, it's not reconnected or reported as a failure when it's done.
+  ///
+  /// \param node_id The id of the node to disconnect from.
   void Disconnect(const std::string &node_id);
 
+  /// Remove the messages of a dead node from the view of the cluster.
+  ///
+  /// The view of a node is removed when its connection is done or disconnected, unless
+  /// the hierarchical topology is enabled. In that case the node might have only
+  /// switched its relay, and its messages which haven't changed won't be sent again, so
+  /// the view is kept until the node is dead.
+  ///
+  /// \param node_id The id of the dead node.
+  void RemoveNode(const std::string &node_id);
+
   /// Get the latest sync message sent from a specific node.
   ///
   /// \param node_id The node id where the message comes from.
@@ -156,6 +175,20 @@ class RaySyncer {
  private:
   void Connect(RaySyncerBidiReactor *connection);
 
+  /// Send the messages of the view of the cluster to a connection.
+  void PushClusterView(RaySyncerBidiReactor *reactor);
+
+  /// Remove the connection of a reactor which is done.
+  ///
+  /// \return false if the node is still connected with another reactor, or the reactor
+  /// was disconnected on purpose, in which case there's nothing to clean up for the
+  /// done one.
+  bool RemoveReactor(RaySyncerBidiReactor *reactor);
+
+  /// Remove the view of a node whose connection is done, unless the views are kept
+  /// until the nodes are dead. See RemoveNode.
+  void RemoveNodeView(const std::string &node_id);
+
   std::shared_ptr<bool> stopped_;
 
   /// Get the io_context used by RaySyncer.
@@ -174,9 +207,22 @@ class RaySyncer {
   /// The current node id.
   const std::string local_node_id_;
 
+  /// Whether to keep the views of the nodes whose connections are done. It's set in the
+  /// hierarchical topology. See RemoveNode.
+  const bool keep_views_on_disconnect_;
+
   /// Manage connections. Here the key is the NodeID in binary form.
   absl::flat_hash_map<std::string, RaySyncerBidiReactor *> sync_reactors_;
 
+  /// The previous connections of the nodes which connected again before they were
+  /// done, from the oldest to the latest. See Connect.
+  absl::flat_hash_map<std::string, std::vector<RaySyncerBidiReactor *>>
+      replaced_reactors_;
+
+  /// The connections which are disconnected on purpose but not done yet. See
+  /// Disconnect.
+  absl::flat_hash_set<RaySyncerBidiReactor *> disconnected_reactors_;
+
   /// The local node state
   std::unique_ptr<NodeState> node_state_;
 
@@ -196,9 +242,8 @@ class RaySyncer {
 
 /// RaySyncerService is a service to take care of resource synchronization
 /// related operations.
-/// Right now only raylet needs to setup this service. But in the future,
-/// we can use this to construct more complicated resource reporting algorithm,
-/// like tree-based one.
+/// GCS always sets up this service. Raylets set it up as well so that they can
+/// act as relays when ray syncer runs in the hierarchical mode (see RelayTopology).
 class RaySyncerService : public ray::rpc::syncer::RaySyncer::CallbackService {
  public:
   RaySyncerService(RaySyncer &syncer) : syncer_(syncer) {}
@@ -0,0 +1,95 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/ray_syncer/relay_topology.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace syncer {
+
+RelayTopology::RelayTopology(size_t group_size) : group_size_(group_size) {
+  RAY_CHECK(group_size_ > 0);
+}
+
+uint64_t RelayTopology::Hash(const std::string &node_id) {
+  uint64_t hash = 0;
+  std::memcpy(&hash, node_id.data(), std::min(sizeof(hash), node_id.size()));
+  return hash;
+}
+
+void RelayTopology::AddNode(const std::string &node_id) {
+  auto hash = Hash(node_id);
+  if (node_hashes_.emplace(node_id, hash).second) {
+    nodes_.emplace(hash, node_id);
+  }
+  unreachable_nodes_.erase(node_id);
+}
+
+void RelayTopology::RemoveNode(const std::string &node_id) {
+  auto iter = node_hashes_.find(node_id);
+  if (iter == node_hashes_.end()) {
+    return;
+  }
+  nodes_.erase(std::make_pair(iter->second, node_id));
+  node_hashes_.erase(iter);
+  unreachable_nodes_.erase(node_id);
+}
+
+void RelayTopology::MarkUnreachable(const std::string &node_id) {
+  if (node_hashes_.contains(node_id)) {
+    unreachable_nodes_.insert(node_id);
+  }
+}
+
+void RelayTopology::MarkReachable(const std::string &node_id) {
+  unreachable_nodes_.erase(node_id);
+}
+
+size_t RelayTopology::NumGroups() const {
+  size_t min_groups = (nodes_.size() + group_size_ - 1) / group_size_;
+  size_t num_groups = 1;
+  while (num_groups < min_groups) {
+    num_groups <<= 1;
+  }
+  return num_groups;
+}
+
+std::optional<std::string> RelayTopology::GetParent(const std::string &node_id) const {
+  auto iter = node_hashes_.find(node_id);
+  if (iter == node_hashes_.end()) {
+    return std::nullopt;
+  }
+  // NumGroups is a power of two, so the group of a node is the low bits of its hash.
+  const uint64_t mask = NumGroups() - 1;
+  const uint64_t group = iter->second & mask;
+  // Nodes are sorted by hash, so the first reachable one in the group is the relay.
+  // On average it takes NumGroups() steps to find it.
+  for (const auto &[hash, candidate] : nodes_) {
+    if ((hash & mask) != group || unreachable_nodes_.contains(candidate)) {
+      continue;
+    }
+    if (candidate == node_id) {
+      return std::nullopt;
+    }
+    return candidate;
+  }
+  return std::nullopt;
+}
+
+}  // namespace syncer
+}  // namespace ray
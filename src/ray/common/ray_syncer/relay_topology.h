@@ -0,0 +1,104 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace ray {
+namespace syncer {
+
+/// RelayTopology decides which node a raylet should sync with when ray syncer runs
+/// in the hierarchical mode.
+///
+/// Nodes are partitioned into groups by the hash of their node id. The number of
+/// groups is the number of nodes divided by the group size, rounded up to a power of
+/// two, so that when the cluster grows every group is split into two instead of being
+/// reshuffled. The relay of a group is the reachable member with the smallest hash.
+/// Relays sync with the root (GCS) and the other members sync with their relay.
+///
+/// Every node computes the topology from its own view of the cluster membership, so
+/// the views can be different for a while. Since the parent of a node always has a
+/// smaller hash than the node itself, the topology never contains a cycle, and every
+/// node is eventually connected to the root.
+class RelayTopology {
+ public:
+  /// Constructor of RelayTopology.
+  ///
+  /// \param group_size The expected number of nodes per group. Must be positive.
+  explicit RelayTopology(size_t group_size);
+
+  /// Add an alive node to the topology.
+  ///
+  /// \param node_id The node id in binary form.
+  void AddNode(const std::string &node_id);
+
+  /// Remove a dead node from the topology.
+  ///
+  /// \param node_id The node id in binary form.
+  void RemoveNode(const std::string &node_id);
+
+  /// Mark a node unreachable from the local node. It won't be picked as a relay
+  /// anymore, but it still counts for the group partition so that the partition is
+  /// the same as the other nodes'.
+  ///
+  /// \param node_id The node id in binary form.
+  void MarkUnreachable(const std::string &node_id);
+
+  /// Clear the mark of MarkUnreachable, e.g. when the local node tries to reconnect
+  /// to the node. Adding a node again clears it as well.
+  ///
+  /// \param node_id The node id in binary form.
+  void MarkReachable(const std::string &node_id);
+
+  /// Get the node to sync with.
+  ///
+  /// \param node_id The node id in binary form.
+  /// \return The relay of the node. std::nullopt if the node is a relay or it's not
+  /// known, in which case it should sync with the root directly.
+  std::optional<std::string> GetParent(const std::string &node_id) const;
+
+  /// Return the number of groups.
+  size_t NumGroups() const;
+
+  /// Return the number of nodes in the topology.
+  size_t NumNodes() const { return nodes_.size(); }
+
+ private:
+  /// The hash used to partition the nodes. Node ids are random, so the leading bytes
+  /// are used directly. It's stable across processes, which is required since every
+  /// node computes the topology on its own.
+  static uint64_t Hash(const std::string &node_id);
+
+  /// The expected number of nodes per group.
+  const size_t group_size_;
+
+  /// All alive nodes, sorted by (hash, node id).
+  std::set<std::pair<uint64_t, std::string>> nodes_;
+
+  /// Node id to its hash for all alive nodes.
+  absl::flat_hash_map<std::string, uint64_t> node_hashes_;
+
+  /// The nodes which can't be used as a relay by the local node.
+  absl::flat_hash_set<std::string> unreachable_nodes_;
+};
+
+}  // namespace syncer
+}  // namespace ray
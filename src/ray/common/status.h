@@ -262,6 +262,12 @@ class RAY_EXPORT Status {
     return Status(StatusCode::AuthError, msg);
   }
 
+  /// Create a status from its code and message, e.g., when they are received in an
+  /// RPC reply. Returns OK if the code is OK.
+  static Status FromCode(StatusCode code, const std::string &msg) {
+    return code == StatusCode::OK ? Status() : Status(code, msg);
+  }
+
   static StatusCode StringToCode(const std::string &str);
 
   // Returns true iff the status indicates success.
@@ -251,6 +251,10 @@ int64_t TaskSpecification::GeneratorBackpressureNumObjects() const {
   return result;
 }
 
+const rpc::TraceContext &TaskSpecification::GetTraceContext() const {
+  return message_->trace_context();
+}
+
 std::vector<ObjectID> TaskSpecification::DynamicReturnIds() const {
   RAY_CHECK(message_->returns_dynamic());
   std::vector<ObjectID> dynamic_return_ids;
@@ -293,6 +297,24 @@ size_t TaskSpecification::ArgMetadataSize(size_t arg_index) const {
   return message_->args(arg_index).metadata().size();
 }
 
+std::shared_ptr<Buffer> TaskSpecification::ArgDataBuffer(size_t arg_index) const {
+  const auto &data = message_->args(arg_index).data();
+  if (data.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<AliasedBuffer>(
+      reinterpret_cast<const uint8_t *>(data.data()), data.size(), message_);
+}
+
+std::shared_ptr<Buffer> TaskSpecification::ArgMetadataBuffer(size_t arg_index) const {
+  const auto &metadata = message_->args(arg_index).metadata();
+  if (metadata.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<AliasedBuffer>(
+      reinterpret_cast<const uint8_t *>(metadata.data()), metadata.size(), message_);
+}
+
 const std::vector<rpc::ObjectReference> TaskSpecification::ArgInlinedRefs(
     size_t arg_index) const {
   return VectorFromProtobuf<rpc::ObjectReference>(
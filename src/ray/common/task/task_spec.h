@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "ray/common/buffer.h"
 #include "ray/common/function_descriptor.h"
 #include "ray/common/grpc_util.h"
 #include "ray/common/id.h"
@@ -270,6 +271,16 @@ class TaskSpecification : public MessageWrapper<rpc::TaskSpec> {
     ComputeResources();
   }
 
+  /// Construct from a protobuf message shared_ptr built from a task spec template.
+  ///
+  /// \param message The protobuf message.
+  /// \param task_spec_template The template the message was built from.
+  TaskSpecification(std::shared_ptr<rpc::TaskSpec> message,
+                    std::shared_ptr<const rpc::TaskSpec> task_spec_template)
+      : MessageWrapper(message), template_(std::move(task_spec_template)) {
+    ComputeResources();
+  }
+
   /// Construct from protobuf-serialized binary.
   ///
   /// \param serialized_binary Protobuf-serialized binary.
@@ -333,6 +344,9 @@ class TaskSpecification : public MessageWrapper<rpc::TaskSpec> {
 
   int64_t GeneratorBackpressureNumObjects() const;
 
+  /// The context of the span of the task, which is empty if the task isn't traced.
+  const rpc::TraceContext &GetTraceContext() const;
+
   std::vector<ObjectID> DynamicReturnIds() const;
 
   void AddDynamicReturnId(const ObjectID &dynamic_return_id);
@@ -345,6 +359,14 @@ class TaskSpecification : public MessageWrapper<rpc::TaskSpec> {
 
   size_t ArgMetadataSize(size_t arg_index) const;
 
+  /// Get the data of an argument passed by value as a buffer which aliases this task
+  /// spec's message, and keeps it alive. Returns nullptr if the data is empty.
+  std::shared_ptr<Buffer> ArgDataBuffer(size_t arg_index) const;
+
+  /// Get the metadata of an argument passed by value as a buffer which aliases this
+  /// task spec's message, and keeps it alive. Returns nullptr if the metadata is empty.
+  std::shared_ptr<Buffer> ArgMetadataBuffer(size_t arg_index) const;
+
   /// Return true if the task should be retried upon exceptions.
   bool ShouldRetryExceptions() const;
 
@@ -489,6 +511,10 @@ class TaskSpecification : public MessageWrapper<rpc::TaskSpec> {
 
   void EmitTaskMetrics() const;
 
+  /// The template the task spec was built from, or nullptr. The tasks built from the
+  /// same template share the template's fields, see `TaskSpecBuilder`.
+  const std::shared_ptr<const rpc::TaskSpec> &Template() const { return template_; }
+
  private:
   void ComputeResources();
 
@@ -500,6 +526,8 @@ class TaskSpecification : public MessageWrapper<rpc::TaskSpec> {
   std::shared_ptr<ResourceSet> required_placement_resources_;
   /// Cached scheduling class of this task.
   SchedulingClass sched_cls_id_ = 0;
+  /// The template the task spec was built from, if any.
+  std::shared_ptr<const rpc::TaskSpec> template_;
 
   /// Below static fields could be mutated in `ComputeResources` concurrently due to
   /// multi-threading, we need a mutex to protect it.
@@ -103,8 +103,21 @@ class TaskSpecBuilder {
  public:
   TaskSpecBuilder() : message_(std::make_shared<rpc::TaskSpec>()) {}
 
+  /// Start from a template holding the fields which are the same for many normal tasks,
+  /// e.g., the calls of a remote function with the same options. The template is built
+  /// with `SetTemplateTaskSpec`, and the rest of the fields are set with
+  /// `SetPerCallTaskSpec`, so the invariant fields are only built once.
+  explicit TaskSpecBuilder(std::shared_ptr<const rpc::TaskSpec> task_spec_template)
+      : message_(std::make_shared<rpc::TaskSpec>(*task_spec_template)),
+        template_(std::move(task_spec_template)) {}
+
   /// Build the `TaskSpecification` object.
-  TaskSpecification Build() { return TaskSpecification(message_); }
+  TaskSpecification Build() {
+    if (template_ != nullptr) {
+      return TaskSpecification(message_, template_);
+    }
+    return TaskSpecification(message_);
+  }
 
   /// Get a reference to the internal protobuf message object.
   const rpc::TaskSpec &GetMessage() const { return *message_; }
@@ -179,6 +192,80 @@ class TaskSpecBuilder {
     return *this;
   }
 
+  /// Set the fields of a task spec template, which are a subset of the common and
+  /// normal task attributes. These must be the only fields set in the template, see
+  /// `ClearTaskSpecTemplateFields`.
+  ///
+  /// \return Reference to the builder object itself.
+  TaskSpecBuilder &SetTemplateTaskSpec(
+      const std::string &name,
+      const ray::FunctionDescriptor &function_descriptor,
+      std::optional<rpc::JobConfig> job_config,
+      const rpc::Address &caller_address,
+      const std::unordered_map<std::string, double> &required_resources,
+      const std::unordered_map<std::string, double> &required_placement_resources,
+      const std::shared_ptr<rpc::RuntimeEnvInfo> runtime_env_info,
+      const std::string &serialized_retry_exception_allowlist,
+      const rpc::SchedulingStrategy &scheduling_strategy) {
+    message_->set_name(name);
+    *message_->mutable_function_descriptor() = function_descriptor->GetMessage();
+    if (job_config.has_value()) {
+      message_->mutable_job_config()->CopyFrom(job_config.value());
+    }
+    message_->mutable_caller_address()->CopyFrom(caller_address);
+    message_->mutable_required_resources()->insert(required_resources.begin(),
+                                                   required_resources.end());
+    message_->mutable_required_placement_resources()->insert(
+        required_placement_resources.begin(), required_placement_resources.end());
+    if (runtime_env_info) {
+      message_->mutable_runtime_env_info()->CopyFrom(*runtime_env_info);
+    }
+    message_->set_serialized_retry_exception_allowlist(
+        serialized_retry_exception_allowlist);
+    message_->mutable_scheduling_strategy()->CopyFrom(scheduling_strategy);
+    return *this;
+  }
+
+  /// Set the common and normal task attributes which aren't in the template the
+  /// builder is started from. Together with `SetTemplateTaskSpec`, this is the same as
+  /// `SetCommonTaskSpec` and `SetNormalTaskSpec`.
+  ///
+  /// \return Reference to the builder object itself.
+  TaskSpecBuilder &SetPerCallTaskSpec(const TaskID &task_id,
+                                      const Language &language,
+                                      const JobID &job_id,
+                                      const TaskID &parent_task_id,
+                                      uint64_t parent_counter,
+                                      const TaskID &caller_id,
+                                      uint64_t num_returns,
+                                      bool returns_dynamic,
+                                      bool is_streaming_generator,
+                                      int64_t generator_backpressure_num_objects,
+                                      const std::string &debugger_breakpoint,
+                                      int64_t depth,
+                                      const TaskID &submitter_task_id,
+                                      int max_retries,
+                                      bool retry_exceptions) {
+    RAY_CHECK(template_ != nullptr);
+    message_->set_type(TaskType::NORMAL_TASK);
+    message_->set_language(language);
+    message_->set_job_id(job_id.Binary());
+    message_->set_task_id(task_id.Binary());
+    message_->set_parent_task_id(parent_task_id.Binary());
+    message_->set_submitter_task_id(submitter_task_id.Binary());
+    message_->set_parent_counter(parent_counter);
+    message_->set_caller_id(caller_id.Binary());
+    message_->set_num_returns(num_returns);
+    message_->set_returns_dynamic(returns_dynamic);
+    message_->set_streaming_generator(is_streaming_generator);
+    message_->set_generator_backpressure_num_objects(generator_backpressure_num_objects);
+    message_->set_debugger_breakpoint(debugger_breakpoint);
+    message_->set_depth(depth);
+    message_->set_max_retries(max_retries);
+    message_->set_retry_exceptions(retry_exceptions);
+    return *this;
+  }
+
   /// Set the driver attributes of the task spec.
   /// See `common.proto` for meaning of the arguments.
   ///
@@ -203,6 +290,17 @@ class TaskSpecBuilder {
     return *this;
   }
 
+  /// Set the context of the span of the task, see tracing::NewSpanContext. It's not
+  /// part of the template, since every task is its own span.
+  ///
+  /// \return Reference to the builder object itself.
+  TaskSpecBuilder &SetTraceContext(const rpc::TraceContext &trace_context) {
+    if (!trace_context.span_id().empty()) {
+      message_->mutable_trace_context()->CopyFrom(trace_context);
+    }
+    return *this;
+  }
+
   /// Add an argument to the task.
   TaskSpecBuilder &AddArg(const TaskArg &arg) {
     auto ref = message_->add_args();
@@ -285,6 +383,32 @@ class TaskSpecBuilder {
 
  private:
   std::shared_ptr<rpc::TaskSpec> message_;
+  /// The template the builder is started from, if any.
+  std::shared_ptr<const rpc::TaskSpec> template_;
 };
 
+/// Clear the fields set by `TaskSpecBuilder::SetTemplateTaskSpec`, so that the task spec
+/// only holds the fields which aren't shared with the other tasks built from the same
+/// template.
+inline void ClearTaskSpecTemplateFields(rpc::TaskSpec *task_spec) {
+  task_spec->clear_name();
+  task_spec->clear_function_descriptor();
+  task_spec->clear_job_config();
+  task_spec->clear_caller_address();
+  task_spec->clear_required_resources();
+  task_spec->clear_required_placement_resources();
+  task_spec->clear_runtime_env_info();
+  task_spec->clear_serialized_retry_exception_allowlist();
+  task_spec->clear_scheduling_strategy();
+}
+
+/// Restore a task spec whose template fields have been cleared by
+/// `ClearTaskSpecTemplateFields`.
+inline void ApplyTaskSpecTemplate(const rpc::TaskSpec &task_spec_template,
+                                  rpc::TaskSpec *task_spec) {
+  rpc::TaskSpec merged = task_spec_template;
+  merged.MergeFrom(*task_spec);
+  task_spec->Swap(&merged);
+}
+
 }  // namespace ray
@@ -0,0 +1,99 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/benchmark_util.h"
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "nlohmann/json.hpp"
+#include "ray/util/filesystem.h"
+
+namespace ray {
+namespace benchmark {
+
+namespace {
+
+void BM_Sum(State &state) {
+  int64_t sum = 0;
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < state.range(); ++i) {
+      sum += i;
+    }
+  }
+  DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * state.range());
+}
+RAY_BENCHMARK(BM_Sum)->Arg(10)->Arg(100);
+
+void BM_Empty(State &state) {
+  while (state.KeepRunning()) {
+  }
+}
+RAY_BENCHMARK(BM_Empty);
+
+}  // namespace
+
+TEST(BenchmarkUtilTest, TestState) {
+  State state(/*max_iterations=*/3, /*args=*/{7});
+  ASSERT_EQ(state.range(), 7);
+  int num_iterations = 0;
+  while (state.KeepRunning()) {
+    num_iterations++;
+    if (num_iterations == 2) {
+      // The time paused isn't counted.
+      state.PauseTiming();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      state.ResumeTiming();
+    }
+  }
+  ASSERT_EQ(num_iterations, 3);
+  ASSERT_LT(state.real_time_ns(), 100 * 1000 * 1000);
+  ASSERT_GE(state.cpu_time_ns(), 0);
+}
+
+TEST(BenchmarkUtilTest, TestRunBenchmarks) {
+  const auto out_path = JoinPaths(GetUserTempDir(), "benchmark_util_test.json");
+  std::string filter_flag = "--benchmark_filter=BM_Sum";
+  std::string min_time_flag = "--benchmark_min_time=0.01";
+  std::string out_flag = "--benchmark_out=" + out_path;
+  std::string executable = "benchmark_util_test";
+  std::vector<char *> argv{
+      executable.data(), filter_flag.data(), min_time_flag.data(), out_flag.data()};
+  ASSERT_EQ(RunBenchmarks(argv.size(), argv.data()), 0);
+
+  std::ifstream in(out_path);
+  const auto json = nlohmann::json::parse(in);
+  std::remove(out_path.c_str());
+  ASSERT_EQ(json["context"]["executable"], "benchmark_util_test");
+  const auto &benchmarks = json["benchmarks"];
+  ASSERT_EQ(benchmarks.size(), 2);
+  ASSERT_EQ(benchmarks[0]["name"], "BM_Sum/10");
+  ASSERT_EQ(benchmarks[1]["name"], "BM_Sum/100");
+  for (const auto &benchmark : benchmarks) {
+    ASSERT_GT(benchmark["iterations"].get<int64_t>(), 1);
+    ASSERT_GT(benchmark["real_time"].get<double>(), 0);
+    ASSERT_EQ(benchmark["time_unit"], "ns");
+    ASSERT_GT(benchmark["items_per_second"].get<double>(), 0);
+  }
+
+  std::string bad_flag = "--benchmark_repetitions=3";
+  std::vector<char *> bad_argv{executable.data(), bad_flag.data()};
+  ASSERT_EQ(RunBenchmarks(bad_argv.size(), bad_argv.data()), 1);
+}
+
+}  // namespace benchmark
+}  // namespace ray
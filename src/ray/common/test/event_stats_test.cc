@@ -14,6 +14,9 @@
 
 #include "ray/common/event_stats.h"
 
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 TEST(EventStatsTest, TestRecordEnd) {
@@ -54,6 +57,96 @@ TEST(EventStatsTest, TestRecordExecution) {
   ASSERT_GE(event_stats.cum_queue_time, 100000000);
 }
 
+TEST(EventStatsTest, TestRegisteredEvent) {
+  EventTracker event_tracker;
+  const auto event = event_tracker.RegisterEvent("method");
+  // The event is registered once.
+  ASSERT_EQ(event_tracker.RegisterEvent("method").stats, event.stats);
+  ASSERT_EQ(event_tracker.get_event_stats("method").value().cum_count, 0);
+
+  const auto start_time = event_tracker.RecordQueued(event);
+  auto event_stats = event_tracker.get_event_stats("method").value();
+  ASSERT_EQ(event_stats.cum_count, 1);
+  ASSERT_EQ(event_stats.curr_count, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  event_tracker.RecordExecution(
+      [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        ASSERT_EQ(event_tracker.get_event_stats("method").value().running_count, 1);
+      },
+      event,
+      start_time);
+  event_stats = event_tracker.get_event_stats("method").value();
+  ASSERT_EQ(event_stats.cum_count, 1);
+  ASSERT_EQ(event_stats.curr_count, 0);
+  ASSERT_EQ(event_stats.running_count, 0);
+  ASSERT_GE(event_stats.cum_execution_time, 200000000);
+  ASSERT_GE(event_stats.cum_queue_time, 100000000);
+  ASSERT_EQ(event_stats.min_queue_time, event_stats.cum_queue_time);
+  ASSERT_EQ(event_tracker.get_global_stats().cum_queue_time, event_stats.cum_queue_time);
+}
+
+TEST(EventStatsTest, TestRunningEvent) {
+  EventTracker event_tracker;
+  const auto event = event_tracker.RegisterEvent("outer");
+  ASSERT_FALSE(event_tracker.GetRunningEvent().has_value());
+  event_tracker.RecordExecution(
+      [&] {
+        auto running_event = event_tracker.GetRunningEvent();
+        ASSERT_TRUE(running_event.has_value());
+        ASSERT_EQ(running_event->first, "outer");
+        // A nested event is running until it returns.
+        event_tracker.RecordExecution(
+            [&] { ASSERT_EQ(event_tracker.GetRunningEvent()->first, "inner"); },
+            event_tracker.RegisterEvent("inner"),
+            event_tracker.RecordQueued(event_tracker.RegisterEvent("inner")));
+        ASSERT_EQ(event_tracker.GetRunningEvent()->first, "outer");
+        ASSERT_EQ(event_tracker.GetRunningEvent()->second, running_event->second);
+      },
+      event,
+      event_tracker.RecordQueued(event));
+  ASSERT_FALSE(event_tracker.GetRunningEvent().has_value());
+}
+
+TEST(EventStatsTest, TestRecordFromManyThreads) {
+  EventTracker event_tracker;
+  const auto event = event_tracker.RegisterEvent("method");
+  constexpr int kNumThreads = 16;
+  constexpr int kNumEventsPerThread = 1000;
+  // The events are queued and executed on different threads.
+  std::vector<int64_t> start_times(kNumThreads * kNumEventsPerThread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumEventsPerThread; i++) {
+        start_times[t * kNumEventsPerThread + i] = event_tracker.RecordQueued(event);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  ASSERT_EQ(event_tracker.get_event_stats("method").value().curr_count,
+            kNumThreads * kNumEventsPerThread);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumEventsPerThread; i++) {
+        event_tracker.RecordExecution(
+            [] {}, event, start_times[t * kNumEventsPerThread + i]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const auto event_stats = event_tracker.get_event_stats("method").value();
+  ASSERT_EQ(event_stats.cum_count, kNumThreads * kNumEventsPerThread);
+  ASSERT_EQ(event_stats.curr_count, 0);
+  ASSERT_EQ(event_stats.running_count, 0);
+  ASSERT_LE(event_stats.min_queue_time, event_stats.max_queue_time);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
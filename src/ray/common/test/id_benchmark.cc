@@ -0,0 +1,106 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of hashing and parsing the IDs, which are the keys of most tables.
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/benchmark_util.h"
+#include "ray/common/id.h"
+
+namespace ray {
+namespace benchmark {
+
+namespace {
+
+constexpr size_t kNumIds = 1024;
+
+std::vector<ObjectID> RandomObjectIds(size_t num_ids) {
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < num_ids; ++i) {
+    ids.push_back(ObjectID::FromRandom());
+  }
+  return ids;
+}
+
+std::vector<TaskID> RandomTaskIds(size_t num_ids) {
+  std::vector<TaskID> ids;
+  for (size_t i = 0; i < num_ids; ++i) {
+    ids.push_back(TaskID::FromRandom(JobID::FromInt(1)));
+  }
+  return ids;
+}
+
+template <typename ID>
+std::vector<std::string> ToBinaries(const std::vector<ID> &ids) {
+  std::vector<std::string> binaries;
+  for (const auto &id : ids) {
+    binaries.push_back(id.Binary());
+  }
+  return binaries;
+}
+
+/// The hashes of the IDs are cached, so every iteration hashes a copy which isn't.
+template <typename ID>
+void HashIds(State &state, const std::vector<ID> &ids) {
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    const ID id = ids[i++ % ids.size()];
+    DoNotOptimize(id.Hash());
+  }
+}
+
+template <typename ID>
+void IdsFromBinary(State &state, const std::vector<std::string> &binaries) {
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    DoNotOptimize(ID::FromBinary(binaries[i++ % binaries.size()]));
+  }
+}
+
+void BM_ObjectIdHash(State &state) { HashIds(state, RandomObjectIds(kNumIds)); }
+RAY_BENCHMARK(BM_ObjectIdHash);
+
+void BM_TaskIdHash(State &state) { HashIds(state, RandomTaskIds(kNumIds)); }
+RAY_BENCHMARK(BM_TaskIdHash);
+
+void BM_ObjectIdFromBinary(State &state) {
+  IdsFromBinary<ObjectID>(state, ToBinaries(RandomObjectIds(kNumIds)));
+}
+RAY_BENCHMARK(BM_ObjectIdFromBinary);
+
+void BM_TaskIdFromBinary(State &state) {
+  IdsFromBinary<TaskID>(state, ToBinaries(RandomTaskIds(kNumIds)));
+}
+RAY_BENCHMARK(BM_TaskIdFromBinary);
+
+/// Look up IDs parsed from binaries in a table of the given size, which is how most
+/// requests find their objects.
+void BM_ObjectIdLookup(State &state) {
+  const auto ids = RandomObjectIds(state.range());
+  absl::flat_hash_map<ObjectID, int64_t> table;
+  for (const auto &id : ids) {
+    table.emplace(id, table.size());
+  }
+  const auto binaries = ToBinaries(ids);
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    DoNotOptimize(table.find(ObjectID::FromBinary(binaries[i++ % binaries.size()])));
+  }
+}
+RAY_BENCHMARK(BM_ObjectIdLookup)->Arg(1000)->Arg(1000000);
+
+}  // namespace
+
+}  // namespace benchmark
+}  // namespace ray
@@ -0,0 +1,103 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/asio/io_context_watchdog.h"
+
+#include <future>
+#include <thread>
+
+#include "absl/debugging/symbolize.h"
+#include "gtest/gtest.h"
+
+namespace ray {
+
+class IoContextWatchdogTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    thread_ = std::thread([this]() {
+      boost::asio::io_context::work work(io_context_);
+      io_context_.run();
+    });
+  }
+
+  void TearDown() override {
+    io_context_.stop();
+    thread_.join();
+  }
+
+  /// Wait until a handler posted to the loop is executed.
+  void WaitForEventLoop() {
+    std::promise<void> promise;
+    io_context_.post([&promise]() { promise.set_value(); }, "WaitForEventLoop");
+    promise.get_future().get();
+  }
+
+ protected:
+  instrumented_io_context io_context_;
+  std::thread thread_;
+};
+
+TEST_F(IoContextWatchdogTest, TestNoStall) {
+  IoContextWatchdog watchdog(io_context_,
+                             "test",
+                             /*period_ms=*/10,
+                             /*stall_threshold_ms=*/1000);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_TRUE(watchdog.GetStalls().empty());
+  ASSERT_GT(io_context_.stats()
+                .get_event_stats("IoContextWatchdog.Heartbeat")
+                .value_or(EventStats())
+                .cum_count,
+            0);
+}
+
+TEST_F(IoContextWatchdogTest, TestStall) {
+  IoContextWatchdog watchdog(io_context_,
+                             "test",
+                             /*period_ms=*/10,
+                             /*stall_threshold_ms=*/100);
+  // Let the watchdog find the thread of the loop.
+  while (io_context_.stats()
+             .get_event_stats("IoContextWatchdog.Heartbeat")
+             .value_or(EventStats())
+             .cum_count < 2) {
+    WaitForEventLoop();
+  }
+
+  io_context_.post(
+      []() { std::this_thread::sleep_for(std::chrono::milliseconds(500)); },
+      "BlockingHandler");
+  WaitForEventLoop();
+  // The stall is over once the next heartbeat is handled.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const auto stalls = watchdog.GetStalls();
+  ASSERT_EQ(stalls.size(), 1);
+  ASSERT_EQ(stalls[0].handler, "BlockingHandler");
+  ASSERT_GE(stalls[0].lag, absl::Milliseconds(100));
+  ASSERT_GE(stalls[0].handler_execution_time, absl::Milliseconds(100));
+  ASSERT_TRUE(stalls[0].duration.has_value());
+  ASSERT_GE(*stalls[0].duration, stalls[0].lag);
+  // The stack trace has at least the interrupted function.
+  ASSERT_FALSE(stalls[0].stack_trace.empty());
+  ASSERT_NE(watchdog.DebugString().find("BlockingHandler"), std::string::npos);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  absl::InitializeSymbolizer(argv[0]);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
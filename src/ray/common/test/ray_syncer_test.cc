@@ -27,6 +27,7 @@
 #include <grpcpp/server_builder.h>
 
 #include "ray/common/ray_syncer/ray_syncer.h"
+#include "ray/common/ray_syncer/relay_topology.h"
 #include "ray/rpc/grpc_server.h"
 #include "mock/ray/common/ray_syncer/ray_syncer.h"
 // clang-format on
@@ -148,6 +149,76 @@ TEST_F(RaySyncerTest, NodeStateConsume) {
   ASSERT_FALSE(node_status->ConsumeSyncMessage(std::make_shared<RaySyncMessage>(msg)));
 }
 
+TEST(RelayTopologyTest, GroupsAndRelays) {
+  RelayTopology topology(/*group_size=*/4);
+  std::vector<std::string> nodes;
+  for (int i = 0; i < 64; ++i) {
+    nodes.push_back(NodeID::FromRandom().Binary());
+    topology.AddNode(nodes.back());
+  }
+  ASSERT_EQ(16, topology.NumGroups());
+  // Adding the same node twice is a no-op.
+  topology.AddNode(nodes.front());
+  ASSERT_EQ(64, topology.NumNodes());
+
+  // The relays sync with the root and the relay of a relay is itself.
+  absl::flat_hash_set<std::string> relays;
+  for (const auto &node : nodes) {
+    auto parent = topology.GetParent(node);
+    if (!parent.has_value()) {
+      relays.insert(node);
+    } else {
+      ASSERT_NE(node, *parent);
+      ASSERT_FALSE(topology.GetParent(*parent).has_value());
+    }
+  }
+  ASSERT_LE(relays.size(), topology.NumGroups());
+  ASSERT_GT(relays.size(), 1);
+
+  // Unknown nodes sync with the root.
+  ASSERT_FALSE(topology.GetParent(NodeID::FromRandom().Binary()).has_value());
+}
+
+TEST(RelayTopologyTest, RelayFailover) {
+  RelayTopology topology(/*group_size=*/8);
+  std::vector<std::string> nodes;
+  for (int i = 0; i < 8; ++i) {
+    nodes.push_back(NodeID::FromRandom().Binary());
+    topology.AddNode(nodes.back());
+  }
+  ASSERT_EQ(1, topology.NumGroups());
+  std::string member;
+  for (const auto &node : nodes) {
+    if (topology.GetParent(node).has_value()) {
+      member = node;
+      break;
+    }
+  }
+  ASSERT_FALSE(member.empty());
+  auto relay = *topology.GetParent(member);
+
+  // An unreachable relay is skipped, but the partition doesn't change.
+  topology.MarkUnreachable(relay);
+  ASSERT_EQ(8, topology.NumNodes());
+  auto new_relay = topology.GetParent(member);
+  ASSERT_NE(relay, new_relay.value_or(member));
+
+  // The relay is picked again once it's reachable.
+  topology.MarkReachable(relay);
+  ASSERT_EQ(relay, topology.GetParent(member));
+  topology.MarkUnreachable(relay);
+
+  // A dead relay is removed and another member takes over.
+  topology.RemoveNode(relay);
+  ASSERT_EQ(7, topology.NumNodes());
+  ASSERT_EQ(new_relay, topology.GetParent(member));
+  for (const auto &node : nodes) {
+    if (node != relay) {
+      ASSERT_NE(relay, topology.GetParent(node).value_or(node));
+    }
+  }
+}
+
 struct MockReactor {
   void StartRead(RaySyncMessage *) { ++read_cnt; }
 
@@ -785,11 +856,139 @@ TEST_F(SyncerTest, TestMToN) {
   ASSERT_TRUE(TestCorrectness(get_cluster_view, servers, g));
 }
 
+TEST_F(SyncerTest, TestRelayFailover) {
+  // s3 syncs with the root s1 through the relay s2:
+  //    s3 -> s2 -> s1
+  // Once s2 is gone, s3 falls back to s1:
+  //    s3 -> s1
+  auto &s1 = MakeServer("19990");
+  auto &s2 = MakeServer("19991");
+  auto &s3 = MakeServer("19992");
+  const auto &id1 = s1.syncer->GetLocalNodeID();
+  const auto &id3 = s3.syncer->GetLocalNodeID();
+
+  std::promise<std::string> failed_relay;
+  s2.syncer->Connect(id1, MakeChannel("19990"));
+  s3.syncer->Connect(s2.syncer->GetLocalNodeID(),
+                     MakeChannel("19991"),
+                     [&s3, &failed_relay, id1](const std::string &node_id) {
+                       failed_relay.set_value(node_id);
+                       s3.syncer->Connect(id1, MakeChannel("19990"));
+                     });
+
+  s1.local_versions[0] = 1;
+  s3.local_versions[0] = 1;
+  ASSERT_TRUE(s3.WaitUntil(
+      [&s3, id1]() { return s3.GetReceivedVersions(id1)[0] == 1; }, 5));
+  ASSERT_TRUE(s1.WaitUntil(
+      [&s1, id3]() { return s1.GetReceivedVersions(id3)[0] == 1; }, 5));
+
+  // Cancel all the calls of s2 to break the connection from s3.
+  s2.server->Shutdown(std::chrono::system_clock::now());
+  auto future = failed_relay.get_future();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(5s));
+  ASSERT_EQ(s2.syncer->GetLocalNodeID(), future.get());
+
+  s1.local_versions[0] = 2;
+  s3.local_versions[0] = 2;
+  ASSERT_TRUE(s3.WaitUntil(
+      [&s3, id1]() { return s3.GetReceivedVersions(id1)[0] == 2; }, 5));
+  ASSERT_TRUE(s1.WaitUntil(
+      [&s1, id3]() { return s1.GetReceivedVersions(id3)[0] == 2; }, 5));
+}
+
+TEST_F(SyncerTest, TestReconnectBeforeDone) {
+  // s2 reconnects to s1 right away, so s1 might get the new connection before the
+  // previous one is done, or even get the connections out of order. s1 ends up with
+  // the latest one either way.
+  auto &s1 = MakeServer("19990");
+  auto &s2 = MakeServer("19991");
+  const auto &id1 = s1.syncer->GetLocalNodeID();
+  const auto &id2 = s2.syncer->GetLocalNodeID();
+  s2.syncer->Connect(id1, MakeChannel("19990"));
+  for (int i = 0; i < 3; ++i) {
+    s2.syncer->Disconnect(id1);
+    s2.syncer->Connect(id1, MakeChannel("19990"));
+  }
+
+  s2.local_versions[0] = 1;
+  ASSERT_TRUE(s1.WaitUntil(
+      [&s1, id2]() { return s1.GetReceivedVersions(id2)[0] == 1; }, 5));
+  ASSERT_TRUE(s1.WaitUntil(
+      [&s1]() { return s1.syncer->GetAllConnectedNodeIDs().size() == 1; }, 5));
+  ASSERT_EQ(std::vector<std::string>{id1}, s2.syncer->GetAllConnectedNodeIDs());
+}
+
+TEST_F(SyncerTest, TestSwitchRelayKeepsView) {
+  // s3 switches from the root s1 to the relay s2:
+  //    s3 -> s1 <- s2
+  // Then,
+  //    s3 -> s2 -> s1
+  // s2 doesn't send the message of s3 to s1 again since it hasn't changed, so s1 has
+  // to keep it when s3 disconnects.
+  RayConfig::instance().initialize(R"({"ray_syncer_relay_group_size": 2})");
+  auto &s1 = MakeServer("19990");
+  auto &s2 = MakeServer("19991");
+  auto &s3 = MakeServer("19992");
+  const auto &id1 = s1.syncer->GetLocalNodeID();
+  const auto &id2 = s2.syncer->GetLocalNodeID();
+  const auto &id3 = s3.syncer->GetLocalNodeID();
+  s2.syncer->Connect(id1, MakeChannel("19990"));
+  s3.syncer->Connect(id1, MakeChannel("19990"));
+
+  s3.local_versions[0] = 1;
+  ASSERT_TRUE(s2.WaitUntil(
+      [&s2, id3]() { return s2.GetReceivedVersions(id3)[0] == 1; }, 5));
+
+  s3.syncer->Disconnect(id1);
+  s3.syncer->Connect(id2, MakeChannel("19991"));
+  ASSERT_TRUE(s1.WaitUntil(
+      [&s1]() { return s1.syncer->GetAllConnectedNodeIDs().size() == 1; }, 5));
+  auto message = s1.syncer->GetSyncMessage(id3, MessageType::RESOURCE_VIEW);
+  ASSERT_NE(nullptr, message);
+  ASSERT_EQ(1, message->version());
+
+  // A dead node is removed from the view.
+  s1.syncer->RemoveNode(id3);
+  ASSERT_EQ(nullptr, s1.syncer->GetSyncMessage(id3, MessageType::RESOURCE_VIEW));
+  RayConfig::instance().initialize("");
+}
+
+TEST_F(SyncerTest, TestDisconnectIsNotFailure) {
+  // s2 disconnects from s1 on purpose, e.g. to switch to another relay, but s1 shuts
+  // down before it finishes the call, so the call ends with an error. It's still not
+  // reported as a broken connection, or reconnected.
+  auto &s1 = MakeServer("19990");
+  auto &s2 = MakeServer("19991");
+  const auto &id1 = s1.syncer->GetLocalNodeID();
+  std::atomic<int> num_failures = 0;
+  s2.syncer->Connect(id1, MakeChannel("19990"), [&num_failures](const std::string &) {
+    num_failures++;
+  });
+  ASSERT_TRUE(s1.WaitUntil(
+      [&s1]() { return s1.syncer->GetAllConnectedNodeIDs().size() == 1; }, 5));
+
+  // Block s1 so that it doesn't finish the call once s2 is done writing.
+  std::promise<void> unblock_s1;
+  s1.io_context.post(
+      [future = unblock_s1.get_future().share()]() { future.wait(); }, "TEST");
+  s2.syncer->Disconnect(id1);
+  std::thread shutdown_s1(
+      [&s1]() { s1.server->Shutdown(std::chrono::system_clock::now()); });
+  std::this_thread::sleep_for(2s);
+  unblock_s1.set_value();
+  shutdown_s1.join();
+
+  std::this_thread::sleep_for(3s);
+  ASSERT_EQ(0, num_failures);
+  ASSERT_TRUE(s2.syncer->GetAllConnectedNodeIDs().empty());
+}
+
 struct MockRaySyncerService : public ray::rpc::syncer::RaySyncer::CallbackService {
   MockRaySyncerService(
       instrumented_io_context &_io_context,
       std::function<void(std::shared_ptr<const RaySyncMessage>)> _message_processor,
-      std::function<void(const std::string &, bool)> _cleanup_cb)
+      std::function<void(RaySyncerBidiReactor *, bool)> _cleanup_cb)
       : message_processor(_message_processor),
         cleanup_cb(_cleanup_cb),
         node_id(NodeID::FromRandom()),
@@ -802,7 +1001,7 @@ struct MockRaySyncerService : public ray::rpc::syncer::RaySyncer::CallbackServic
   }
 
   std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor;
-  std::function<void(const std::string &, bool)> cleanup_cb;
+  std::function<void(RaySyncerBidiReactor *, bool)> cleanup_cb;
   NodeID node_id;
   instrumented_io_context &io_context;
   RayServerBidiReactor *reactor = nullptr;
@@ -814,8 +1013,8 @@ class SyncerReactorTest : public ::testing::Test {
     rpc_service_ = std::make_unique<MockRaySyncerService>(
         io_context_,
         [this](auto msg) { server_received_message.set_value(msg); },
-        [this](auto &node, bool restart) {
-          server_cleanup.set_value(std::make_pair(node, restart));
+        [this](RaySyncerBidiReactor *reactor, bool restart) {
+          server_cleanup.set_value(std::make_pair(reactor->GetRemoteNodeID(), restart));
         });
     grpc::ServerBuilder builder;
     builder.AddListeningPort("0.0.0.0:18990", grpc::InsecureServerCredentials());
@@ -830,8 +1029,9 @@ class SyncerReactorTest : public ::testing::Test {
                       client_node_id.Binary(),
                       io_context_,
                       [this](auto msg) { client_received_message.set_value(msg); },
-                      [this](const std::string &n, bool r) {
-                        client_cleanup.set_value(std::make_pair(n, r));
+                      [this](RaySyncerBidiReactor *reactor, bool r) {
+                        client_cleanup.set_value(
+                            std::make_pair(reactor->GetRemoteNodeID(), r));
                       },
                       std::move(cli_stub))
                       .release();
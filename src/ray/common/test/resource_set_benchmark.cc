@@ -0,0 +1,78 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the ResourceSet arithmetic of the scheduler, with the argument being
+// the number of resources in a set.
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/benchmark_util.h"
+#include "ray/common/scheduling/resource_set.h"
+
+namespace ray {
+namespace benchmark {
+
+namespace {
+
+/// A resource set with CPU, GPU, memory and custom resources.
+ResourceSet MakeResourceSet(int64_t num_resources, double quantity) {
+  absl::flat_hash_map<std::string, double> resources{
+      {"CPU", quantity}, {"GPU", quantity}, {"memory", quantity}};
+  for (int64_t i = resources.size(); i < num_resources; ++i) {
+    resources["custom_" + std::to_string(i)] = quantity;
+  }
+  return ResourceSet(resources);
+}
+
+void BM_ResourceSetAdd(State &state) {
+  const auto a = MakeResourceSet(state.range(), 4);
+  const auto b = MakeResourceSet(state.range(), 1);
+  while (state.KeepRunning()) {
+    DoNotOptimize(a + b);
+  }
+}
+RAY_BENCHMARK(BM_ResourceSetAdd)->Arg(3)->Arg(16);
+
+void BM_ResourceSetSubtractInPlace(State &state) {
+  auto a = MakeResourceSet(state.range(), 1e9);
+  const auto b = MakeResourceSet(state.range(), 1);
+  while (state.KeepRunning()) {
+    a -= b;
+    DoNotOptimize(a);
+  }
+}
+RAY_BENCHMARK(BM_ResourceSetSubtractInPlace)->Arg(3)->Arg(16);
+
+void BM_ResourceSetLessEqual(State &state) {
+  const auto a = MakeResourceSet(state.range(), 1);
+  const auto b = MakeResourceSet(state.range(), 4);
+  while (state.KeepRunning()) {
+    DoNotOptimize(a <= b);
+  }
+}
+RAY_BENCHMARK(BM_ResourceSetLessEqual)->Arg(3)->Arg(16);
+
+void BM_NodeResourceSetSubtract(State &state) {
+  NodeResourceSet node(MakeResourceSet(state.range(), 1e9).GetResourceMap());
+  const auto request = MakeResourceSet(state.range(), 1);
+  while (state.KeepRunning()) {
+    DoNotOptimize(node >= request);
+    node -= request;
+  }
+}
+RAY_BENCHMARK(BM_NodeResourceSetSubtract)->Arg(3)->Arg(16);
+
+}  // namespace
+
+}  // namespace benchmark
+}  // namespace ray
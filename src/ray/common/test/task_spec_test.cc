@@ -14,7 +14,10 @@
 
 #include "ray/common/task/task_spec.h"
 
+#include <google/protobuf/util/message_differencer.h>
+
 #include "gtest/gtest.h"
+#include "ray/common/task/task_util.h"
 
 namespace ray {
 TEST(TaskSpecTest, TestSchedulingClassDescriptor) {
@@ -146,6 +149,30 @@ TEST(TaskSpecTest, TestTaskSpecification) {
   ASSERT_TRUE(task_spec.GetNodeAffinitySchedulingStrategyNodeId() == node_id);
 }
 
+TEST(TaskSpecTest, TestArgBuffersAliasMessage) {
+  rpc::TaskSpec message;
+  message.add_args()->set_data("data");
+  message.add_args()->set_metadata("metadata");
+  std::shared_ptr<Buffer> data;
+  std::shared_ptr<Buffer> metadata;
+  {
+    TaskSpecification task_spec(std::move(message));
+    data = task_spec.ArgDataBuffer(0);
+    ASSERT_EQ(data->Data(), task_spec.ArgData(0));
+    ASSERT_EQ(task_spec.ArgMetadataBuffer(0), nullptr);
+    metadata = task_spec.ArgMetadataBuffer(1);
+    ASSERT_EQ(metadata->Data(), task_spec.ArgMetadata(1));
+    ASSERT_EQ(task_spec.ArgDataBuffer(1), nullptr);
+  }
+  // The buffers are still valid after the task spec is destroyed.
+  ASSERT_TRUE(data->OwnsData());
+  ASSERT_EQ(std::string(reinterpret_cast<const char *>(data->Data()), data->Size()),
+            "data");
+  ASSERT_EQ(
+      std::string(reinterpret_cast<const char *>(metadata->Data()), metadata->Size()),
+      "metadata");
+}
+
 TEST(TaskSpecTest, TestNodeLabelSchedulingStrategy) {
   rpc::SchedulingStrategy scheduling_strategy_1;
   auto expr_1 = scheduling_strategy_1.mutable_node_label_scheduling_strategy()
@@ -196,6 +223,97 @@ TEST(TaskSpecTest, TestNodeLabelSchedulingStrategy) {
   ASSERT_FALSE(std::hash<rpc::SchedulingStrategy>()(scheduling_strategy_1) ==
                std::hash<rpc::SchedulingStrategy>()(scheduling_strategy_5));
 }
+
+TEST(TaskSpecTest, TestTaskSpecTemplate) {
+  FunctionDescriptor function_descriptor =
+      FunctionDescriptorBuilder::BuildPython("module", "class", "func", "");
+  const JobID job_id = JobID::FromInt(1);
+  const TaskID task_id = TaskID::FromRandom(job_id);
+  const TaskID parent_task_id = TaskID::FromRandom(job_id);
+  rpc::JobConfig job_config;
+  job_config.set_ray_namespace("namespace");
+  rpc::Address caller_address;
+  caller_address.set_ip_address("127.0.0.1");
+  std::unordered_map<std::string, double> resources{{"CPU", 1.0}};
+  auto runtime_env_info = std::make_shared<rpc::RuntimeEnvInfo>();
+  runtime_env_info->set_serialized_runtime_env("{\"pip\": [\"requests\"]}");
+  rpc::SchedulingStrategy scheduling_strategy;
+  scheduling_strategy.mutable_spread_scheduling_strategy();
+
+  TaskSpecBuilder builder;
+  builder
+      .SetCommonTaskSpec(task_id,
+                         "name",
+                         Language::PYTHON,
+                         function_descriptor,
+                         job_id,
+                         job_config,
+                         parent_task_id,
+                         /*parent_counter=*/3,
+                         parent_task_id,
+                         caller_address,
+                         /*num_returns=*/2,
+                         /*returns_dynamic=*/false,
+                         /*is_streaming_generator=*/false,
+                         /*generator_backpressure_num_objects=*/-1,
+                         resources,
+                         resources,
+                         /*debugger_breakpoint=*/"",
+                         /*depth=*/1,
+                         parent_task_id,
+                         runtime_env_info)
+      .SetNormalTaskSpec(/*max_retries=*/3,
+                         /*retry_exceptions=*/true,
+                         /*serialized_retry_exception_allowlist=*/"allowlist",
+                         scheduling_strategy);
+  const auto task_spec = builder.Build();
+  ASSERT_EQ(task_spec.Template(), nullptr);
+
+  TaskSpecBuilder template_builder;
+  template_builder.SetTemplateTaskSpec("name",
+                                       function_descriptor,
+                                       job_config,
+                                       caller_address,
+                                       resources,
+                                       resources,
+                                       runtime_env_info,
+                                       "allowlist",
+                                       scheduling_strategy);
+  auto task_spec_template =
+      std::make_shared<const rpc::TaskSpec>(template_builder.GetMessage());
+  TaskSpecBuilder builder_from_template(task_spec_template);
+  builder_from_template.SetPerCallTaskSpec(task_id,
+                                           Language::PYTHON,
+                                           job_id,
+                                           parent_task_id,
+                                           /*parent_counter=*/3,
+                                           parent_task_id,
+                                           /*num_returns=*/2,
+                                           /*returns_dynamic=*/false,
+                                           /*is_streaming_generator=*/false,
+                                           /*generator_backpressure_num_objects=*/-1,
+                                           /*debugger_breakpoint=*/"",
+                                           /*depth=*/1,
+                                           parent_task_id,
+                                           /*max_retries=*/3,
+                                           /*retry_exceptions=*/true);
+  const auto task_spec_from_template = builder_from_template.Build();
+  ASSERT_EQ(task_spec_from_template.Template(), task_spec_template);
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+      task_spec.GetMessage(), task_spec_from_template.GetMessage()));
+  ASSERT_EQ(task_spec.GetSchedulingClass(), task_spec_from_template.GetSchedulingClass());
+
+  // The fields cleared from the task spec are restored from the template.
+  rpc::TaskSpec per_call_fields = task_spec_from_template.GetMessage();
+  per_call_fields.set_attempt_number(1);
+  ClearTaskSpecTemplateFields(&per_call_fields);
+  ASSERT_LT(per_call_fields.ByteSizeLong(), task_spec.GetMessage().ByteSizeLong());
+  ApplyTaskSpecTemplate(*task_spec_template, &per_call_fields);
+  rpc::TaskSpec expected = task_spec.GetMessage();
+  expected.set_attempt_number(1);
+  ASSERT_TRUE(
+      google::protobuf::util::MessageDifferencer::Equals(expected, per_call_fields));
+}
 }  // namespace ray
 
 int main(int argc, char **argv) {
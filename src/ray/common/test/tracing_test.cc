@@ -0,0 +1,121 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/tracing.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "absl/strings/escaping.h"
+#include "gtest/gtest.h"
+#include "nlohmann/json.hpp"
+#include "ray/common/ray_config.h"
+
+namespace ray {
+namespace tracing {
+
+class TracingTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    log_dir_ = std::filesystem::temp_directory_path() /
+               ("tracing_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(log_dir_);
+    Init("test", log_dir_.string());
+  }
+
+  void TearDown() override {
+    Shutdown();
+    std::filesystem::remove_all(log_dir_);
+    RayConfig::instance().initialize(R"({"tracing_sample_ratio": 0})");
+  }
+
+  /// Read the exported spans.
+  std::vector<nlohmann::json> ReadSpans() {
+    std::vector<nlohmann::json> spans;
+    std::ifstream file(log_dir_ /
+                       ("traces_test_" + std::to_string(getpid()) + ".jsonl"));
+    std::string line;
+    while (std::getline(file, line)) {
+      const auto request = nlohmann::json::parse(line);
+      const auto &resource_spans = request["resourceSpans"][0];
+      EXPECT_EQ(resource_spans["resource"]["attributes"][0]["value"]["stringValue"],
+                "test");
+      spans.push_back(resource_spans["scopeSpans"][0]["spans"][0]);
+    }
+    return spans;
+  }
+
+ protected:
+  std::filesystem::path log_dir_;
+};
+
+TEST_F(TracingTest, TestNotSampled) {
+  RayConfig::instance().initialize(R"({"tracing_sample_ratio": 0})");
+  const auto context = NewSpanContext(rpc::TraceContext());
+  ASSERT_FALSE(IsSampled(context));
+  ASSERT_FALSE(IsSampled(NewChildContext(context)));
+  {
+    Span span("task", context);
+    ASSERT_FALSE(span.IsRecording());
+    span.SetAttribute("key", "value");
+    auto child = Span::StartChild("child", span.Context());
+    ASSERT_FALSE(child.IsRecording());
+  }
+  ASSERT_TRUE(ReadSpans().empty());
+}
+
+TEST_F(TracingTest, TestSampled) {
+  RayConfig::instance().initialize(R"({"tracing_sample_ratio": 1})");
+  const auto context = NewSpanContext(rpc::TraceContext());
+  ASSERT_TRUE(IsSampled(context));
+  ASSERT_EQ(context.trace_id().size(), 16u);
+  ASSERT_EQ(context.span_id().size(), 8u);
+  ASSERT_TRUE(context.parent_span_id().empty());
+
+  // The children of a sampled span are in its trace, whatever the sample ratio.
+  RayConfig::instance().initialize(R"({"tracing_sample_ratio": 0})");
+  const auto child_context = NewSpanContext(context);
+  ASSERT_EQ(child_context.trace_id(), context.trace_id());
+  ASSERT_EQ(child_context.parent_span_id(), context.span_id());
+  ASSERT_NE(child_context.span_id(), context.span_id());
+
+  {
+    Span span("task", context);
+    ASSERT_TRUE(span.IsRecording());
+    auto child = Span::StartChild("child", span.Context());
+    child.SetAttribute("key", "value");
+    ASSERT_EQ(child.Context().parent_span_id(), context.span_id());
+    // Moving the span doesn't end it.
+    Span moved = std::move(child);
+    moved.End();
+    ASSERT_FALSE(moved.IsRecording());
+    ASSERT_EQ(ReadSpans().size(), 1);
+  }
+
+  const auto spans = ReadSpans();
+  ASSERT_EQ(spans.size(), 2);
+  ASSERT_EQ(spans[0]["name"], "child");
+  ASSERT_EQ(spans[0]["traceId"], absl::BytesToHexString(context.trace_id()));
+  ASSERT_EQ(spans[0]["parentSpanId"], absl::BytesToHexString(context.span_id()));
+  ASSERT_EQ(spans[0]["attributes"][0]["key"], "key");
+  ASSERT_EQ(spans[0]["attributes"][0]["value"]["stringValue"], "value");
+  ASSERT_EQ(spans[1]["name"], "task");
+  ASSERT_EQ(spans[1]["spanId"], absl::BytesToHexString(context.span_id()));
+  ASSERT_FALSE(spans[1].contains("parentSpanId"));
+  ASSERT_LE(std::stoll(spans[1]["startTimeUnixNano"].get<std::string>()),
+            std::stoll(spans[1]["endTimeUnixNano"].get<std::string>()));
+}
+
+}  // namespace tracing
+}  // namespace ray
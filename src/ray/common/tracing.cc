@@ -0,0 +1,211 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/common/tracing.h"
+
+#include <fstream>
+
+#include "absl/random/random.h"
+#include "absl/strings/escaping.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "nlohmann/json.hpp"
+#include "ray/common/ray_config.h"
+#include "ray/util/logging.h"
+#include "ray/util/util.h"
+
+namespace ray {
+namespace tracing {
+
+namespace {
+
+constexpr size_t kTraceIdSize = 16;
+constexpr size_t kSpanIdSize = 8;
+
+/// The exporter of the spans of the process.
+struct Exporter {
+  absl::Mutex mutex;
+  std::string component ABSL_GUARDED_BY(mutex);
+  std::string path ABSL_GUARDED_BY(mutex);
+  /// The file of the spans, opened when the first span is exported.
+  std::unique_ptr<std::ofstream> file ABSL_GUARDED_BY(mutex);
+};
+
+Exporter &GetExporter() {
+  static auto *exporter = new Exporter();
+  return *exporter;
+}
+
+absl::BitGen &GetBitGen() {
+  thread_local absl::BitGen bitgen;
+  return bitgen;
+}
+
+std::string RandomId(size_t size) {
+  std::string id(size, '\0');
+  auto &bitgen = GetBitGen();
+  for (auto &byte : id) {
+    byte = static_cast<char>(absl::Uniform<uint8_t>(bitgen));
+  }
+  return id;
+}
+
+nlohmann::json StringAttribute(const std::string &key, const std::string &value) {
+  return {{"key", key}, {"value", {{"stringValue", value}}}};
+}
+
+void Export(const std::string &name,
+            const rpc::TraceContext &context,
+            int64_t start_time_ns,
+            int64_t end_time_ns,
+            const std::vector<std::pair<std::string, std::string>> &attributes) {
+  auto &exporter = GetExporter();
+  absl::MutexLock lock(&exporter.mutex);
+  if (exporter.path.empty()) {
+    return;
+  }
+  if (exporter.file == nullptr) {
+    exporter.file = std::make_unique<std::ofstream>(exporter.path, std::ios::app);
+    if (!exporter.file->good()) {
+      RAY_LOG(WARNING) << "Failed to open the file of the spans " << exporter.path
+                       << ", the spans are dropped.";
+      exporter.path.clear();
+      exporter.file.reset();
+      return;
+    }
+  }
+
+  nlohmann::json span = {
+      {"traceId", absl::BytesToHexString(context.trace_id())},
+      {"spanId", absl::BytesToHexString(context.span_id())},
+      {"name", name},
+      // SPAN_KIND_INTERNAL.
+      {"kind", 1},
+      // The 64 bits integers are strings in OTLP/JSON.
+      {"startTimeUnixNano", std::to_string(start_time_ns)},
+      {"endTimeUnixNano", std::to_string(end_time_ns)},
+      {"attributes", nlohmann::json::array()}};
+  if (!context.parent_span_id().empty()) {
+    span["parentSpanId"] = absl::BytesToHexString(context.parent_span_id());
+  }
+  for (const auto &[key, value] : attributes) {
+    span["attributes"].push_back(StringAttribute(key, value));
+  }
+  nlohmann::json request = {
+      {"resourceSpans",
+       {{{"resource",
+          {{"attributes",
+            {StringAttribute("service.name", exporter.component),
+             StringAttribute("process.pid", std::to_string(getpid()))}}}},
+         {"scopeSpans",
+          {{{"scope", {{"name", "ray"}}}, {"spans", {std::move(span)}}}}}}}}};
+  // The spans are sampled, so they're few enough to be flushed one by one, which keeps
+  // the file complete if the process crashes.
+  *exporter.file << request.dump() << std::endl;
+}
+
+}  // namespace
+
+void Init(const std::string &component, const std::string &log_dir) {
+  auto &exporter = GetExporter();
+  absl::MutexLock lock(&exporter.mutex);
+  exporter.component = component;
+  exporter.path = log_dir.empty() ? ""
+                                  : log_dir + "/traces_" + component + "_" +
+                                        std::to_string(getpid()) + ".jsonl";
+  exporter.file.reset();
+}
+
+void Shutdown() {
+  auto &exporter = GetExporter();
+  absl::MutexLock lock(&exporter.mutex);
+  exporter.path.clear();
+  exporter.file.reset();
+}
+
+bool IsSampled(const rpc::TraceContext &context) { return !context.span_id().empty(); }
+
+rpc::TraceContext NewChildContext(const rpc::TraceContext &parent) {
+  rpc::TraceContext context;
+  if (IsSampled(parent)) {
+    context.set_trace_id(parent.trace_id());
+    context.set_span_id(RandomId(kSpanIdSize));
+    context.set_parent_span_id(parent.span_id());
+  }
+  return context;
+}
+
+rpc::TraceContext NewSpanContext(const rpc::TraceContext &parent) {
+  if (IsSampled(parent)) {
+    return NewChildContext(parent);
+  }
+  rpc::TraceContext context;
+  const double sample_ratio = RayConfig::instance().tracing_sample_ratio();
+  if (sample_ratio > 0 && absl::Bernoulli(GetBitGen(), sample_ratio)) {
+    context.set_trace_id(RandomId(kTraceIdSize));
+    context.set_span_id(RandomId(kSpanIdSize));
+  }
+  return context;
+}
+
+Span::Span(std::string name, const rpc::TraceContext &context) {
+  if (IsSampled(context)) {
+    data_ = std::make_unique<Data>();
+    data_->name = std::move(name);
+    data_->context = context;
+    data_->start_time_ns = absl::GetCurrentTimeNanos();
+  }
+}
+
+Span Span::StartChild(absl::string_view name, const rpc::TraceContext &parent) {
+  if (!IsSampled(parent)) {
+    return Span();
+  }
+  return Span(std::string(name), NewChildContext(parent));
+}
+
+Span &Span::operator=(Span &&other) {
+  if (this != &other) {
+    End();
+    data_ = std::move(other.data_);
+  }
+  return *this;
+}
+
+Span::~Span() { End(); }
+
+const rpc::TraceContext &Span::Context() const {
+  return data_ != nullptr ? data_->context : rpc::TraceContext::default_instance();
+}
+
+void Span::SetAttribute(std::string key, std::string value) {
+  if (data_ != nullptr) {
+    data_->attributes.emplace_back(std::move(key), std::move(value));
+  }
+}
+
+void Span::End() {
+  if (data_ == nullptr) {
+    return;
+  }
+  Export(data_->name,
+         data_->context,
+         data_->start_time_ns,
+         absl::GetCurrentTimeNanos(),
+         data_->attributes);
+  data_.reset();
+}
+
+}  // namespace tracing
+}  // namespace ray
@@ -0,0 +1,111 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "src/ray/protobuf/common.pb.h"
+
+namespace ray {
+namespace tracing {
+
+/// The tracing of the lifecycle of the tasks, across the submitter, the raylets, the
+/// executor and the object transfers.
+///
+/// A span is a timed operation of a trace, e.g. the lease of a task. The context of a
+/// span is propagated in the task specs and the RPCs, so that the processes handling the
+/// task record their spans as children of it. The traces are sampled when they start
+/// (head-based sampling), and only the contexts of the sampled traces are set, so the
+/// spans of the other traces cost a check of an empty context.
+///
+/// The ended spans are written to a file of the log directory, a line per span in the
+/// OTLP/JSON format of OpenTelemetry, i.e. an ExportTraceServiceRequest. The files can
+/// be sent to any OpenTelemetry backend by a collector with the otlpjsonfile receiver.
+
+/// Start exporting the spans of this process.
+///
+/// \param component The name of the process, e.g. raylet. It's the service name of
+/// the spans.
+/// \param log_dir The directory of the file of the spans. The spans are dropped if it's
+/// empty.
+void Init(const std::string &component, const std::string &log_dir);
+
+/// Stop exporting the spans. The spans ended after it are dropped.
+void Shutdown();
+
+/// Whether the context is of a sampled trace.
+bool IsSampled(const rpc::TraceContext &context);
+
+/// Get the context of a new child span of a span.
+///
+/// \return The context, or an empty one if the trace of the parent isn't sampled.
+rpc::TraceContext NewChildContext(const rpc::TraceContext &parent);
+
+/// Get the context of a new span, which is a child of the given span if its trace is
+/// sampled, or else the root of a new trace which is sampled with the probability of the
+/// config.
+///
+/// \return The context, or an empty one if the span isn't sampled.
+rpc::TraceContext NewSpanContext(const rpc::TraceContext &parent);
+
+/// A span, which is ended when it's destroyed. It's a no-op if its context is empty.
+/// This class isn't thread-safe.
+class Span {
+ public:
+  /// Construct a no-op span.
+  Span() = default;
+
+  /// Start a span.
+  ///
+  /// \param name The name of the span.
+  /// \param context The context of the span, see NewSpanContext.
+  Span(std::string name, const rpc::TraceContext &context);
+
+  /// Start a child span of a span. The name is only copied if the span is sampled.
+  static Span StartChild(absl::string_view name, const rpc::TraceContext &parent);
+
+  Span(Span &&other) = default;
+  Span &operator=(Span &&other);
+
+  ~Span();
+
+  /// Whether the span is recorded, i.e. it's sampled and not ended.
+  bool IsRecording() const { return data_ != nullptr; }
+
+  /// The context of the span, or an empty one if it isn't recording.
+  const rpc::TraceContext &Context() const;
+
+  void SetAttribute(std::string key, std::string value);
+
+  /// End the span and export it. This is a no-op if it's not recording.
+  void End();
+
+ private:
+  struct Data {
+    std::string name;
+    rpc::TraceContext context;
+    int64_t start_time_ns;
+    std::vector<std::pair<std::string, std::string>> attributes;
+  };
+
+  std::unique_ptr<Data> data_;
+};
+
+}  // namespace tracing
+}  // namespace ray
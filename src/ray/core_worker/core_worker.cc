@@ -22,12 +22,14 @@
 #include <google/protobuf/util/json_util.h>
 
 #include "absl/cleanup/cleanup.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "boost/fiber/all.hpp"
 #include "ray/common/bundle_spec.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/runtime_env_common.h"
 #include "ray/common/task/task_util.h"
+#include "ray/common/tracing.h"
 #include "ray/core_worker/context.h"
 #include "ray/core_worker/transport/direct_actor_transport.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
@@ -105,6 +107,35 @@ ObjectLocation CreateObjectLocation(const rpc::GetObjectLocationsOwnerReply &rep
                         NodeID::FromBinary(object_info.spilled_node_id()),
                         object_info.did_spill());
 }
+
+// Convert the num_returns of the task options to the num_returns of the task spec.
+// Returns whether the task returns dynamically and whether it's a streaming generator.
+std::pair<bool, bool> ResolveNumReturns(int64_t *num_returns) {
+  bool returns_dynamic = *num_returns == -1;
+  if (returns_dynamic) {
+    // This remote function returns 1 ObjectRef, whose value
+    // is a generator of ObjectRefs.
+    *num_returns = 1;
+  }
+  // TODO(sang): Remove this and integrate it to
+  // nun_returns == -1 once migrating to streaming
+  // generator.
+  bool is_streaming_generator = *num_returns == kStreamingGeneratorReturn;
+  if (is_streaming_generator) {
+    *num_returns = 1;
+    // We are using the dynamic return if
+    // the streaming generator is used.
+    returns_dynamic = true;
+  }
+  RAY_CHECK(*num_returns >= 0);
+  return {returns_dynamic, is_streaming_generator};
+}
+
+// Append a length-prefixed part to the key of a task spec template, so that different
+// parts can't produce the same key.
+void AppendTemplateKeyPart(std::string *key, const std::string &part) {
+  absl::StrAppend(key, part.size(), ":", part);
+}
 }  // namespace
 
 CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_id)
@@ -116,6 +147,10 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       io_work_(io_service_),
       client_call_manager_(new rpc::ClientCallManager(io_service_)),
       periodical_runner_(io_service_),
+      io_context_watchdog_(
+          RayConfig::instance().core_worker_event_loop_watchdog_enabled()
+              ? IoContextWatchdog::Create(io_service_, "core_worker")
+              : nullptr),
       task_queue_length_(0),
       num_executed_tasks_(0),
       resource_ids_(new ResourceMappingType()),
@@ -303,9 +338,16 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
     RAY_CHECK(
         RayConfig::instance().max_pending_lease_requests_per_scheduling_category() != 0)
         << "max_pending_lease_requests_per_scheduling_category can't be 0";
-    lease_request_rate_limiter_ =
-        std::make_shared<ClusterSizeBasedLeaseRequestRateLimiter>(
-            /*kMinConcurrentLeaseCap*/ 10);
+    if (RayConfig::instance().adaptive_lease_request_rate_limiter_enabled()) {
+      lease_request_rate_limiter_ = std::make_shared<AdaptiveLeaseRequestRateLimiter>(
+          /*kMinConcurrentLeaseCap*/ 10,
+          RayConfig::instance().adaptive_lease_request_rate_limit_per_node(),
+          RayConfig::instance().adaptive_lease_request_target_latency_ms());
+    } else {
+      lease_request_rate_limiter_ =
+          std::make_shared<ClusterSizeBasedLeaseRequestRateLimiter>(
+              /*kMinConcurrentLeaseCap*/ 10);
+    }
   }
 
   // Register a callback to monitor add/removed nodes.
@@ -320,6 +362,7 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
                        "reconstruction is not enabled.";
       reference_counter->ResetObjectsOnRemovedNode(node_id);
     }
+    // This includes AdaptiveLeaseRequestRateLimiter, which also tracks the cluster size.
     auto cluster_size_based_rate_limiter =
         dynamic_cast<ClusterSizeBasedLeaseRequestRateLimiter *>(rate_limiter.get());
     if (cluster_size_based_rate_limiter) {
@@ -515,7 +558,21 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
 
   // Unfortunately the raylet client has to be constructed after the receivers.
   if (direct_task_receiver_ != nullptr) {
-    task_argument_waiter_.reset(new DependencyWaiterImpl(*local_raylet_client_));
+    if (RayConfig::instance().actor_task_args_prefetch_max_tasks() > 0 &&
+        !options_.is_local_mode) {
+      actor_task_arg_prefetcher_ = std::make_unique<ActorTaskArgPrefetcher>(
+          RayConfig::instance().actor_task_args_prefetch_max_tasks(),
+          RayConfig::instance().actor_task_args_prefetch_max_bytes(),
+          [this](const absl::flat_hash_set<ObjectID> &object_ids,
+                 absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> *results) {
+            // Get() would make the raylet fetch the objects and cancel the gets of the
+            // worker, so only look up the objects which are already local.
+            return plasma_store_provider_->GetIfLocal(
+                std::vector<ObjectID>(object_ids.begin(), object_ids.end()), results);
+          });
+    }
+    task_argument_waiter_.reset(new DependencyWaiterImpl(
+        *local_raylet_client_, actor_task_arg_prefetcher_.get()));
     direct_task_receiver_->Init(
         core_worker_client_pool_, rpc_address_, task_argument_waiter_);
   }
@@ -590,6 +647,9 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
                         << "-----------------\n"
                         << "Task Event stats:\n"
                         << task_event_buffer_->DebugString() << "\n";
+          if (io_context_watchdog_ != nullptr) {
+            RAY_LOG(INFO) << io_context_watchdog_->DebugString();
+          }
         },
         event_stats_print_interval_ms,
         "CoreWorker.PrintEventStats");
@@ -674,6 +734,9 @@ void CoreWorker::Shutdown() {
     direct_task_receiver_->Stop();
     task_execution_service_.stop();
   }
+  if (actor_task_arg_prefetcher_ != nullptr) {
+    actor_task_arg_prefetcher_->Stop();
+  }
   if (options_.on_worker_shutdown) {
     // Running in a main thread.
     options_.on_worker_shutdown(GetWorkerID());
@@ -1020,6 +1083,9 @@ void CoreWorker::InternalHeartbeat() {
   // are lost or reordered.
   direct_task_submitter_->ReportWorkerBacklog();
 
+  // Return the idle workers kept for other scheduling keys once their leases expire.
+  direct_task_submitter_->ReturnExpiredIdleLeases();
+
   // Check for unhandled exceptions to raise after a timeout on the driver.
   // Only do this for TTY, since shells like IPython sometimes save references
   // to the result and prevent normal result deletion from handling.
@@ -1881,23 +1947,7 @@ void CoreWorker::BuildCommonTaskSpec(
   auto override_runtime_env_info =
       OverrideTaskOrActorRuntimeEnvInfo(serialized_runtime_env_info);
 
-  bool returns_dynamic = num_returns == -1;
-  if (returns_dynamic) {
-    // This remote function returns 1 ObjectRef, whose value
-    // is a generator of ObjectRefs.
-    num_returns = 1;
-  }
-  // TODO(sang): Remove this and integrate it to
-  // nun_returns == -1 once migrating to streaming
-  // generator.
-  bool is_streaming_generator = num_returns == kStreamingGeneratorReturn;
-  if (is_streaming_generator) {
-    num_returns = 1;
-    // We are using the dynamic return if
-    // the streaming generator is used.
-    returns_dynamic = true;
-  }
-  RAY_CHECK(num_returns >= 0);
+  const auto [returns_dynamic, is_streaming_generator] = ResolveNumReturns(&num_returns);
   builder.SetCommonTaskSpec(
       task_id,
       name,
@@ -1941,46 +1991,39 @@ std::vector<rpc::ObjectReference> CoreWorker::SubmitTask(
   RAY_CHECK(scheduling_strategy.scheduling_strategy_case() !=
             rpc::SchedulingStrategy::SchedulingStrategyCase::SCHEDULING_STRATEGY_NOT_SET);
 
-  TaskSpecBuilder builder;
+  // The fields which are the same for the calls of the function with the same options
+  // come from the template, and only the rest is built for every call.
+  TaskSpecBuilder builder(GetNormalTaskSpecTemplate(
+      function, task_options, scheduling_strategy, serialized_retry_exception_allowlist));
   const auto next_task_index = worker_context_.GetNextTaskIndex();
   const auto task_id = TaskID::ForNormalTask(worker_context_.GetCurrentJobID(),
                                              worker_context_.GetCurrentInternalTaskId(),
                                              next_task_index);
-  auto constrained_resources =
-      AddPlacementGroupConstraint(task_options.resources, scheduling_strategy);
-
-  auto task_name = task_options.name.empty()
-                       ? function.GetFunctionDescriptor()->DefaultTaskName()
-                       : task_options.name;
+  int64_t num_returns = task_options.num_returns;
+  const auto [returns_dynamic, is_streaming_generator] = ResolveNumReturns(&num_returns);
   int64_t depth = worker_context_.GetTaskDepth() + 1;
   // TODO(ekl) offload task building onto a thread pool for performance
-  BuildCommonTaskSpec(builder,
-                      worker_context_.GetCurrentJobID(),
-                      task_id,
-                      task_name,
-                      current_task_id != TaskID::Nil()
-                          ? current_task_id
-                          : worker_context_.GetCurrentTaskID(),
-                      next_task_index,
-                      GetCallerId(),
-                      rpc_address_,
-                      function,
-                      args,
-                      task_options.num_returns,
-                      constrained_resources,
-                      constrained_resources,
-                      debugger_breakpoint,
-                      depth,
-                      task_options.serialized_runtime_env_info,
-                      worker_context_.GetMainThreadOrActorCreationTaskID(),
-                      /*concurrency_group_name*/ "",
-                      /*include_job_config*/ true,
-                      /*generator_backpressure_num_objects*/
-                      task_options.generator_backpressure_num_objects);
-  builder.SetNormalTaskSpec(max_retries,
-                            retry_exceptions,
-                            serialized_retry_exception_allowlist,
-                            scheduling_strategy);
+  builder.SetPerCallTaskSpec(
+      task_id,
+      function.GetLanguage(),
+      worker_context_.GetCurrentJobID(),
+      current_task_id != TaskID::Nil() ? current_task_id
+                                       : worker_context_.GetCurrentTaskID(),
+      next_task_index,
+      GetCallerId(),
+      num_returns,
+      returns_dynamic,
+      is_streaming_generator,
+      task_options.generator_backpressure_num_objects,
+      debugger_breakpoint,
+      depth,
+      worker_context_.GetMainThreadOrActorCreationTaskID(),
+      max_retries,
+      retry_exceptions);
+  for (const auto &arg : args) {
+    builder.AddArg(*arg);
+  }
+  builder.SetTraceContext(NewTaskTraceContext());
   TaskSpecification task_spec = builder.Build();
   RAY_LOG(DEBUG) << "Submitting normal task " << task_spec.DebugString();
   std::vector<rpc::ObjectReference> returned_refs;
@@ -1999,6 +2042,72 @@ std::vector<rpc::ObjectReference> CoreWorker::SubmitTask(
   return returned_refs;
 }
 
+rpc::TraceContext CoreWorker::NewTaskTraceContext() const {
+  // The tasks submitted by a traced task are in its trace.
+  const auto current_task = worker_context_.GetCurrentTask();
+  return tracing::NewSpanContext(current_task != nullptr
+                                     ? current_task->GetTraceContext()
+                                     : rpc::TraceContext::default_instance());
+}
+
+std::shared_ptr<const rpc::TaskSpec> CoreWorker::GetNormalTaskSpecTemplate(
+    const RayFunction &function,
+    const TaskOptions &task_options,
+    const rpc::SchedulingStrategy &scheduling_strategy,
+    const std::string &serialized_retry_exception_allowlist) {
+  // The key covers everything the template is built from. The runtime env of the
+  // current task is included because the runtime env of the task inherits from it.
+  const auto &function_descriptor = function.GetFunctionDescriptor();
+  std::string key;
+  AppendTemplateKeyPart(&key, function_descriptor->GetMessage().SerializeAsString());
+  AppendTemplateKeyPart(&key, task_options.name);
+  // Sort the resources, so that equal options always make the same key.
+  const std::map<std::string, double> sorted_resources(task_options.resources.begin(),
+                                                       task_options.resources.end());
+  for (const auto &[resource, quantity] : sorted_resources) {
+    AppendTemplateKeyPart(&key, resource);
+    absl::StrAppend(&key, quantity, ";");
+  }
+  AppendTemplateKeyPart(&key, task_options.serialized_runtime_env_info);
+  AppendTemplateKeyPart(&key, worker_context_.GetCurrentSerializedRuntimeEnv());
+  AppendTemplateKeyPart(&key, scheduling_strategy.SerializeAsString());
+  AppendTemplateKeyPart(&key, serialized_retry_exception_allowlist);
+  {
+    absl::MutexLock lock(&task_spec_templates_mutex_);
+    auto it = normal_task_spec_templates_.find(key);
+    if (it != normal_task_spec_templates_.end()) {
+      return it->second;
+    }
+  }
+
+  auto constrained_resources =
+      AddPlacementGroupConstraint(task_options.resources, scheduling_strategy);
+  auto task_name = task_options.name.empty() ? function_descriptor->DefaultTaskName()
+                                              : task_options.name;
+  TaskSpecBuilder builder;
+  builder.SetTemplateTaskSpec(
+      task_name,
+      function_descriptor,
+      worker_context_.GetCurrentJobConfig(),
+      rpc_address_,
+      constrained_resources,
+      constrained_resources,
+      OverrideTaskOrActorRuntimeEnvInfo(task_options.serialized_runtime_env_info),
+      serialized_retry_exception_allowlist,
+      scheduling_strategy);
+  auto task_spec_template = std::make_shared<const rpc::TaskSpec>(builder.GetMessage());
+  const auto cache_size = RayConfig::instance().task_spec_template_cache_size();
+  if (cache_size > 0) {
+    absl::MutexLock lock(&task_spec_templates_mutex_);
+    if (normal_task_spec_templates_.size() >= static_cast<size_t>(cache_size)) {
+      // The options rarely vary this much, so start over instead of tracking the usage.
+      normal_task_spec_templates_.clear();
+    }
+    normal_task_spec_templates_.emplace(std::move(key), task_spec_template);
+  }
+  return task_spec_template;
+}
+
 Status CoreWorker::CreateActor(const RayFunction &function,
                                const std::vector<std::unique_ptr<TaskArg>> &args,
                                const ActorCreationOptions &actor_creation_options,
@@ -2104,6 +2213,7 @@ Status CoreWorker::CreateActor(const RayFunction &function,
       std::move(actor_handle), CurrentCallSite(), rpc_address_, is_detached))
       << "Actor " << actor_id << " already exists";
   *return_actor_id = actor_id;
+  builder.SetTraceContext(NewTaskTraceContext());
   TaskSpecification task_spec = builder.Build();
   RAY_LOG(DEBUG) << "Submitting actor creation task " << task_spec.DebugString();
   if (options_.is_local_mode) {
@@ -2314,6 +2424,7 @@ Status CoreWorker::SubmitActorTask(
                                  max_retries,
                                  retry_exceptions,
                                  serialized_retry_exception_allowlist);
+  builder.SetTraceContext(NewTaskTraceContext());
   // Submit task.
   TaskSpecification task_spec = builder.Build();
   RAY_LOG(DEBUG) << "Submitting actor task " << task_spec.DebugString();
@@ -2669,6 +2780,14 @@ Status CoreWorker::ExecuteTask(
   task_queue_length_ -= 1;
   num_executed_tasks_ += 1;
 
+  // The span covers getting the arguments, which may wait for them to be fetched.
+  auto execute_span =
+      tracing::Span::StartChild("CoreWorker.ExecuteTask", task_spec.GetTraceContext());
+  if (execute_span.IsRecording()) {
+    execute_span.SetAttribute("task_id", task_spec.TaskId().Hex());
+    execute_span.SetAttribute("worker_id", worker_context_.GetWorkerID().Hex());
+  }
+
   // Modify the worker's per function counters.
   std::string func_name = task_spec.FunctionDescriptor()->CallString();
   std::string actor_repr_name = "";
@@ -2843,6 +2962,10 @@ Status CoreWorker::ExecuteTask(
   }
   RAY_LOG(DEBUG) << "Finished executing task " << task_spec.TaskId()
                  << ", status=" << status;
+  if (execute_span.IsRecording()) {
+    execute_span.SetAttribute("status", status.ToString());
+    execute_span.End();
+  }
 
   std::ostringstream stream;
   if (status.IsCreationTaskError()) {
@@ -3158,23 +3281,11 @@ Status CoreWorker::GetAndPinArgsForExecutor(const TaskSpecification &task,
           arg_id, ObjectID::Nil(), task.ArgRef(i).owner_address());
       borrowed_ids->push_back(arg_id);
     } else {
-      // A pass-by-value argument.
-      std::shared_ptr<LocalMemoryBuffer> data = nullptr;
-      if (task.ArgDataSize(i)) {
-        data = std::make_shared<LocalMemoryBuffer>(const_cast<uint8_t *>(task.ArgData(i)),
-                                                   task.ArgDataSize(i));
-      }
-      std::shared_ptr<LocalMemoryBuffer> metadata = nullptr;
-      if (task.ArgMetadataSize(i)) {
-        metadata = std::make_shared<LocalMemoryBuffer>(
-            const_cast<uint8_t *>(task.ArgMetadata(i)), task.ArgMetadataSize(i));
-      }
-      // NOTE: this is a workaround to avoid an extra copy for Java workers.
-      // Python workers need this copy to pass test case
-      // test_inline_arg_memory_corruption.
-      bool copy_data = options_.language == Language::PYTHON;
-      args->at(i) =
-          std::make_shared<RayObject>(data, metadata, task.ArgInlinedRefs(i), copy_data);
+      // A pass-by-value argument. The buffers alias the received task spec, which they
+      // keep alive, so the argument isn't copied even if the language frontend holds on
+      // to it after the task finishes (see test_inline_arg_memory_corruption).
+      args->at(i) = std::make_shared<RayObject>(
+          task.ArgDataBuffer(i), task.ArgMetadataBuffer(i), task.ArgInlinedRefs(i));
       arg_refs->at(i).set_object_id(ObjectID::Nil().Binary());
       // The task borrows all ObjectIDs that were serialized in the inlined
       // arguments. The task will receive references to these IDs, so it is
@@ -3195,10 +3306,15 @@ Status CoreWorker::GetAndPinArgsForExecutor(const TaskSpecification &task,
   // Fetch by-reference arguments directly from the plasma store.
   bool got_exception = false;
   absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> result_map;
+  bool all_args_prefetched = false;
+  if (actor_task_arg_prefetcher_ != nullptr && task.IsActorTask()) {
+    actor_task_arg_prefetcher_->Take(&by_ref_ids, &result_map);
+    all_args_prefetched = !result_map.empty() && by_ref_ids.empty();
+  }
   if (options_.is_local_mode) {
     RAY_RETURN_NOT_OK(
         memory_store_->Get(by_ref_ids, -1, worker_context_, &result_map, &got_exception));
-  } else {
+  } else if (!all_args_prefetched) {
     RAY_RETURN_NOT_OK(
         plasma_store_provider_->Get(by_ref_ids,
                                     -1,
@@ -3276,6 +3392,70 @@ void CoreWorker::HandlePushTask(rpc::PushTaskRequest request,
   }
 }
 
+void CoreWorker::HandlePushTaskBatch(rpc::PushTaskBatchRequest request,
+                                     rpc::PushTaskBatchReply *reply,
+                                     rpc::SendReplyCallback send_reply_callback) {
+  if (HandleWrongRecipient(WorkerID::FromBinary(request.intended_worker_id()),
+                           send_reply_callback)) {
+    return;
+  }
+  RAY_LOG(DEBUG) << "Received a batch of " << request.requests_size() << " tasks";
+  // Every task is replied as soon as it finishes, since a task may depend on the
+  // returns of an earlier task of the same batch.
+  const auto caller_id = WorkerID::FromBinary(request.caller_worker_id());
+  for (auto &task_request : *request.mutable_requests()) {
+    const auto task_id = TaskID::FromBinary(task_request.task_spec().task_id());
+    auto *task_reply = normal_task_reply_coalescer_.AddTask(caller_id, task_id);
+    const int template_index = task_request.task_spec_template_index();
+    if (template_index < 0 || template_index > request.task_spec_templates_size()) {
+      RAY_LOG(WARNING) << "Task " << task_id << " references task spec template "
+                       << template_index << ", but the batch only has "
+                       << request.task_spec_templates_size() << " templates.";
+      normal_task_reply_coalescer_.ReplyTask(
+          caller_id,
+          task_id,
+          Status::Invalid("The task spec template of the task is missing."));
+      continue;
+    }
+    if (template_index > 0) {
+      ApplyTaskSpecTemplate(request.task_spec_templates(template_index - 1),
+                            task_request.mutable_task_spec());
+    }
+    HandlePushTask(
+        std::move(task_request),
+        task_reply,
+        [this, caller_id, task_id](
+            Status status, std::function<void()>, std::function<void()>) {
+          normal_task_reply_coalescer_.ReplyTask(caller_id, task_id, status);
+        });
+  }
+  normal_task_reply_coalescer_.WaitForReplies(
+      caller_id, reply->mutable_task_replies(), std::move(send_reply_callback));
+}
+
+void CoreWorker::HandlePushActorTaskBatch(rpc::PushActorTaskBatchRequest request,
+                                          rpc::PushActorTaskBatchReply *reply,
+                                          rpc::SendReplyCallback send_reply_callback) {
+  if (HandleWrongRecipient(WorkerID::FromBinary(request.intended_worker_id()),
+                           send_reply_callback)) {
+    return;
+  }
+  const auto caller_id = WorkerID::FromBinary(request.caller_worker_id());
+  for (auto &task_request : *request.mutable_requests()) {
+    const auto task_id = TaskID::FromBinary(task_request.task_spec().task_id());
+    auto *task_reply = actor_task_reply_coalescer_.AddTask(caller_id, task_id);
+    HandlePushTask(
+        std::move(task_request),
+        task_reply,
+        [this, caller_id, task_id](
+            Status status, std::function<void()>, std::function<void()>) {
+          actor_task_reply_coalescer_.ReplyTask(caller_id, task_id, status);
+        });
+  }
+  actor_task_reply_coalescer_.WaitForReplies(
+      caller_id, reply->mutable_task_replies(), std::move(send_reply_callback));
+}
+
 void CoreWorker::HandleDirectActorCallArgWaitComplete(
     rpc::DirectActorCallArgWaitCompleteRequest request,
     rpc::DirectActorCallArgWaitCompleteReply *reply,
@@ -3285,6 +3465,10 @@ void CoreWorker::HandleDirectActorCallArgWaitComplete(
     return;
   }
 
+  // Start to get the arguments here, since the task execution event loop may be busy
+  // executing the earlier tasks.
+  task_argument_waiter_->PrefetchDependencies(request.tag());
+
   // Post on the task execution event loop since this may trigger the
   // execution of a task that is now ready to run.
   task_execution_service_.post(
@@ -4444,5 +4628,80 @@ void ClusterSizeBasedLeaseRequestRateLimiter::OnNodeChanges(
   RAY_LOG_EVERY_MS(INFO, 60000) << "Number of alive nodes:" << num_alive_nodes_.load();
 }
 
+AdaptiveLeaseRequestRateLimiter::AdaptiveLeaseRequestRateLimiter(
+    size_t min_concurrent_lease_limit,
+    size_t max_limit_per_node,
+    int64_t target_latency_ms)
+    : ClusterSizeBasedLeaseRequestRateLimiter(min_concurrent_lease_limit),
+      max_limit_per_node_(max_limit_per_node),
+      target_latency_ms_(target_latency_ms) {}
+
+size_t
+AdaptiveLeaseRequestRateLimiter::GetMaxPendingLeaseRequestsPerSchedulingCategory() {
+  absl::MutexLock lock(&mu_);
+  ClampLimit();
+  return static_cast<size_t>(limit_);
+}
+
+void AdaptiveLeaseRequestRateLimiter::OnLeaseReply(LeaseOutcome outcome,
+                                                   int64_t latency_ms) {
+  std::string outcome_name;
+  size_t limit = 0;
+  {
+    absl::MutexLock lock(&mu_);
+    ClampLimit();
+    replies_since_decrease_++;
+    switch (outcome) {
+    case LeaseOutcome::kGranted:
+      outcome_name = "Granted";
+      if (latency_ms > target_latency_ms_) {
+        DecreaseLimit();
+      } else {
+        limit_ += slow_start_ ? 1 : 1 / limit_;
+      }
+      break;
+    case LeaseOutcome::kSpilledBack:
+      // The lease is retried at another node, which replies with the actual outcome.
+      outcome_name = "SpilledBack";
+      break;
+    case LeaseOutcome::kRejected:
+      outcome_name = "Rejected";
+      DecreaseLimit();
+      break;
+    case LeaseOutcome::kCanceled:
+      // Canceled by the worker itself, or because the task can't be scheduled at all.
+      outcome_name = "Canceled";
+      break;
+    case LeaseOutcome::kFailed:
+      outcome_name = "Failed";
+      DecreaseLimit();
+      break;
+    }
+    ClampLimit();
+    limit = static_cast<size_t>(limit_);
+  }
+  ray::stats::STATS_lease_request_rate_limit.Record(limit);
+  ray::stats::STATS_lease_request_replies_total.Record(1, outcome_name);
+  ray::stats::STATS_lease_request_latency_ms.Record(latency_ms, outcome_name);
+}
+
+void AdaptiveLeaseRequestRateLimiter::ClampLimit() {
+  const size_t num_alive_nodes = num_alive_nodes_.load();
+  const double min_limit = std::max<size_t>(kMinConcurrentLeaseCap, num_alive_nodes);
+  const double max_limit =
+      std::max<double>(min_limit, max_limit_per_node_ * num_alive_nodes);
+  limit_ = std::min(std::max(limit_, min_limit), max_limit);
+}
+
+void AdaptiveLeaseRequestRateLimiter::DecreaseLimit() {
+  if (!slow_start_ && replies_since_decrease_ < limit_) {
+    return;
+  }
+  slow_start_ = false;
+  replies_since_decrease_ = 0;
+  limit_ /= 2;
+  RAY_LOG(DEBUG) << "Decreased the lease request rate limit to " << limit_;
+}
+
 }  // namespace core
 }  // namespace ray
@@ -17,6 +17,7 @@
 #include "absl/base/optimization.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
+#include "ray/common/asio/io_context_watchdog.h"
 #include "ray/common/asio/periodical_runner.h"
 #include "ray/common/buffer.h"
 #include "ray/common/placement_group.h"
@@ -35,8 +36,10 @@
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/store_provider/plasma_store_provider.h"
 #include "ray/core_worker/task_event_buffer.h"
+#include "ray/core_worker/transport/actor_task_arg_prefetcher.h"
 #include "ray/core_worker/transport/direct_actor_transport.h"
 #include "ray/core_worker/transport/direct_task_transport.h"
+#include "ray/core_worker/transport/task_reply_coalescer.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/pubsub/publisher.h"
 #include "ray/pubsub/subscriber.h"
@@ -1182,6 +1185,16 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
                       rpc::PushTaskReply *reply,
                       rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Implements gRPC server handler.
+  void HandlePushTaskBatch(rpc::PushTaskBatchRequest request,
+                           rpc::PushTaskBatchReply *reply,
+                           rpc::SendReplyCallback send_reply_callback) override;
+
+  /// Implements gRPC server handler.
+  void HandlePushActorTaskBatch(rpc::PushActorTaskBatchRequest request,
+                                rpc::PushActorTaskBatchReply *reply,
+                                rpc::SendReplyCallback send_reply_callback) override;
+
   /// Implements gRPC server handler.
   void HandleDirectActorCallArgWaitComplete(
       rpc::DirectActorCallArgWaitCompleteRequest request,
@@ -1406,6 +1419,20 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
       const std::string &concurrency_group_name = "",
       bool include_job_config = false,
       int64_t generator_backpressure_num_objects = -1);
+
+  /// Get the trace context of a task submitted by the current task, see
+  /// tracing::NewSpanContext.
+  rpc::TraceContext NewTaskTraceContext() const;
+
+  /// Get the template of the normal tasks submitted with the given function and
+  /// options. The templates are cached, so the fields shared by the calls of a remote
+  /// function with the same options are only built once.
+  std::shared_ptr<const rpc::TaskSpec> GetNormalTaskSpecTemplate(
+      const RayFunction &function,
+      const TaskOptions &task_options,
+      const rpc::SchedulingStrategy &scheduling_strategy,
+      const std::string &serialized_retry_exception_allowlist);
+
   void SetCurrentTaskId(const TaskID &task_id,
                         uint64_t attempt_number,
                         const std::string &task_name);
@@ -1698,6 +1725,9 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   /// The runner to run function periodically.
   PeriodicalRunner periodical_runner_;
 
+  /// The watchdog of io_service_, or null if it's disabled, which is the default.
+  std::unique_ptr<IoContextWatchdog> io_context_watchdog_;
+
   /// RPC server used to receive tasks to execute.
   std::unique_ptr<rpc::GrpcServer> core_worker_server_;
 
@@ -1808,6 +1838,10 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   /// Common rpc service for all worker modules.
   rpc::CoreWorkerGrpcService grpc_service_;
 
+  /// Prefetches the plasma arguments of the queued actor tasks. Null if disabled, see
+  /// actor_task_args_prefetch_max_tasks.
+  std::unique_ptr<ActorTaskArgPrefetcher> actor_task_arg_prefetcher_;
+
   /// Used to notify the task receiver when the arguments of a queued
   /// actor task are ready.
   std::shared_ptr<DependencyWaiterImpl> task_argument_waiter_;
@@ -1815,6 +1849,20 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   // Interface that receives tasks from direct actor calls.
   std::unique_ptr<CoreWorkerDirectTaskReceiver> direct_task_receiver_;
 
+  /// Returns the replies of the actor tasks pushed in batches.
+  TaskReplyCoalescer actor_task_reply_coalescer_;
+
+  /// Returns the replies of the normal tasks pushed in batches.
+  TaskReplyCoalescer normal_task_reply_coalescer_;
+
+  /// Protects normal_task_spec_templates_.
+  absl::Mutex task_spec_templates_mutex_;
+
+  /// The cached templates of the normal tasks, keyed by the function and the options
+  /// they're built from. See GetNormalTaskSpecTemplate.
+  absl::flat_hash_map<std::string, std::shared_ptr<const rpc::TaskSpec>>
+      normal_task_spec_templates_ ABSL_GUARDED_BY(task_spec_templates_mutex_);
+
   /// Event loop where tasks are processed.
   /// task_execution_service_ should be destructed first to avoid
   /// issues like https://github.com/ray-project/ray/issues/18857
@@ -1878,9 +1926,43 @@ class ClusterSizeBasedLeaseRequestRateLimiter : public LeaseRequestRateLimiter {
   size_t GetMaxPendingLeaseRequestsPerSchedulingCategory() override;
   void OnNodeChanges(const rpc::GcsNodeInfo &data);
 
- private:
+ protected:
   const size_t kMinConcurrentLeaseCap;
   std::atomic<size_t> num_alive_nodes_;
 };
+
+// Lease request rate-limiter which adapts to the lease replies, like the congestion
+// control of TCP. The limit stays between the cluster size based limit and
+// max_limit_per_node times the number of alive nodes. It grows while the leases are
+// granted within the target latency: by 1 per grant until the first congestion, and by
+// 1 per limit's worth of grants after. It's halved when a lease is rejected, failed or
+// granted slower than the target latency, at most once per limit's worth of replies.
+class AdaptiveLeaseRequestRateLimiter : public ClusterSizeBasedLeaseRequestRateLimiter {
+ public:
+  AdaptiveLeaseRequestRateLimiter(size_t min_concurrent_lease_limit,
+                                  size_t max_limit_per_node,
+                                  int64_t target_latency_ms);
+  size_t GetMaxPendingLeaseRequestsPerSchedulingCategory() override;
+  void OnLeaseReply(LeaseOutcome outcome, int64_t latency_ms) override;
+
+ private:
+  /// Keep the limit within its bounds, which change with the cluster size.
+  void ClampLimit() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Halve the limit, unless it has been halved within the last limit's worth of
+  /// replies, which were sent before the previous decrease took effect.
+  void DecreaseLimit() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const size_t max_limit_per_node_;
+  const int64_t target_latency_ms_;
+
+  absl::Mutex mu_;
+  /// The current limit. It's fractional so that it can grow by less than 1 per grant.
+  double limit_ ABSL_GUARDED_BY(mu_) = 0;
+  /// Whether the limit hasn't been decreased yet, in which case it grows faster.
+  bool slow_start_ ABSL_GUARDED_BY(mu_) = true;
+  /// The number of replies since the limit was last decreased.
+  int64_t replies_since_decrease_ ABSL_GUARDED_BY(mu_) = 0;
+};
 }  // namespace core
 }  // namespace ray
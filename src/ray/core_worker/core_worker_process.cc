@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "ray/common/tracing.h"
 #include "ray/core_worker/core_worker.h"
 #include "ray/stats/stats.h"
 #include "ray/util/event.h"
@@ -126,6 +127,7 @@ CoreWorkerProcessImpl::CoreWorkerProcessImpl(const CoreWorkerOptions &options)
 
   // We need init stats before using it/spawning threads.
   stats::Init(global_tags, options_.metrics_agent_port, worker_id_);
+  tracing::Init("core_worker", options_.log_dir);
 
   {
     // Initialize global worker instance.
@@ -148,6 +150,7 @@ CoreWorkerProcessImpl::~CoreWorkerProcessImpl() {
   RAY_LOG(INFO) << "Destructing CoreWorkerProcessImpl. pid: " << getpid();
   // Shutdown stats module if worker process exits.
   stats::Shutdown();
+  tracing::Shutdown();
   if (options_.enable_logging) {
     RayLog::ShutDownRayLog();
   }
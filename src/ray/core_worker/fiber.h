@@ -16,6 +16,8 @@
 
 #include <boost/fiber/all.hpp>
 #include <chrono>
+#include <deque>
+#include <functional>
 
 #include "ray/util/logging.h"
 #include "ray/util/macros.h"
@@ -55,40 +57,12 @@ class Event {
 using FiberEvent = Event<boost::fibers::mutex, boost::fibers::condition_variable>;
 using StdEvent = Event<std::mutex, std::condition_variable>;
 
-/// Used by async actor mode. The FiberRateLimiter is a barrier that
-/// allows at most num fibers running at once. It implements the
-/// semaphore data structure.
-class FiberRateLimiter {
- public:
-  FiberRateLimiter(int num) : num_(num) {}
-
-  // Enter the semaphore. Wait for the value to be > 0 and decrement the value.
-  void Acquire() {
-    std::unique_lock<boost::fibers::mutex> lock(mutex_);
-    cond_.wait(lock, [this]() { return num_ > 0; });
-    num_ -= 1;
-  }
-
-  // Exit the semaphore. Increment the value and notify other waiter.
-  void Release() {
-    {
-      std::unique_lock<boost::fibers::mutex> lock(mutex_);
-      num_ += 1;
-    }
-    // NOTE(simon): This not does guarantee to wake up the first queued fiber.
-    // This could be a problem for certain workloads because there is no guarantee
-    // on task ordering.
-    cond_.notify_one();
-  }
-
- private:
-  boost::fibers::condition_variable cond_;
-  boost::fibers::mutex mutex_;
-  int num_ = 1;
-};
-
-using FiberChannel = boost::fibers::unbuffered_channel<std::function<void()>>;
-
+/// Runs the tasks of an async actor on boost fibers, on a dedicated thread, with at
+/// most max_concurrency of them running at once.
+///
+/// The tasks are queued until they can run, and a fiber is only started for a task
+/// then. So the queued tasks don't hold fiber stacks, enqueueing a task doesn't wait
+/// for the fiber thread, and the tasks start in the order they're enqueued.
 class FiberState {
  public:
   static bool NeedDefaultExecutor(int32_t max_concurrency_in_default_group) {
@@ -98,59 +72,71 @@ class FiberState {
   }
 
   FiberState(int max_concurrency)
-      : rate_limiter_(max_concurrency),
+      : max_concurrency_(max_concurrency),
         fiber_stopped_event_(std::make_shared<StdEvent>()) {
     std::shared_ptr<StdEvent> fiber_stopped_event = fiber_stopped_event_;
-    fiber_runner_thread_ =
-        std::thread(
-            [&, fiber_stopped_event]() {
-              while (!channel_.is_closed()) {
-                std::function<void()> func;
-                auto op_status = channel_.pop(func);
-                if (op_status == boost::fibers::channel_op_status::success) {
-                  boost::fibers::fiber(boost::fibers::launch::dispatch, func).detach();
-                } else if (op_status == boost::fibers::channel_op_status::closed) {
-                  // The channel was closed. We will just exit the loop and finish
-                  // cleanup.
-                  break;
-                } else {
-                  RAY_LOG(ERROR)
-                      << "Async actor fiber channel returned unexpected error code, "
-                      << "shutting down the worker thread. Please submit a github issue "
-                      << "at https://github.com/ray-project/ray";
-                  return;
-                }
-              }
-
-              // Boost fiber thread cannot be terminated and joined
-              // if there are still running detached fibers.
-              // When we exit async actor, we stop running coroutines
-              // which means the corresponding waiting boost fibers
-              // will never be resumed by done callbacks of those coroutines.
-              // As a result, those fibers will never exit and the fiber
-              // runner thread cannot be joined.
-              // The hack here is that we rely on the process exit to clean up
-              // the fiber runner thread. What we guarantee here is that
-              // no fibers can run after this point as we don't yield here.
-              // This makes sure this thread won't accidentally
-              // access being destructed core worker.
-              fiber_stopped_event->Notify();
-              while (true) {
-                std::this_thread::sleep_for(std::chrono::hours(1));
-              }
-            });
+    fiber_runner_thread_ = std::thread([&, fiber_stopped_event]() {
+      while (true) {
+        std::function<void()> func;
+        {
+          std::unique_lock<boost::fibers::mutex> lock(mutex_);
+          cond_.wait(lock, [this]() {
+            return stopped_ || (!queue_.empty() && num_running_ < max_concurrency_);
+          });
+          if (stopped_) {
+            break;
+          }
+          func = std::move(queue_.front());
+          queue_.pop_front();
+          num_running_++;
+        }
+        boost::fibers::fiber(boost::fibers::launch::dispatch,
+                             [this, func = std::move(func)]() {
+                               func();
+                               {
+                                 std::unique_lock<boost::fibers::mutex> lock(mutex_);
+                                 num_running_--;
+                               }
+                               cond_.notify_one();
+                             })
+            .detach();
+      }
+
+      // Boost fiber thread cannot be terminated and joined
+      // if there are still running detached fibers.
+      // When we exit async actor, we stop running coroutines
+      // which means the corresponding waiting boost fibers
+      // will never be resumed by done callbacks of those coroutines.
+      // As a result, those fibers will never exit and the fiber
+      // runner thread cannot be joined.
+      // The hack here is that we rely on the process exit to clean up
+      // the fiber runner thread. What we guarantee here is that
+      // no fibers can run after this point as we don't yield here.
+      // This makes sure this thread won't accidentally
+      // access being destructed core worker.
+      fiber_stopped_event->Notify();
+      while (true) {
+        std::this_thread::sleep_for(std::chrono::hours(1));
+      }
+    });
   }
 
   void EnqueueFiber(std::function<void()> &&callback) {
-    auto op_status = channel_.push([this, callback]() {
-      rate_limiter_.Acquire();
-      callback();
-      rate_limiter_.Release();
-    });
-    RAY_CHECK(op_status == boost::fibers::channel_op_status::success);
+    {
+      std::unique_lock<boost::fibers::mutex> lock(mutex_);
+      RAY_CHECK(!stopped_) << "Tasks can't be enqueued after the fibers are stopped.";
+      queue_.push_back(std::move(callback));
+    }
+    cond_.notify_one();
   }
 
-  void Stop() { channel_.close(); }
+  void Stop() {
+    {
+      std::unique_lock<boost::fibers::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    cond_.notify_one();
+  }
 
   void Join() {
     fiber_stopped_event_->Wait();
@@ -158,12 +144,19 @@ class FiberState {
   }
 
  private:
-  /// The fiber channel used to send task between the submitter thread
-  /// (main direct_actor_trasnport thread) and the fiber_runner_thread_ (defined below)
-  FiberChannel channel_;
-  /// The fiber semaphore used to limit the number of concurrent fibers
-  /// running at once.
-  FiberRateLimiter rate_limiter_;
+  /// The maximum number of fibers running at once.
+  const int max_concurrency_;
+  /// Protects the fields below. The fiber mutex and condition variable can be used
+  /// from the submitter thread (main direct_actor_trasnport thread) too.
+  boost::fibers::mutex mutex_;
+  /// Notified when a task is enqueued, a fiber finishes or the fibers are stopped.
+  boost::fibers::condition_variable cond_;
+  /// The tasks waiting for a fiber.
+  std::deque<std::function<void()>> queue_;
+  /// The number of running fibers.
+  int num_running_ = 0;
+  /// Whether Stop has been called. No fiber is started after it.
+  bool stopped_ = false;
   /// The fiber event used to notify that all worker fibers are stopped running.
   /// Since we don't join the fiber_runner_thread, it's possible that the
   /// `fiber_runner_thread_` still accesses the `fiber_stopped_event_` after it's
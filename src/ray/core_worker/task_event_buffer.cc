@@ -130,8 +130,7 @@ void TaskProfileEvent::ToRpcTaskEvents(rpc::TaskEvents *rpc_task_events) {
 TaskEventBufferImpl::TaskEventBufferImpl(std::unique_ptr<gcs::GcsClient> gcs_client)
     : work_guard_(boost::asio::make_work_guard(io_service_)),
       periodical_runner_(io_service_),
-      gcs_client_(std::move(gcs_client)),
-      status_events_() {}
+      gcs_client_(std::move(gcs_client)) {}
 
 TaskEventBufferImpl::~TaskEventBufferImpl() { Stop(); }
 
@@ -141,8 +140,11 @@ Status TaskEventBufferImpl::Start(bool auto_flush) {
   RAY_CHECK(report_interval_ms > 0)
       << "RAY_task_events_report_interval_ms should be > 0 to use TaskEventBuffer.";
 
-  status_events_.set_capacity(
+  status_events_ = std::make_unique<LockFreeRingBuffer<std::unique_ptr<TaskEvent>>>(
       RayConfig::instance().task_events_max_num_status_events_buffer_on_worker());
+  new_profile_events_ =
+      std::make_unique<LockFreeRingBuffer<std::unique_ptr<TaskEvent>>>(
+          RayConfig::instance().task_events_max_num_profile_events_buffer_on_worker());
 
   // Reporting to GCS, set up gcs client and and events flushing.
   auto status = gcs_client_->Connect(io_service_);
@@ -210,10 +212,19 @@ bool TaskEventBufferImpl::Enabled() const { return enabled_; }
 void TaskEventBufferImpl::GetTaskStatusEventsToSend(
     std::vector<std::unique_ptr<TaskEvent>> *status_events_to_send,
     absl::flat_hash_set<TaskAttempt> *dropped_task_attempts_to_send) {
+  // Get the events data to send.
+  const size_t num_batch_events =
+      static_cast<size_t>(RayConfig::instance().task_events_send_batch_size());
+  std::unique_ptr<TaskEvent> status_event;
+  while (status_events_to_send->size() < num_batch_events &&
+         status_events_->TryPop(&status_event)) {
+    status_events_to_send->push_back(std::move(status_event));
+  }
+
   absl::MutexLock lock(&mutex_);
 
-  // No data to send.
-  if (status_events_.empty() && dropped_task_attempts_unreported_.empty()) {
+  // No data loss to report.
+  if (dropped_task_attempts_unreported_.empty()) {
     return;
   }
 
@@ -232,27 +243,34 @@ void TaskEventBufferImpl::GetTaskStatusEventsToSend(
     dropped_task_attempts_unreported_.erase(itr);
     num_dropped_task_attempts_to_send++;
   }
-
-  // Get the events data to send.
-  size_t num_to_send =
-      std::min(static_cast<size_t>(RayConfig::instance().task_events_send_batch_size()),
-               static_cast<size_t>(status_events_.size()));
-  status_events_to_send->insert(
-      status_events_to_send->end(),
-      std::make_move_iterator(status_events_.begin()),
-      std::make_move_iterator(status_events_.begin() + num_to_send));
-  status_events_.erase(status_events_.begin(), status_events_.begin() + num_to_send);
-
-  stats_counter_.Decrement(TaskEventBufferCounter::kNumTaskStatusEventsStored,
-                           status_events_to_send->size());
   stats_counter_.Decrement(TaskEventBufferCounter::kNumDroppedTaskAttemptsStored,
                            num_dropped_task_attempts_to_send);
+
+  // The task attempts which are still tracked as dropped will be reported in the next
+  // flushes, so their events are dropped now. The events of the task attempts reported
+  // in this flush are dropped when the data is created.
+  size_t num_kept = 0;
+  for (auto &event : *status_events_to_send) {
+    if (dropped_task_attempts_unreported_.count(event->GetTaskAttempt())) {
+      stats_counter_.Increment(
+          TaskEventBufferCounter::kNumTaskStatusEventDroppedSinceLastFlush);
+      continue;
+    }
+    (*status_events_to_send)[num_kept++] = std::move(event);
+  }
+  status_events_to_send->resize(num_kept);
 }
 
 void TaskEventBufferImpl::GetTaskProfileEventsToSend(
     std::vector<std::unique_ptr<TaskEvent>> *profile_events_to_send) {
   absl::MutexLock lock(&profile_mutex_);
 
+  // Aggregate the profile events added since the last flush.
+  std::unique_ptr<TaskEvent> profile_event;
+  while (new_profile_events_->TryPop(&profile_event)) {
+    AggregateProfileEvent(std::move(profile_event));
+  }
+
   size_t batch_size =
       static_cast<size_t>(RayConfig::instance().task_events_send_batch_size());
   while (!profile_events_.empty() && profile_events_to_send->size() < batch_size) {
@@ -340,10 +358,8 @@ void TaskEventBufferImpl::FlushEvents(bool forced) {
         << "GCS hasn't replied to the previous flush events call (likely "
            "overloaded). "
            "Skipping reporting task state events and retry later."
-        << "[cur_status_events_size="
-        << stats_counter_.Get(TaskEventBufferCounter::kNumTaskStatusEventsStored)
-        << "][cur_profile_events_size="
-        << stats_counter_.Get(TaskEventBufferCounter::kNumTaskProfileEventsStored) << "]";
+        << "[cur_status_events_size=" << NumStatusEventsStored()
+        << "][cur_profile_events_size=" << NumProfileEventsStored() << "]";
     return;
   }
 
@@ -432,46 +448,56 @@ void TaskEventBufferImpl::AddTaskEvent(std::unique_ptr<TaskEvent> task_event) {
 }
 
 void TaskEventBufferImpl::AddTaskStatusEvent(std::unique_ptr<TaskEvent> status_event) {
-  absl::MutexLock lock(&mutex_);
   if (!enabled_) {
     return;
   }
 
-  if (dropped_task_attempts_unreported_.count(status_event->GetTaskAttempt())) {
-    // This task attempt has been dropped before, so we drop this event.
-    stats_counter_.Increment(
-        TaskEventBufferCounter::kNumTaskStatusEventDroppedSinceLastFlush);
-    return;
+  while (!status_events_->TryPush(std::move(status_event))) {
+    // The buffer is full, evict the oldest event. The pop might race with a flush,
+    // which frees some space anyway.
+    std::unique_ptr<TaskEvent> to_evict;
+    if (status_events_->TryPop(&to_evict)) {
+      RecordStatusEventDropped(*to_evict);
+    }
   }
+}
 
-  if (status_events_.full()) {
-    const auto &to_evict = status_events_.front();
-    auto inserted = dropped_task_attempts_unreported_.insert(to_evict->GetTaskAttempt());
-    stats_counter_.Increment(
-        TaskEventBufferCounter::kNumTaskStatusEventDroppedSinceLastFlush);
+void TaskEventBufferImpl::RecordStatusEventDropped(const TaskEvent &status_event) {
+  absl::MutexLock lock(&mutex_);
+  auto inserted = dropped_task_attempts_unreported_.insert(status_event.GetTaskAttempt());
+  stats_counter_.Increment(
+      TaskEventBufferCounter::kNumTaskStatusEventDroppedSinceLastFlush);
 
-    RAY_LOG_EVERY_N(WARNING, 100000)
-        << "Dropping task status events for task: "
-        << status_event->GetTaskAttempt().first
-        << ", set a higher value for "
-           "RAY_task_events_max_num_status_events_buffer_on_worker("
-        << RayConfig::instance().task_events_max_num_status_events_buffer_on_worker()
-        << ") to avoid this.";
-
-    if (inserted.second) {
-      stats_counter_.Increment(TaskEventBufferCounter::kNumDroppedTaskAttemptsStored);
-    }
-  } else {
-    stats_counter_.Increment(TaskEventBufferCounter::kNumTaskStatusEventsStored);
+  RAY_LOG_EVERY_N(WARNING, 100000)
+      << "Dropping task status events for task: " << status_event.GetTaskAttempt().first
+      << ", set a higher value for "
+         "RAY_task_events_max_num_status_events_buffer_on_worker("
+      << RayConfig::instance().task_events_max_num_status_events_buffer_on_worker()
+      << ") to avoid this.";
+
+  if (inserted.second) {
+    stats_counter_.Increment(TaskEventBufferCounter::kNumDroppedTaskAttemptsStored);
   }
-  status_events_.push_back(std::move(status_event));
 }
 
 void TaskEventBufferImpl::AddTaskProfileEvent(std::unique_ptr<TaskEvent> profile_event) {
-  absl::MutexLock lock(&profile_mutex_);
   if (!enabled_) {
     return;
   }
+
+  if (!new_profile_events_->TryPush(std::move(profile_event))) {
+    // Data loss. We are dropping the newly reported profile event.
+    stats_counter_.Increment(
+        TaskEventBufferCounter::kNumTaskProfileEventDroppedSinceLastFlush);
+    RAY_LOG_EVERY_N(WARNING, 100000)
+        << "Dropping profiling events, set a higher value for "
+           "RAY_task_events_max_num_profile_events_buffer_on_worker ("
+        << new_profile_events_->Capacity() << ") to avoid this.";
+  }
+}
+
+void TaskEventBufferImpl::AggregateProfileEvent(
+    std::unique_ptr<TaskEvent> profile_event) {
   auto profile_events_itr = profile_events_.find(profile_event->GetTaskAttempt());
   if (profile_events_itr == profile_events_.end()) {
     auto inserted = profile_events_.insert(
@@ -504,6 +530,9 @@ void TaskEventBufferImpl::AddTaskProfileEvent(std::unique_ptr<TaskEvent> profile
         << max_num_profile_event_per_task
         << "), or RAY_task_events_max_num_profile_events_buffer_on_worker ("
         << max_profile_events_stored << ") to avoid this.";
+    if (profile_events_itr->second.empty()) {
+      profile_events_.erase(profile_events_itr);
+    }
     return;
   }
 
@@ -525,9 +554,8 @@ const std::string TaskEventBufferImpl::DebugString() {
   ss << "\nOther Stats:"
      << "\n\tgrpc_in_progress:" << grpc_in_progress_
      << "\n\tcurrent number of task status events in buffer: "
-     << stats[TaskEventBufferCounter::kNumTaskStatusEventsStored]
-     << "\n\tcurrent number of profile events in buffer: "
-     << stats[TaskEventBufferCounter::kNumTaskProfileEventsStored]
+     << NumStatusEventsStored()
+     << "\n\tcurrent number of profile events in buffer: " << NumProfileEventsStored()
      << "\n\tcurrent number of dropped task attempts tracked: "
      << stats[TaskEventBufferCounter::kNumDroppedTaskAttemptsStored]
      << "\n\ttotal task events sent: "
@@ -14,7 +14,6 @@
 
 #pragma once
 
-#include <boost/circular_buffer.hpp>
 #include <memory>
 #include <string>
 
@@ -27,6 +26,7 @@
 #include "ray/common/task/task_spec.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/util/counter_map.h"
+#include "ray/util/lock_free_ring_buffer.h"
 #include "src/ray/protobuf/gcs.pb.h"
 
 namespace ray {
@@ -175,7 +175,6 @@ enum TaskEventBufferCounter {
   kNumTaskProfileEventDroppedSinceLastFlush,
   kNumTaskStatusEventDroppedSinceLastFlush,
   kNumTaskProfileEventsStored,
-  kNumTaskStatusEventsStored,
   kNumDroppedTaskAttemptsStored,
   kTotalNumTaskProfileEventDropped,
   kTotalNumTaskStatusEventDropped,
@@ -256,6 +255,11 @@ class TaskEventBuffer {
 /// The buffer has its own io_context and io_thread, that's isolated from other
 /// components.
 ///
+/// The task events are added from the threads executing and submitting tasks, so they
+/// are pushed to lock-free ring buffers, and adding an event only takes a lock when an
+/// event is dropped. The events are popped when flushing, which aggregates the profile
+/// events by task attempt and enforces the limits on them.
+///
 /// This class is thread-safe.
 class TaskEventBufferImpl : public TaskEventBuffer {
  public:
@@ -280,17 +284,31 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   const std::string DebugString() override;
 
  private:
-  /// Add a task status event to be reported.
+  /// Add a task status event to be reported. If the buffer is full, the oldest status
+  /// event is evicted, and its task attempt is reported as dropped.
   ///
   /// \param status_event Task status event.
   void AddTaskStatusEvent(std::unique_ptr<TaskEvent> status_event)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
-  /// Add a task profile event to be reported.
+  /// Record a task status event evicted from the buffer.
+  ///
+  /// \param status_event Task status event evicted.
+  void RecordStatusEventDropped(const TaskEvent &status_event)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Add a task profile event to be reported. If the buffer is full, the event is
+  /// dropped.
   ///
   /// \param profile_event Task profile event.
-  void AddTaskProfileEvent(std::unique_ptr<TaskEvent> profile_event)
-      ABSL_LOCKS_EXCLUDED(profile_mutex_);
+  void AddTaskProfileEvent(std::unique_ptr<TaskEvent> profile_event);
+
+  /// Aggregate a task profile event by its task attempt, or drop it if the task attempt
+  /// or the buffer has too many profile events.
+  ///
+  /// \param profile_event Task profile event.
+  void AggregateProfileEvent(std::unique_ptr<TaskEvent> profile_event)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(profile_mutex_);
 
   /// Get data related to task status events to be send to GCS.
   ///
@@ -304,6 +322,9 @@ class TaskEventBufferImpl : public TaskEventBuffer {
 
   /// Get data related to task profile events to be send to GCS.
   ///
+  /// The profile events added since the last call are first aggregated by task attempt,
+  /// and the ones over the limits are dropped.
+  ///
   /// \param[out] profile_events_to_send Task profile events to be sent.
   void GetTaskProfileEventsToSend(
       std::vector<std::unique_ptr<TaskEvent>> *profile_events_to_send)
@@ -324,10 +345,20 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   /// Reset the counters during flushing data to GCS.
   void ResetCountersForFlush();
 
+  /// The number of task status events buffered.
+  size_t NumStatusEventsStored() const {
+    return status_events_ == nullptr ? 0 : status_events_->Size();
+  }
+
+  /// The number of task profile events buffered, aggregated or not.
+  size_t NumProfileEventsStored() {
+    return (new_profile_events_ == nullptr ? 0 : new_profile_events_->Size()) +
+           stats_counter_.Get(TaskEventBufferCounter::kNumTaskProfileEventsStored);
+  }
+
   /// Test only functions.
   size_t GetNumTaskEventsStored() {
-    return stats_counter_.Get(TaskEventBufferCounter::kNumTaskStatusEventsStored) +
-           stats_counter_.Get(TaskEventBufferCounter::kNumTaskProfileEventsStored);
+    return NumStatusEventsStored() + NumProfileEventsStored();
   }
 
   /// Test only functions.
@@ -363,9 +394,10 @@ class TaskEventBufferImpl : public TaskEventBuffer {
     return gcs_client_.get();
   }
 
-  /// Mutex guarding task_events_data_.
+  /// Mutex guarding the GCS client and the dropped task attempts.
   absl::Mutex mutex_;
 
+  /// Mutex guarding the aggregated profile events.
   absl::Mutex profile_mutex_;
 
   /// IO service event loop owned by TaskEventBuffer.
@@ -386,16 +418,20 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   /// True if the TaskEventBuffer is enabled.
   std::atomic<bool> enabled_ = false;
 
-  /// Circular buffered task status events.
-  boost::circular_buffer<std::unique_ptr<TaskEvent>> status_events_
-      ABSL_GUARDED_BY(mutex_);
+  /// Buffered task status events, created by Start() with the capacity of
+  /// `RAY_task_events_max_num_status_events_buffer_on_worker`.
+  std::unique_ptr<LockFreeRingBuffer<std::unique_ptr<TaskEvent>>> status_events_;
+
+  /// Task profile events added since the last flush, created by Start() with the
+  /// capacity of `RAY_task_events_max_num_profile_events_buffer_on_worker`.
+  std::unique_ptr<LockFreeRingBuffer<std::unique_ptr<TaskEvent>>> new_profile_events_;
 
   /// Buffered task attempts that were dropped due to status events being dropped.
   /// This will be sent to GCS to surface the dropped task attempts.
   absl::flat_hash_set<TaskAttempt> dropped_task_attempts_unreported_
       ABSL_GUARDED_BY(mutex_);
 
-  /// Buffered task profile events. A FIFO queue to be sent to GCS.
+  /// Buffered task profile events aggregated by task attempt, to be sent to GCS.
   absl::flat_hash_map<TaskAttempt, std::vector<std::unique_ptr<TaskEvent>>>
       profile_events_ ABSL_GUARDED_BY(profile_mutex_);
 
@@ -415,6 +451,7 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   FRIEND_TEST(TaskEventBufferTest, TestBackPressure);
   FRIEND_TEST(TaskEventBufferTest, TestForcedFlush);
   FRIEND_TEST(TaskEventBufferTestLimitBuffer, TestBufferSizeLimitStatusEvents);
+  FRIEND_TEST(TaskEventBufferTest, TestConcurrentAddStatusEvents);
   FRIEND_TEST(TaskEventBufferTestLimitProfileEvents, TestBufferSizeLimitProfileEvents);
   FRIEND_TEST(TaskEventBufferTestLimitProfileEvents, TestLimitProfileEventsPerTask);
 };
@@ -1286,7 +1286,7 @@ std::vector<TaskID> TaskManager::GetPendingChildrenTasks(
     const TaskID &parent_task_id) const {
   std::vector<TaskID> ret_vec;
   absl::MutexLock lock(&mu_);
-  for (auto it : submissible_tasks_) {
+  for (const auto &it : submissible_tasks_) {
     if (it.second.IsPending() && (it.second.spec.ParentTaskId() == parent_task_id)) {
       ret_vec.push_back(it.first);
     }
@@ -1384,6 +1384,15 @@ void TaskManager::SetTaskStatus(
                         status,
                         /* include_task_info */ false,
                         worker::TaskStatusEvent::TaskStateUpdate(error_info));
+  // The span lasts until the task is done, including its retries, so it's only ended
+  // on the terminal states. It's ended as well if the entry is removed before that.
+  if (task_entry.span.IsRecording() &&
+      (status == rpc::TaskStatus::FINISHED || status == rpc::TaskStatus::FAILED)) {
+    task_entry.span.SetAttribute("status", rpc::TaskStatus_Name(status));
+    task_entry.span.SetAttribute("attempt_number",
+                                 std::to_string(task_entry.spec.AttemptNumber()));
+    task_entry.span.End();
+  }
 }
 
 void TaskManager::FillTaskInfo(rpc::GetCoreWorkerStatsReply *reply,
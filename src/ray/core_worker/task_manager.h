@@ -19,6 +19,7 @@
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task.h"
+#include "ray/common/tracing.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
 #include "ray/stats/metric_defs.h"
@@ -613,6 +614,10 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
           std::make_tuple(spec.GetName(), rpc::TaskStatus::PENDING_ARGS_AVAIL, false);
       counter.Increment(new_status);
       status = new_status;
+      if (tracing::IsSampled(spec.GetTraceContext())) {
+        span = tracing::Span("Task " + spec.GetName(), spec.GetTraceContext());
+        span.SetAttribute("task_id", spec.TaskId().Hex());
+      }
     }
 
     void SetStatus(rpc::TaskStatus new_status) {
@@ -691,6 +696,9 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
     int64_t lineage_footprint_bytes = 0;
     // Number of times this task successfully completed execution so far.
     int num_successful_executions = 0;
+    // The span of the task from its submission to its completion, including its
+    // retries. It's a no-op if the task isn't traced.
+    tracing::Span span;
 
    private:
     // The task's current execution and metric status (name, status, is_retry).
@@ -753,7 +761,8 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// Set the TaskStatus
   ///
   /// Sets the task status on the TaskEntry, and record the task status change events in
-  /// the TaskEventBuffer if enabled.
+  /// the TaskEventBuffer if enabled. The span of the task is ended if the status is
+  /// FINISHED or FAILED.
   ///
   /// \param task_entry corresponding TaskEntry of a task to record the event.
   /// \param status new status.
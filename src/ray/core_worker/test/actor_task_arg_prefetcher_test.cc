@@ -0,0 +1,164 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/actor_task_arg_prefetcher.h"
+
+#include <atomic>
+
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+#include "ray/common/test_util.h"
+
+namespace ray {
+namespace core {
+
+constexpr size_t kObjectSize = 100;
+
+class ActorTaskArgPrefetcherTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<ActorTaskArgPrefetcher> MakePrefetcher(int64_t max_tasks,
+                                                         int64_t max_bytes) {
+    return std::make_unique<ActorTaskArgPrefetcher>(
+        max_tasks,
+        max_bytes,
+        [this](const absl::flat_hash_set<ObjectID> &object_ids,
+               absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> *results) {
+          if (block_get_) {
+            unblock_get_.WaitForNotification();
+          }
+          for (const auto &object_id : object_ids) {
+            auto data = std::make_shared<LocalMemoryBuffer>(kObjectSize);
+            (*results)[object_id] = std::make_shared<RayObject>(
+                data, nullptr, std::vector<rpc::ObjectReference>());
+          }
+          num_gets_++;
+          return Status::OK();
+        });
+  }
+
+  bool WaitForBytes(const ActorTaskArgPrefetcher &prefetcher, int64_t num_bytes) {
+    return WaitForCondition(
+        [&prefetcher, num_bytes]() { return prefetcher.NumBytes() == num_bytes; }, 5000);
+  }
+
+  bool block_get_ = false;
+  absl::Notification unblock_get_;
+  std::atomic<int> num_gets_{0};
+};
+
+TEST_F(ActorTaskArgPrefetcherTest, TestPrefetchAndTake) {
+  auto prefetcher = MakePrefetcher(/*max_tasks=*/10, /*max_bytes=*/1000);
+  const auto id1 = ObjectID::FromRandom();
+  const auto id2 = ObjectID::FromRandom();
+  const auto id3 = ObjectID::FromRandom();
+  prefetcher->Prefetch({id1, id2});
+  ASSERT_TRUE(WaitForBytes(*prefetcher, 2 * kObjectSize));
+  ASSERT_EQ(prefetcher->NumTasks(), 1);
+
+  // The task gets the arguments which haven't been prefetched itself.
+  absl::flat_hash_set<ObjectID> object_ids{id1, id2, id3};
+  absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results;
+  prefetcher->Take(&object_ids, &results);
+  ASSERT_EQ(object_ids, absl::flat_hash_set<ObjectID>{id3});
+  ASSERT_EQ(results.size(), 2);
+  ASSERT_TRUE(results.contains(id1));
+  ASSERT_TRUE(results.contains(id2));
+  ASSERT_EQ(prefetcher->NumTasks(), 0);
+  ASSERT_EQ(prefetcher->NumBytes(), 0);
+}
+
+TEST_F(ActorTaskArgPrefetcherTest, TestBounds) {
+  auto prefetcher = MakePrefetcher(/*max_tasks=*/2, /*max_bytes=*/1000);
+  prefetcher->Prefetch({ObjectID::FromRandom()});
+  prefetcher->Prefetch({ObjectID::FromRandom()});
+  // The number of tasks is bounded.
+  prefetcher->Prefetch({ObjectID::FromRandom()});
+  ASSERT_TRUE(WaitForBytes(*prefetcher, 2 * kObjectSize));
+  ASSERT_EQ(prefetcher->NumTasks(), 2);
+  ASSERT_EQ(num_gets_.load(), 2);
+
+  prefetcher = MakePrefetcher(/*max_tasks=*/10, /*max_bytes=*/kObjectSize);
+  prefetcher->Prefetch({ObjectID::FromRandom()});
+  ASSERT_TRUE(WaitForBytes(*prefetcher, kObjectSize));
+  // The total size is bounded.
+  prefetcher->Prefetch({ObjectID::FromRandom()});
+  ASSERT_EQ(prefetcher->NumTasks(), 1);
+}
+
+TEST_F(ActorTaskArgPrefetcherTest, TestBytesBoundedWhenFetched) {
+  auto prefetcher = MakePrefetcher(/*max_tasks=*/10, /*max_bytes=*/kObjectSize * 3 / 2);
+  const auto id1 = ObjectID::FromRandom();
+  const auto id2 = ObjectID::FromRandom();
+  // Both objects are fetched, but only one of them fits.
+  prefetcher->Prefetch({id1, id2});
+  ASSERT_TRUE(WaitForCondition([this]() { return num_gets_.load() == 1; }, 5000));
+  ASSERT_TRUE(WaitForBytes(*prefetcher, kObjectSize));
+  ASSERT_EQ(prefetcher->NumTasks(), 1);
+
+  absl::flat_hash_set<ObjectID> object_ids{id1, id2};
+  absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results;
+  prefetcher->Take(&object_ids, &results);
+  ASSERT_EQ(object_ids.size(), 1);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(prefetcher->NumTasks(), 0);
+  ASSERT_EQ(prefetcher->NumBytes(), 0);
+}
+
+TEST_F(ActorTaskArgPrefetcherTest, TestTakeWhileFetching) {
+  block_get_ = true;
+  auto prefetcher = MakePrefetcher(/*max_tasks=*/10, /*max_bytes=*/1000);
+  const auto id = ObjectID::FromRandom();
+  prefetcher->Prefetch({id});
+  absl::flat_hash_set<ObjectID> object_ids{id};
+  absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results;
+  prefetcher->Take(&object_ids, &results);
+  // The task gets the object itself, and the fetched object isn't kept.
+  ASSERT_EQ(object_ids.size(), 1);
+  ASSERT_TRUE(results.empty());
+  ASSERT_EQ(prefetcher->NumTasks(), 0);
+  unblock_get_.Notify();
+  // The objects are fetched in order, so the first one has been fetched once the next
+  // one is.
+  const auto next_id = ObjectID::FromRandom();
+  prefetcher->Prefetch({next_id});
+  ASSERT_TRUE(WaitForBytes(*prefetcher, kObjectSize));
+  ASSERT_EQ(prefetcher->NumTasks(), 1);
+}
+
+TEST_F(ActorTaskArgPrefetcherTest, TestDropStaleObjects) {
+  auto prefetcher = MakePrefetcher(/*max_tasks=*/2, /*max_bytes=*/1000);
+  // The object of the first task is never taken, e.g. because the task is cancelled.
+  prefetcher->Prefetch({ObjectID::FromRandom()});
+  for (int i = 0; i < 3; i++) {
+    const auto id = ObjectID::FromRandom();
+    prefetcher->Prefetch({id});
+    ASSERT_TRUE(WaitForBytes(*prefetcher, 2 * kObjectSize));
+    absl::flat_hash_set<ObjectID> object_ids{id};
+    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results;
+    prefetcher->Take(&object_ids, &results);
+    ASSERT_EQ(results.size(), 1);
+  }
+  // It's dropped once the tasks prefetched more than max_tasks tasks after it have
+  // taken their objects.
+  ASSERT_EQ(prefetcher->NumTasks(), 0);
+  ASSERT_EQ(prefetcher->NumBytes(), 0);
+}
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
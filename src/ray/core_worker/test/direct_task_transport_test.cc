@@ -14,6 +14,7 @@
 
 #include "ray/core_worker/transport/direct_task_transport.h"
 
+#include "absl/strings/str_format.h"
 #include "gtest/gtest.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/task/task_util.h"
@@ -107,12 +108,62 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
     return true;
   }
 
+  void PushNormalTaskBatch(
+      std::unique_ptr<rpc::PushTaskBatchRequest> request,
+      const rpc::ClientCallback<rpc::PushTaskBatchReply> &callback) override {
+    std::vector<std::string> task_ids;
+    if (request->requests_size() == 0) {
+      // The request waits for the rest of the tasks of the batch being replied.
+      task_ids = std::move(unreplied_batch_task_ids);
+    }
+    for (const auto &task_request : request->requests()) {
+      task_ids.push_back(task_request.task_spec().task_id());
+    }
+    batch_sizes.push_back(request->requests_size());
+    batch_task_ids.push_back(std::move(task_ids));
+    batch_callbacks.push_back(callback);
+    last_batch_request = std::move(*request);
+  }
+
+  // Reply to the first batch request. If num_replied is set, only that many tasks are
+  // replied to, and the rest are left to the next request of the batch. If
+  // worker_exiting is set, the last replied task makes the worker exit.
+  bool ReplyPushTaskBatch(std::optional<int> num_replied = std::nullopt,
+                          bool worker_exiting = false) {
+    if (batch_callbacks.size() == 0) {
+      return false;
+    }
+    auto callback = batch_callbacks.front();
+    auto task_ids = std::move(batch_task_ids.front());
+    batch_callbacks.pop_front();
+    batch_sizes.pop_front();
+    batch_task_ids.pop_front();
+    const int num_tasks = num_replied.value_or(task_ids.size());
+    auto reply = rpc::PushTaskBatchReply();
+    for (int i = 0; i < num_tasks; i++) {
+      auto *task_reply = reply.add_task_replies();
+      task_reply->set_task_id(task_ids[i]);
+      if (worker_exiting && i == num_tasks - 1) {
+        task_reply->mutable_reply()->set_worker_exiting(true);
+      }
+    }
+    unreplied_batch_task_ids.assign(task_ids.begin() + num_tasks, task_ids.end());
+    callback(Status::OK(), reply);
+    unreplied_batch_task_ids.clear();
+    return true;
+  }
+
   void CancelTask(const rpc::CancelTaskRequest &request,
                   const rpc::ClientCallback<rpc::CancelTaskReply> &callback) override {
     kill_requests.push_front(request);
   }
 
   std::list<rpc::ClientCallback<rpc::PushTaskReply>> callbacks;
+  std::list<rpc::ClientCallback<rpc::PushTaskBatchReply>> batch_callbacks;
+  std::list<int> batch_sizes;
+  std::list<std::vector<std::string>> batch_task_ids;
+  std::vector<std::string> unreplied_batch_task_ids;
+  rpc::PushTaskBatchRequest last_batch_request;
   std::list<rpc::CancelTaskRequest> kill_requests;
 };
 
@@ -222,8 +273,10 @@ class MockRayletClient : public WorkerLeaseInterface {
       bool grant_or_reject,
       const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
       const int64_t backlog_size,
-      const bool is_selected_based_on_locality) override {
+      const bool is_selected_based_on_locality,
+      const int64_t num_workers) override {
     num_workers_requested += 1;
+    num_workers_per_request.push_back(num_workers);
     if (grant_or_reject) {
       num_grant_or_reject_leases_requested += 1;
     }
@@ -280,6 +333,34 @@ class MockRayletClient : public WorkerLeaseInterface {
     }
   }
 
+  // Trigger reply to RequestWorkerLease, granting the requested worker and
+  // num_additional_workers more on the ports after it.
+  bool GrantWorkerLeases(const std::string &address,
+                         int port,
+                         int num_additional_workers) {
+    if (callbacks.size() == 0) {
+      return false;
+    }
+    rpc::RequestWorkerLeaseReply reply;
+    reply.mutable_worker_address()->set_ip_address(address);
+    reply.mutable_worker_address()->set_port(port);
+    reply.mutable_worker_address()->set_raylet_id(NodeID::Nil().Binary());
+    reply.mutable_worker_address()->set_worker_id(WorkerID::FromRandom().Binary());
+    for (int i = 1; i <= num_additional_workers; i++) {
+      auto *additional_lease = reply.add_additional_leases();
+      additional_lease->set_task_id(TaskID::FromRandom(JobID::Nil()).Binary());
+      additional_lease->mutable_worker_address()->set_ip_address(address);
+      additional_lease->mutable_worker_address()->set_port(port + i);
+      additional_lease->mutable_worker_address()->set_raylet_id(NodeID::Nil().Binary());
+      additional_lease->mutable_worker_address()->set_worker_id(
+          WorkerID::FromRandom().Binary());
+    }
+    auto callback = callbacks.front();
+    callback(Status::OK(), reply);
+    callbacks.pop_front();
+    return true;
+  }
+
   bool FailWorkerLeaseDueToGrpcUnavailable() {
     rpc::RequestWorkerLeaseReply reply;
     if (callbacks.size() == 0) {
@@ -310,6 +391,7 @@ class MockRayletClient : public WorkerLeaseInterface {
   int num_grant_or_reject_leases_requested = 0;
   int num_is_selected_based_on_locality_leases_requested = 0;
   int num_workers_requested = 0;
+  std::list<int64_t> num_workers_per_request;
   int num_workers_returned = 0;
   int num_workers_returned_exiting = 0;
   int num_workers_disconnected = 0;
@@ -385,6 +467,14 @@ TaskSpecification BuildEmptyTaskSpec() {
   return BuildTaskSpec(empty_resources, empty_descriptor);
 }
 
+// Calls BuildEmptyTaskSpec with a random task ID, since the tasks pushed in a batch are
+// replied by their IDs.
+TaskSpecification BuildBatchedTaskSpec() {
+  auto task_spec = BuildEmptyTaskSpec();
+  task_spec.GetMutableMessage().set_task_id(TaskID::FromRandom(JobID::Nil()).Binary());
+  return task_spec;
+}
+
 TEST(DirectTaskTransportTest, TestLocalityAwareSubmitOneTask) {
   rpc::Address address;
   auto raylet_client = std::make_shared<MockRayletClient>();
@@ -1250,6 +1340,479 @@ TEST(DirectTaskTransportTest, TestReuseWorkerLease) {
   ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
 }
 
+TEST(DirectTaskTransportTest, TestPushTaskBatch) {
+  RayConfig::instance().initialize(R"({"max_tasks_per_push_batch": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  for (int i = 0; i < 6; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildBatchedTaskSpec()).ok());
+  }
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+
+  // The first 4 tasks are pushed in one batch.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({4}));
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+  // The second worker takes both of the remaining tasks, since it's the only idle one.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({4, 2}));
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+  // Both workers are returned once their batches are done.
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch());
+  ASSERT_EQ(task_finisher->num_tasks_complete, 4);
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch());
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 6);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_FALSE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+TEST(DirectTaskTransportTest, TestLeaseMultipleWorkers) {
+  RayConfig::instance().initialize(R"({"max_workers_per_lease_request": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  for (int i = 0; i < 7; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+  }
+  // The first request is sent when there's only one task.
+  ASSERT_EQ(raylet_client->num_workers_per_request, std::list<int64_t>({1}));
+
+  // The next request asks for a worker for every queued task, up to the limit.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_workers_per_request, std::list<int64_t>({1, 4}));
+
+  // The raylet only grants some of them, and the rest are requested again.
+  ASSERT_TRUE(raylet_client->GrantWorkerLeases("localhost", 1001, 2));
+  ASSERT_EQ(worker_client->callbacks.size(), 4);
+  ASSERT_EQ(raylet_client->num_workers_per_request, std::list<int64_t>({1, 4, 3}));
+  ASSERT_EQ(raylet_client->reported_backlog_size, 0);
+
+  ASSERT_TRUE(raylet_client->GrantWorkerLeases("localhost", 1004, 2));
+  ASSERT_EQ(worker_client->callbacks.size(), 7);
+  ASSERT_EQ(raylet_client->num_workers_requested, 3);
+
+  for (int i = 0; i < 7; i++) {
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+  }
+  ASSERT_EQ(raylet_client->num_workers_returned, 7);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 7);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 0);
+  ASSERT_FALSE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+TEST(DirectTaskTransportTest, TestReuseLeaseAcrossSchedulingKeys) {
+  RayConfig::instance().initialize(
+      R"({"worker_lease_reuse_across_scheduling_keys": true})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  // Different functions with the same resources have different scheduling keys, but
+  // the same lease shape.
+  std::unordered_map<std::string, double> resources;
+  auto f = FunctionDescriptorBuilder::BuildPython("module", "", "f", "");
+  auto g = FunctionDescriptorBuilder::BuildPython("module", "", "g", "");
+
+  ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec(resources, f)).ok());
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  // The idle worker is kept instead of being returned.
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+
+  // A task of another function reuses the idle worker without a new lease.
+  ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec(resources, g)).ok());
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+  ASSERT_EQ(submitter.GetNumLeasesReused(), 1);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+
+  // The worker goes to the task that's waiting for a lease as soon as it's idle, and
+  // the pending lease request is canceled.
+  ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec(resources, f)).ok());
+  ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec(resources, g)).ok());
+  ASSERT_EQ(submitter.GetNumLeasesReused(), 2);
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(submitter.GetNumLeasesReused(), 3);
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 1);
+  ASSERT_TRUE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("", 0, NodeID::Nil(), /*cancel=*/true));
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+
+  // A task with other resources doesn't reuse the worker.
+  ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec({{"CPU", 1}}, g)).ok());
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_EQ(raylet_client->num_workers_requested, 3);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, NodeID::Nil()));
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+
+  ASSERT_EQ(submitter.GetNumLeasesReused(), 3);
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 5);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+TEST(DirectTaskTransportTest, TestPushTaskBatchWithTemplates) {
+  RayConfig::instance().initialize(R"({"max_tasks_per_push_batch": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  // The template matches BuildEmptyTaskSpec, so all the tasks have the same scheduling
+  // key.
+  TaskSpecBuilder template_builder;
+  template_builder.SetTemplateTaskSpec(
+      "dummy_task",
+      FunctionDescriptorBuilder::BuildPython("", "", "", ""),
+      rpc::JobConfig(),
+      address,
+      {},
+      {},
+      nullptr,
+      "",
+      rpc::SchedulingStrategy());
+  auto task_spec_template =
+      std::make_shared<const rpc::TaskSpec>(template_builder.GetMessage());
+  std::vector<TaskSpecification> task_specs;
+  for (int i = 0; i < 3; i++) {
+    TaskSpecBuilder builder(task_spec_template);
+    builder.SetPerCallTaskSpec(TaskID::FromRandom(JobID::Nil()),
+                               Language::PYTHON,
+                               JobID::Nil(),
+                               TaskID::Nil(),
+                               i,
+                               TaskID::Nil(),
+                               1,
+                               false,
+                               false,
+                               -1,
+                               "",
+                               0,
+                               TaskID::Nil(),
+                               0,
+                               false);
+    task_specs.push_back(builder.Build());
+    ASSERT_TRUE(submitter.SubmitTask(task_specs.back()).ok());
+  }
+  ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+
+  // The template is sent once, and only the tasks built from it reference it.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({4}));
+  const auto &request = worker_client->last_batch_request;
+  ASSERT_EQ(request.task_spec_templates_size(), 1);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(request.requests(i).task_spec_template_index(), 1);
+    ASSERT_FALSE(request.requests(i).task_spec().has_function_descriptor());
+    rpc::TaskSpec task_spec = request.requests(i).task_spec();
+    ApplyTaskSpecTemplate(request.task_spec_templates(0), &task_spec);
+    ASSERT_EQ(task_spec.SerializeAsString(),
+              task_specs[i].GetMessage().SerializeAsString());
+  }
+  ASSERT_EQ(request.requests(3).task_spec_template_index(), 0);
+  ASSERT_TRUE(request.requests(3).task_spec().has_function_descriptor());
+
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch());
+  ASSERT_EQ(task_finisher->num_tasks_complete, 4);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_FALSE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+TEST(DirectTaskTransportTest, TestPushTaskBatchWorkerExiting) {
+  RayConfig::instance().initialize(R"({"max_tasks_per_push_batch": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildBatchedTaskSpec()).ok());
+  }
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({3}));
+
+  // The first task makes the worker exit, so the other 2 tasks are not executed. They
+  // are queued again instead of failing.
+  ASSERT_TRUE(
+      worker_client->ReplyPushTaskBatch(/*num_replied=*/1, /*worker_exiting=*/true));
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_EQ(raylet_client->num_workers_returned_exiting, 1);
+
+  // They are pushed in one batch to the next worker.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, NodeID::Nil()));
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({2}));
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch());
+  ASSERT_EQ(task_finisher->num_tasks_complete, 3);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_FALSE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+TEST(DirectTaskTransportTest, TestPushTaskBatchRepliesEachTask) {
+  RayConfig::instance().initialize(R"({"max_tasks_per_push_batch": 4})");
+  rpc::Address address;
+  address.set_worker_id(WorkerID::FromRandom().Binary());
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildBatchedTaskSpec()).ok());
+  }
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({3}));
+
+  // The first task is completed as soon as it's replied, and the submitter waits for
+  // the other 2 with a request without tasks. The worker is still busy.
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch(/*num_replied=*/1));
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+  ASSERT_EQ(worker_client->batch_sizes, std::list<int>({0}));
+  ASSERT_EQ(worker_client->last_batch_request.caller_worker_id(), address.worker_id());
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch(/*num_replied=*/1));
+  ASSERT_EQ(task_finisher->num_tasks_complete, 2);
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch());
+  ASSERT_EQ(task_finisher->num_tasks_complete, 3);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_TRUE(worker_client->batch_callbacks.empty());
+  ASSERT_FALSE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+TEST(DirectTaskTransportTest, TestPushTaskBatchMissingReplies) {
+  RayConfig::instance().initialize(R"({"max_tasks_per_push_batch": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildBatchedTaskSpec()).ok());
+  }
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch(/*num_replied=*/1));
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+
+  // The worker replies without the other 2 tasks, so they're failed instead of being
+  // waited for forever.
+  ASSERT_TRUE(worker_client->ReplyPushTaskBatch(/*num_replied=*/0));
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+  ASSERT_EQ(raylet_client->num_get_task_failure_causes, 2);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 2);
+  ASSERT_TRUE(worker_client->batch_callbacks.empty());
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 1);
+  ASSERT_FALSE(raylet_client->ReplyCancelWorkerLease());
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  RayConfig::instance().initialize("");
+}
+
+// Measures the tasks/sec of the submitter for no-op tasks, with and without batching.
+// It's disabled by default. Run it with
+//   bazel run -c opt //:direct_task_transport_test -- \
+//       --gtest_also_run_disabled_tests --gtest_filter=*NoOpTaskThroughput*
+TEST(DirectTaskTransportTest, DISABLED_NoOpTaskThroughput) {
+  constexpr int kNumTasks = 100000;
+  for (int max_tasks_per_push_batch : {1, 16, 64}) {
+    RayConfig::instance().initialize(absl::StrFormat(
+        R"({"max_tasks_per_push_batch": %d})", max_tasks_per_push_batch));
+    rpc::Address address;
+    auto raylet_client = std::make_shared<MockRayletClient>();
+    auto worker_client = std::make_shared<MockWorkerClient>();
+    auto store = std::make_shared<CoreWorkerMemoryStore>();
+    auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+        [&](const rpc::Address &addr) { return worker_client; });
+    auto task_finisher = std::make_shared<MockTaskFinisher>();
+    auto actor_creator = std::make_shared<MockActorCreator>();
+    auto lease_policy = std::make_shared<MockLeasePolicy>();
+    CoreWorkerDirectTaskSubmitter submitter(address,
+                                            raylet_client,
+                                            client_pool,
+                                            nullptr,
+                                            lease_policy,
+                                            store,
+                                            task_finisher,
+                                            NodeID::Nil(),
+                                            WorkerType::WORKER,
+                                            kLongTimeout,
+                                            actor_creator,
+                                            JobID::Nil(),
+                                            kOneRateLimiter);
+
+    const auto start = absl::GetCurrentTimeNanos();
+    for (int i = 0; i < kNumTasks; i++) {
+      ASSERT_TRUE(submitter.SubmitTask(BuildBatchedTaskSpec()).ok());
+    }
+    ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+    int num_pushes = 0;
+    while (worker_client->ReplyPushTask() || worker_client->ReplyPushTaskBatch()) {
+      num_pushes++;
+    }
+    const auto end = absl::GetCurrentTimeNanos();
+    ASSERT_EQ(task_finisher->num_tasks_complete, kNumTasks);
+    std::cout << "max_tasks_per_push_batch=" << max_tasks_per_push_batch << ": "
+              << num_pushes << " pushes, " << kNumTasks / ((end - start) / 1e9)
+              << " tasks/s" << std::endl;
+  }
+  RayConfig::instance().initialize("");
+}
+
 TEST(DirectTaskTransportTest, TestRetryLeaseCancellation) {
   rpc::Address address;
   auto raylet_client = std::make_shared<MockRayletClient>();
@@ -2123,6 +2686,58 @@ TEST(LeaseRequestRateLimiterTest, ClusterSizeBasedLeaseRequestRateLimiter) {
   }
 }
 
+TEST(LeaseRequestRateLimiterTest, AdaptiveLeaseRequestRateLimiter) {
+  using LeaseOutcome = LeaseRequestRateLimiter::LeaseOutcome;
+  rpc::GcsNodeInfo dead_node;
+  dead_node.set_state(rpc::GcsNodeInfo::DEAD);
+  rpc::GcsNodeInfo alive_node;
+  alive_node.set_state(rpc::GcsNodeInfo::ALIVE);
+  AdaptiveLeaseRequestRateLimiter limiter(/*min_concurrent_lease_limit=*/1,
+                                          /*max_limit_per_node=*/4,
+                                          /*target_latency_ms=*/100);
+  limiter.OnNodeChanges(alive_node);
+  limiter.OnNodeChanges(alive_node);
+  // Starts from the cluster size.
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 2);
+
+  // Grows by 1 per grant until the first congestion.
+  limiter.OnLeaseReply(LeaseOutcome::kGranted, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 3);
+  limiter.OnLeaseReply(LeaseOutcome::kGranted, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 4);
+
+  // A slow grant is a congestion, which halves the limit.
+  limiter.OnLeaseReply(LeaseOutcome::kGranted, 200);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 2);
+  // The replies to the requests sent before the decrease don't decrease it again.
+  limiter.OnLeaseReply(LeaseOutcome::kRejected, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 2);
+
+  // Grows by 1 per limit's worth of grants after the first congestion.
+  limiter.OnLeaseReply(LeaseOutcome::kGranted, 10);
+  limiter.OnLeaseReply(LeaseOutcome::kGranted, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 2);
+  limiter.OnLeaseReply(LeaseOutcome::kGranted, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 3);
+
+  // Spillbacks and cancellations don't change the limit.
+  limiter.OnLeaseReply(LeaseOutcome::kSpilledBack, 10);
+  limiter.OnLeaseReply(LeaseOutcome::kCanceled, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 3);
+
+  // Never goes below the cluster size.
+  limiter.OnLeaseReply(LeaseOutcome::kFailed, 10);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 2);
+
+  // Converges to the max limit per node while the leases are granted in time.
+  for (int i = 0; i < 100; i++) {
+    limiter.OnLeaseReply(LeaseOutcome::kGranted, 10);
+  }
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 8);
+  limiter.OnNodeChanges(dead_node);
+  ASSERT_EQ(limiter.GetMaxPendingLeaseRequestsPerSchedulingCategory(), 4);
+}
+
 }  // namespace core
 }  // namespace ray
 
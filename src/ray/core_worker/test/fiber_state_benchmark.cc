@@ -0,0 +1,106 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of the async actor calls run by FiberState. Every call waits for an event
+// which is notified by another thread, like a task waiting for its coroutine to be
+// done on the asyncio event loop.
+//
+// It's not run by default. Run it with
+//   bazel run -c opt //:fiber_state_benchmark
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/core_worker/fiber.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+constexpr int kNumCalls = 1000 * 1000;
+
+class FiberStateBenchmark : public ::testing::TestWithParam<int> {};
+
+TEST_P(FiberStateBenchmark, ConcurrentCalls) {
+  const int max_concurrency = GetParam();
+  FiberState fiber_state(max_concurrency);
+
+  // The events of the calls waiting to be done.
+  absl::Mutex mutex;
+  std::vector<FiberEvent *> waiting_events;
+  std::atomic<bool> stopped = false;
+  std::thread event_loop([&]() {
+    std::vector<FiberEvent *> events;
+    while (!stopped) {
+      {
+        absl::MutexLock lock(&mutex);
+        events.swap(waiting_events);
+      }
+      for (auto *event : events) {
+        event->Notify();
+      }
+      events.clear();
+    }
+  });
+
+  std::atomic<int> num_done = 0;
+  absl::Notification all_done;
+  const auto start = absl::GetCurrentTimeNanos();
+  for (int i = 0; i < kNumCalls; i++) {
+    fiber_state.EnqueueFiber([&]() {
+      FiberEvent event;
+      {
+        absl::MutexLock lock(&mutex);
+        waiting_events.push_back(&event);
+      }
+      event.Wait();
+      if (++num_done == kNumCalls) {
+        all_done.Notify();
+      }
+    });
+  }
+  const auto enqueue_done = absl::GetCurrentTimeNanos();
+  all_done.WaitForNotification();
+  const auto end = absl::GetCurrentTimeNanos();
+  stopped = true;
+  event_loop.join();
+  fiber_state.Stop();
+  fiber_state.Join();
+
+  std::cout << "max_concurrency=" << max_concurrency << ": " << kNumCalls
+            << " calls, enqueue " << (enqueue_done - start) / 1e6 << " ms, total "
+            << (end - start) / 1e6 << " ms, " << kNumCalls / ((end - start) / 1e9)
+            << " calls/s" << std::endl;
+}
+
+INSTANTIATE_TEST_SUITE_P(FiberStateBenchmark,
+                         FiberStateBenchmark,
+                         ::testing::Values(1, 100, 1000));
+
+}  // namespace
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
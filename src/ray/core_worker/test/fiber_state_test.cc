@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <boost/fiber/all.hpp>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "ray/core_worker/fiber.h"
@@ -95,6 +96,29 @@ TEST(FiberStateTest, RespectsConcurrencyLimit) {
   fiber_state.Join();
 }
 
+TEST(FiberStateTest, StartsTasksInOrder) {
+  FiberState fiber_state(2);
+  TotalCounter total_counter;
+
+  std::vector<int> started;
+  for (int i = 0; i < 100; ++i) {
+    fiber_state.EnqueueFiber([&, i]() {
+      started.push_back(i);
+      boost::this_fiber::sleep_for(std::chrono::milliseconds(1));
+      total_counter.increment();
+    });
+  }
+
+  total_counter.wait_for(100);
+  ASSERT_EQ(started.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(started[i], i);
+  }
+
+  fiber_state.Stop();
+  fiber_state.Join();
+}
+
 }  // namespace core
 }  // namespace ray
 
@@ -0,0 +1,92 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the in-memory store of the small objects owned by a worker.
+
+#include "ray/common/benchmark_util.h"
+#include "ray/core_worker/context.h"
+#include "ray/core_worker/store_provider/memory_store/memory_store.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+using benchmark::State;
+
+/// The number of objects put between the deletes.
+constexpr size_t kNumObjects = 1000;
+
+std::vector<ObjectID> RandomObjectIds(size_t num_ids) {
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < num_ids; ++i) {
+    ids.push_back(ObjectID::FromRandom());
+  }
+  return ids;
+}
+
+RayObject MakeObject(size_t size) {
+  const std::string data(size, 'x');
+  auto buffer = std::make_shared<LocalMemoryBuffer>(
+      reinterpret_cast<uint8_t *>(const_cast<char *>(data.data())),
+      data.size(),
+      /*copy_data=*/true);
+  return RayObject(buffer, nullptr, std::vector<rpc::ObjectReference>());
+}
+
+/// Put objects of the given size. The objects are deleted in batches, untimed.
+void BM_MemoryStorePut(State &state) {
+  CoreWorkerMemoryStore store;
+  const auto object = MakeObject(state.range());
+  const auto ids = RandomObjectIds(kNumObjects);
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    store.Put(object, ids[i++]);
+    if (i == ids.size()) {
+      state.PauseTiming();
+      store.Delete(ids);
+      i = 0;
+      state.ResumeTiming();
+    }
+  }
+}
+RAY_BENCHMARK(BM_MemoryStorePut)->Arg(100)->Arg(100 * 1024);
+
+/// Get a batch of the given number of objects, which are all in the store.
+void BM_MemoryStoreGet(State &state) {
+  CoreWorkerMemoryStore store;
+  WorkerContext context(WorkerType::WORKER, WorkerID::FromRandom(), JobID::FromInt(0));
+  const auto object = MakeObject(100);
+  const auto ids = RandomObjectIds(state.range());
+  for (const auto &id : ids) {
+    store.Put(object, id);
+  }
+  std::vector<std::shared_ptr<RayObject>> results;
+  while (state.KeepRunning()) {
+    RAY_CHECK_OK(store.Get(ids,
+                           static_cast<int>(ids.size()),
+                           /*timeout_ms=*/-1,
+                           context,
+                           /*remove_after_get=*/false,
+                           &results));
+    benchmark::DoNotOptimize(results);
+  }
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+RAY_BENCHMARK(BM_MemoryStoreGet)->Arg(1)->Arg(100);
+
+}  // namespace
+
+}  // namespace core
+}  // namespace ray
@@ -0,0 +1,111 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of counting the references of the objects, which the workers do for
+// every ObjectRef they create, copy and drop.
+
+#include "ray/core_worker/reference_count.h"
+
+#include "gmock/gmock.h"
+#include "mock/ray/pubsub/publisher.h"
+#include "mock/ray/pubsub/subscriber.h"
+#include "ray/common/benchmark_util.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+using benchmark::State;
+using ::testing::NiceMock;
+
+/// A reference counter of a worker, whose pubsub isn't used by local references.
+class ReferenceCounterFixture {
+ public:
+  ReferenceCounterFixture()
+      : reference_counter_(address_,
+                           &publisher_,
+                           &subscriber_,
+                           [](const NodeID &node_id) { return true; }) {}
+
+  ReferenceCounter &reference_counter() { return reference_counter_; }
+  const rpc::Address &address() const { return address_; }
+
+ private:
+  rpc::Address address_;
+  NiceMock<pubsub::MockPublisher> publisher_;
+  NiceMock<pubsub::MockSubscriber> subscriber_;
+  ReferenceCounter reference_counter_;
+};
+
+/// Add and remove a local reference of an object with the given number of other
+/// objects in scope, like copying and dropping an ObjectRef.
+void BM_AddRemoveLocalReference(State &state) {
+  ReferenceCounterFixture fixture;
+  auto &reference_counter = fixture.reference_counter();
+  for (int64_t i = 0; i < state.range(); ++i) {
+    reference_counter.AddOwnedObject(ObjectID::FromRandom(),
+                                     /*contained_ids=*/{},
+                                     fixture.address(),
+                                     /*call_site=*/"",
+                                     /*object_size=*/100,
+                                     /*is_reconstructable=*/false,
+                                     /*add_local_ref=*/true);
+  }
+  const auto object_id = ObjectID::FromRandom();
+  reference_counter.AddOwnedObject(object_id,
+                                   /*contained_ids=*/{},
+                                   fixture.address(),
+                                   /*call_site=*/"",
+                                   /*object_size=*/100,
+                                   /*is_reconstructable=*/false,
+                                   /*add_local_ref=*/true);
+  std::vector<ObjectID> deleted;
+  while (state.KeepRunning()) {
+    reference_counter.AddLocalReference(object_id, /*call_site=*/"");
+    reference_counter.RemoveLocalReference(object_id, &deleted);
+  }
+  RAY_CHECK(deleted.empty());
+}
+RAY_BENCHMARK(BM_AddRemoveLocalReference)->Arg(1)->Arg(100000);
+
+/// Create an owned object and drop its only reference, which deletes it.
+void BM_OwnedObjectLifecycle(State &state) {
+  ReferenceCounterFixture fixture;
+  auto &reference_counter = fixture.reference_counter();
+  std::vector<ObjectID> object_ids;
+  for (size_t i = 0; i < 1000; ++i) {
+    object_ids.push_back(ObjectID::FromRandom());
+  }
+  std::vector<ObjectID> deleted;
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    const auto &object_id = object_ids[i++ % object_ids.size()];
+    reference_counter.AddOwnedObject(object_id,
+                                     /*contained_ids=*/{},
+                                     fixture.address(),
+                                     /*call_site=*/"",
+                                     /*object_size=*/100,
+                                     /*is_reconstructable=*/true,
+                                     /*add_local_ref=*/true);
+    reference_counter.RemoveLocalReference(object_id, &deleted);
+    deleted.clear();
+  }
+}
+RAY_BENCHMARK(BM_OwnedObjectLifecycle);
+
+}  // namespace
+
+}  // namespace core
+}  // namespace ray
@@ -16,6 +16,8 @@
 
 #include <google/protobuf/util/message_differencer.h>
 
+#include <thread>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
@@ -449,6 +451,44 @@ TEST_F(TaskEventBufferTestLimitBuffer, TestBufferSizeLimitStatusEvents) {
   ASSERT_EQ(task_event_buffer_->GetTotalNumStatusTaskEventsDropped(), num_status_dropped);
 }
 
+TEST_F(TaskEventBufferTest, TestConcurrentAddStatusEvents) {
+  size_t num_threads = 4;
+  size_t num_events_per_thread = 1000;
+  size_t num_limit_status_events = 100;  // sync with setup
+
+  // Every event is of a different task attempt, so every event evicted is dropped.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([this, num_events_per_thread]() {
+      for (size_t i = 0; i < num_events_per_thread; ++i) {
+        task_event_buffer_->AddTaskEvent(GenStatusTaskEvent(RandomTaskId(), 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), num_limit_status_events);
+
+  auto task_gcs_accessor =
+      static_cast<ray::gcs::MockGcsClient *>(task_event_buffer_->GetGcsClient())
+          ->mock_task_accessor;
+  EXPECT_CALL(*task_gcs_accessor, AsyncAddTaskEventData)
+      .WillOnce([&](std::unique_ptr<rpc::TaskEventData> actual_data,
+                    ray::gcs::StatusCallback callback) {
+        // Every event is either sent or reported as dropped.
+        EXPECT_EQ(actual_data->events_by_task_size(), num_limit_status_events);
+        EXPECT_EQ(actual_data->dropped_task_attempts_size(),
+                  num_threads * num_events_per_thread - num_limit_status_events);
+        return Status::OK();
+      });
+  task_event_buffer_->FlushEvents(false);
+
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), 0);
+  ASSERT_EQ(task_event_buffer_->GetTotalNumStatusTaskEventsDropped(),
+            num_threads * num_events_per_thread - num_limit_status_events);
+}
+
 TEST_F(TaskEventBufferTestLimitProfileEvents, TestBufferSizeLimitProfileEvents) {
   size_t num_limit_profile_events = 20;  // sync with setup
   size_t num_profile_dropped = 20;
@@ -14,13 +14,18 @@
 
 #include "ray/core_worker/task_manager.h"
 
+#include <filesystem>
+#include <fstream>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mock/ray/gcs/gcs_client/gcs_client.h"
 #include "mock/ray/pubsub/publisher.h"
 #include "mock/ray/pubsub/subscriber.h"
+#include "nlohmann/json.hpp"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/test_util.h"
+#include "ray/common/tracing.h"
 #include "ray/core_worker/reference_count.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
@@ -238,6 +243,69 @@ TEST_F(TaskManagerTest, TestTaskSuccess) {
   ASSERT_EQ(reference_counter_->NumObjectIDsInScope(), 0);
 }
 
+TEST_F(TaskManagerTest, TestTaskSpanEndsWhenDone) {
+  const auto log_dir = std::filesystem::temp_directory_path() /
+                       ("task_manager_test_" + std::to_string(getpid()));
+  std::filesystem::create_directories(log_dir);
+  RayConfig::instance().initialize(R"({"tracing_sample_ratio": 1})");
+  tracing::Init("test", log_dir.string());
+  auto read_spans = [&log_dir]() {
+    std::vector<nlohmann::json> spans;
+    std::ifstream file(log_dir / ("traces_test_" + std::to_string(getpid()) + ".jsonl"));
+    std::string line;
+    while (std::getline(file, line)) {
+      spans.push_back(
+          nlohmann::json::parse(line)["resourceSpans"][0]["scopeSpans"][0]["spans"][0]);
+    }
+    return spans;
+  };
+
+  rpc::Address caller_address;
+  auto spec = CreateTaskHelper(1, {ObjectID::FromRandom()});
+  *spec.GetMutableMessage().mutable_trace_context() =
+      tracing::NewSpanContext(rpc::TraceContext());
+  manager_.AddPendingTask(caller_address, spec, "");
+  // The span isn't ended by the intermediate states.
+  manager_.MarkDependenciesResolved(spec.TaskId());
+  manager_.MarkTaskWaitingForExecution(
+      spec.TaskId(), NodeID::FromRandom(), WorkerID::FromRandom());
+  ASSERT_TRUE(read_spans().empty());
+
+  rpc::PushTaskReply reply;
+  auto return_object = reply.add_return_objects();
+  return_object->set_object_id(spec.ReturnId(0).Binary());
+  auto data = GenerateRandomBuffer();
+  return_object->set_data(data->Data(), data->Size());
+  manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
+
+  auto span_status = [](const nlohmann::json &span) {
+    std::string status;
+    for (const auto &attribute : span["attributes"]) {
+      if (attribute["key"] == "status") {
+        status = attribute["value"]["stringValue"];
+      }
+    }
+    return status;
+  };
+  auto spans = read_spans();
+  ASSERT_EQ(spans.size(), 1);
+  ASSERT_EQ(span_status(spans[0]), "FINISHED");
+
+  // A task that fails without retries ends its span with the FAILED status.
+  auto failed_spec = CreateTaskHelper(1, {ObjectID::FromRandom()});
+  *failed_spec.GetMutableMessage().mutable_trace_context() =
+      tracing::NewSpanContext(rpc::TraceContext());
+  manager_.AddPendingTask(caller_address, failed_spec, "");
+  manager_.FailOrRetryPendingTask(failed_spec.TaskId(), rpc::ErrorType::WORKER_DIED);
+  spans = read_spans();
+  ASSERT_EQ(spans.size(), 2);
+  ASSERT_EQ(span_status(spans[1]), "FAILED");
+
+  tracing::Shutdown();
+  std::filesystem::remove_all(log_dir);
+  RayConfig::instance().initialize(R"({"tracing_sample_ratio": 0})");
+}
+
 TEST_F(TaskManagerTest, TestTaskFailure) {
   rpc::Address caller_address;
   ObjectID dep1 = ObjectID::FromRandom();
@@ -0,0 +1,142 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/task_reply_coalescer.h"
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace core {
+
+class TaskReplyCoalescerTest : public ::testing::Test {
+ protected:
+  /// Wait for the replies of the caller, and return the number of times the request
+  /// has been replied.
+  std::shared_ptr<int> Wait(const WorkerID &caller_id,
+                            rpc::PushTaskBatchReply *reply) {
+    auto num_replied = std::make_shared<int>(0);
+    coalescer_.WaitForReplies(
+        caller_id,
+        reply->mutable_task_replies(),
+        [num_replied](Status status, std::function<void()>, std::function<void()>) {
+          ASSERT_TRUE(status.ok());
+          (*num_replied)++;
+        });
+    return num_replied;
+  }
+
+  TaskReplyCoalescer coalescer_;
+};
+
+TEST_F(TaskReplyCoalescerTest, TestReplyAsSoonAsTaskFinishes) {
+  const auto caller_id = WorkerID::FromRandom();
+  const auto task1 = TaskID::FromRandom(JobID::FromInt(1));
+  const auto task2 = TaskID::FromRandom(JobID::FromInt(1));
+  coalescer_.AddTask(caller_id, task1);
+  coalescer_.AddTask(caller_id, task2)->set_worker_exiting(true);
+  rpc::PushTaskBatchReply reply;
+  auto num_replied = Wait(caller_id, &reply);
+  ASSERT_EQ(*num_replied, 0);
+
+  // The request is replied once the second task finishes, without waiting for the
+  // first one.
+  coalescer_.ReplyTask(caller_id, task2, Status::OK());
+  ASSERT_EQ(*num_replied, 1);
+  ASSERT_EQ(reply.task_replies_size(), 1);
+  ASSERT_EQ(reply.task_replies(0).task_id(), task2.Binary());
+  ASSERT_EQ(reply.task_replies(0).status_code(), 0);
+  ASSERT_TRUE(reply.task_replies(0).reply().worker_exiting());
+
+  // The reply of the first task is returned by the next request.
+  coalescer_.ReplyTask(
+      caller_id, task1, Status::SchedulingCancelled("The task is cancelled."));
+  rpc::PushTaskBatchReply next_reply;
+  auto next_num_replied = Wait(caller_id, &next_reply);
+  ASSERT_EQ(*next_num_replied, 1);
+  ASSERT_EQ(next_reply.task_replies_size(), 1);
+  ASSERT_EQ(next_reply.task_replies(0).task_id(), task1.Binary());
+  ASSERT_EQ(static_cast<StatusCode>(next_reply.task_replies(0).status_code()),
+            StatusCode::SchedulingCancelled);
+  ASSERT_EQ(coalescer_.NumCallers(), 0);
+}
+
+TEST_F(TaskReplyCoalescerTest, TestCoalesceReplies) {
+  const auto caller_id = WorkerID::FromRandom();
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 3; i++) {
+    task_ids.push_back(TaskID::FromRandom(JobID::FromInt(1)));
+    coalescer_.AddTask(caller_id, task_ids.back());
+  }
+  // The replies are ready while no request is waiting, so they are returned together.
+  for (const auto &task_id : task_ids) {
+    coalescer_.ReplyTask(caller_id, task_id, Status::OK());
+  }
+  rpc::PushTaskBatchReply reply;
+  auto num_replied = Wait(caller_id, &reply);
+  ASSERT_EQ(*num_replied, 1);
+  ASSERT_EQ(reply.task_replies_size(), 3);
+  ASSERT_EQ(coalescer_.NumCallers(), 0);
+}
+
+TEST_F(TaskReplyCoalescerTest, TestOnlyLatestRequestWaits) {
+  const auto caller_id = WorkerID::FromRandom();
+  const auto task_id = TaskID::FromRandom(JobID::FromInt(1));
+  coalescer_.AddTask(caller_id, task_id);
+  rpc::PushTaskBatchReply reply1;
+  auto num_replied1 = Wait(caller_id, &reply1);
+  rpc::PushTaskBatchReply reply2;
+  auto num_replied2 = Wait(caller_id, &reply2);
+  // The earlier request is replied empty, and the later one waits for the task.
+  ASSERT_EQ(*num_replied1, 1);
+  ASSERT_EQ(reply1.task_replies_size(), 0);
+  ASSERT_EQ(*num_replied2, 0);
+  coalescer_.ReplyTask(caller_id, task_id, Status::OK());
+  ASSERT_EQ(*num_replied2, 1);
+  ASSERT_EQ(reply2.task_replies_size(), 1);
+
+  // A request without pending tasks is replied right away.
+  rpc::PushTaskBatchReply reply3;
+  auto num_replied3 = Wait(caller_id, &reply3);
+  ASSERT_EQ(*num_replied3, 1);
+  ASSERT_EQ(coalescer_.NumCallers(), 0);
+}
+
+TEST_F(TaskReplyCoalescerTest, TestCallersAreIndependent) {
+  const auto caller1 = WorkerID::FromRandom();
+  const auto caller2 = WorkerID::FromRandom();
+  const auto task1 = TaskID::FromRandom(JobID::FromInt(1));
+  const auto task2 = TaskID::FromRandom(JobID::FromInt(1));
+  coalescer_.AddTask(caller1, task1);
+  coalescer_.AddTask(caller2, task2);
+  rpc::PushTaskBatchReply reply1;
+  auto num_replied1 = Wait(caller1, &reply1);
+  rpc::PushTaskBatchReply reply2;
+  auto num_replied2 = Wait(caller2, &reply2);
+  ASSERT_EQ(coalescer_.NumCallers(), 2);
+
+  coalescer_.ReplyTask(caller2, task2, Status::OK());
+  ASSERT_EQ(*num_replied1, 0);
+  ASSERT_EQ(*num_replied2, 1);
+  coalescer_.ReplyTask(caller1, task1, Status::OK());
+  ASSERT_EQ(*num_replied1, 1);
+  ASSERT_EQ(coalescer_.NumCallers(), 0);
+}
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -50,13 +50,25 @@ const ray::FunctionDescriptor &InboundRequest::FunctionDescriptor() const {
 }
 void InboundRequest::MarkDependenciesSatisfied() { has_pending_dependencies_ = false; }
 
-DependencyWaiterImpl::DependencyWaiterImpl(DependencyWaiterInterface &dependency_client)
-    : dependency_client_(dependency_client) {}
+DependencyWaiterImpl::DependencyWaiterImpl(DependencyWaiterInterface &dependency_client,
+                                           ActorTaskArgPrefetcher *arg_prefetcher)
+    : dependency_client_(dependency_client), arg_prefetcher_(arg_prefetcher) {}
 
 void DependencyWaiterImpl::Wait(const std::vector<rpc::ObjectReference> &dependencies,
                                 std::function<void()> on_dependencies_available) {
   auto tag = next_request_id_++;
   requests_[tag] = on_dependencies_available;
+  if (arg_prefetcher_ != nullptr) {
+    // Added before the request is sent, since the completion may be received on
+    // another thread right after.
+    std::vector<ObjectID> object_ids;
+    object_ids.reserve(dependencies.size());
+    for (const auto &dependency : dependencies) {
+      object_ids.push_back(ObjectID::FromBinary(dependency.object_id()));
+    }
+    absl::MutexLock lock(&mutex_);
+    dependencies_to_prefetch_.emplace(tag, std::move(object_ids));
+  }
   RAY_CHECK_OK(dependency_client_.WaitForDirectActorCallArgs(dependencies, tag));
 }
 
@@ -66,6 +78,27 @@ void DependencyWaiterImpl::OnWaitComplete(int64_t tag) {
   RAY_CHECK(it != requests_.end());
   it->second();
   requests_.erase(it);
+  if (arg_prefetcher_ != nullptr) {
+    absl::MutexLock lock(&mutex_);
+    dependencies_to_prefetch_.erase(tag);
+  }
+}
+
+void DependencyWaiterImpl::PrefetchDependencies(int64_t tag) {
+  if (arg_prefetcher_ == nullptr) {
+    return;
+  }
+  std::vector<ObjectID> object_ids;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = dependencies_to_prefetch_.find(tag);
+    if (it == dependencies_to_prefetch_.end()) {
+      return;
+    }
+    object_ids = std::move(it->second);
+    dependencies_to_prefetch_.erase(it);
+  }
+  arg_prefetcher_->Prefetch(object_ids);
 }
 }  // namespace core
 }  // namespace ray
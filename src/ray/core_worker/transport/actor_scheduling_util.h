@@ -14,8 +14,11 @@
 
 #pragma once
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task_spec.h"
+#include "ray/core_worker/transport/actor_task_arg_prefetcher.h"
 #include "ray/raylet_client/raylet_client.h"
 #include "ray/rpc/server_call.h"
 #include "src/ray/protobuf/core_worker.pb.h"
@@ -67,7 +70,11 @@ class DependencyWaiter {
 
 class DependencyWaiterImpl : public DependencyWaiter {
  public:
-  DependencyWaiterImpl(DependencyWaiterInterface &dependency_client);
+  /// \param dependency_client The client to wait for the dependencies with.
+  /// \param arg_prefetcher If not null, the dependencies are prefetched as soon as
+  /// they're available, see PrefetchDependencies.
+  DependencyWaiterImpl(DependencyWaiterInterface &dependency_client,
+                       ActorTaskArgPrefetcher *arg_prefetcher = nullptr);
 
   void Wait(const std::vector<rpc::ObjectReference> &dependencies,
             std::function<void()> on_dependencies_available) override;
@@ -75,10 +82,21 @@ class DependencyWaiterImpl : public DependencyWaiter {
   /// Fulfills the callback stored by Wait().
   void OnWaitComplete(int64_t tag);
 
+  /// Prefetch the dependencies of the request, which are available now. This is called
+  /// when the wait completes, before the callback is posted to the thread executing
+  /// the tasks, so that the dependencies of the queued tasks are prefetched while the
+  /// earlier tasks execute. This method is thread-safe.
+  void PrefetchDependencies(int64_t tag);
+
  private:
   int64_t next_request_id_ = 0;
   absl::flat_hash_map<int64_t, std::function<void()>> requests_;
   DependencyWaiterInterface &dependency_client_;
+  ActorTaskArgPrefetcher *const arg_prefetcher_;
+  absl::Mutex mutex_;
+  /// The dependencies of the requests to prefetch once they're available.
+  absl::flat_hash_map<int64_t, std::vector<ObjectID>> dependencies_to_prefetch_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace core
@@ -0,0 +1,174 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/actor_task_arg_prefetcher.h"
+
+#include <algorithm>
+
+namespace ray {
+namespace core {
+
+ActorTaskArgPrefetcher::ActorTaskArgPrefetcher(int64_t max_tasks,
+                                               int64_t max_bytes,
+                                               GetObjectsCallback get_objects)
+    : max_tasks_(max_tasks),
+      max_bytes_(max_bytes),
+      get_objects_(std::move(get_objects)),
+      executor_(/*max_concurrency=*/1) {}
+
+ActorTaskArgPrefetcher::~ActorTaskArgPrefetcher() { Stop(); }
+
+void ActorTaskArgPrefetcher::Prefetch(const std::vector<ObjectID> &object_ids) {
+  int64_t task_index;
+  absl::flat_hash_set<ObjectID> ids_to_fetch;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (stopped_ || static_cast<int64_t>(num_objects_per_task_.size()) >= max_tasks_ ||
+        num_bytes_ >= max_bytes_) {
+      return;
+    }
+    task_index = next_task_index_++;
+    for (const auto &object_id : object_ids) {
+      if (fetching_objects_.contains(object_id) ||
+          prefetched_objects_.contains(object_id)) {
+        continue;
+      }
+      ids_to_fetch.insert(object_id);
+      fetching_objects_.emplace(object_id, task_index);
+    }
+    if (ids_to_fetch.empty()) {
+      return;
+    }
+    num_objects_per_task_[task_index] = ids_to_fetch.size();
+  }
+  executor_.Post([this, task_index, ids_to_fetch = std::move(ids_to_fetch)]() {
+    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results;
+    auto status = get_objects_(ids_to_fetch, &results);
+    if (!status.ok()) {
+      RAY_LOG(DEBUG) << "Failed to prefetch the arguments of an actor task: " << status;
+      results.clear();
+    }
+    OnObjectsFetched(task_index, ids_to_fetch, std::move(results));
+  });
+}
+
+void ActorTaskArgPrefetcher::OnObjectsFetched(
+    int64_t task_index,
+    const absl::flat_hash_set<ObjectID> &object_ids,
+    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto &object_id : object_ids) {
+    auto it = fetching_objects_.find(object_id);
+    if (it == fetching_objects_.end() || it->second != task_index) {
+      // The object has been taken while it was being fetched.
+      continue;
+    }
+    fetching_objects_.erase(it);
+    auto result_it = results.find(object_id);
+    if (result_it == results.end() || result_it->second == nullptr ||
+        num_bytes_ + static_cast<int64_t>(result_it->second->GetSize()) > max_bytes_) {
+      // The object isn't local, or it doesn't fit in the budget. The task gets it when
+      // it starts.
+      ReleaseObject(task_index);
+      continue;
+    }
+    num_bytes_ += result_it->second->GetSize();
+    prefetched_objects_.emplace(
+        object_id, PrefetchedObject{std::move(result_it->second), task_index});
+  }
+}
+
+void ActorTaskArgPrefetcher::Take(
+    absl::flat_hash_set<ObjectID> *object_ids,
+    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> *results) {
+  absl::MutexLock lock(&mutex_);
+  if (fetching_objects_.empty() && prefetched_objects_.empty()) {
+    return;
+  }
+  int64_t max_task_index = -1;
+  for (auto id_it = object_ids->begin(); id_it != object_ids->end();) {
+    auto fetching_it = fetching_objects_.find(*id_it);
+    if (fetching_it != fetching_objects_.end()) {
+      ReleaseObject(fetching_it->second);
+      fetching_objects_.erase(fetching_it);
+      id_it++;
+      continue;
+    }
+    auto prefetched_it = prefetched_objects_.find(*id_it);
+    if (prefetched_it == prefetched_objects_.end()) {
+      id_it++;
+      continue;
+    }
+    auto &prefetched = prefetched_it->second;
+    max_task_index = std::max(max_task_index, prefetched.task_index);
+    num_bytes_ -= prefetched.object->GetSize();
+    ReleaseObject(prefetched.task_index);
+    results->emplace(*id_it, std::move(prefetched.object));
+    prefetched_objects_.erase(prefetched_it);
+    object_ids->erase(id_it++);
+  }
+  if (max_task_index >= 0) {
+    DropStaleObjects(max_task_index);
+  }
+}
+
+void ActorTaskArgPrefetcher::ReleaseObject(int64_t task_index) {
+  auto it = num_objects_per_task_.find(task_index);
+  RAY_CHECK(it != num_objects_per_task_.end());
+  if (--it->second == 0) {
+    num_objects_per_task_.erase(it);
+  }
+}
+
+void ActorTaskArgPrefetcher::DropStaleObjects(int64_t task_index) {
+  for (auto it = prefetched_objects_.begin(); it != prefetched_objects_.end();) {
+    if (it->second.task_index < task_index - max_tasks_) {
+      num_bytes_ -= it->second.object->GetSize();
+      ReleaseObject(it->second.task_index);
+      prefetched_objects_.erase(it++);
+    } else {
+      it++;
+    }
+  }
+}
+
+void ActorTaskArgPrefetcher::Stop() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  executor_.Stop();
+  executor_.Join();
+  absl::MutexLock lock(&mutex_);
+  fetching_objects_.clear();
+  prefetched_objects_.clear();
+  num_objects_per_task_.clear();
+  num_bytes_ = 0;
+}
+
+size_t ActorTaskArgPrefetcher::NumTasks() const {
+  absl::MutexLock lock(&mutex_);
+  return num_objects_per_task_.size();
+}
+
+int64_t ActorTaskArgPrefetcher::NumBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return num_bytes_;
+}
+
+}  // namespace core
+}  // namespace ray
@@ -0,0 +1,142 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/id.h"
+#include "ray/common/ray_object.h"
+#include "ray/common/status.h"
+#include "ray/core_worker/transport/thread_pool.h"
+
+namespace ray {
+namespace core {
+
+/// Gets and pins the plasma arguments of queued actor tasks in the background.
+///
+/// The raylet pulls the arguments of an actor task as soon as the task is queued, but
+/// the task only gets them from plasma when it starts to execute, on the thread which
+/// executes the actor tasks. Once the arguments are local, they are prefetched on a
+/// separate thread, so that the previous tasks keep executing meanwhile, and the task
+/// takes them when it starts.
+///
+/// The prefetched objects are bounded by the number of tasks and the total size. The
+/// size is checked as the objects are fetched, and the objects which don't fit are
+/// released right away. The objects which aren't taken, e.g. because the task was
+/// cancelled, are dropped once the tasks prefetched more than max_tasks tasks after
+/// them have taken theirs.
+///
+/// This class is thread-safe.
+class ActorTaskArgPrefetcher {
+ public:
+  using GetObjectsCallback = std::function<Status(
+      const absl::flat_hash_set<ObjectID> &object_ids,
+      absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> *results)>;
+
+  /// Create the prefetcher.
+  ///
+  /// \param max_tasks The maximum number of tasks whose arguments are being fetched or
+  /// have been prefetched.
+  /// \param max_bytes The maximum total size of the prefetched objects.
+  /// \param get_objects Gets the local objects from plasma without blocking, and
+  /// without the side effects of a get of the worker, e.g. notifying the raylet that the
+  /// worker is blocked. It's called on the prefetching thread.
+  ActorTaskArgPrefetcher(int64_t max_tasks,
+                         int64_t max_bytes,
+                         GetObjectsCallback get_objects);
+
+  ~ActorTaskArgPrefetcher();
+
+  /// Prefetch the arguments of a queued task, which are local. This is a no-op if the
+  /// bounds are reached.
+  void Prefetch(const std::vector<ObjectID> &object_ids);
+
+  /// Take the prefetched objects of a task which starts to execute.
+  ///
+  /// \param[in,out] object_ids The arguments of the task. The ones which have been
+  /// prefetched are removed, and the task has to get the rest.
+  /// \param[out] results The prefetched objects.
+  void Take(absl::flat_hash_set<ObjectID> *object_ids,
+            absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> *results);
+
+  /// Stop the prefetching thread. Nothing is prefetched after this.
+  void Stop();
+
+  /// Get the number of tasks whose arguments are being fetched or have been prefetched.
+  size_t NumTasks() const;
+
+  /// Get the total size of the prefetched objects.
+  int64_t NumBytes() const;
+
+ private:
+  struct PrefetchedObject {
+    std::shared_ptr<RayObject> object;
+    /// The index of the task that prefetched the object.
+    int64_t task_index;
+  };
+
+  /// Add the fetched arguments of a task.
+  void OnObjectsFetched(
+      int64_t task_index,
+      const absl::flat_hash_set<ObjectID> &object_ids,
+      absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> results);
+
+  /// Remove an object of a task from the count of the task.
+  void ReleaseObject(int64_t task_index) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Drop the objects of the tasks prefetched more than max_tasks tasks before the
+  /// given task, which won't be taken.
+  void DropStaleObjects(int64_t task_index) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int64_t max_tasks_;
+
+  const int64_t max_bytes_;
+
+  const GetObjectsCallback get_objects_;
+
+  mutable absl::Mutex mutex_;
+
+  /// The index of the next prefetched task.
+  int64_t next_task_index_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// Whether Stop has been called.
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /// The objects being fetched, and the indices of their tasks. An object which is
+  /// taken while it's being fetched is removed, so it's not kept when it's fetched.
+  absl::flat_hash_map<ObjectID, int64_t> fetching_objects_ ABSL_GUARDED_BY(mutex_);
+
+  /// The prefetched objects which haven't been taken.
+  absl::flat_hash_map<ObjectID, PrefetchedObject> prefetched_objects_
+      ABSL_GUARDED_BY(mutex_);
+
+  /// The number of fetching and prefetched objects of every task.
+  absl::flat_hash_map<int64_t, size_t> num_objects_per_task_ ABSL_GUARDED_BY(mutex_);
+
+  /// The total size of the prefetched objects.
+  int64_t num_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// The thread to get the objects on.
+  BoundedExecutor executor_;
+};
+
+}  // namespace core
+}  // namespace ray
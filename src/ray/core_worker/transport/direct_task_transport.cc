@@ -14,6 +14,7 @@
 
 #include "ray/core_worker/transport/direct_task_transport.h"
 
+#include "ray/common/task/task_util.h"
 #include "ray/core_worker/transport/dependency_resolver.h"
 #include "ray/gcs/pb_util.h"
 #include "ray/stats/metric_defs.h"
@@ -218,14 +219,26 @@ void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
 
     // Return the worker only if there are no tasks to do.
     if (!lease_entry.is_busy) {
-      ReturnWorker(addr, was_error, error_detail, worker_exiting, scheduling_key);
+      absl::optional<LeaseShape> lease_shape;
+      if (lease_reuse_across_scheduling_keys_ && !was_error && !worker_exiting &&
+          current_time_ms() <= lease_entry.lease_expiration_time) {
+        lease_shape = GetLeaseShape(scheduling_key);
+      }
+      if (lease_shape.has_value()) {
+        // Keep the lease for the other scheduling keys of the same shape.
+        scheduling_key_entry.active_workers.erase(addr);
+        if (scheduling_key_entry.CanDelete()) {
+          scheduling_key_entries_.erase(scheduling_key);
+        }
+        PoolIdleLease(addr, *lease_shape);
+      } else {
+        ReturnWorker(addr, was_error, error_detail, worker_exiting, scheduling_key);
+      }
     }
   } else {
     auto client = client_cache_->GetOrConnect(addr);
 
     while (!current_queue.empty() && !lease_entry.is_busy) {
-      auto task_spec = current_queue.front();
-
       lease_entry.is_busy = true;
 
       // Increment the total number of tasks in flight to any worker associated with the
@@ -234,12 +247,23 @@ void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
       RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
       scheduling_key_entry.num_busy_workers++;
 
-      task_spec.GetMutableMessage().set_lease_grant_timestamp_ms(current_sys_time_ms());
-      task_spec.EmitTaskMetrics();
-
-      executing_tasks_.emplace(task_spec.TaskId(), addr);
-      PushNormalTask(addr, client, scheduling_key, task_spec, assigned_resources);
-      current_queue.pop_front();
+      const size_t batch_size = GetPushBatchSize(scheduling_key_entry);
+      std::vector<TaskSpecification> task_specs;
+      task_specs.reserve(batch_size);
+      for (size_t i = 0; i < batch_size; i++) {
+        auto task_spec = current_queue.front();
+        task_spec.GetMutableMessage().set_lease_grant_timestamp_ms(current_sys_time_ms());
+        task_spec.EmitTaskMetrics();
+        executing_tasks_.emplace(task_spec.TaskId(), addr);
+        task_specs.push_back(std::move(task_spec));
+        current_queue.pop_front();
+      }
+      if (task_specs.size() == 1) {
+        PushNormalTask(addr, client, scheduling_key, task_specs[0], assigned_resources);
+      } else {
+        PushNormalTaskBatch(
+            addr, client, scheduling_key, std::move(task_specs), assigned_resources);
+      }
     }
 
     CancelWorkerLeaseIfNeeded(scheduling_key);
@@ -247,6 +271,167 @@ void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
   RequestNewWorkerIfNeeded(scheduling_key);
 }
 
+absl::optional<CoreWorkerDirectTaskSubmitter::LeaseShape>
+CoreWorkerDirectTaskSubmitter::GetLeaseShape(const SchedulingKey &scheduling_key) {
+  if (!std::get<2>(scheduling_key).IsNil()) {
+    // Actor creation leases are bound to the actor.
+    return absl::nullopt;
+  }
+  const SchedulingClass scheduling_class = std::get<0>(scheduling_key);
+  auto it = lease_shape_classes_.find(scheduling_class);
+  if (it == lease_shape_classes_.end()) {
+    const auto &descriptor =
+        TaskSpecification::GetSchedulingClassDescriptor(scheduling_class);
+    const SchedulingClass lease_shape_class =
+        TaskSpecification::GetSchedulingClass(SchedulingClassDescriptor(
+            descriptor.resource_set,
+            FunctionDescriptorBuilder::Empty(),
+            /*depth=*/0,
+            descriptor.scheduling_strategy));
+    it = lease_shape_classes_.emplace(scheduling_class, lease_shape_class).first;
+  }
+  return LeaseShape(it->second, std::get<3>(scheduling_key));
+}
+
+void CoreWorkerDirectTaskSubmitter::PoolIdleLease(const rpc::Address &addr,
+                                                  const LeaseShape &lease_shape) {
+  RAY_LOG(DEBUG) << "Keeping idle worker " << WorkerID::FromBinary(addr.worker_id())
+                 << " for the other scheduling keys of its lease shape";
+  idle_leases_[lease_shape].push_back(addr);
+
+  std::vector<SchedulingKey> waiting_scheduling_keys;
+  for (const auto &[scheduling_key, scheduling_key_entry] : scheduling_key_entries_) {
+    if (!scheduling_key_entry.task_queue.empty() &&
+        GetLeaseShape(scheduling_key) == lease_shape) {
+      waiting_scheduling_keys.push_back(scheduling_key);
+    }
+  }
+  for (const auto &scheduling_key : waiting_scheduling_keys) {
+    if (!idle_leases_.contains(lease_shape)) {
+      break;
+    }
+    TryReuseIdleLease(scheduling_key);
+  }
+}
+
+bool CoreWorkerDirectTaskSubmitter::TryReuseIdleLease(
+    const SchedulingKey &scheduling_key) {
+  if (idle_leases_.empty()) {
+    return false;
+  }
+  auto entry_it = scheduling_key_entries_.find(scheduling_key);
+  if (entry_it == scheduling_key_entries_.end() ||
+      entry_it->second.task_queue.empty() || !entry_it->second.AllWorkersBusy()) {
+    return false;
+  }
+  const auto lease_shape = GetLeaseShape(scheduling_key);
+  if (!lease_shape.has_value()) {
+    return false;
+  }
+  auto pool_it = idle_leases_.find(*lease_shape);
+  if (pool_it == idle_leases_.end()) {
+    return false;
+  }
+
+  absl::optional<rpc::Address> addr;
+  const int64_t now = current_time_ms();
+  auto &idle_workers = pool_it->second;
+  while (!addr.has_value() && !idle_workers.empty()) {
+    const rpc::Address idle_worker = std::move(idle_workers.back());
+    idle_workers.pop_back();
+    if (now > worker_to_lease_entry_[idle_worker].lease_expiration_time) {
+      ReturnIdleLease(idle_worker);
+    } else {
+      addr = idle_worker;
+    }
+  }
+  if (idle_workers.empty()) {
+    idle_leases_.erase(pool_it);
+  }
+  if (!addr.has_value()) {
+    return false;
+  }
+
+  RAY_LOG(DEBUG) << "Reusing the lease of idle worker "
+                 << WorkerID::FromBinary(addr->worker_id()) << " for scheduling class "
+                 << std::get<0>(scheduling_key);
+  num_leases_reused_++;
+  ray::stats::STATS_worker_lease_reuse_total.Record(1, "Hit");
+  auto &lease_entry = worker_to_lease_entry_[*addr];
+  lease_entry.scheduling_key = scheduling_key;
+  RAY_CHECK(entry_it->second.active_workers.emplace(*addr).second);
+  OnWorkerIdle(*addr,
+               scheduling_key,
+               /*was_error=*/false,
+               /*error_detail*/ "",
+               /*worker_exiting=*/false,
+               lease_entry.assigned_resources);
+  return true;
+}
+
+void CoreWorkerDirectTaskSubmitter::ReturnIdleLease(const rpc::Address &addr) {
+  RAY_LOG(DEBUG) << "Returning idle worker " << WorkerID::FromBinary(addr.worker_id())
+                 << " to raylet " << NodeID::FromBinary(addr.raylet_id());
+  auto it = worker_to_lease_entry_.find(addr);
+  RAY_CHECK(it != worker_to_lease_entry_.end());
+  auto status =
+      it->second.lease_client->ReturnWorker(addr.port(),
+                                            WorkerID::FromBinary(addr.worker_id()),
+                                            /*disconnect_worker=*/false,
+                                            /*disconnect_worker_error_detail=*/"",
+                                            /*worker_exiting=*/false);
+  if (!status.ok()) {
+    RAY_LOG(ERROR) << "Error returning worker to raylet: " << status.ToString();
+  }
+  worker_to_lease_entry_.erase(it);
+}
+
+void CoreWorkerDirectTaskSubmitter::ReturnExpiredIdleLeases() {
+  absl::MutexLock lock(&mu_);
+  const int64_t now = current_time_ms();
+  for (auto it = idle_leases_.begin(); it != idle_leases_.end();) {
+    std::vector<rpc::Address> unexpired_workers;
+    for (auto &idle_worker : it->second) {
+      if (now > worker_to_lease_entry_[idle_worker].lease_expiration_time) {
+        ReturnIdleLease(idle_worker);
+      } else {
+        unexpired_workers.push_back(std::move(idle_worker));
+      }
+    }
+    if (unexpired_workers.empty()) {
+      idle_leases_.erase(it++);
+    } else {
+      it->second = std::move(unexpired_workers);
+      it++;
+    }
+  }
+}
+
+size_t CoreWorkerDirectTaskSubmitter::GetPushBatchSize(
+    const SchedulingKeyEntry &scheduling_key_entry) const {
+  const auto &task_queue = scheduling_key_entry.task_queue;
+  if (max_tasks_per_push_batch_ <= 1 || task_queue.front().IsActorCreationTask()) {
+    return 1;
+  }
+  // Split the queued tasks evenly among the idle workers, including the one being
+  // assigned, so that batching never leaves a leased worker without tasks.
+  const size_t num_idle_workers = scheduling_key_entry.active_workers.size() -
+                                  scheduling_key_entry.num_busy_workers + 1;
+  const size_t tasks_per_worker =
+      (task_queue.size() + num_idle_workers - 1) / num_idle_workers;
+  return std::min(tasks_per_worker, max_tasks_per_push_batch_);
+}
+
+size_t CoreWorkerDirectTaskSubmitter::GetNumWorkersToLease(
+    const SchedulingKeyEntry &scheduling_key_entry) const {
+  if (max_workers_per_lease_request_ <= 1 ||
+      scheduling_key_entry.resource_spec.IsActorCreationTask()) {
+    return 1;
+  }
+  return std::clamp<size_t>(
+      scheduling_key_entry.BacklogSize(), 1, max_workers_per_lease_request_);
+}
+
 void CoreWorkerDirectTaskSubmitter::CancelWorkerLeaseIfNeeded(
     const SchedulingKey &scheduling_key) {
   auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
@@ -352,6 +537,11 @@ void CoreWorkerDirectTaskSubmitter::ReportWorkerBacklogIfNeeded(
 
 void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
     const SchedulingKey &scheduling_key, const rpc::Address *raylet_address) {
+  if (TryReuseIdleLease(scheduling_key)) {
+    // The reused worker requests more workers for the scheduling key if needed.
+    return;
+  }
+
   auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
 
   const size_t kMaxPendingLeaseRequestsPerSchedulingCategory =
@@ -378,12 +568,15 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
     }
     return;
   } else if (scheduling_key_entry.task_queue.size() <=
-             scheduling_key_entry.pending_lease_requests.size()) {
+             scheduling_key_entry.num_pending_lease_workers) {
     // All tasks have corresponding pending leases, no need to request more
     return;
   }
 
   num_leases_requested_++;
+  if (lease_reuse_across_scheduling_keys_) {
+    ray::stats::STATS_worker_lease_reuse_total.Record(1, "Miss");
+  }
   // Create a TaskSpecification with an overwritten TaskID to make sure we don't reuse the
   // same TaskID to request a worker
   auto resource_spec_msg = scheduling_key_entry.resource_spec.GetMutableMessage();
@@ -402,10 +595,12 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
   auto lease_client = GetOrConnectLeaseClient(raylet_address);
   const TaskID task_id = resource_spec.TaskId();
   const std::string task_name = resource_spec.GetName();
-  RAY_LOG(DEBUG) << "Requesting lease from raylet "
+  const size_t num_workers = GetNumWorkersToLease(scheduling_key_entry);
+  RAY_LOG(DEBUG) << "Requesting lease of " << num_workers << " workers from raylet "
                  << NodeID::FromBinary(raylet_address->raylet_id()) << " for task "
                  << task_id;
 
+  const int64_t request_start_time_ms = current_time_ms();
   lease_client->RequestWorkerLease(
       resource_spec.GetMessage(),
       /*grant_or_reject=*/is_spillback,
@@ -414,8 +609,27 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
        task_id,
        task_name,
        is_spillback,
+       num_workers,
+       request_start_time_ms,
        raylet_address = *raylet_address](const Status &status,
                                          const rpc::RequestWorkerLeaseReply &reply) {
+        using LeaseOutcome = LeaseRequestRateLimiter::LeaseOutcome;
+        LeaseOutcome outcome = LeaseOutcome::kFailed;
+        if (status.ok()) {
+          if (reply.canceled()) {
+            outcome = LeaseOutcome::kCanceled;
+          } else if (reply.rejected()) {
+            outcome = LeaseOutcome::kRejected;
+          } else if (!reply.worker_address().raylet_id().empty()) {
+            outcome = LeaseOutcome::kGranted;
+          } else {
+            outcome = LeaseOutcome::kSpilledBack;
+          }
+        }
+        // Report before requesting more leases below, so that they use the new limit.
+        lease_request_rate_limiter_->OnLeaseReply(
+            outcome, current_time_ms() - request_start_time_ms);
+
         std::deque<TaskSpecification> tasks_to_fail;
         rpc::RayErrorInfo error_info;
         ray::Status error_status;
@@ -426,6 +640,22 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
           auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
           auto lease_client = GetOrConnectLeaseClient(&raylet_address);
           scheduling_key_entry.pending_lease_requests.erase(task_id);
+          scheduling_key_entry.num_pending_lease_workers -= num_workers;
+          // The additional workers are granted regardless of the first one.
+          for (const auto &additional_lease : reply.additional_leases()) {
+            RAY_LOG(DEBUG) << "Additional lease granted with task " << task_id
+                           << " from raylet "
+                           << NodeID::FromBinary(
+                                  additional_lease.worker_address().raylet_id())
+                           << " with worker "
+                           << WorkerID::FromBinary(
+                                  additional_lease.worker_address().worker_id());
+            AddWorkerLeaseClient(additional_lease.worker_address(),
+                                 lease_client,
+                                 additional_lease.resource_mapping(),
+                                 scheduling_key,
+                                 TaskID::FromBinary(additional_lease.task_id()));
+          }
 
           if (status.ok()) {
             if (reply.canceled()) {
@@ -564,6 +794,17 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
               RequestNewWorkerIfNeeded(scheduling_key);
             }
           }
+
+          // Assign tasks to the additional workers after handling the first one, which
+          // doesn't lease more workers since these are still idle.
+          for (const auto &additional_lease : reply.additional_leases()) {
+            OnWorkerIdle(additional_lease.worker_address(),
+                         scheduling_key,
+                         /*error=*/false,
+                         /*error_detail*/ "",
+                         /*worker_exiting=*/false,
+                         additional_lease.resource_mapping());
+          }
         }
         error_info.set_error_type(error_type);
         while (!tasks_to_fail.empty()) {
@@ -583,14 +824,16 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
         }
       },
       task_queue.size(),
-      is_selected_based_on_locality);
+      is_selected_based_on_locality,
+      num_workers);
   scheduling_key_entry.pending_lease_requests.emplace(task_id, *raylet_address);
+  scheduling_key_entry.num_pending_lease_workers += num_workers;
   ReportWorkerBacklogIfNeeded(scheduling_key);
 
   // Lease more workers if there are still pending tasks and
   // and we haven't hit the max_pending_lease_requests yet.
   if (scheduling_key_entry.task_queue.size() >
-          scheduling_key_entry.pending_lease_requests.size() &&
+          scheduling_key_entry.num_pending_lease_workers &&
       scheduling_key_entry.pending_lease_requests.size() <
           kMaxPendingLeaseRequestsPerSchedulingCategory) {
     RequestNewWorkerIfNeeded(scheduling_key);
@@ -608,24 +851,14 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
                  << NodeID::FromBinary(addr.raylet_id());
   auto task_id = task_spec.TaskId();
   auto request = std::make_unique<rpc::PushTaskRequest>();
-  bool is_actor = task_spec.IsActorTask();
   bool is_actor_creation = task_spec.IsActorCreationTask();
 
-  // NOTE(swang): CopyFrom is needed because if we use Swap here and the task
-  // fails, then the task data will be gone when the TaskManager attempts to
-  // access the task.
-  request->mutable_task_spec()->CopyFrom(task_spec.GetMessage());
-  request->mutable_resource_mapping()->CopyFrom(assigned_resources);
-  request->set_intended_worker_id(addr.worker_id());
-  task_finisher_->MarkTaskWaitingForExecution(task_id,
-                                              NodeID::FromBinary(addr.raylet_id()),
-                                              WorkerID::FromBinary(addr.worker_id()));
+  FillPushTaskRequest(addr, task_spec, assigned_resources, request.get());
   client->PushNormalTask(
       std::move(request),
       [this,
        task_spec,
        task_id,
-       is_actor,
        is_actor_creation,
        scheduling_key,
        addr,
@@ -635,7 +868,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
                          << WorkerID::FromBinary(addr.worker_id()) << " of raylet "
                          << NodeID::FromBinary(addr.raylet_id());
           absl::MutexLock lock(&mu_);
-          executing_tasks_.erase(task_id);
+          OnPushedTaskDone(status, task_spec, addr);
 
           // Decrement the number of tasks in flight to the worker
           auto &lease_entry = worker_to_lease_entry_[addr];
@@ -649,24 +882,6 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
           RAY_CHECK_GE(scheduling_key_entry.num_busy_workers, 1u);
           scheduling_key_entry.num_busy_workers--;
 
-          if (!status.ok()) {
-            RAY_LOG(DEBUG) << "Getting error from raylet for task " << task_id;
-            const ray::rpc::ClientCallback<ray::rpc::GetTaskFailureCauseReply> callback =
-                [this, status, is_actor, task_id, addr](
-                    const Status &get_task_failure_cause_reply_status,
-                    const rpc::GetTaskFailureCauseReply &get_task_failure_cause_reply) {
-                  HandleGetTaskFailureCause(status,
-                                            is_actor,
-                                            task_id,
-                                            addr,
-                                            get_task_failure_cause_reply_status,
-                                            get_task_failure_cause_reply);
-                };
-            auto &lease_entry = worker_to_lease_entry_[addr];
-            RAY_CHECK(lease_entry.lease_client);
-            lease_entry.lease_client->GetTaskFailureCause(lease_entry.task_id, callback);
-          }
-
           if (!status.ok() || !is_actor_creation || reply.worker_exiting()) {
             bool was_error = !status.ok();
             bool is_worker_exiting = reply.worker_exiting();
@@ -680,24 +895,215 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
           }
         }
         if (status.ok()) {
-          if (reply.was_cancelled_before_running()) {
-            RAY_LOG(DEBUG) << "Task " << task_id
-                           << " was cancelled before it started running.";
-            RAY_UNUSED(
-                task_finisher_->FailPendingTask(task_id, rpc::ErrorType::TASK_CANCELLED));
-          } else if (!task_spec.GetMessage().retry_exceptions() ||
-                     !reply.is_retryable_error() ||
-                     !task_finisher_->RetryTaskIfPossible(
-                         task_id,
-                         gcs::GetRayErrorInfo(rpc::ErrorType::TASK_EXECUTION_EXCEPTION,
-                                              reply.task_execution_error()))) {
-            task_finisher_->CompletePendingTask(
-                task_id, reply, addr, reply.is_application_error());
+          HandlePushTaskReply(task_spec, reply, addr);
+        }
+      });
+}
+
+void CoreWorkerDirectTaskSubmitter::PushNormalTaskBatch(
+    const rpc::Address &addr,
+    shared_ptr<rpc::CoreWorkerClientInterface> client,
+    const SchedulingKey &scheduling_key,
+    std::vector<TaskSpecification> task_specs,
+    const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources) {
+  RAY_LOG(DEBUG) << "Pushing " << task_specs.size() << " tasks to worker "
+                 << WorkerID::FromBinary(addr.worker_id()) << " of raylet "
+                 << NodeID::FromBinary(addr.raylet_id());
+  auto request = std::make_unique<rpc::PushTaskBatchRequest>();
+  // The indexes of the templates in the request, so that the fields shared by the
+  // tasks built from the same template are only sent once.
+  absl::flat_hash_map<const rpc::TaskSpec *, int> template_indexes;
+  for (const auto &task_spec : task_specs) {
+    auto *task_request = request->add_requests();
+    FillPushTaskRequest(addr, task_spec, assigned_resources, task_request);
+    const auto &task_spec_template = task_spec.Template();
+    if (task_spec_template == nullptr) {
+      continue;
+    }
+    const int next_index = request->task_spec_templates_size() + 1;
+    auto [it, inserted] = template_indexes.emplace(task_spec_template.get(), next_index);
+    if (inserted) {
+      request->add_task_spec_templates()->CopyFrom(*task_spec_template);
+    }
+    ClearTaskSpecTemplateFields(task_request->mutable_task_spec());
+    task_request->set_task_spec_template_index(it->second);
+  }
+  auto batch = std::make_shared<PushedTaskBatch>();
+  for (size_t i = 0; i < task_specs.size(); i++) {
+    batch->pending_tasks.emplace(task_specs[i].TaskId(), i);
+  }
+  batch->task_specs = std::move(task_specs);
+  SendPushTaskBatch(
+      addr, client, scheduling_key, std::move(request), batch, assigned_resources);
+}
+
+void CoreWorkerDirectTaskSubmitter::SendPushTaskBatch(
+    const rpc::Address &addr,
+    shared_ptr<rpc::CoreWorkerClientInterface> client,
+    const SchedulingKey &scheduling_key,
+    std::unique_ptr<rpc::PushTaskBatchRequest> request,
+    std::shared_ptr<PushedTaskBatch> batch,
+    const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources) {
+  request->set_intended_worker_id(addr.worker_id());
+  request->set_caller_worker_id(rpc_address_.worker_id());
+  client->PushNormalTaskBatch(
+      std::move(request),
+      [this, client, batch, scheduling_key, addr, assigned_resources](
+          Status status, const rpc::PushTaskBatchReply &reply) {
+        std::vector<std::pair<size_t, const rpc::PushTaskReply *>> replied_tasks;
+        {
+          RAY_LOG(DEBUG) << reply.task_replies_size() << " tasks of a batch finished "
+                         << "from worker " << WorkerID::FromBinary(addr.worker_id())
+                         << " of raylet " << NodeID::FromBinary(addr.raylet_id());
+          absl::MutexLock lock(&mu_);
+          auto &task_specs = batch->task_specs;
+          auto &pending_tasks = batch->pending_tasks;
+          // Every task is replied once, and the worker only replies without any task
+          // if it has none of the caller's tasks left.
+          bool unexpected_reply = status.ok() && reply.task_replies_size() == 0;
+          for (const auto &task_reply : reply.task_replies()) {
+            auto it = pending_tasks.find(TaskID::FromBinary(task_reply.task_id()));
+            if (it == pending_tasks.end()) {
+              unexpected_reply = true;
+              continue;
+            }
+            const size_t i = it->second;
+            pending_tasks.erase(it);
+            const auto task_status = Status::FromCode(
+                static_cast<StatusCode>(task_reply.status_code()),
+                task_reply.status_message());
+            OnPushedTaskDone(task_status, task_specs[i], addr);
+            if (!task_status.ok()) {
+              batch->worker_status = task_status;
+            } else {
+              replied_tasks.emplace_back(i, &task_reply.reply());
+            }
+            batch->worker_exiting |= task_reply.reply().worker_exiting();
+          }
+          if (!pending_tasks.empty() && batch->worker_exiting) {
+            // The worker exited before executing the rest of the tasks, so push them
+            // again unless they're being cancelled.
+            std::vector<size_t> not_executed_tasks;
+            for (const auto &[task_id, i] : pending_tasks) {
+              executing_tasks_.erase(task_id);
+              if (cancelled_tasks_.contains(task_id)) {
+                RAY_UNUSED(task_finisher_->FailPendingTask(
+                    task_id, rpc::ErrorType::TASK_CANCELLED));
+              } else {
+                not_executed_tasks.push_back(i);
+              }
+            }
+            pending_tasks.clear();
+            std::sort(not_executed_tasks.begin(), not_executed_tasks.end());
+            auto &task_queue = scheduling_key_entries_[scheduling_key].task_queue;
+            for (auto it = not_executed_tasks.rbegin(); it != not_executed_tasks.rend();
+                 it++) {
+              task_queue.push_front(std::move(task_specs[*it]));
+            }
+          } else if (!pending_tasks.empty() && (!status.ok() || unexpected_reply)) {
+            // Every remaining task is handled as if its own PushTask RPC failed.
+            if (status.ok()) {
+              RAY_LOG(WARNING) << "Worker " << WorkerID::FromBinary(addr.worker_id())
+                               << " didn't reply to " << pending_tasks.size()
+                               << " tasks of a batch, failing them.";
+              status = Status::IOError("The worker lost the tasks of the batch.");
+            }
+            for (const auto &[_, i] : pending_tasks) {
+              OnPushedTaskDone(status, task_specs[i], addr);
+            }
+            pending_tasks.clear();
+            batch->worker_status = status;
+          }
+
+          if (!pending_tasks.empty()) {
+            // Wait for the replies of the rest of the tasks.
+            SendPushTaskBatch(addr,
+                              client,
+                              scheduling_key,
+                              std::make_unique<rpc::PushTaskBatchRequest>(),
+                              batch,
+                              assigned_resources);
+          } else {
+            auto &lease_entry = worker_to_lease_entry_[addr];
+            RAY_CHECK(lease_entry.is_busy);
+            lease_entry.is_busy = false;
+            auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
+            RAY_CHECK_GE(scheduling_key_entry.active_workers.size(), 1u);
+            RAY_CHECK_GE(scheduling_key_entry.num_busy_workers, 1u);
+            scheduling_key_entry.num_busy_workers--;
+            OnWorkerIdle(addr,
+                         scheduling_key,
+                         /*error=*/!batch->worker_status.ok(),
+                         /*error_detail*/ batch->worker_status.message(),
+                         batch->worker_exiting,
+                         assigned_resources);
           }
         }
+        for (const auto &[i, task_reply] : replied_tasks) {
+          HandlePushTaskReply(batch->task_specs[i], *task_reply, addr);
+        }
       });
 }
 
+void CoreWorkerDirectTaskSubmitter::FillPushTaskRequest(
+    const rpc::Address &addr,
+    const TaskSpecification &task_spec,
+    const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources,
+    rpc::PushTaskRequest *request) {
+  // NOTE(swang): CopyFrom is needed because if we use Swap here and the task
+  // fails, then the task data will be gone when the TaskManager attempts to
+  // access the task.
+  request->mutable_task_spec()->CopyFrom(task_spec.GetMessage());
+  request->mutable_resource_mapping()->CopyFrom(assigned_resources);
+  request->set_intended_worker_id(addr.worker_id());
+  task_finisher_->MarkTaskWaitingForExecution(task_spec.TaskId(),
+                                              NodeID::FromBinary(addr.raylet_id()),
+                                              WorkerID::FromBinary(addr.worker_id()));
+}
+
+void CoreWorkerDirectTaskSubmitter::OnPushedTaskDone(const Status &status,
+                                                     const TaskSpecification &task_spec,
+                                                     const rpc::Address &addr) {
+  const auto task_id = task_spec.TaskId();
+  executing_tasks_.erase(task_id);
+  if (status.ok()) {
+    return;
+  }
+  RAY_LOG(DEBUG) << "Getting error from raylet for task " << task_id;
+  const ray::rpc::ClientCallback<ray::rpc::GetTaskFailureCauseReply> callback =
+      [this, status, is_actor = task_spec.IsActorTask(), task_id, addr](
+          const Status &get_task_failure_cause_reply_status,
+          const rpc::GetTaskFailureCauseReply &get_task_failure_cause_reply) {
+        HandleGetTaskFailureCause(status,
+                                  is_actor,
+                                  task_id,
+                                  addr,
+                                  get_task_failure_cause_reply_status,
+                                  get_task_failure_cause_reply);
+      };
+  auto &lease_entry = worker_to_lease_entry_[addr];
+  RAY_CHECK(lease_entry.lease_client);
+  lease_entry.lease_client->GetTaskFailureCause(lease_entry.task_id, callback);
+}
+
+void CoreWorkerDirectTaskSubmitter::HandlePushTaskReply(
+    const TaskSpecification &task_spec,
+    const rpc::PushTaskReply &reply,
+    const rpc::Address &addr) {
+  const auto task_id = task_spec.TaskId();
+  if (reply.was_cancelled_before_running()) {
+    RAY_LOG(DEBUG) << "Task " << task_id << " was cancelled before it started running.";
+    RAY_UNUSED(task_finisher_->FailPendingTask(task_id, rpc::ErrorType::TASK_CANCELLED));
+  } else if (!task_spec.GetMessage().retry_exceptions() || !reply.is_retryable_error() ||
+             !task_finisher_->RetryTaskIfPossible(
+                 task_id,
+                 gcs::GetRayErrorInfo(rpc::ErrorType::TASK_EXECUTION_EXCEPTION,
+                                      reply.task_execution_error()))) {
+    task_finisher_->CompletePendingTask(
+        task_id, reply, addr, reply.is_application_error());
+  }
+}
+
 void CoreWorkerDirectTaskSubmitter::HandleGetTaskFailureCause(
     const Status &task_execution_status,
     const bool is_actor,
@@ -19,6 +19,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/ray_object.h"
 #include "ray/core_worker/actor_manager.h"
 #include "ray/core_worker/context.h"
@@ -57,7 +58,18 @@ using SchedulingKey =
 // per scheduling category.
 class LeaseRequestRateLimiter {
  public:
+  /// How a lease request was replied.
+  enum class LeaseOutcome { kGranted, kSpilledBack, kRejected, kCanceled, kFailed };
+
   virtual size_t GetMaxPendingLeaseRequestsPerSchedulingCategory() = 0;
+
+  /// Called when a lease request is replied, so that the limit can adapt to how the
+  /// cluster copes with the lease requests. Must be thread-safe.
+  ///
+  /// \param outcome How the request was replied.
+  /// \param latency_ms The time from sending the request to receiving the reply.
+  virtual void OnLeaseReply(LeaseOutcome outcome, int64_t latency_ms) {}
+
   virtual ~LeaseRequestRateLimiter() = default;
 };
 
@@ -101,6 +113,12 @@ class CoreWorkerDirectTaskSubmitter {
         actor_creator_(actor_creator),
         client_cache_(core_worker_client_pool),
         job_id_(job_id),
+        max_tasks_per_push_batch_(
+            std::max<int64_t>(RayConfig::instance().max_tasks_per_push_batch(), 1)),
+        max_workers_per_lease_request_(
+            std::max<int64_t>(RayConfig::instance().max_workers_per_lease_request(), 1)),
+        lease_reuse_across_scheduling_keys_(
+            RayConfig::instance().worker_lease_reuse_across_scheduling_keys()),
         lease_request_rate_limiter_(lease_request_rate_limiter),
         cancel_retry_timer_(std::move(cancel_timer)) {}
 
@@ -137,6 +155,16 @@ class CoreWorkerDirectTaskSubmitter {
     return num_leases_requested_;
   }
 
+  /// Get the number of times an idle lease was reused by another scheduling key
+  /// instead of requesting a new lease.
+  int64_t GetNumLeasesReused() {
+    absl::MutexLock lock(&mu_);
+    return num_leases_reused_;
+  }
+
+  /// Return the idle leases kept for other scheduling keys once they expire.
+  void ReturnExpiredIdleLeases();
+
   /// Report worker backlog information to the local raylet.
   /// Since each worker only reports to its local rayet
   /// we avoid double counting backlogs in autoscaler.
@@ -213,6 +241,32 @@ class CoreWorkerDirectTaskSubmitter {
                     const SchedulingKey &scheduling_key)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// The resource shape of a lease: the scheduling class without the function and the
+  /// depth, and the runtime env hash. A leased worker can run the normal tasks of any
+  /// scheduling key with the same shape.
+  using LeaseShape = std::pair<SchedulingClass, RuntimeEnvHash>;
+
+  /// Get the lease shape of a scheduling key. Returns nullopt if its leases can't be
+  /// reused by other scheduling keys, i.e., for actor creation.
+  absl::optional<LeaseShape> GetLeaseShape(const SchedulingKey &scheduling_key)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Keep an idle worker in the pool of its lease shape instead of returning it, and
+  /// hand it to another scheduling key of the same shape if one is waiting for
+  /// workers.
+  void PoolIdleLease(const rpc::Address &addr, const LeaseShape &lease_shape)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Bind a pooled idle worker of the same lease shape to the scheduling key if it
+  /// needs more workers, and assign tasks to it.
+  ///
+  /// \return Whether a pooled worker was reused.
+  bool TryReuseIdleLease(const SchedulingKey &scheduling_key)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Return a pooled idle worker to the raylet.
+  void ReturnIdleLease(const rpc::Address &addr) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Check that the scheduling_key_entries_ hashmap is empty.
   inline bool CheckNoSchedulingKeyEntries() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     return scheduling_key_entries_.empty();
@@ -226,6 +280,35 @@ class CoreWorkerDirectTaskSubmitter {
                       const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry>
                           &assigned_resources);
 
+  /// Push a batch of tasks to a specific worker. The replies of the tasks are handled
+  /// as soon as they come back, and the worker stays busy until all of the tasks are
+  /// done. Tasks that the worker didn't execute because it exited are queued again.
+  void PushNormalTaskBatch(const rpc::Address &addr,
+                           std::shared_ptr<rpc::CoreWorkerClientInterface> client,
+                           const SchedulingKey &task_queue_key,
+                           std::vector<TaskSpecification> task_specs,
+                           const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry>
+                               &assigned_resources) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fill in the request to push a task to a specific worker.
+  void FillPushTaskRequest(const rpc::Address &addr,
+                           const TaskSpecification &task_spec,
+                           const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry>
+                               &assigned_resources,
+                           rpc::PushTaskRequest *request);
+
+  /// Stop tracking a pushed task once the worker has replied to it or the push has
+  /// failed. If it failed, the cause is fetched from the raylet and the task is
+  /// failed or retried.
+  void OnPushedTaskDone(const Status &status,
+                        const TaskSpecification &task_spec,
+                        const rpc::Address &addr) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Complete, retry or fail a task according to the reply from the worker.
+  void HandlePushTaskReply(const TaskSpecification &task_spec,
+                           const rpc::PushTaskReply &reply,
+                           const rpc::Address &addr) ABSL_LOCKS_EXCLUDED(mu_);
+
   /// Handles result from GetTaskFailureCause.
   void HandleGetTaskFailureCause(
       const Status &task_execution_status,
@@ -318,6 +401,8 @@ class CoreWorkerDirectTaskSubmitter {
   struct SchedulingKeyEntry {
     // Keep track of pending worker lease requests to the raylet.
     absl::flat_hash_map<TaskID, rpc::Address> pending_lease_requests;
+    // The number of workers asked for by the pending lease requests.
+    size_t num_pending_lease_workers = 0;
     TaskSpecification resource_spec = TaskSpecification();
     // Tasks that are queued for execution. We keep an individual queue per
     // scheduling class to ensure fairness.
@@ -349,16 +434,46 @@ class CoreWorkerDirectTaskSubmitter {
 
     // Get the current backlog size for this scheduling key
     [[nodiscard]] inline int64_t BacklogSize() const {
-      if (task_queue.size() < pending_lease_requests.size()) {
+      if (task_queue.size() < num_pending_lease_workers) {
         // This can happen if worker is reused.
         return 0;
       }
 
       // Subtract tasks with pending lease requests so we don't double count them.
-      return task_queue.size() - pending_lease_requests.size();
+      return task_queue.size() - num_pending_lease_workers;
     }
   };
 
+  /// The tasks of a PushTaskBatch request which are waiting for their replies.
+  struct PushedTaskBatch {
+    std::vector<TaskSpecification> task_specs;
+    // The indexes in task_specs of the tasks which haven't been replied.
+    absl::flat_hash_map<TaskID, size_t> pending_tasks;
+    // The last error of the tasks, which is reported when the worker is returned.
+    Status worker_status;
+    bool worker_exiting = false;
+  };
+
+  /// Send a PushTaskBatch request, and handle the task replies it returns. Another
+  /// request without tasks is sent to wait for the rest of the replies until all of the
+  /// tasks of the batch are done.
+  void SendPushTaskBatch(const rpc::Address &addr,
+                         std::shared_ptr<rpc::CoreWorkerClientInterface> client,
+                         const SchedulingKey &scheduling_key,
+                         std::unique_ptr<rpc::PushTaskBatchRequest> request,
+                         std::shared_ptr<PushedTaskBatch> batch,
+                         const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry>
+                             &assigned_resources) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Get the number of queued tasks to push to an idle worker of the scheduling key.
+  size_t GetPushBatchSize(const SchedulingKeyEntry &scheduling_key_entry) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Get the number of workers to ask for in the next lease request of the scheduling
+  /// key, which is its backlog, i.e., the queued tasks without a pending lease.
+  size_t GetNumWorkersToLease(const SchedulingKeyEntry &scheduling_key_entry) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // For each Scheduling Key, scheduling_key_entries_ contains a SchedulingKeyEntry struct
   // with the queue of tasks belonging to that SchedulingKey, together with the other
   // fields that are needed to orchestrate the execution of those tasks by the workers.
@@ -371,6 +486,29 @@ class CoreWorkerDirectTaskSubmitter {
   // Keeps track of where currently executing tasks are being run.
   absl::flat_hash_map<TaskID, rpc::Address> executing_tasks_ ABSL_GUARDED_BY(mu_);
 
+  /// The number of queued tasks to push to an idle worker in one request. Tasks are
+  /// split evenly among the idle workers of a scheduling key, up to this many per
+  /// worker.
+  const size_t max_tasks_per_push_batch_;
+
+  /// The number of workers to ask for in one lease request. Each request asks for a
+  /// worker for every queued task of the scheduling key without a pending lease, up to
+  /// this many.
+  const size_t max_workers_per_lease_request_;
+
+  /// Whether idle workers are kept until their leases expire, to run the tasks of
+  /// other scheduling keys with the same lease shape without a new lease.
+  const bool lease_reuse_across_scheduling_keys_;
+
+  /// The lease shape class of every scheduling class seen, see LeaseShape.
+  absl::flat_hash_map<SchedulingClass, SchedulingClass> lease_shape_classes_
+      ABSL_GUARDED_BY(mu_);
+
+  /// Idle workers which aren't bound to any scheduling key, by lease shape. Their
+  /// leases are kept in worker_to_lease_entry_ until they're reused or expire.
+  absl::flat_hash_map<LeaseShape, std::vector<rpc::Address>> idle_leases_
+      ABSL_GUARDED_BY(mu_);
+
   // Ratelimiter controls the num of pending lease requests.
   std::shared_ptr<LeaseRequestRateLimiter> lease_request_rate_limiter_;
 
@@ -379,6 +517,7 @@ class CoreWorkerDirectTaskSubmitter {
 
   int64_t num_tasks_submitted_ = 0;
   int64_t num_leases_requested_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_leases_reused_ ABSL_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace core
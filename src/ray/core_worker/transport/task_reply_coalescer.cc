@@ -0,0 +1,104 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/task_reply_coalescer.h"
+
+namespace ray {
+namespace core {
+
+rpc::PushTaskReply *TaskReplyCoalescer::AddTask(const WorkerID &caller_id,
+                                                const TaskID &task_id) {
+  absl::MutexLock lock(&mutex_);
+  auto &reply = callers_[caller_id].pending_tasks[task_id];
+  RAY_CHECK(reply == nullptr) << "Task " << task_id << " is already pending.";
+  reply = std::make_unique<rpc::PushTaskReply>();
+  return reply.get();
+}
+
+void TaskReplyCoalescer::ReplyTask(const WorkerID &caller_id,
+                                   const TaskID &task_id,
+                                   const Status &status) {
+  rpc::SendReplyCallback send_reply_callback;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = callers_.find(caller_id);
+    RAY_CHECK(it != callers_.end());
+    auto &state = it->second;
+    auto task_it = state.pending_tasks.find(task_id);
+    RAY_CHECK(task_it != state.pending_tasks.end());
+    auto *task_reply = state.ready_replies.Add();
+    task_reply->set_task_id(task_id.Binary());
+    task_reply->set_status_code(static_cast<int>(status.code()));
+    task_reply->set_status_message(status.message());
+    task_reply->mutable_reply()->Swap(task_it->second.get());
+    state.pending_tasks.erase(task_it);
+    send_reply_callback = TakeWaitingRequest(state);
+    MaybeEraseCaller(caller_id);
+  }
+  if (send_reply_callback) {
+    send_reply_callback(Status::OK(), nullptr, nullptr);
+  }
+}
+
+void TaskReplyCoalescer::WaitForReplies(const WorkerID &caller_id,
+                                        TaskReplies *task_replies,
+                                        rpc::SendReplyCallback send_reply_callback) {
+  rpc::SendReplyCallback previous_send_reply_callback;
+  bool reply_now = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto &state = callers_[caller_id];
+    // Return the ready replies, if any, through the earlier request.
+    previous_send_reply_callback = TakeWaitingRequest(state);
+    state.waiting_replies = task_replies;
+    state.waiting_send_reply_callback = std::move(send_reply_callback);
+    if (state.ready_replies.size() > 0 || state.pending_tasks.empty()) {
+      send_reply_callback = TakeWaitingRequest(state);
+      reply_now = true;
+    }
+    MaybeEraseCaller(caller_id);
+  }
+  if (previous_send_reply_callback) {
+    previous_send_reply_callback(Status::OK(), nullptr, nullptr);
+  }
+  if (reply_now) {
+    send_reply_callback(Status::OK(), nullptr, nullptr);
+  }
+}
+
+size_t TaskReplyCoalescer::NumCallers() const {
+  absl::MutexLock lock(&mutex_);
+  return callers_.size();
+}
+
+rpc::SendReplyCallback TaskReplyCoalescer::TakeWaitingRequest(CallerState &state) {
+  if (state.waiting_replies == nullptr) {
+    return nullptr;
+  }
+  state.waiting_replies->Swap(&state.ready_replies);
+  state.ready_replies.Clear();
+  state.waiting_replies = nullptr;
+  return std::move(state.waiting_send_reply_callback);
+}
+
+void TaskReplyCoalescer::MaybeEraseCaller(const WorkerID &caller_id) {
+  auto it = callers_.find(caller_id);
+  if (it != callers_.end() && it->second.pending_tasks.empty() &&
+      it->second.ready_replies.empty() && it->second.waiting_replies == nullptr) {
+    callers_.erase(it);
+  }
+}
+
+}  // namespace core
+}  // namespace ray
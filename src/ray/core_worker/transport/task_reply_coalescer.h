@@ -0,0 +1,96 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/id.h"
+#include "ray/common/status.h"
+#include "ray/rpc/server_call.h"
+#include "src/ray/protobuf/core_worker.pb.h"
+
+namespace ray {
+namespace core {
+
+/// Coalesces the replies of the tasks pushed in PushActorTaskBatch and PushTaskBatch
+/// requests.
+///
+/// Every caller keeps at most one batch request waiting on the worker. The replies of
+/// the caller's tasks are returned through the waiting request as soon as they're
+/// ready, and the replies which become ready while no request is waiting are returned
+/// together by the next request. So the replies don't have to wait for the other tasks
+/// of the same batch, and are batched under load like long polling.
+///
+/// The actor tasks are still executed by the ActorSchedulingQueue of the caller, which
+/// keeps the ordering of the sequence numbers.
+///
+/// This class is thread-safe.
+class TaskReplyCoalescer {
+ public:
+  using TaskReplies = google::protobuf::RepeatedPtrField<rpc::BatchedTaskReply>;
+
+  /// Add a task pushed by the caller.
+  ///
+  /// \param caller_id The worker that pushed the task.
+  /// \param task_id The task.
+  /// \return The reply to fill in for the task. It's valid until ReplyTask is called.
+  rpc::PushTaskReply *AddTask(const WorkerID &caller_id, const TaskID &task_id);
+
+  /// Mark the reply of a task as ready, and return it to the caller if it's waiting.
+  void ReplyTask(const WorkerID &caller_id, const TaskID &task_id, const Status &status);
+
+  /// Wait for the replies of the caller's tasks. The request is replied right away if
+  /// there are ready replies or no pending tasks. An earlier waiting request of the
+  /// caller is replied, since the caller only needs one.
+  ///
+  /// \param caller_id The worker that pushed the tasks.
+  /// \param task_replies The task replies of the batch reply, to fill in.
+  /// \param send_reply_callback Sends the batch reply.
+  void WaitForReplies(const WorkerID &caller_id,
+                      TaskReplies *task_replies,
+                      rpc::SendReplyCallback send_reply_callback);
+
+  /// Get the number of callers with pending tasks, ready replies or a waiting request.
+  size_t NumCallers() const;
+
+ private:
+  struct CallerState {
+    /// The replies of the tasks which are still being executed.
+    absl::flat_hash_map<TaskID, std::unique_ptr<rpc::PushTaskReply>> pending_tasks;
+    /// The replies which are ready but not returned yet.
+    TaskReplies ready_replies;
+    /// The request waiting for the replies, if any.
+    TaskReplies *waiting_replies = nullptr;
+    rpc::SendReplyCallback waiting_send_reply_callback;
+  };
+
+  /// Move the ready replies into the waiting request, and return the callback to send
+  /// it. Returns nullptr if no request is waiting.
+  rpc::SendReplyCallback TakeWaitingRequest(CallerState &state)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Erase the state of the caller if there's nothing left in it.
+  void MaybeEraseCaller(const WorkerID &caller_id) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+
+  absl::flat_hash_map<WorkerID, CallerState> callers_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace core
+}  // namespace ray
@@ -19,7 +19,10 @@
 #include <utility>
 
 #include "ray/common/ray_config.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_split.h"
 #include "ray/gcs/gcs_client/accessor.h"
+#include "ray/pubsub/pubsub_stream.h"
 #include "ray/pubsub/subscriber.h"
 
 namespace ray {
@@ -30,7 +33,8 @@ namespace {
 class GcsSubscriberClient final : public pubsub::SubscriberClientInterface {
  public:
   explicit GcsSubscriberClient(const std::shared_ptr<rpc::GcsRpcClient> &rpc_client)
-      : rpc_client_(rpc_client) {}
+      : rpc_client_(rpc_client),
+        stream_stub_(rpc::SubscriberService::NewStub(rpc_client->GetChannel())) {}
 
   ~GcsSubscriberClient() final = default;
 
@@ -42,8 +46,15 @@ class GcsSubscriberClient final : public pubsub::SubscriberClientInterface {
       const rpc::PubsubCommandBatchRequest &request,
       const rpc::ClientCallback<rpc::PubsubCommandBatchReply> &callback) final;
 
+  std::shared_ptr<pubsub::SubscriberStreamInterface> PubsubStream(
+      const rpc::PubsubLongPollingRequest &request,
+      std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+      std::function<void(const Status &, bool)> done_callback) final;
+
  private:
   const std::shared_ptr<rpc::GcsRpcClient> rpc_client_;
+  /// Stub of the streaming pubsub service of GCS.
+  const std::unique_ptr<rpc::SubscriberService::Stub> stream_stub_;
 };
 
 void GcsSubscriberClient::PubsubLongPolling(
@@ -78,6 +89,32 @@ void GcsSubscriberClient::PubsubCommandBatch(
       });
 }
 
+std::shared_ptr<pubsub::SubscriberStreamInterface> GcsSubscriberClient::PubsubStream(
+    const rpc::PubsubLongPollingRequest &request,
+    std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+    std::function<void(const Status &, bool)> done_callback) {
+  // Wait for GCS to be ready like the other GCS RPCs, so that the stream isn't failed
+  // while GCS is restarting.
+  return pubsub::SubscriberStreamClient::Start(stream_stub_.get(),
+                                               request,
+                                               std::move(reply_callback),
+                                               std::move(done_callback),
+                                               /*wait_for_ready=*/true);
+}
+
+/// Parse the channels from a comma separated list of channel names, e.g.
+/// "GCS_ACTOR_CHANNEL,GCS_NODE_INFO_CHANNEL".
+absl::flat_hash_set<rpc::ChannelType> ParseChannels(const std::string &channels) {
+  absl::flat_hash_set<rpc::ChannelType> result;
+  for (absl::string_view name : absl::StrSplit(channels, ',', absl::SkipWhitespace())) {
+    rpc::ChannelType channel_type;
+    RAY_CHECK(rpc::ChannelType_Parse(std::string(name), &channel_type))
+        << "Unknown pubsub channel: " << name;
+    result.insert(channel_type);
+  }
+  return result;
+}
+
 }  // namespace
 
 GcsClient::GcsClient(const GcsClientOptions &options, UniqueID gcs_client_id)
@@ -104,22 +141,49 @@ Status GcsClient::Connect(instrumented_io_context &io_service,
   /// TODO(mwtian): refactor pubsub::Subscriber to avoid faking worker ID.
   gcs_address.set_worker_id(UniqueID::FromRandom().Binary());
 
+  // Channels which receive messages through a stream, and the others through long
+  // polling. A subscriber uses only one of them, so the channels are split into two
+  // subscribers.
+  const auto streaming_channels =
+      ParseChannels(RayConfig::instance().gcs_pubsub_streaming_channels());
+  std::vector<rpc::ChannelType> polling_channel_list;
+  std::vector<rpc::ChannelType> streaming_channel_list;
+  for (auto channel_type : {rpc::ChannelType::GCS_ACTOR_CHANNEL,
+                            rpc::ChannelType::GCS_JOB_CHANNEL,
+                            rpc::ChannelType::GCS_NODE_INFO_CHANNEL,
+                            rpc::ChannelType::GCS_WORKER_DELTA_CHANNEL}) {
+    if (streaming_channels.contains(channel_type)) {
+      streaming_channel_list.push_back(channel_type);
+    } else {
+      polling_channel_list.push_back(channel_type);
+    }
+  }
+  auto get_client = [this](const rpc::Address &) {
+    return std::make_shared<GcsSubscriberClient>(gcs_rpc_client_);
+  };
+
   auto subscriber = std::make_unique<pubsub::Subscriber>(
       /*subscriber_id=*/gcs_client_id_,
-      /*channels=*/
-      std::vector<rpc::ChannelType>{rpc::ChannelType::GCS_ACTOR_CHANNEL,
-                                    rpc::ChannelType::GCS_JOB_CHANNEL,
-                                    rpc::ChannelType::GCS_NODE_INFO_CHANNEL,
-                                    rpc::ChannelType::GCS_WORKER_DELTA_CHANNEL},
+      /*channels=*/polling_channel_list,
       /*max_command_batch_size*/ RayConfig::instance().max_command_batch_size(),
-      /*get_client=*/
-      [this](const rpc::Address &) {
-        return std::make_shared<GcsSubscriberClient>(gcs_rpc_client_);
-      },
+      /*get_client=*/get_client,
       /*callback_service*/ &io_service);
+  std::unique_ptr<pubsub::Subscriber> streaming_subscriber;
+  if (!streaming_channel_list.empty()) {
+    // The subscriber id must be different from the polling one, because GCS keeps one
+    // connection per subscriber.
+    streaming_subscriber = std::make_unique<pubsub::Subscriber>(
+        /*subscriber_id=*/UniqueID::FromRandom(),
+        /*channels=*/streaming_channel_list,
+        /*max_command_batch_size*/ RayConfig::instance().max_command_batch_size(),
+        /*get_client=*/get_client,
+        /*callback_service*/ &io_service,
+        /*use_streaming=*/true);
+  }
 
   // Init GCS subscriber instance.
-  gcs_subscriber_ = std::make_unique<GcsSubscriber>(gcs_address, std::move(subscriber));
+  gcs_subscriber_ = std::make_unique<GcsSubscriber>(
+      gcs_address, std::move(subscriber), std::move(streaming_subscriber));
 
   job_accessor_ = std::make_unique<JobInfoAccessor>(this);
   actor_accessor_ = std::make_unique<ActorInfoAccessor>(this);
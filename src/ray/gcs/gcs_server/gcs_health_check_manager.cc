@@ -14,12 +14,20 @@
 
 #include "ray/gcs/gcs_server/gcs_health_check_manager.h"
 
+#include <algorithm>
+
 #include "ray/stats/metric.h"
 DEFINE_stats(health_check_rpc_latency_ms,
              "Latency of rpc request for health check.",
              (),
              ({1, 10, 100, 1000, 10000}, ),
              ray::stats::HISTOGRAM);
+DEFINE_stats(health_check_probes,
+             "Number of health checks, broken down by whether the RPC is sent or "
+             "skipped because a ray syncer message from the node has been received.",
+             ("Type"),
+             (),
+             ray::stats::COUNT);
 
 namespace ray {
 namespace gcs {
@@ -30,18 +38,24 @@ GcsHealthCheckManager::GcsHealthCheckManager(
     int64_t initial_delay_ms,
     int64_t timeout_ms,
     int64_t period_ms,
-    int64_t failure_threshold)
+    int64_t failure_threshold,
+    int64_t max_period_ms,
+    double jitter_ratio)
     : io_service_(io_service),
       on_node_death_callback_(on_node_death_callback),
       initial_delay_ms_(initial_delay_ms),
       timeout_ms_(timeout_ms),
       period_ms_(period_ms),
-      failure_threshold_(failure_threshold) {
+      failure_threshold_(failure_threshold),
+      max_period_ms_(std::max(max_period_ms, period_ms)),
+      jitter_ratio_(jitter_ratio),
+      gen_(std::random_device()()) {
   RAY_CHECK(on_node_death_callback != nullptr);
   RAY_CHECK(initial_delay_ms >= 0);
   RAY_CHECK(timeout_ms >= 0);
   RAY_CHECK(period_ms >= 0);
   RAY_CHECK(failure_threshold >= 0);
+  RAY_CHECK(jitter_ratio >= 0 && jitter_ratio < 1);
 }
 
 GcsHealthCheckManager::~GcsHealthCheckManager() {}
@@ -55,6 +69,8 @@ void GcsHealthCheckManager::RemoveNode(const NodeID &node_id) {
         }
         iter->second->Stop();
         health_check_contexts_.erase(iter);
+        absl::MutexLock lock(&mutex_);
+        last_heard_time_ns_.erase(node_id);
       },
       "GcsHealthCheckManager::RemoveNode");
 }
@@ -65,20 +81,65 @@ void GcsHealthCheckManager::FailNode(const NodeID &node_id) {
   if (iter != health_check_contexts_.end()) {
     on_node_death_callback_(node_id);
     health_check_contexts_.erase(iter);
+    absl::MutexLock lock(&mutex_);
+    last_heard_time_ns_.erase(node_id);
   }
 }
 
 std::vector<NodeID> GcsHealthCheckManager::GetAllNodes() const {
+  // The health check contexts are only accessed from the health check io context, but
+  // the nodes being monitored are also tracked by last_heard_time_ns_.
+  absl::MutexLock lock(&mutex_);
   std::vector<NodeID> nodes;
-  for (const auto &[node_id, _] : health_check_contexts_) {
+  for (const auto &[node_id, _] : last_heard_time_ns_) {
     nodes.emplace_back(node_id);
   }
   return nodes;
 }
 
+void GcsHealthCheckManager::MarkNodeHealthy(const NodeID &node_id) {
+  auto now = absl::GetCurrentTimeNanos();
+  absl::MutexLock lock(&mutex_);
+  // Only the nodes being monitored are tracked.
+  auto iter = last_heard_time_ns_.find(node_id);
+  if (iter != last_heard_time_ns_.end()) {
+    iter->second = now;
+  }
+}
+
+int64_t GcsHealthCheckManager::GetLastHeardTimeNs(const NodeID &node_id) const {
+  absl::MutexLock lock(&mutex_);
+  auto iter = last_heard_time_ns_.find(node_id);
+  return iter == last_heard_time_ns_.end() ? -1 : iter->second;
+}
+
+int64_t GcsHealthCheckManager::Jitter(int64_t interval_ms) {
+  if (jitter_ratio_ == 0) {
+    return interval_ms;
+  }
+  std::uniform_real_distribution<double> dist(1 - jitter_ratio_, 1 + jitter_ratio_);
+  return static_cast<int64_t>(interval_ms * dist(gen_));
+}
+
 void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
   using ::grpc::health::v1::HealthCheckResponse;
 
+  if (stopped_) {
+    delete this;
+    return;
+  }
+
+  // The node has sent messages since the previous check, so it's alive.
+  auto last_check_time_ns = last_check_time_ns_;
+  last_check_time_ns_ = absl::GetCurrentTimeNanos();
+  if (last_check_time_ns > 0 &&
+      manager_->GetLastHeardTimeNs(node_id_) >= last_check_time_ns) {
+    STATS_health_check_probes.Record(1, "Skipped");
+    OnHealthCheckDone(/*passed=*/true);
+    return;
+  }
+  STATS_health_check_probes.Record(1, "Sent");
+
   // Reset the context/request/response for the next request.
   context_.~ClientContext();
   new (&context_) grpc::ClientContext();
@@ -100,33 +161,44 @@ void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
               }
               RAY_LOG(DEBUG) << "Health check status: " << int(response_.status());
 
-              if (status.ok() && response_.status() == HealthCheckResponse::SERVING) {
-                // Health check passed
-                health_check_remaining_ = manager_->failure_threshold_;
-              } else {
-                --health_check_remaining_;
+              bool passed =
+                  status.ok() && response_.status() == HealthCheckResponse::SERVING;
+              if (!passed) {
                 RAY_LOG(WARNING)
                     << "Health check failed for node " << node_id_
-                    << ", remaining checks " << health_check_remaining_ << ", status "
-                    << status.error_code() << ", response status " << response_.status()
-                    << ", status message " << status.error_message()
-                    << ", status details " << status.error_details();
-              }
-
-              if (health_check_remaining_ == 0) {
-                manager_->FailNode(node_id_);
-                delete this;
-              } else {
-                // Do another health check.
-                timer_.expires_from_now(
-                    boost::posix_time::milliseconds(manager_->period_ms_));
-                timer_.async_wait([this](auto) { StartHealthCheck(); });
+                    << ", remaining checks " << health_check_remaining_ - 1
+                    << ", status " << status.error_code() << ", response status "
+                    << response_.status() << ", status message "
+                    << status.error_message() << ", status details "
+                    << status.error_details();
               }
+              OnHealthCheckDone(passed);
             },
             "HealthCheck");
       });
 }
 
+void GcsHealthCheckManager::HealthCheckContext::OnHealthCheckDone(bool passed) {
+  if (passed) {
+    health_check_remaining_ = manager_->failure_threshold_;
+    // Back off for a healthy node.
+    period_ms_ = std::min(period_ms_ * 2, manager_->max_period_ms_);
+  } else {
+    --health_check_remaining_;
+    // Retry fast for a suspicious node to keep the failure detection latency bounded.
+    period_ms_ = manager_->period_ms_;
+  }
+
+  if (health_check_remaining_ == 0) {
+    manager_->FailNode(node_id_);
+    delete this;
+  } else {
+    // Do another health check.
+    timer_.expires_from_now(boost::posix_time::milliseconds(manager_->Jitter(period_ms_)));
+    timer_.async_wait([this](auto) { StartHealthCheck(); });
+  }
+}
+
 void GcsHealthCheckManager::HealthCheckContext::Stop() { stopped_ = true; }
 
 void GcsHealthCheckManager::AddNode(const NodeID &node_id,
@@ -134,6 +206,10 @@ void GcsHealthCheckManager::AddNode(const NodeID &node_id,
   io_service_.dispatch(
       [this, channel, node_id]() {
         RAY_CHECK(health_check_contexts_.count(node_id) == 0);
+        {
+          absl::MutexLock lock(&mutex_);
+          last_heard_time_ns_.emplace(node_id, -1);
+        }
         auto context = new HealthCheckContext(this, channel, node_id);
         health_check_contexts_.emplace(std::make_pair(node_id, context));
       },
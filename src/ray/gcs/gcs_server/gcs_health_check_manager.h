@@ -16,7 +16,10 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include <random>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/id.h"
 #include "ray/common/ray_config.h"
@@ -35,6 +38,15 @@ namespace gcs {
 /// node will be removed from GcsHealthCheckManager. The node can be added into this class
 /// later. Although the same node id is not supposed to be reused in ray cluster, this is
 /// not enforced in this class.
+///
+/// To reduce the number of health check RPCs in large clusters, the liveness signal is
+/// piggybacked on the ray syncer traffic: if a message from the node has been received
+/// since its previous health check (see MarkNodeHealthy), the RPC is skipped and the
+/// check is treated as passed. The interval between two checks of a healthy node grows
+/// from `period_ms` up to `max_period_ms`, and is reset to `period_ms` once a check
+/// fails, so a dead node is detected in at most
+/// `max_period_ms + failure_threshold * (period_ms + timeout_ms)`.
+/// Intervals are jittered to avoid the checks of all nodes firing at the same time.
 /// TODO (iycheng): Move the GcsHealthCheckManager to ray/common.
 class GcsHealthCheckManager {
  public:
@@ -47,13 +59,19 @@ class GcsHealthCheckManager {
   /// \param period_ms The interval between two health checks for the same node.
   /// \param failure_threshold The threshold before a node will be marked as dead due to
   /// health check failure.
+  /// \param max_period_ms The max interval between two health checks for a healthy
+  /// node. If it's not larger than `period_ms`, the interval is always `period_ms`.
+  /// \param jitter_ratio The intervals are randomized in
+  /// [interval * (1 - jitter_ratio), interval * (1 + jitter_ratio)].
   GcsHealthCheckManager(
       instrumented_io_context &io_service,
       std::function<void(const NodeID &)> on_node_death_callback,
       int64_t initial_delay_ms = RayConfig::instance().health_check_initial_delay_ms(),
       int64_t timeout_ms = RayConfig::instance().health_check_timeout_ms(),
       int64_t period_ms = RayConfig::instance().health_check_period_ms(),
-      int64_t failure_threshold = RayConfig::instance().health_check_failure_threshold());
+      int64_t failure_threshold = RayConfig::instance().health_check_failure_threshold(),
+      int64_t max_period_ms = RayConfig::instance().health_check_max_period_ms(),
+      double jitter_ratio = RayConfig::instance().health_check_jitter_ratio());
 
   ~GcsHealthCheckManager();
 
@@ -68,12 +86,26 @@ class GcsHealthCheckManager {
   /// \param node_id The id of the node to stop tracking.
   void RemoveNode(const NodeID &node_id);
 
-  /// Return all the nodes monitored.
+  /// Return all the nodes monitored. It's thread-safe.
   ///
   /// \return A list of node id which are being monitored by this class.
   std::vector<NodeID> GetAllNodes() const;
 
+  /// Record that a node is alive because a message sent by it has been received, so
+  /// that its next health check RPC can be skipped. It's thread-safe and cheap so that
+  /// it can be called for every ray syncer message. Nodes not being monitored are
+  /// ignored.
+  ///
+  /// \param node_id The id of the node.
+  void MarkNodeHealthy(const NodeID &node_id);
+
  private:
+  /// Return the last time in ns a message was received from the node, or -1 if
+  /// there is none.
+  int64_t GetLastHeardTimeNs(const NodeID &node_id) const;
+
+  /// Return a jittered delay in ms around the given interval.
+  int64_t Jitter(int64_t interval_ms);
   /// Fail a node when health check failed. It'll stop the health checking and
   /// call on_node_death_callback.
   ///
@@ -92,11 +124,14 @@ class GcsHealthCheckManager {
         : manager_(manager),
           node_id_(node_id),
           timer_(manager->io_service_),
-          health_check_remaining_(manager->failure_threshold_) {
+          health_check_remaining_(manager->failure_threshold_),
+          period_ms_(manager->period_ms_) {
       request_.set_service(node_id.Hex());
       stub_ = grpc::health::v1::Health::NewStub(channel);
+      // Spread the first checks of the nodes added at the same time, e.g., after
+      // GCS restarts.
       timer_.expires_from_now(
-          boost::posix_time::milliseconds(manager_->initial_delay_ms_));
+          boost::posix_time::milliseconds(manager_->Jitter(manager_->initial_delay_ms_)));
       timer_.async_wait([this](auto) { StartHealthCheck(); });
     }
 
@@ -105,6 +140,11 @@ class GcsHealthCheckManager {
    private:
     void StartHealthCheck();
 
+    /// Handle the result of a health check and schedule the next one.
+    ///
+    /// \param passed Whether the node is healthy.
+    void OnHealthCheckDone(bool passed);
+
     GcsHealthCheckManager *manager_;
 
     NodeID node_id_;
@@ -124,6 +164,12 @@ class GcsHealthCheckManager {
 
     /// The remaining check left. If it reaches 0, the node will be marked as dead.
     int64_t health_check_remaining_;
+
+    /// The current interval between two health checks.
+    int64_t period_ms_;
+
+    /// The time in ns when the previous health check started.
+    int64_t last_check_time_ns_ = 0;
   };
 
   /// The main service. All method needs to run on this thread.
@@ -143,6 +189,19 @@ class GcsHealthCheckManager {
   const int64_t period_ms_;
   /// The number of failures before the node is considered as dead.
   const int64_t failure_threshold_;
+  /// The max intervals between two health check.
+  const int64_t max_period_ms_;
+  /// The ratio of the randomized part of the intervals.
+  const double jitter_ratio_;
+
+  /// Random generator for the jitter.
+  std::mt19937_64 gen_;
+
+  /// Protects last_heard_time_ns_, which is updated from the ray syncer thread and read
+  /// by GetAllNodes.
+  mutable absl::Mutex mutex_;
+  /// The last time in ns a message was received from each node being monitored.
+  absl::flat_hash_map<NodeID, int64_t> last_heard_time_ns_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace gcs
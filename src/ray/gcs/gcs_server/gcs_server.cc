@@ -32,6 +32,7 @@
 #include "ray/gcs/gcs_server/store_client_kv.h"
 #include "ray/gcs/store_client/observable_store_client.h"
 #include "ray/pubsub/publisher.h"
+#include "ray/util/sampling_profiler.h"
 #include "ray/util/util.h"
 
 namespace ray {
@@ -68,6 +69,7 @@ GcsServer::GcsServer(const ray::gcs::GcsServerConfig &config,
           std::make_shared<rpc::NodeManagerClientPool>(client_call_manager_)),
       pubsub_periodical_runner_(pubsub_io_service_),
       periodical_runner_(main_service),
+      io_context_watchdog_(IoContextWatchdog::Create(main_service, "gcs")),
       is_started_(false),
       is_stopped_(false) {
   // Init GCS table storage.
@@ -122,7 +124,9 @@ GcsServer::GcsServer(const ray::gcs::GcsServerConfig &config,
       /*get_time_ms=*/[]() { return absl::GetCurrentTimeNanos() / 1e6; },
       /*subscriber_timeout_ms=*/RayConfig::instance().subscriber_timeout_ms(),
       /*publish_batch_size_=*/RayConfig::instance().publish_batch_size(),
-      /*publisher_id=*/NodeID::FromRandom());
+      /*publisher_id=*/NodeID::FromRandom(),
+      /*num_shards=*/RayConfig::instance().gcs_publisher_num_shards(),
+      /*num_fanout_threads=*/RayConfig::instance().gcs_publisher_fanout_threads());
 
   gcs_publisher_ = std::make_shared<GcsPublisher>(std::move(inner_publisher));
 }
@@ -194,12 +198,12 @@ void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
   // Init gcs resource manager.
   InitGcsResourceManager(gcs_init_data);
 
-  // Init synchronization service
-  InitRaySyncer(gcs_init_data);
-
   // Init gcs health check manager.
   InitGcsHealthCheckManager(gcs_init_data);
 
+  // Init synchronization service
+  InitRaySyncer(gcs_init_data);
+
   // Init KV service.
   InitKVService();
 
@@ -251,6 +255,7 @@ void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
       [this] {
         RAY_LOG(INFO) << GetDebugState();
         PrintAsioStats();
+        DumpProfileToFile();
       },
       /*ms*/ RayConfig::instance().event_stats_print_interval_ms(),
       "GCSServer.deadline_timer.debug_state_event_stats_print");
@@ -276,6 +281,9 @@ void GcsServer::Stop() {
     ray_syncer_thread_->join();
     ray_syncer_.reset();
 
+    health_check_io_context_.stop();
+    health_check_thread_->join();
+
     gcs_task_manager_->Stop();
 
     pubsub_handler_->Stop();
@@ -317,8 +325,12 @@ void GcsServer::InitGcsHealthCheckManager(const GcsInitData &gcs_init_data) {
         "GcsServer.NodeDeathCallback");
   };
 
-  gcs_healthcheck_manager_ =
-      std::make_unique<GcsHealthCheckManager>(main_service_, node_death_callback);
+  gcs_healthcheck_manager_ = std::make_unique<GcsHealthCheckManager>(
+      health_check_io_context_, node_death_callback);
+  health_check_thread_ = std::make_unique<std::thread>([this]() {
+    boost::asio::io_service::work work(health_check_io_context_);
+    health_check_io_context_.run();
+  });
   for (const auto &item : gcs_init_data.Nodes()) {
     if (item.second.state() == rpc::GcsNodeInfo::ALIVE) {
       rpc::Address remote_address;
@@ -539,12 +551,15 @@ GcsServer::StorageType GcsServer::GetStorageType() const {
 }
 
 void GcsServer::InitRaySyncer(const GcsInitData &gcs_init_data) {
+  RAY_CHECK(gcs_healthcheck_manager_);
+  ray_syncer_receiver_ = std::make_unique<GcsSyncMessageReceiver>(
+      *gcs_resource_manager_, *gcs_healthcheck_manager_);
   ray_syncer_ =
       std::make_unique<syncer::RaySyncer>(ray_syncer_io_context_, kGCSNodeID.Binary());
   ray_syncer_->Register(
-      syncer::MessageType::RESOURCE_VIEW, nullptr, gcs_resource_manager_.get());
+      syncer::MessageType::RESOURCE_VIEW, nullptr, ray_syncer_receiver_.get());
   ray_syncer_->Register(
-      syncer::MessageType::COMMANDS, nullptr, gcs_resource_manager_.get());
+      syncer::MessageType::COMMANDS, nullptr, ray_syncer_receiver_.get());
   ray_syncer_thread_ = std::make_unique<std::thread>([this]() {
     boost::asio::io_service::work work(ray_syncer_io_context_);
     ray_syncer_io_context_.run();
@@ -594,8 +609,12 @@ void GcsServer::InitPubSubHandler() {
       std::make_unique<InternalPubSubHandler>(pubsub_io_service_, gcs_publisher_);
   pubsub_service_ = std::make_unique<rpc::InternalPubSubGrpcService>(pubsub_io_service_,
                                                                      *pubsub_handler_);
+  // Subscribers can also receive messages through a stream instead of long polling.
+  pubsub_stream_service_ =
+      std::make_unique<pubsub::PubsubStreamService>(gcs_publisher_->GetPublisher());
   // Register service.
   rpc_server_.RegisterService(*pubsub_service_);
+  rpc_server_.RegisterService(*pubsub_stream_service_);
 }
 
 void GcsServer::InitRuntimeEnvManager() {
@@ -733,6 +752,7 @@ void GcsServer::InstallEventListeners() {
         gcs_healthcheck_manager_->RemoveNode(node_id);
         pubsub_handler_->RemoveSubscriberFrom(node_id.Binary());
         gcs_autoscaler_state_manager_->OnNodeDead(node_id);
+        ray_syncer_->RemoveNode(node_id.Binary());
       });
 
   // Install worker event listener.
@@ -807,6 +827,9 @@ void GcsServer::DumpDebugStateToFile() const {
           std::fstream::out | std::fstream::trunc);
   fs << GetDebugState() << "\n\n";
   fs << main_service_.stats().StatsString();
+  if (io_context_watchdog_ != nullptr) {
+    fs << "\n\n" << io_context_watchdog_->DebugString();
+  }
   fs.close();
 }
 
@@ -849,6 +872,16 @@ void GcsServer::PrintAsioStats() {
   }
 }
 
+void GcsServer::DumpProfileToFile() const {
+  if (!SamplingProfiler::Instance().IsStarted()) {
+    return;
+  }
+  std::fstream fs;
+  fs.open(config_.log_dir + "/profile_gcs.txt", std::fstream::out | std::fstream::trunc);
+  fs << SamplingProfiler::Instance().GetFoldedStacks();
+  fs.close();
+}
+
 void GcsServer::TryGlobalGC() {
   if (cluster_task_manager_->GetPendingQueueSize() == 0) {
     task_pending_schedule_detected_ = 0;
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/asio/io_context_watchdog.h"
 #include "ray/common/ray_syncer/ray_syncer.h"
 #include "ray/common/runtime_env_manager.h"
 #include "ray/gcs/gcs_client/usage_stats_client.h"
@@ -30,6 +31,7 @@
 #include "ray/gcs/gcs_server/runtime_env_handler.h"
 #include "ray/gcs/pubsub/gcs_pub_sub.h"
 #include "ray/gcs/redis_client.h"
+#include "ray/pubsub/pubsub_stream.h"
 #include "ray/raylet/scheduling/cluster_resource_scheduler.h"
 #include "ray/raylet/scheduling/cluster_task_manager.h"
 #include "ray/rpc/client_call.h"
@@ -60,6 +62,25 @@ struct GcsServerConfig {
   std::string session_name;
 };
 
+/// Receiver of the ray syncer messages in GCS. Besides delegating the messages to the
+/// resource manager, it records the liveness of the sending nodes so that their health
+/// check RPCs can be skipped.
+class GcsSyncMessageReceiver : public syncer::ReceiverInterface {
+ public:
+  GcsSyncMessageReceiver(syncer::ReceiverInterface &receiver,
+                         GcsHealthCheckManager &health_check_manager)
+      : receiver_(receiver), health_check_manager_(health_check_manager) {}
+
+  void ConsumeSyncMessage(std::shared_ptr<const syncer::RaySyncMessage> message) override {
+    health_check_manager_.MarkNodeHealthy(NodeID::FromBinary(message->node_id()));
+    receiver_.ConsumeSyncMessage(std::move(message));
+  }
+
+ private:
+  syncer::ReceiverInterface &receiver_;
+  GcsHealthCheckManager &health_check_manager_;
+};
+
 class GcsNodeManager;
 class GcsActorManager;
 class GcsJobManager;
@@ -200,6 +221,10 @@ class GcsServer {
   /// Print the asio event loop stats for debugging.
   void PrintAsioStats();
 
+  /// Dump the profile of the main thread to profile_gcs.txt, if the sampling profiler
+  /// is enabled.
+  void DumpProfileToFile() const;
+
   /// Get or connect to a redis server
   std::shared_ptr<RedisClient> GetOrConnectRedis();
 
@@ -231,6 +256,9 @@ class GcsServer {
   std::unique_ptr<GcsNodeManager> gcs_node_manager_;
   /// The health check manager.
   std::shared_ptr<GcsHealthCheckManager> gcs_healthcheck_manager_;
+  /// The health checks run on a dedicated thread to keep them off the main thread.
+  std::unique_ptr<std::thread> health_check_thread_;
+  instrumented_io_context health_check_io_context_;
   /// The gcs redis failure detector.
   std::shared_ptr<GcsRedisFailureDetector> gcs_redis_failure_detector_;
   /// The gcs actor manager.
@@ -252,6 +280,7 @@ class GcsServer {
   std::unique_ptr<rpc::NodeResourceInfoGrpcService> node_resource_info_service_;
 
   /// Ray Syncer related fields.
+  std::unique_ptr<GcsSyncMessageReceiver> ray_syncer_receiver_;
   std::unique_ptr<syncer::RaySyncer> ray_syncer_;
   std::unique_ptr<syncer::RaySyncerService> ray_syncer_service_;
   std::unique_ptr<std::thread> ray_syncer_thread_;
@@ -277,6 +306,7 @@ class GcsServer {
   /// GCS PubSub handler and service.
   std::unique_ptr<InternalPubSubHandler> pubsub_handler_;
   std::unique_ptr<rpc::InternalPubSubGrpcService> pubsub_service_;
+  std::unique_ptr<pubsub::PubsubStreamService> pubsub_stream_service_;
   /// GCS Task info manager for managing task states change events.
   std::unique_ptr<GcsTaskManager> gcs_task_manager_;
   /// Independent task info service from the main grpc service.
@@ -291,6 +321,8 @@ class GcsServer {
   PeriodicalRunner pubsub_periodical_runner_;
   /// The runner to run function periodically.
   PeriodicalRunner periodical_runner_;
+  /// The watchdog of the main event loop, or null if it's disabled.
+  std::unique_ptr<IoContextWatchdog> io_context_watchdog_;
   /// The gcs table storage.
   std::shared_ptr<gcs::GcsTableStorage> gcs_table_storage_;
   /// Stores references to URIs stored by the GCS for runtime envs.
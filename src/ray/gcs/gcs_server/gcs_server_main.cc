@@ -20,6 +20,7 @@
 #include "ray/gcs/store_client/redis_store_client.h"
 #include "ray/stats/stats.h"
 #include "ray/util/event.h"
+#include "ray/util/sampling_profiler.h"
 #include "ray/util/util.h"
 #include "src/ray/protobuf/gcs_service.pb.h"
 
@@ -78,6 +79,11 @@ int main(int argc, char *argv[]) {
                                             {ray::stats::SessionNameKey, session_name}};
   ray::stats::Init(global_tags, metrics_agent_port, WorkerID::Nil());
 
+  // Profile the main thread.
+  ray::SamplingProfiler::Instance().Start(
+      RayConfig::instance().sampling_profiler_frequency_hz());
+  ray::SamplingProfiler::Instance().AddCurrentThread();
+
   // Initialize event framework.
   if (RayConfig::instance().event_log_reporter_enabled() && !log_dir.empty()) {
     ray::RayEventInit(ray::rpc::Event_SourceType::Event_SourceType_GCS,
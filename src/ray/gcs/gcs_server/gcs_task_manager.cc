@@ -14,6 +14,9 @@
 
 #include "ray/gcs/gcs_server/gcs_task_manager.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 
@@ -29,52 +32,301 @@ void GcsTaskManager::Stop() {
 
 std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents()
     const {
-  std::vector<rpc::TaskEvents> ret;
+  return GetTaskEvents(GetTaskEventLocators());
+}
+
+std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
+    JobID job_id) const {
+  return GetTaskEvents(GetTaskEventLocators(job_id));
+}
+
+std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
+    const absl::flat_hash_set<TaskID> &task_ids) const {
+  return GetTaskEvents(GetTaskEventLocators(task_ids));
+}
+
+std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
+    const std::vector<std::shared_ptr<TaskEventLocator>> &task_locators) const {
+  std::vector<rpc::TaskEvents> result(task_locators.size());
+  std::vector<size_t> compressed;
+  for (size_t i = 0; i < task_locators.size(); ++i) {
+    if (task_locators[i]->IsCompressed()) {
+      compressed.push_back(i);
+    } else {
+      // Copy the task event to the output.
+      result[i] = task_locators[i]->GetTaskEventsMutable();
+    }
+  }
+
+  // Decompress the task events segment by segment.
+  std::sort(compressed.begin(), compressed.end(), [&task_locators](size_t a, size_t b) {
+    return task_locators[a]->GetCompressedId() < task_locators[b]->GetCompressedId();
+  });
+  for (auto i : compressed) {
+    result[i] = compressed_task_events_.Get(task_locators[i]->GetCompressedId());
+  }
+  return result;
+}
+
+std::vector<std::shared_ptr<GcsTaskManager::GcsTaskManagerStorage::TaskEventLocator>>
+GcsTaskManager::GcsTaskManagerStorage::GetTaskEventLocators() const {
+  std::vector<std::shared_ptr<TaskEventLocator>> ret;
+  ret.reserve(primary_index_.size());
   // From the higher priority to the lower priority list.
   for (int i = gc_policy_->MaxPriority() - 1; i >= 0; --i) {
+    if (i == 0) {
+      // The compressed task events are older than the ones of the lowest priority list.
+      for (const auto &id : compressed_task_events_.GetAll()) {
+        ret.push_back(primary_index_.at(compressed_task_events_.GetTaskAttempt(id)));
+      }
+    }
     // Reverse iterate the list to get the latest task events.
     for (auto itr = task_events_list_[i].rbegin(); itr != task_events_list_[i].rend();
          ++itr) {
-      ret.push_back(*itr);
+      ret.push_back(primary_index_.at(GetTaskAttempt(*itr)));
     }
   }
 
   return ret;
 }
 
-std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
-    JobID job_id) const {
+std::vector<std::shared_ptr<GcsTaskManager::GcsTaskManagerStorage::TaskEventLocator>>
+GcsTaskManager::GcsTaskManagerStorage::GetTaskEventLocators(const JobID &job_id) const {
   auto task_locators_itr = job_index_.find(job_id);
   if (task_locators_itr == job_index_.end()) {
     // Not found any tasks related to this job.
     return {};
   }
-  return GetTaskEvents(task_locators_itr->second);
+  return {task_locators_itr->second.begin(), task_locators_itr->second.end()};
 }
 
-std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
+std::vector<std::shared_ptr<GcsTaskManager::GcsTaskManagerStorage::TaskEventLocator>>
+GcsTaskManager::GcsTaskManagerStorage::GetTaskEventLocators(
     const absl::flat_hash_set<TaskID> &task_ids) const {
-  absl::flat_hash_set<std::shared_ptr<TaskEventLocator>> select_task_locators;
+  std::vector<std::shared_ptr<TaskEventLocator>> select_task_locators;
   for (const auto &task_id : task_ids) {
     auto task_locator_itr = task_index_.find(task_id);
     if (task_locator_itr != task_index_.end()) {
-      select_task_locators.insert(task_locator_itr->second.begin(),
+      select_task_locators.insert(select_task_locators.end(),
+                                  task_locator_itr->second.begin(),
                                   task_locator_itr->second.end());
     }
   }
 
-  return GetTaskEvents(select_task_locators);
+  return select_task_locators;
 }
 
-std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
-    const absl::flat_hash_set<std::shared_ptr<TaskEventLocator>> &task_locators) const {
-  std::vector<rpc::TaskEvents> result;
-  for (const auto &task_attempt_loc : task_locators) {
-    // Copy the task event to the output.
-    result.push_back(task_attempt_loc->GetTaskEventsMutable());
+GcsTaskManager::GcsTaskManagerStorage::TaskEventsQuery::TaskEventsQuery(
+    const rpc::GetTaskEventsRequest::Filters &filters)
+    : exclude_driver(filters.exclude_driver()) {
+  if (filters.has_job_id()) {
+    job_id = JobID::FromBinary(filters.job_id());
+  }
+  for (const auto &task_id : filters.task_ids()) {
+    task_ids.insert(TaskID::FromBinary(task_id));
+  }
+  if (filters.has_actor_id()) {
+    actor_id = ActorID::FromBinary(filters.actor_id());
+  }
+  if (filters.has_name()) {
+    name = filters.name();
   }
+  if (filters.has_state()) {
+    state = filters.state();
+  }
+}
 
-  return result;
+namespace {
+
+/// Get the task attempts of a key of an index, or nullptr if there are none.
+template <typename Index, typename Key>
+const typename Index::mapped_type *FindTaskAttempts(const Index &index, const Key &key) {
+  auto it = index.find(key);
+  return it == index.end() ? nullptr : &it->second;
+}
+
+}  // namespace
+
+GcsTaskManager::GcsTaskManagerStorage::TaskEventsPage
+GcsTaskManager::GcsTaskManagerStorage::GetTaskEventsPage(const TaskEventsQuery &query,
+                                                         absl::optional<uint64_t> cursor,
+                                                         int64_t limit) const {
+  // Select the candidates from the smallest index among the ones of the filters. The
+  // candidates of a filter are the task attempts of one key of its index, or of
+  // several keys for the task ids.
+  std::vector<const TaskAttemptSet *> candidates;
+  size_t num_candidates = std::numeric_limits<size_t>::max();
+  auto select = [&candidates, &num_candidates](std::vector<const TaskAttemptSet *> sets) {
+    size_t num = 0;
+    for (const auto *set : sets) {
+      num += set == nullptr ? 0 : set->size();
+    }
+    if (num < num_candidates) {
+      num_candidates = num;
+      candidates = std::move(sets);
+    }
+  };
+  if (!query.task_ids.empty()) {
+    std::vector<const TaskAttemptSet *> sets;
+    for (const auto &task_id : query.task_ids) {
+      sets.push_back(FindTaskAttempts(task_index_, task_id));
+    }
+    select(std::move(sets));
+  }
+  if (query.job_id.has_value()) {
+    select({FindTaskAttempts(job_index_, *query.job_id)});
+  }
+  if (query.state.has_value()) {
+    select({FindTaskAttempts(state_index_, *query.state)});
+  }
+  if (query.name.has_value()) {
+    select({FindTaskAttempts(name_index_, *query.name)});
+  }
+  if (query.actor_id.has_value()) {
+    select({FindTaskAttempts(actor_index_, *query.actor_id)});
+  }
+  if (num_candidates == std::numeric_limits<size_t>::max()) {
+    // No filter has an index, all the task attempts are candidates, which the state
+    // index partitions.
+    for (const auto &[state, set] : state_index_) {
+      candidates.push_back(&set);
+    }
+  }
+
+  // Merge the candidates from the most recently added one, after the cursor.
+  using Range = std::pair<TaskAttemptSet::const_iterator, TaskAttemptSet::const_iterator>;
+  std::vector<Range> heap;
+  for (const auto *set : candidates) {
+    if (set == nullptr) {
+      continue;
+    }
+    auto begin = cursor.has_value() ? set->upper_bound(*cursor) : set->begin();
+    if (begin != set->end()) {
+      heap.emplace_back(begin, set->end());
+    }
+  }
+  auto older = [](const Range &a, const Range &b) {
+    return (*a.first)->GetSeqNo() < (*b.first)->GetSeqNo();
+  };
+  std::make_heap(heap.begin(), heap.end(), older);
+
+  TaskEventsPage page;
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), older);
+    auto &range = heap.back();
+    const auto &loc = *range.first;
+    if (++range.first == range.second) {
+      heap.pop_back();
+    } else {
+      std::push_heap(heap.begin(), heap.end(), older);
+    }
+
+    if (!MatchQuery(*loc, query)) {
+      page.num_filtered++;
+      continue;
+    }
+    if (limit >= 0 && page.task_locators.size() >= static_cast<size_t>(limit)) {
+      // The page is full, and the next one starts after its last task attempt.
+      page.next_cursor = page.task_locators.empty()
+                             ? cursor.value_or(std::numeric_limits<uint64_t>::max())
+                             : page.task_locators.back()->GetSeqNo();
+      break;
+    }
+    page.task_locators.push_back(loc);
+  }
+  return page;
+}
+
+size_t GcsTaskManager::GcsTaskManagerStorage::NumTaskEvents(
+    const TaskEventsQuery &query) const {
+  if (!query.task_ids.empty()) {
+    size_t num = 0;
+    for (const auto &task_id : query.task_ids) {
+      const auto *set = FindTaskAttempts(task_index_, task_id);
+      num += set == nullptr ? 0 : set->size();
+    }
+    return num;
+  }
+  if (query.job_id.has_value()) {
+    const auto *set = FindTaskAttempts(job_index_, *query.job_id);
+    return set == nullptr ? 0 : set->size();
+  }
+  return primary_index_.size();
+}
+
+bool GcsTaskManager::GcsTaskManagerStorage::MatchQuery(
+    const TaskEventLocator &loc, const TaskEventsQuery &query) const {
+  if (query.state.has_value() && loc.GetState() != *query.state) {
+    return false;
+  }
+
+  if (!loc.IsCompressed()) {
+    const auto &task_event = loc.GetTaskEventsMutable();
+    if (!task_event.has_task_info()) {
+      // Skip task events w/o task info.
+      return false;
+    }
+    const auto &task_info = task_event.task_info();
+    if (query.exclude_driver && task_info.type() == rpc::TaskType::DRIVER_TASK) {
+      return false;
+    }
+
+    if (query.job_id.has_value() &&
+        JobID::FromBinary(task_event.job_id()) != *query.job_id) {
+      return false;
+    }
+
+    if (!query.task_ids.empty() &&
+        !query.task_ids.contains(TaskID::FromBinary(task_event.task_id()))) {
+      return false;
+    }
+
+    if (query.actor_id.has_value() &&
+        (!task_info.has_actor_id() ||
+         ActorID::FromBinary(task_info.actor_id()) != *query.actor_id)) {
+      return false;
+    }
+
+    if (query.name.has_value() && task_info.name() != *query.name) {
+      return false;
+    }
+
+    return true;
+  }
+
+  const auto &id = loc.GetCompressedId();
+  if (!compressed_task_events_.HasTaskInfo(id)) {
+    return false;
+  }
+  if (query.exclude_driver &&
+      compressed_task_events_.GetType(id) == rpc::TaskType::DRIVER_TASK) {
+    return false;
+  }
+  if (query.job_id.has_value() && compressed_task_events_.GetJobId(id) != *query.job_id) {
+    return false;
+  }
+  if (!query.task_ids.empty() &&
+      !query.task_ids.contains(compressed_task_events_.GetTaskAttempt(id).first)) {
+    return false;
+  }
+  if (query.actor_id.has_value() &&
+      (!compressed_task_events_.HasActorId(id) ||
+       ActorID::FromBinary(std::string(compressed_task_events_.GetActorId(id))) !=
+           *query.actor_id)) {
+    return false;
+  }
+  if (query.name.has_value() && compressed_task_events_.GetName(id) != *query.name) {
+    return false;
+  }
+  return true;
+}
+
+size_t GcsTaskManager::GcsTaskManagerStorage::NumProfileEvents(
+    const TaskEventLocator &loc) const {
+  if (loc.IsCompressed()) {
+    return compressed_task_events_.NumProfileEvents(loc.GetCompressedId());
+  }
+  return gcs::NumProfileEvents(loc.GetTaskEventsMutable());
 }
 
 void GcsTaskManager::GcsTaskManagerStorage::MarkTasksFailedOnWorkerDead(
@@ -103,6 +355,10 @@ void GcsTaskManager::GcsTaskManagerStorage::MarkTaskAttemptFailedIfNeeded(
     const std::shared_ptr<TaskEventLocator> &locator,
     int64_t failed_ts,
     const rpc::RayErrorInfo &error_info) {
+  if (locator->IsCompressed()) {
+    // The compressed task attempts are terminated.
+    return;
+  }
   auto &task_events = locator->GetTaskEventsMutable();
   // We don't mark tasks as failed if they are already terminated.
   if (IsTaskTerminated(task_events)) {
@@ -114,6 +370,7 @@ void GcsTaskManager::GcsTaskManagerStorage::MarkTaskAttemptFailedIfNeeded(
   auto state_updates = task_events.mutable_state_updates();
   state_updates->set_failed_ts(failed_ts);
   state_updates->mutable_error_info()->CopyFrom(error_info);
+  UpdateStateIndex(locator, rpc::TaskStatus::FAILED);
 }
 
 void GcsTaskManager::GcsTaskManagerStorage::MarkTasksFailedOnJobEnds(
@@ -140,6 +397,9 @@ void GcsTaskManager::GcsTaskManagerStorage::MarkTasksFailedOnJobEnds(
 void GcsTaskManager::GcsTaskManagerStorage::UpdateExistingTaskAttempt(
     const std::shared_ptr<GcsTaskManager::GcsTaskManagerStorage::TaskEventLocator> &loc,
     const rpc::TaskEvents &task_events) {
+  if (loc->IsCompressed()) {
+    DecompressTaskAttempt(loc);
+  }
   auto &existing_task = loc->GetTaskEventsMutable();
   // Update the tracking
   if (task_events.has_task_info() && !existing_task.has_task_info()) {
@@ -172,7 +432,8 @@ GcsTaskManager::GcsTaskManagerStorage::AddNewTaskEvent(rpc::TaskEvents &&task_ev
   task_events_list_.at(target_list_index).push_front(std::move(task_events));
   auto list_itr = task_events_list_.at(target_list_index).begin();
 
-  auto loc = std::make_shared<TaskEventLocator>(list_itr, target_list_index);
+  auto loc =
+      std::make_shared<TaskEventLocator>(list_itr, target_list_index, next_seq_no_++);
 
   // Add to index.
   UpdateIndex(loc);
@@ -207,15 +468,64 @@ void GcsTaskManager::GcsTaskManagerStorage::UpdateIndex(
   if (!worker_id.IsNil()) {
     worker_index_[worker_id].insert(loc);
   }
+  if (task_events.has_task_info()) {
+    const auto &task_info = task_events.task_info();
+    name_index_[task_info.name()].insert(loc);
+    if (task_info.has_actor_id()) {
+      actor_index_[ActorID::FromBinary(task_info.actor_id())].insert(loc);
+    }
+  }
+  UpdateStateIndex(loc, GetLatestTaskStatus(task_events));
+}
+
+void GcsTaskManager::GcsTaskManagerStorage::UpdateStateIndex(
+    const std::shared_ptr<TaskEventLocator> &loc, rpc::TaskStatus state) {
+  if (state != loc->GetState()) {
+    auto state_attempts_iter = state_index_.find(loc->GetState());
+    if (state_attempts_iter != state_index_.end()) {
+      // A new task attempt isn't indexed yet.
+      state_attempts_iter->second.erase(loc);
+      if (state_attempts_iter->second.empty()) {
+        state_index_.erase(state_attempts_iter);
+      }
+    }
+    loc->SetState(state);
+  }
+  state_index_[state].insert(loc);
 }
 
 void GcsTaskManager::GcsTaskManagerStorage::RemoveFromIndex(
     const std::shared_ptr<TaskEventLocator> &loc) {
-  const auto &task_events = loc->GetTaskEventsMutable();
-  const auto task_attempt = GetTaskAttempt(task_events);
-  const auto job_id = JobID::FromBinary(task_events.job_id());
-  const auto task_id = TaskID::FromBinary(task_events.task_id());
-  const auto worker_id = GetWorkerID(task_events);
+  TaskAttempt task_attempt;
+  JobID job_id;
+  WorkerID worker_id;
+  absl::optional<std::string> name;
+  absl::optional<ActorID> actor_id;
+  if (loc->IsCompressed()) {
+    const auto &id = loc->GetCompressedId();
+    task_attempt = compressed_task_events_.GetTaskAttempt(id);
+    job_id = compressed_task_events_.GetJobId(id);
+    worker_id = compressed_task_events_.GetWorkerId(id);
+    if (compressed_task_events_.HasTaskInfo(id)) {
+      name = std::string(compressed_task_events_.GetName(id));
+      if (compressed_task_events_.HasActorId(id)) {
+        actor_id =
+            ActorID::FromBinary(std::string(compressed_task_events_.GetActorId(id)));
+      }
+    }
+  } else {
+    const auto &task_events = loc->GetTaskEventsMutable();
+    task_attempt = GetTaskAttempt(task_events);
+    job_id = JobID::FromBinary(task_events.job_id());
+    worker_id = GetWorkerID(task_events);
+    if (task_events.has_task_info()) {
+      name = task_events.task_info().name();
+      if (task_events.task_info().has_actor_id()) {
+        actor_id = ActorID::FromBinary(task_events.task_info().actor_id());
+      }
+    }
+  }
+  const auto &task_id = task_attempt.first;
 
   // Remove from secondary indices.
   RAY_CHECK(!job_id.IsNil());
@@ -243,6 +553,31 @@ void GcsTaskManager::GcsTaskManagerStorage::RemoveFromIndex(
     }
   }
 
+  if (name.has_value()) {
+    auto name_attempts_iter = name_index_.find(*name);
+    RAY_CHECK(name_attempts_iter != name_index_.end());
+    RAY_CHECK(name_attempts_iter->second.erase(loc) == 1);
+    if (name_attempts_iter->second.empty()) {
+      name_index_.erase(name_attempts_iter);
+    }
+  }
+
+  if (actor_id.has_value()) {
+    auto actor_attempts_iter = actor_index_.find(*actor_id);
+    RAY_CHECK(actor_attempts_iter != actor_index_.end());
+    RAY_CHECK(actor_attempts_iter->second.erase(loc) == 1);
+    if (actor_attempts_iter->second.empty()) {
+      actor_index_.erase(actor_attempts_iter);
+    }
+  }
+
+  auto state_attempts_iter = state_index_.find(loc->GetState());
+  RAY_CHECK(state_attempts_iter != state_index_.end());
+  RAY_CHECK(state_attempts_iter->second.erase(loc) == 1);
+  if (state_attempts_iter->second.empty()) {
+    state_index_.erase(state_attempts_iter);
+  }
+
   // Remove from primary index.
   primary_index_.erase(task_attempt);
 }
@@ -269,23 +604,110 @@ GcsTaskManager::GcsTaskManagerStorage::UpdateOrInitTaskEventLocator(
 
 void GcsTaskManager::GcsTaskManagerStorage::RemoveTaskAttempt(
     std::shared_ptr<TaskEventLocator> loc) {
-  const auto &to_remove = loc->GetTaskEventsMutable();
-
-  const auto job_id = JobID::FromBinary(to_remove.job_id());
+  JobID job_id;
+  TaskAttempt task_attempt;
+  if (loc->IsCompressed()) {
+    job_id = compressed_task_events_.GetJobId(loc->GetCompressedId());
+    task_attempt = compressed_task_events_.GetTaskAttempt(loc->GetCompressedId());
+  } else {
+    const auto &to_remove = loc->GetTaskEventsMutable();
+    job_id = JobID::FromBinary(to_remove.job_id());
+    task_attempt = GetTaskAttempt(to_remove);
+  }
+  const auto num_profile_events = NumProfileEvents(*loc);
 
   // Update the tracking
-  job_task_summary_[job_id].RecordProfileEventsDropped(NumProfileEvents(to_remove));
-  job_task_summary_[job_id].RecordTaskAttemptDropped(GetTaskAttempt(to_remove));
+  job_task_summary_[job_id].RecordProfileEventsDropped(num_profile_events);
+  job_task_summary_[job_id].RecordTaskAttemptDropped(task_attempt);
   stats_counter_.Decrement(kNumTaskEventsStored);
   stats_counter_.Increment(kTotalNumTaskAttemptsDropped);
-  stats_counter_.Increment(kTotalNumProfileTaskEventsDropped,
-                           NumProfileEvents(to_remove));
+  stats_counter_.Increment(kTotalNumProfileTaskEventsDropped, num_profile_events);
 
   // Remove from the index.
   RemoveFromIndex(loc);
 
   // Lastly, remove from the underlying list.
-  task_events_list_[loc->GetCurrentListIndex()].erase(loc->GetCurrentListIterator());
+  if (loc->IsCompressed()) {
+    compressed_task_events_.Remove(loc->GetCompressedId());
+    stats_counter_.Decrement(kNumTaskEventsCompressed);
+    RecordCompressedBytes();
+  } else {
+    task_events_list_[loc->GetCurrentListIndex()].erase(loc->GetCurrentListIterator());
+  }
+}
+
+void GcsTaskManager::GcsTaskManagerStorage::CompressTaskEventsIfNeeded() {
+  // The lowest priority list.
+  auto &task_events_list = task_events_list_[0];
+  if (segment_size_ == 0 || task_events_list.size() <= segment_size_) {
+    return;
+  }
+
+  // Only the terminated task attempts are compressed, since the others are still
+  // updated. They're all terminated with the default gc policy.
+  auto itr = task_events_list.rbegin();
+  for (size_t i = 0; i < segment_size_; ++i, ++itr) {
+    if (!IsTaskTerminated(*itr)) {
+      return;
+    }
+  }
+
+  // Compress the oldest task attempts.
+  std::vector<rpc::TaskEvents> segment;
+  std::vector<std::shared_ptr<TaskEventLocator>> locators;
+  segment.reserve(segment_size_);
+  locators.reserve(segment_size_);
+  for (size_t i = 0; i < segment_size_; ++i) {
+    auto &task_events = task_events_list.back();
+    locators.push_back(primary_index_.at(GetTaskAttempt(task_events)));
+    segment.push_back(std::move(task_events));
+    task_events_list.pop_back();
+  }
+  const auto ids = compressed_task_events_.AddSegment(std::move(segment));
+  for (size_t i = 0; i < ids.size(); ++i) {
+    locators[i]->SetCompressed(ids[i]);
+  }
+  stats_counter_.Increment(kNumTaskEventsCompressed, ids.size());
+  RecordCompressedBytes();
+}
+
+void GcsTaskManager::GcsTaskManagerStorage::DecompressTaskAttempt(
+    const std::shared_ptr<TaskEventLocator> &loc) {
+  const auto id = loc->GetCompressedId();
+  auto task_events = compressed_task_events_.Get(id);
+  compressed_task_events_.Remove(id);
+  stats_counter_.Decrement(kNumTaskEventsCompressed);
+  RecordCompressedBytes();
+
+  auto list_index = gc_policy_->GetTaskListPriority(task_events);
+  task_events_list_[list_index].push_front(std::move(task_events));
+  loc->SetCurrentList(list_index, task_events_list_[list_index].begin());
+}
+
+void GcsTaskManager::GcsTaskManagerStorage::RecordCompressedBytes() {
+  const int64_t num_bytes = compressed_task_events_.NumBytes();
+  const int64_t recorded = stats_counter_.Get(kNumTaskEventsCompressedBytes);
+  if (num_bytes > recorded) {
+    stats_counter_.Increment(kNumTaskEventsCompressedBytes, num_bytes - recorded);
+  } else if (num_bytes < recorded) {
+    stats_counter_.Decrement(kNumTaskEventsCompressedBytes, recorded - num_bytes);
+  }
+}
+
+void GcsTaskManager::GcsTaskManagerStorage::EvictCompressedTaskEventsIfNeeded() {
+  if (max_compressed_bytes_ < 0) {
+    return;
+  }
+  // The bytes of a segment are only released once all its task attempts are removed,
+  // so this evicts the oldest segments as a whole.
+  while (!compressed_task_events_.Empty() &&
+         static_cast<int64_t>(compressed_task_events_.NumBytes()) >
+             max_compressed_bytes_) {
+    const auto &loc_iter = primary_index_.find(
+        compressed_task_events_.GetTaskAttempt(compressed_task_events_.Oldest()));
+    RAY_CHECK(loc_iter != primary_index_.end());
+    RemoveTaskAttempt(loc_iter->second);
+  }
 }
 
 void GcsTaskManager::GcsTaskManagerStorage::EvictTaskEvent() {
@@ -335,9 +757,11 @@ void GcsTaskManager::GcsTaskManagerStorage::AddOrReplaceTaskEvent(
   std::shared_ptr<TaskEventLocator> loc =
       UpdateOrInitTaskEventLocator(std::move(events_by_task));
 
-  // If limit enforced, replace one.
-  if (max_num_task_events_ > 0 && static_cast<size_t>(stats_counter_.Get(
-                                      kNumTaskEventsStored)) > max_num_task_events_) {
+  // If limit enforced, replace one. The compressed task events have their own limit.
+  const auto num_uncompressed = stats_counter_.Get(kNumTaskEventsStored) -
+                                stats_counter_.Get(kNumTaskEventsCompressed);
+  if (max_num_task_events_ > 0 &&
+      static_cast<size_t>(num_uncompressed) > max_num_task_events_) {
     RAY_LOG_EVERY_MS(WARNING, 10000)
         << "Max number of tasks event (" << max_num_task_events_
         << ") allowed is reached. Old task events will be overwritten. Set "
@@ -345,6 +769,9 @@ void GcsTaskManager::GcsTaskManagerStorage::AddOrReplaceTaskEvent(
            "store more.";
     EvictTaskEvent();
   }
+
+  CompressTaskEventsIfNeeded();
+  EvictCompressedTaskEventsIfNeeded();
 }
 
 void GcsTaskManager::HandleGetTaskEvents(rpc::GetTaskEventsRequest request,
@@ -352,26 +779,16 @@ void GcsTaskManager::HandleGetTaskEvents(rpc::GetTaskEventsRequest request,
                                          rpc::SendReplyCallback send_reply_callback) {
   RAY_LOG(DEBUG) << "Getting task status:" << request.ShortDebugString();
 
-  // Select candidate events by indexing if possible.
-  std::vector<rpc::TaskEvents> task_events;
-  const auto &filters = request.filters();
-  if (filters.task_ids_size() > 0) {
-    absl::flat_hash_set<TaskID> task_ids;
-    for (const auto &task_id_str : filters.task_ids()) {
-      task_ids.insert(TaskID::FromBinary(task_id_str));
-    }
-    task_events = task_event_storage_->GetTaskEvents(task_ids);
-  } else if (filters.has_job_id()) {
-    const auto job_id = JobID::FromBinary(filters.job_id());
-    task_events = task_event_storage_->GetTaskEvents(job_id);
+  const GcsTaskManagerStorage::TaskEventsQuery query(request.filters());
+  // The data loss isn't tracked by task, so it's only populated without task ids.
+  if (query.task_ids.empty() && query.job_id.has_value()) {
     // Populate per-job data loss.
-    if (task_event_storage_->HasJob(job_id)) {
-      const auto &job_summary = task_event_storage_->GetJobTaskSummary(job_id);
+    if (task_event_storage_->HasJob(*query.job_id)) {
+      const auto &job_summary = task_event_storage_->GetJobTaskSummary(*query.job_id);
       reply->set_num_profile_task_events_dropped(job_summary.NumProfileEventsDropped());
       reply->set_num_status_task_events_dropped(job_summary.NumTaskAttemptsDropped());
     }
-  } else {
-    task_events = task_event_storage_->GetTaskEvents();
+  } else if (query.task_ids.empty()) {
     // Populate all jobs data loss
     reply->set_num_profile_task_events_dropped(
         task_event_storage_->NumProfileEventsDropped());
@@ -379,67 +796,29 @@ void GcsTaskManager::HandleGetTaskEvents(rpc::GetTaskEventsRequest request,
         task_event_storage_->NumTaskAttemptsDropped());
   }
 
-  // Populate reply.
-  auto limit = request.has_limit() ? request.limit() : -1;
-  // Simple limit.
-  auto count = 0;
-  int64_t num_profile_event_limit = 0;
-  int64_t num_status_event_limit = 0;
-  int64_t num_limit_truncated = 0;
-
-  // A lambda filter fn, where it returns true for task events to be included in the
-  // result. Task ids and job ids are already filtered by the storage with indexing above.
-  auto filter_fn = [&filters](const rpc::TaskEvents &task_event) {
-    if (!task_event.has_task_info()) {
-      // Skip task events w/o task info.
-      return false;
-    }
-    if (filters.exclude_driver() &&
-        task_event.task_info().type() == rpc::TaskType::DRIVER_TASK) {
-      return false;
-    }
-
-    if (filters.has_actor_id() && task_event.task_info().has_actor_id() &&
-        ActorID::FromBinary(task_event.task_info().actor_id()) !=
-            ActorID::FromBinary(filters.actor_id())) {
-      return false;
-    }
-
-    if (filters.has_name() && task_event.task_info().name() != filters.name()) {
-      return false;
-    }
-
-    return true;
-  };
-
-  int64_t num_filtered = 0;
-  for (auto itr = task_events.rbegin(); itr != task_events.rend(); ++itr) {
-    auto &task_event = *itr;
-    if (!filter_fn(task_event)) {
-      num_filtered++;
-      continue;
-    }
-
-    if (limit < 0 || count++ < limit) {
-      auto events = reply->add_events_by_task();
-      events->Swap(&task_event);
-    } else {
-      num_profile_event_limit +=
-          task_event.has_profile_events() ? task_event.profile_events().events_size() : 0;
-      num_status_event_limit += task_event.has_state_updates() ? 1 : 0;
-      num_limit_truncated++;
-    }
+  // The limit of the request is capped by the one of the server, so that a reply
+  // doesn't copy too many task events on the task manager thread.
+  int64_t limit = request.has_limit() ? request.limit() : -1;
+  const int64_t max_num_returned =
+      RayConfig::instance().task_events_max_num_returned_in_gcs();
+  if (max_num_returned >= 0 && (limit < 0 || limit > max_num_returned)) {
+    limit = max_num_returned;
   }
 
-  // Take into account truncation.
-  reply->set_num_profile_task_events_dropped(reply->num_profile_task_events_dropped() +
-                                             num_profile_event_limit);
-  reply->set_num_status_task_events_dropped(reply->num_status_task_events_dropped() +
-                                            num_status_event_limit);
+  const auto page = task_event_storage_->GetTaskEventsPage(
+      query,
+      request.has_cursor() ? absl::make_optional(request.cursor()) : absl::nullopt,
+      limit);
+  for (auto &task_event : task_event_storage_->GetTaskEvents(page.task_locators)) {
+    auto events = reply->add_events_by_task();
+    events->Swap(&task_event);
+  }
 
-  reply->set_num_total_stored(task_events.size());
-  reply->set_num_truncated(num_limit_truncated);
-  reply->set_num_filtered_on_gcs(num_filtered);
+  reply->set_num_total_stored(task_event_storage_->NumTaskEvents(query));
+  reply->set_num_filtered_on_gcs(page.num_filtered);
+  if (page.next_cursor.has_value()) {
+    reply->set_next_cursor(*page.next_cursor);
+  }
 
   GCS_RPC_SEND_REPLY(send_reply_callback, reply, Status::OK());
   return;
@@ -495,6 +874,9 @@ std::string GcsTaskManager::DebugString() {
      << counters[kTotalNumTaskAttemptsDropped] << "\n-Total num profile events dropped: "
      << counters[kTotalNumProfileTaskEventsDropped]
      << "\n-Current num of task events stored: " << counters[kNumTaskEventsStored]
+     << "\n-Current num of task events compressed: " << counters[kNumTaskEventsCompressed]
+     << "\n-Current bytes of compressed task events: "
+     << counters[kNumTaskEventsCompressedBytes]
      << "\n-Total num of actor creation tasks: " << counters[kTotalNumActorCreationTask]
      << "\n-Total num of actor tasks: " << counters[kTotalNumActorTask]
      << "\n-Total num of normal tasks: " << counters[kTotalNumNormalTask]
@@ -15,10 +15,13 @@
 #pragma once
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "ray/gcs/gcs_client/usage_stats_client.h"
+#include "ray/gcs/gcs_server/task_event_column_store.h"
 #include "ray/gcs/pb_util.h"
 #include "ray/rpc/gcs_server/gcs_rpc_server.h"
 #include "ray/util/counter_map.h"
@@ -36,6 +39,8 @@ enum GcsTaskManagerCounter {
   kTotalNumActorTask,
   kTotalNumNormalTask,
   kTotalNumDriverTask,
+  kNumTaskEventsCompressed,
+  kNumTaskEventsCompressedBytes,
 };
 
 const absl::flat_hash_map<rpc::TaskType, GcsTaskManagerCounter> kTaskTypeToCounterType = {
@@ -78,7 +83,8 @@ class FinishedTaskActorTaskGcPolicy : public TaskEventsGcPolicyInterface {
 ///
 /// When the maximal number of task events tracked specified by
 /// `RAY_task_events_max_num_task_in_gcs` is exceeded, older events (approximately by
-/// insertion order) will be dropped.
+/// insertion order) will be dropped. The compressed events of terminated tasks are
+/// bounded by `RAY_task_events_max_compressed_bytes_in_gcs` instead.
 ///
 /// This class has its own io_context and io_thread, that's separate from other GCS
 /// services. All handling of all rpc should be posted to the single thread it owns.
@@ -90,7 +96,9 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
         task_event_storage_(std::make_unique<GcsTaskManagerStorage>(
             RayConfig::instance().task_events_max_num_task_in_gcs(),
             stats_counter_,
-            std::make_unique<FinishedTaskActorTaskGcPolicy>())),
+            std::make_unique<FinishedTaskActorTaskGcPolicy>(),
+            RayConfig::instance().task_events_compressed_segment_size_in_gcs(),
+            RayConfig::instance().task_events_max_compressed_bytes_in_gcs())),
         io_service_thread_(std::make_unique<std::thread>([this] {
           SetThreadName("task_events");
           // Keep io_service_ alive.
@@ -169,11 +177,23 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
   /// It merges events from a single task attempt (same task id and attempt number) into
   /// a single rpc::TaskEvents entry, as reported by multiple rpc calls from workers.
   ///
-  /// When more than `RAY_task_events_max_num_task_in_gcs` task events are stored in the
-  /// the storage, tasks with lower gc priority as specified by
+  /// When more than `RAY_task_events_max_num_task_in_gcs` uncompressed task events are
+  /// stored in the storage, tasks with lower gc priority as specified by
   /// `TaskEventGcPolicyInterface` will be evicted first. When new events from the
   /// already evicted task attempts are reported to GCS, those events will also be
   /// dropped.
+  ///
+  /// The terminated task attempts with the lowest gc priority are rarely updated, so
+  /// they're compressed by segments of `segment_size` into a TaskEventColumnStore once
+  /// there are more of them. They're bounded by the bytes of their segments instead of
+  /// their number, and evicted from the oldest one once the segments take more than
+  /// `max_compressed_bytes`. When new events of a compressed task attempt are reported,
+  /// it's decompressed to merge them.
+  ///
+  /// The task attempts are indexed by task, job, latest state, name and actor, in the
+  /// order they were added, and the indices are updated as the task events are merged.
+  /// A query looks at the task attempts of the smallest index of its filters, and is
+  /// paginated from the most recently added task attempt.
   class GcsTaskManagerStorage {
     class TaskEventLocator;
     class JobTaskSummary;
@@ -181,20 +201,29 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
    public:
     /// Constructor
     ///
-    /// \param max_num_task_events Max number of task events stored before replacing older
-    /// ones.
+    /// \param max_num_task_events Max number of uncompressed task events stored before
+    /// replacing older ones.
+    /// \param segment_size The number of task attempts compressed together, or 0 to not
+    /// compress them.
+    /// \param max_compressed_bytes Max number of bytes of the compressed task events
+    /// before evicting older ones, or -1 for no limit.
     GcsTaskManagerStorage(size_t max_num_task_events,
                           CounterMapThreadSafe<GcsTaskManagerCounter> &stats_counter,
-                          std::unique_ptr<TaskEventsGcPolicyInterface> gc_policy)
+                          std::unique_ptr<TaskEventsGcPolicyInterface> gc_policy,
+                          size_t segment_size = 0,
+                          int64_t max_compressed_bytes = -1)
         : max_num_task_events_(max_num_task_events),
+          segment_size_(segment_size),
+          max_compressed_bytes_(max_compressed_bytes),
           stats_counter_(stats_counter),
           gc_policy_(std::move(gc_policy)),
           task_events_list_(gc_policy_->MaxPriority(), std::list<rpc::TaskEvents>()) {}
 
     /// Add a new task event or replace an existing task event in the storage.
     ///
-    /// If there are already `RAY_task_events_max_num_task_in_gcs` in the storage, the
-    /// oldest task event will be replaced. Otherwise the `task_event` will be added.
+    /// If there are already `RAY_task_events_max_num_task_in_gcs` uncompressed task
+    /// events in the storage, the oldest task event will be replaced. Otherwise the
+    /// `task_event` will be added.
     ///
     /// \param task_event Task event to be added to the storage.
     /// replaced task event.
@@ -209,7 +238,8 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// Get all task events.
     ///
     /// This retrieves copies of all task events ordered from the least recently inserted
-    /// to the most recently inserted task events.
+    /// to the most recently inserted task events, from the higher gc priority to the
+    /// lower one.
     ///
     /// \return all task events stored sorted with insertion order.
     std::vector<rpc::TaskEvents> GetTaskEvents() const;
@@ -223,11 +253,69 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
 
     /// Get task events of task locators.
     ///
-    /// \param task_attempts Task attempts (task ids + attempt number).
-    /// \return task events from the `task_attempts`.
+    /// The compressed task events are decompressed segment by segment.
+    ///
+    /// \param task_locators Task locators.
+    /// \return task events from the `task_locators`, in the same order.
     std::vector<rpc::TaskEvents> GetTaskEvents(
-        const absl::flat_hash_set<std::shared_ptr<TaskEventLocator>> &task_locators)
-        const;
+        const std::vector<std::shared_ptr<TaskEventLocator>> &task_locators) const;
+
+    /// Get the locators of all task events, in the order of GetTaskEvents().
+    std::vector<std::shared_ptr<TaskEventLocator>> GetTaskEventLocators() const;
+
+    /// Get the locators of the task events of a job.
+    std::vector<std::shared_ptr<TaskEventLocator>> GetTaskEventLocators(
+        const JobID &job_id) const;
+
+    /// Get the locators of the task events of tasks.
+    std::vector<std::shared_ptr<TaskEventLocator>> GetTaskEventLocators(
+        const absl::flat_hash_set<TaskID> &task_ids) const;
+
+    /// The filters of a query of task events, parsed from the request.
+    struct TaskEventsQuery {
+      explicit TaskEventsQuery(const rpc::GetTaskEventsRequest::Filters &filters);
+
+      absl::optional<JobID> job_id;
+      absl::flat_hash_set<TaskID> task_ids;
+      absl::optional<ActorID> actor_id;
+      absl::optional<std::string> name;
+      absl::optional<rpc::TaskStatus> state;
+      bool exclude_driver = false;
+    };
+
+    /// A page of the task attempts matching a query.
+    struct TaskEventsPage {
+      /// The locators of the task attempts, from the most recently added one.
+      std::vector<std::shared_ptr<TaskEventLocator>> task_locators;
+      /// The number of task attempts looked at which don't match the query.
+      int64_t num_filtered = 0;
+      /// The cursor of the next page, if more task attempts match the query.
+      absl::optional<uint64_t> next_cursor;
+    };
+
+    /// Get a page of the task attempts matching a query, from the most recently added
+    /// one.
+    ///
+    /// The candidates are the task attempts of the smallest index among the ones of the
+    /// filters, and the other filters are evaluated on them until the page is full. So a
+    /// page costs the number of task attempts looked at to fill it, rather than the
+    /// number of task attempts stored.
+    ///
+    /// \param query The query.
+    /// \param cursor If set, only the task attempts added before the one of the cursor
+    /// are returned.
+    /// \param limit The max number of task attempts returned, or -1 for no limit.
+    /// \return The page.
+    TaskEventsPage GetTaskEventsPage(const TaskEventsQuery &query,
+                                     absl::optional<uint64_t> cursor,
+                                     int64_t limit) const;
+
+    /// Return the number of task attempts stored of the tasks of a query if it has task
+    /// ids, else of its job if it has one, else of all the jobs.
+    size_t NumTaskEvents(const TaskEventsQuery &query) const;
+
+    /// Return the number of profile events of a task attempt.
+    size_t NumProfileEvents(const TaskEventLocator &loc) const;
 
     ///  Mark tasks from a job as failed as job ends with a delay.
     ///
@@ -301,19 +389,44 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// priority. The GC priority and the number of task lists is specified by the
     /// `TaskEventsGcPolicyInterface`.
     ///
-    /// Each locator contains the iterator to the list and the index of the list.
+    /// Each locator contains the iterator to the list and the index of the list, or the
+    /// id of the task attempt in the compressed storage. It also contains the sequence
+    /// number of the task attempt, which orders the task attempts by when they were
+    /// added in the indices, and the latest state of the task attempt indexed.
     /// - When a task event is added to the storage, a locator is created and added to the
     /// indices.
     /// - When a task event is removed from the storage, the locator is removed from the
     /// indices.
     /// - When a task event is updated, it might move between different lists, and the
     /// locator will be updated accordingly.
+    /// - When a task event is compressed or decompressed, the locator is updated
+    /// accordingly.
     class TaskEventLocator {
      public:
-      TaskEventLocator(std::list<rpc::TaskEvents>::iterator iter, size_t task_list_index)
-          : iter_(iter), task_list_index_(task_list_index) {}
+      TaskEventLocator(std::list<rpc::TaskEvents>::iterator iter,
+                       size_t task_list_index,
+                       uint64_t seq_no)
+          : iter_(iter), task_list_index_(task_list_index), seq_no_(seq_no) {}
+
+      /// Get the task events, which must not be compressed.
+      rpc::TaskEvents &GetTaskEventsMutable() const {
+        RAY_CHECK(!IsCompressed());
+        return *iter_;
+      }
+
+      bool IsCompressed() const { return compressed_id_.has_value(); }
+
+      const TaskEventColumnStore::RowId &GetCompressedId() const {
+        return *compressed_id_;
+      }
+
+      void SetCompressed(const TaskEventColumnStore::RowId &id) { compressed_id_ = id; }
+
+      uint64_t GetSeqNo() const { return seq_no_; }
+
+      rpc::TaskStatus GetState() const { return state_; }
 
-      rpc::TaskEvents &GetTaskEventsMutable() const { return *iter_; }
+      void SetState(rpc::TaskStatus state) { state_ = state; }
 
       size_t GetCurrentListIndex() const { return task_list_index_; }
 
@@ -325,6 +438,7 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
                           std::list<rpc::TaskEvents>::iterator cur_list_iter) {
         iter_ = cur_list_iter;
         task_list_index_ = cur_list_index;
+        compressed_id_.reset();
       }
 
      private:
@@ -332,8 +446,35 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
       std::list<rpc::TaskEvents>::iterator iter_;
       /// Index of the task list.
       size_t task_list_index_;
+      /// The id of the task attempt in the compressed storage, if it's compressed.
+      absl::optional<TaskEventColumnStore::RowId> compressed_id_;
+      /// The sequence number of the task attempt.
+      const uint64_t seq_no_;
+      /// The state of the task attempt in the state index.
+      rpc::TaskStatus state_ = rpc::TaskStatus::NIL;
     };
 
+    /// Order the locators from the most recently added task attempt. The sequence
+    /// numbers can be compared to the locators, to look up the cursor of a page.
+    struct NewerTaskAttemptFirst {
+      using is_transparent = void;
+
+      bool operator()(const std::shared_ptr<TaskEventLocator> &a,
+                      const std::shared_ptr<TaskEventLocator> &b) const {
+        return a->GetSeqNo() > b->GetSeqNo();
+      }
+      bool operator()(uint64_t a, const std::shared_ptr<TaskEventLocator> &b) const {
+        return a > b->GetSeqNo();
+      }
+      bool operator()(const std::shared_ptr<TaskEventLocator> &a, uint64_t b) const {
+        return a->GetSeqNo() > b;
+      }
+    };
+
+    /// The locators of the task attempts with a key of an index.
+    using TaskAttemptSet =
+        absl::btree_set<std::shared_ptr<TaskEventLocator>, NewerTaskAttemptFirst>;
+
     /// A helper class to summarize the stats of a job.
     /// TODO: we could probably do source side summary here per job.
     ///
@@ -429,6 +570,21 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// \param loc The task event locator.
     void UpdateIndex(const std::shared_ptr<TaskEventLocator> &loc);
 
+    /// Move the locator to the key of a state in the state index.
+    ///
+    /// \param loc The task event locator.
+    /// \param state The latest state of the task attempt.
+    void UpdateStateIndex(const std::shared_ptr<TaskEventLocator> &loc,
+                          rpc::TaskStatus state);
+
+    /// Return if a task attempt matches the filters of a query. The filters are
+    /// evaluated on the columns of the compressed task events, without decompressing
+    /// them.
+    ///
+    /// \param loc The locator of the task attempt.
+    /// \param query The query.
+    bool MatchQuery(const TaskEventLocator &loc, const TaskEventsQuery &query) const;
+
     /// Remove the locator from indices.
     ///
     /// \param loc The locator
@@ -439,35 +595,64 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// \param data
     void RecordDataLossFromWorker(const rpc::TaskEventData &data);
 
-    /// Evict task events from the storage when there are too many task events.
+    /// Evict an uncompressed task event from the storage when there are too many of
+    /// them.
     void EvictTaskEvent();
 
+    /// Evict the oldest compressed task events while their segments take more than
+    /// `max_compressed_bytes_`.
+    void EvictCompressedTaskEventsIfNeeded();
+
     /// Remove information of a task attempt from the storage.
     void RemoveTaskAttempt(std::shared_ptr<TaskEventLocator> loc);
 
+    /// Compress the oldest terminated task attempts of the lowest gc priority by a
+    /// segment, if there are more than a segment of them.
+    void CompressTaskEventsIfNeeded();
+
+    /// Decompress a task attempt, so that it can be updated.
+    ///
+    /// \param loc The locator of the compressed task attempt.
+    void DecompressTaskAttempt(const std::shared_ptr<TaskEventLocator> &loc);
+
+    /// Record the number of bytes of the compressed storage in the stats.
+    void RecordCompressedBytes();
+
     /// Test only functions.
     std::shared_ptr<TaskEventLocator> GetTaskEventLocator(
         const TaskAttempt &task_attempt) const {
       return primary_index_.at(task_attempt);
     }
 
-    /// Max number of task events allowed in the storage.
+    /// Max number of uncompressed task events allowed in the storage.
     const size_t max_num_task_events_ = 0;
 
+    /// The number of task attempts compressed together, or 0 if they aren't compressed.
+    const size_t segment_size_ = 0;
+
+    /// Max number of bytes of the compressed task events, or -1 for no limit.
+    const int64_t max_compressed_bytes_ = -1;
+
     /// Reference to the counter map owned by the GcsTaskManager.
     CounterMapThreadSafe<GcsTaskManagerCounter> &stats_counter_;
 
     // Primary index from task attempt to the locator.
     absl::flat_hash_map<TaskAttempt, std::shared_ptr<TaskEventLocator>> primary_index_;
 
-    // Secondary indices for retrieval.
-    absl::flat_hash_map<TaskID, absl::flat_hash_set<std::shared_ptr<TaskEventLocator>>>
-        task_index_;
-    absl::flat_hash_map<JobID, absl::flat_hash_set<std::shared_ptr<TaskEventLocator>>>
-        job_index_;
+    // Secondary indices for retrieval. The ones which are queried are ordered from the
+    // most recently added task attempt, so that the queries are paginated by looking up
+    // the cursor in them.
+    absl::flat_hash_map<TaskID, TaskAttemptSet> task_index_;
+    absl::flat_hash_map<JobID, TaskAttemptSet> job_index_;
+    absl::flat_hash_map<rpc::TaskStatus, TaskAttemptSet> state_index_;
+    absl::flat_hash_map<std::string, TaskAttemptSet> name_index_;
+    absl::flat_hash_map<ActorID, TaskAttemptSet> actor_index_;
     absl::flat_hash_map<WorkerID, absl::flat_hash_set<std::shared_ptr<TaskEventLocator>>>
         worker_index_;
 
+    /// The sequence number of the next task attempt added.
+    uint64_t next_seq_no_ = 1;
+
     // A summary for per job stats.
     absl::flat_hash_map<JobID, JobTaskSummary> job_task_summary_;
 
@@ -477,6 +662,10 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// Task events lists.
     std::vector<std::list<rpc::TaskEvents>> task_events_list_;
 
+    /// The compressed task events, which have the lowest gc priority and are older than
+    /// the ones of its list.
+    TaskEventColumnStore compressed_task_events_;
+
     friend class GcsTaskManager;
     FRIEND_TEST(GcsTaskManagerTest, TestHandleAddTaskEventBasic);
     FRIEND_TEST(GcsTaskManagerTest, TestMergeTaskEventsSameTaskAttempt);
@@ -485,6 +674,8 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     FRIEND_TEST(GcsTaskManagerTest, TestMarkTaskAttemptFailedIfNeeded);
     FRIEND_TEST(GcsTaskManagerTest, TestMultipleJobsDataLoss);
     FRIEND_TEST(GcsTaskManagerDroppedTaskAttemptsLimit, TestDroppedTaskAttemptsLimit);
+    FRIEND_TEST(GcsTaskManagerCompressedTest, TestCompressFinishedTasks);
+    FRIEND_TEST(GcsTaskManagerCompressedBytesLimitedTest, TestLimitCompressedBytes);
   };
 
  private:
@@ -543,6 +734,9 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
   FRIEND_TEST(GcsTaskManagerTest, TestTaskDataLossWorker);
   FRIEND_TEST(GcsTaskManagerTest, TestMultipleJobsDataLoss);
   FRIEND_TEST(GcsTaskManagerDroppedTaskAttemptsLimit, TestDroppedTaskAttemptsLimit);
+  FRIEND_TEST(GcsTaskManagerCompressedTest, TestCompressFinishedTasks);
+  FRIEND_TEST(GcsTaskManagerCompressedBytesLimitedTest, TestLimitCompressedBytes);
+  FRIEND_TEST(GcsTaskManagerTest, TestGetTaskEventsIndices);
 };
 
 }  // namespace gcs
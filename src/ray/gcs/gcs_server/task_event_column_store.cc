@@ -0,0 +1,496 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/task_event_column_store.h"
+
+#include <zlib.h>
+
+#include <array>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace gcs {
+
+namespace {
+
+/// The timestamps of the state updates, in the order of the lifecycle of a task.
+struct TimestampField {
+  rpc::TaskStatus status;
+  bool (rpc::TaskStateUpdate::*has)() const;
+  int64_t (rpc::TaskStateUpdate::*get)() const;
+  void (rpc::TaskStateUpdate::*set)(int64_t);
+  void (rpc::TaskStateUpdate::*clear)();
+};
+
+const TimestampField kTimestampFields[] = {
+    {rpc::TaskStatus::PENDING_ARGS_AVAIL,
+     &rpc::TaskStateUpdate::has_pending_args_avail_ts,
+     &rpc::TaskStateUpdate::pending_args_avail_ts,
+     &rpc::TaskStateUpdate::set_pending_args_avail_ts,
+     &rpc::TaskStateUpdate::clear_pending_args_avail_ts},
+    {rpc::TaskStatus::PENDING_NODE_ASSIGNMENT,
+     &rpc::TaskStateUpdate::has_pending_node_assignment_ts,
+     &rpc::TaskStateUpdate::pending_node_assignment_ts,
+     &rpc::TaskStateUpdate::set_pending_node_assignment_ts,
+     &rpc::TaskStateUpdate::clear_pending_node_assignment_ts},
+    {rpc::TaskStatus::SUBMITTED_TO_WORKER,
+     &rpc::TaskStateUpdate::has_submitted_to_worker_ts,
+     &rpc::TaskStateUpdate::submitted_to_worker_ts,
+     &rpc::TaskStateUpdate::set_submitted_to_worker_ts,
+     &rpc::TaskStateUpdate::clear_submitted_to_worker_ts},
+    {rpc::TaskStatus::RUNNING,
+     &rpc::TaskStateUpdate::has_running_ts,
+     &rpc::TaskStateUpdate::running_ts,
+     &rpc::TaskStateUpdate::set_running_ts,
+     &rpc::TaskStateUpdate::clear_running_ts},
+    {rpc::TaskStatus::FINISHED,
+     &rpc::TaskStateUpdate::has_finished_ts,
+     &rpc::TaskStateUpdate::finished_ts,
+     &rpc::TaskStateUpdate::set_finished_ts,
+     &rpc::TaskStateUpdate::clear_finished_ts},
+    {rpc::TaskStatus::FAILED,
+     &rpc::TaskStateUpdate::has_failed_ts,
+     &rpc::TaskStateUpdate::failed_ts,
+     &rpc::TaskStateUpdate::set_failed_ts,
+     &rpc::TaskStateUpdate::clear_failed_ts},
+};
+
+constexpr size_t kNumTimestamps = sizeof(kTimestampFields) / sizeof(TimestampField);
+
+/// The flags of the fields of a task attempt.
+enum RowFlag : uint16_t {
+  kHasTaskInfo = 1 << 0,
+  kHasStateUpdates = 1 << 1,
+  kHasActorId = 1 << 2,
+  kHasWorkerId = 1 << 3,
+  /// The job id of the task info is the one of the task events.
+  kTaskInfoHasJobId = 1 << 4,
+  /// The task id of the task info is the one of the task events.
+  kTaskInfoHasTaskId = 1 << 5,
+  /// The flag of the first timestamp, followed by the ones of the others.
+  kHasFirstTimestamp = 1 << 6,
+};
+
+void AppendVarint(uint64_t value, std::string *out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+uint64_t ReadVarint(const std::string &data, size_t *offset) {
+  uint64_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    RAY_CHECK(*offset < data.size());
+    const auto byte = static_cast<uint8_t>(data[(*offset)++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}  // namespace
+
+StringDictionary::StringDictionary() {
+  // The empty string isn't reference counted.
+  entries_.emplace_back();
+  codes_.emplace(entries_[0].value, 0);
+}
+
+uint32_t StringDictionary::Add(absl::string_view value) {
+  auto it = codes_.find(value);
+  uint32_t code;
+  if (it != codes_.end()) {
+    code = it->second;
+  } else if (!free_codes_.empty()) {
+    code = free_codes_.back();
+    free_codes_.pop_back();
+    entries_[code].value = std::string(value);
+    codes_.emplace(entries_[code].value, code);
+    num_bytes_ += value.size();
+  } else {
+    code = entries_.size();
+    entries_.emplace_back();
+    entries_.back().value = std::string(value);
+    codes_.emplace(entries_.back().value, code);
+    num_bytes_ += value.size();
+  }
+  if (code != 0) {
+    entries_[code].num_references++;
+  }
+  return code;
+}
+
+void StringDictionary::Release(uint32_t code) {
+  if (code == 0) {
+    return;
+  }
+  auto &entry = entries_[code];
+  RAY_CHECK(entry.num_references > 0);
+  if (--entry.num_references == 0) {
+    codes_.erase(entry.value);
+    num_bytes_ -= entry.value.size();
+    std::string().swap(entry.value);
+    free_codes_.push_back(code);
+  }
+}
+
+size_t TaskEventColumnStore::Segment::NumBytes() const {
+  return sizeof(Segment) +
+         num_rows * (sizeof(TaskID) + sizeof(int32_t) + 4 * sizeof(uint32_t) +
+                     sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint32_t)) +
+         removed.size() / 8 + block.capacity();
+}
+
+struct TaskEventColumnStore::DecodedBlock {
+  uint64_t segment_id;
+  std::string data;
+  /// The timestamps of each task attempt, or 0 if they aren't set.
+  std::vector<std::array<int64_t, kNumTimestamps>> timestamps;
+  /// The offsets and the sizes of the other fields in the data.
+  std::vector<std::pair<size_t, size_t>> others;
+};
+
+TaskEventColumnStore::TaskEventColumnStore() = default;
+
+TaskEventColumnStore::~TaskEventColumnStore() = default;
+
+std::vector<TaskEventColumnStore::RowId> TaskEventColumnStore::AddSegment(
+    std::vector<rpc::TaskEvents> &&task_events) {
+  RAY_CHECK(!task_events.empty());
+  const uint64_t segment_id = first_segment_id_ + segments_.size();
+  segments_.emplace_back();
+  auto &segment = segments_.back();
+  const size_t num_rows = task_events.size();
+  segment.num_rows = num_rows;
+  segment.task_ids.reserve(num_rows);
+  segment.attempt_numbers.reserve(num_rows);
+  segment.job_codes.reserve(num_rows);
+  segment.name_codes.reserve(num_rows);
+  segment.actor_codes.reserve(num_rows);
+  segment.worker_codes.reserve(num_rows);
+  segment.types.reserve(num_rows);
+  segment.flags.reserve(num_rows);
+  segment.num_profile_events.reserve(num_rows);
+  segment.removed.resize(num_rows, false);
+
+  // The timestamps and the other fields are encoded column by column in the block.
+  std::vector<std::string> timestamp_columns(kNumTimestamps);
+  std::vector<int64_t> previous_timestamps(kNumTimestamps, 0);
+  std::string others;
+
+  std::vector<RowId> ids;
+  ids.reserve(num_rows);
+  for (size_t row = 0; row < num_rows; ++row) {
+    auto &events = task_events[row];
+    uint16_t flags = 0;
+    segment.task_ids.push_back(TaskID::FromBinary(events.task_id()));
+    segment.attempt_numbers.push_back(events.attempt_number());
+    segment.job_codes.push_back(dictionary_.Add(events.job_id()));
+    segment.num_profile_events.push_back(
+        events.has_profile_events() ? events.profile_events().events_size() : 0);
+
+    uint32_t name_code = 0;
+    uint32_t actor_code = 0;
+    uint8_t type = 0;
+    if (events.has_task_info()) {
+      flags |= kHasTaskInfo;
+      auto *task_info = events.mutable_task_info();
+      name_code = dictionary_.Add(task_info->name());
+      type = static_cast<uint8_t>(task_info->type());
+      if (task_info->has_actor_id()) {
+        flags |= kHasActorId;
+        actor_code = dictionary_.Add(task_info->actor_id());
+      }
+      if (!task_info->job_id().empty() && task_info->job_id() == events.job_id()) {
+        flags |= kTaskInfoHasJobId;
+        task_info->clear_job_id();
+      }
+      if (!task_info->task_id().empty() && task_info->task_id() == events.task_id()) {
+        flags |= kTaskInfoHasTaskId;
+        task_info->clear_task_id();
+      }
+      task_info->clear_name();
+      task_info->clear_type();
+      task_info->clear_actor_id();
+    }
+    segment.name_codes.push_back(name_code);
+    segment.actor_codes.push_back(actor_code);
+    segment.types.push_back(type);
+
+    uint32_t worker_code = 0;
+    if (events.has_state_updates()) {
+      flags |= kHasStateUpdates;
+      auto *state_updates = events.mutable_state_updates();
+      if (state_updates->has_worker_id()) {
+        flags |= kHasWorkerId;
+        worker_code = dictionary_.Add(state_updates->worker_id());
+        state_updates->clear_worker_id();
+      }
+      for (size_t i = 0; i < kNumTimestamps; ++i) {
+        const auto &field = kTimestampFields[i];
+        if (!(state_updates->*field.has)()) {
+          continue;
+        }
+        flags |= static_cast<uint16_t>(kHasFirstTimestamp << i);
+        const int64_t timestamp = (state_updates->*field.get)();
+        AppendVarint(ZigZagEncode(timestamp - previous_timestamps[i]),
+                     &timestamp_columns[i]);
+        previous_timestamps[i] = timestamp;
+        (state_updates->*field.clear)();
+      }
+    }
+    segment.worker_codes.push_back(worker_code);
+    segment.flags.push_back(flags);
+
+    events.clear_task_id();
+    events.clear_job_id();
+    events.clear_attempt_number();
+    const auto serialized = events.SerializeAsString();
+    AppendVarint(serialized.size(), &others);
+    others.append(serialized);
+
+    ids.push_back({segment_id, static_cast<uint32_t>(row)});
+  }
+  task_events.clear();
+
+  std::string block;
+  for (const auto &column : timestamp_columns) {
+    block.append(column);
+  }
+  block.append(others);
+  segment.uncompressed_block_size = block.size();
+  uLongf compressed_size = compressBound(block.size());
+  segment.block.resize(compressed_size);
+  RAY_CHECK(compress(reinterpret_cast<Bytef *>(&segment.block[0]),
+                     &compressed_size,
+                     reinterpret_cast<const Bytef *>(block.data()),
+                     block.size()) == Z_OK);
+  segment.block.resize(compressed_size);
+  segment.block.shrink_to_fit();
+
+  num_rows_ += num_rows;
+  num_bytes_ += segment.NumBytes();
+  return ids;
+}
+
+const TaskEventColumnStore::Segment &TaskEventColumnStore::GetSegment(
+    uint64_t id) const {
+  RAY_CHECK(id >= first_segment_id_ && id - first_segment_id_ < segments_.size());
+  return segments_[id - first_segment_id_];
+}
+
+TaskEventColumnStore::Segment &TaskEventColumnStore::GetSegment(uint64_t id) {
+  RAY_CHECK(id >= first_segment_id_ && id - first_segment_id_ < segments_.size());
+  return segments_[id - first_segment_id_];
+}
+
+const TaskEventColumnStore::DecodedBlock &TaskEventColumnStore::Decode(
+    uint64_t segment_id) const {
+  if (decoded_block_ != nullptr && decoded_block_->segment_id == segment_id) {
+    return *decoded_block_;
+  }
+  const auto &segment = GetSegment(segment_id);
+  auto decoded = std::make_unique<DecodedBlock>();
+  decoded->segment_id = segment_id;
+  decoded->data.resize(segment.uncompressed_block_size);
+  uLongf size = segment.uncompressed_block_size;
+  RAY_CHECK(uncompress(reinterpret_cast<Bytef *>(&decoded->data[0]),
+                       &size,
+                       reinterpret_cast<const Bytef *>(segment.block.data()),
+                       segment.block.size()) == Z_OK);
+  RAY_CHECK(size == segment.uncompressed_block_size);
+
+  size_t offset = 0;
+  decoded->timestamps.resize(segment.num_rows);
+  for (size_t i = 0; i < kNumTimestamps; ++i) {
+    int64_t previous = 0;
+    for (size_t row = 0; row < segment.num_rows; ++row) {
+      if (segment.flags[row] & (kHasFirstTimestamp << i)) {
+        previous += ZigZagDecode(ReadVarint(decoded->data, &offset));
+        decoded->timestamps[row][i] = previous;
+      } else {
+        decoded->timestamps[row][i] = 0;
+      }
+    }
+  }
+  decoded->others.reserve(segment.num_rows);
+  for (size_t row = 0; row < segment.num_rows; ++row) {
+    const size_t size = ReadVarint(decoded->data, &offset);
+    RAY_CHECK(offset + size <= decoded->data.size());
+    decoded->others.emplace_back(offset, size);
+    offset += size;
+  }
+  decoded_block_ = std::move(decoded);
+  return *decoded_block_;
+}
+
+rpc::TaskEvents TaskEventColumnStore::Get(const RowId &id) const {
+  const auto &segment = GetSegment(id.segment);
+  RAY_CHECK(id.row < segment.num_rows && !segment.removed[id.row]);
+  const auto &block = Decode(id.segment);
+  const auto row = id.row;
+  const auto flags = segment.flags[row];
+
+  rpc::TaskEvents events;
+  const auto &[offset, size] = block.others[row];
+  RAY_CHECK(events.ParseFromArray(block.data.data() + offset, size));
+  events.set_task_id(segment.task_ids[row].Binary());
+  events.set_attempt_number(segment.attempt_numbers[row]);
+  events.set_job_id(dictionary_.Get(segment.job_codes[row]));
+  if (flags & kHasTaskInfo) {
+    auto *task_info = events.mutable_task_info();
+    task_info->set_name(dictionary_.Get(segment.name_codes[row]));
+    task_info->set_type(static_cast<rpc::TaskType>(segment.types[row]));
+    if (flags & kHasActorId) {
+      task_info->set_actor_id(dictionary_.Get(segment.actor_codes[row]));
+    }
+    if (flags & kTaskInfoHasJobId) {
+      task_info->set_job_id(events.job_id());
+    }
+    if (flags & kTaskInfoHasTaskId) {
+      task_info->set_task_id(events.task_id());
+    }
+  }
+  if (flags & kHasStateUpdates) {
+    auto *state_updates = events.mutable_state_updates();
+    if (flags & kHasWorkerId) {
+      state_updates->set_worker_id(dictionary_.Get(segment.worker_codes[row]));
+    }
+    for (size_t i = 0; i < kNumTimestamps; ++i) {
+      if (flags & (kHasFirstTimestamp << i)) {
+        (state_updates->*kTimestampFields[i].set)(block.timestamps[row][i]);
+      }
+    }
+  }
+  return events;
+}
+
+void TaskEventColumnStore::Remove(const RowId &id) {
+  auto &segment = GetSegment(id.segment);
+  const auto row = id.row;
+  RAY_CHECK(row < segment.num_rows && !segment.removed[row]);
+  segment.removed[row] = true;
+  dictionary_.Release(segment.job_codes[row]);
+  dictionary_.Release(segment.name_codes[row]);
+  dictionary_.Release(segment.actor_codes[row]);
+  dictionary_.Release(segment.worker_codes[row]);
+  num_rows_--;
+  while (segment.first_row < segment.num_rows && segment.removed[segment.first_row]) {
+    segment.first_row++;
+  }
+  if (segment.first_row < segment.num_rows) {
+    return;
+  }
+
+  // All the task attempts of the segment are removed.
+  if (decoded_block_ != nullptr && decoded_block_->segment_id == id.segment) {
+    decoded_block_.reset();
+  }
+  num_bytes_ -= segment.NumBytes();
+  segment = Segment();
+  while (!segments_.empty() && segments_.front().num_rows == 0) {
+    segments_.pop_front();
+    first_segment_id_++;
+  }
+}
+
+TaskEventColumnStore::RowId TaskEventColumnStore::Oldest() const {
+  RAY_CHECK(!Empty());
+  // The oldest segment has task attempts which aren't removed.
+  return {first_segment_id_, segments_.front().first_row};
+}
+
+std::vector<TaskEventColumnStore::RowId> TaskEventColumnStore::GetAll() const {
+  std::vector<RowId> ids;
+  ids.reserve(num_rows_);
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const auto &segment = segments_[i];
+    for (size_t row = segment.first_row; row < segment.num_rows; ++row) {
+      if (!segment.removed[row]) {
+        ids.push_back({first_segment_id_ + i, static_cast<uint32_t>(row)});
+      }
+    }
+  }
+  return ids;
+}
+
+TaskAttempt TaskEventColumnStore::GetTaskAttempt(const RowId &id) const {
+  const auto &segment = GetSegment(id.segment);
+  return std::make_pair(segment.task_ids[id.row], segment.attempt_numbers[id.row]);
+}
+
+JobID TaskEventColumnStore::GetJobId(const RowId &id) const {
+  return JobID::FromBinary(dictionary_.Get(GetSegment(id.segment).job_codes[id.row]));
+}
+
+WorkerID TaskEventColumnStore::GetWorkerId(const RowId &id) const {
+  const auto &segment = GetSegment(id.segment);
+  if (!(segment.flags[id.row] & kHasWorkerId)) {
+    return WorkerID::Nil();
+  }
+  return WorkerID::FromBinary(dictionary_.Get(segment.worker_codes[id.row]));
+}
+
+bool TaskEventColumnStore::HasTaskInfo(const RowId &id) const {
+  return GetSegment(id.segment).flags[id.row] & kHasTaskInfo;
+}
+
+bool TaskEventColumnStore::HasStateUpdates(const RowId &id) const {
+  return GetSegment(id.segment).flags[id.row] & kHasStateUpdates;
+}
+
+rpc::TaskType TaskEventColumnStore::GetType(const RowId &id) const {
+  return static_cast<rpc::TaskType>(GetSegment(id.segment).types[id.row]);
+}
+
+absl::string_view TaskEventColumnStore::GetName(const RowId &id) const {
+  return dictionary_.Get(GetSegment(id.segment).name_codes[id.row]);
+}
+
+bool TaskEventColumnStore::HasActorId(const RowId &id) const {
+  return GetSegment(id.segment).flags[id.row] & kHasActorId;
+}
+
+absl::string_view TaskEventColumnStore::GetActorId(const RowId &id) const {
+  return dictionary_.Get(GetSegment(id.segment).actor_codes[id.row]);
+}
+
+rpc::TaskStatus TaskEventColumnStore::GetState(const RowId &id) const {
+  const auto flags = GetSegment(id.segment).flags[id.row];
+  for (size_t i = kNumTimestamps; i > 0; --i) {
+    if (flags & (kHasFirstTimestamp << (i - 1))) {
+      return kTimestampFields[i - 1].status;
+    }
+  }
+  return rpc::TaskStatus::NIL;
+}
+
+size_t TaskEventColumnStore::NumProfileEvents(const RowId &id) const {
+  return GetSegment(id.segment).num_profile_events[id.row];
+}
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,205 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "ray/common/id.h"
+#include "ray/common/task/task_spec.h"
+#include "src/ray/protobuf/gcs.pb.h"
+
+namespace ray {
+namespace gcs {
+
+/// A dictionary of strings, which encodes the strings repeated across the task events,
+/// e.g. the names of the tasks, as codes. The code 0 is the empty string.
+///
+/// The codes are reference counted, and the code of a string is reused once it isn't
+/// referenced anymore.
+class StringDictionary {
+ public:
+  StringDictionary();
+
+  /// Add a reference to a string.
+  ///
+  /// \return The code of the string.
+  uint32_t Add(absl::string_view value);
+
+  /// Remove a reference to a string.
+  void Release(uint32_t code);
+
+  /// Get the string of a code.
+  const std::string &Get(uint32_t code) const { return entries_[code].value; }
+
+  /// The number of strings in the dictionary.
+  size_t Size() const { return codes_.size(); }
+
+  /// The approximate number of bytes of the dictionary.
+  size_t NumBytes() const {
+    return num_bytes_ + entries_.size() * (sizeof(Entry) + sizeof(absl::string_view) +
+                                           sizeof(uint32_t));
+  }
+
+ private:
+  struct Entry {
+    std::string value;
+    size_t num_references = 0;
+  };
+
+  /// The entries by code. It's a deque so that the keys of codes_ stay valid.
+  std::deque<Entry> entries_;
+  absl::flat_hash_map<absl::string_view, uint32_t> codes_;
+  std::vector<uint32_t> free_codes_;
+  /// The number of bytes of the strings.
+  size_t num_bytes_ = 0;
+};
+
+/// A columnar storage of task events, which stores the events of the task attempts in
+/// a fraction of the memory of their protobufs, at the cost of making them immutable.
+///
+/// The task events are added by segments. The columns of a segment are:
+/// - The task ids, the attempt numbers, the types and the numbers of profile events.
+/// - The job ids, the names, the actor ids and the worker ids, encoded by a dictionary
+///   shared by the segments.
+/// - The timestamps of the state updates, delta-encoded with the same timestamp of the
+///   previous task attempt of the segment. The state of a task attempt is derived from
+///   which timestamps are set.
+/// - The other fields, as a serialized rpc::TaskEvents.
+/// The timestamps and the other fields are compressed as a block, which is decompressed
+/// when a task attempt of the segment is read. The other columns aren't compressed, so
+/// that the task attempts are filtered and indexed without decompressing the blocks.
+///
+/// A task attempt is removed by marking it in its segment, and the segments are freed
+/// once all of their task attempts are removed.
+///
+/// This class is not thread-safe.
+class TaskEventColumnStore {
+ public:
+  /// The id of a task attempt in the storage.
+  struct RowId {
+    /// The id of the segment, which increases with the segments added.
+    uint64_t segment;
+    /// The index of the task attempt in the segment.
+    uint32_t row;
+
+    bool operator<(const RowId &other) const {
+      return segment < other.segment || (segment == other.segment && row < other.row);
+    }
+  };
+
+  TaskEventColumnStore();
+  ~TaskEventColumnStore();
+
+  /// Add a segment of task events.
+  ///
+  /// \param task_events The events of the task attempts, from the oldest one.
+  /// \return The ids of the task attempts, in the same order.
+  std::vector<RowId> AddSegment(std::vector<rpc::TaskEvents> &&task_events);
+
+  /// Get the events of a task attempt. The block of its segment is decompressed unless
+  /// it's the last one which was, so the task attempts should be read segment by
+  /// segment.
+  rpc::TaskEvents Get(const RowId &id) const;
+
+  /// Remove a task attempt.
+  void Remove(const RowId &id);
+
+  /// Return the number of task attempts stored.
+  size_t NumRows() const { return num_rows_; }
+
+  /// Return if no task attempts are stored.
+  bool Empty() const { return num_rows_ == 0; }
+
+  /// Return the approximate number of bytes of the segments and the dictionary.
+  size_t NumBytes() const { return num_bytes_ + dictionary_.NumBytes(); }
+
+  /// Get the oldest task attempt. The storage must not be empty.
+  RowId Oldest() const;
+
+  /// Get all the task attempts, from the oldest one.
+  std::vector<RowId> GetAll() const;
+
+  /// The columns of a task attempt.
+  TaskAttempt GetTaskAttempt(const RowId &id) const;
+  JobID GetJobId(const RowId &id) const;
+  /// The nil id if the task attempt has no worker.
+  WorkerID GetWorkerId(const RowId &id) const;
+  bool HasTaskInfo(const RowId &id) const;
+  bool HasStateUpdates(const RowId &id) const;
+  rpc::TaskType GetType(const RowId &id) const;
+  absl::string_view GetName(const RowId &id) const;
+  bool HasActorId(const RowId &id) const;
+  absl::string_view GetActorId(const RowId &id) const;
+  /// The latest status of the task attempt, or NIL if it has no state updates.
+  rpc::TaskStatus GetState(const RowId &id) const;
+  size_t NumProfileEvents(const RowId &id) const;
+
+ private:
+  struct Segment {
+    /// The columns which aren't compressed.
+    std::vector<TaskID> task_ids;
+    std::vector<int32_t> attempt_numbers;
+    std::vector<uint32_t> job_codes;
+    std::vector<uint32_t> name_codes;
+    std::vector<uint32_t> actor_codes;
+    std::vector<uint32_t> worker_codes;
+    std::vector<uint8_t> types;
+    /// The flags of the fields which are set, see RowFlag.
+    std::vector<uint16_t> flags;
+    std::vector<uint32_t> num_profile_events;
+    std::vector<bool> removed;
+
+    /// The compressed block of the timestamps and the other fields.
+    std::string block;
+    size_t uncompressed_block_size = 0;
+
+    size_t num_rows = 0;
+    /// The oldest task attempt which isn't removed.
+    uint32_t first_row = 0;
+
+    size_t NumBytes() const;
+  };
+
+  struct DecodedBlock;
+
+  const Segment &GetSegment(uint64_t id) const;
+  Segment &GetSegment(uint64_t id);
+
+  /// Decode the block of a segment, if it isn't the one decoded last.
+  const DecodedBlock &Decode(uint64_t segment_id) const;
+
+  /// The segments, from the oldest one. The ones whose task attempts are all removed
+  /// are freed, and dropped once they're the oldest.
+  std::deque<Segment> segments_;
+
+  /// The id of the oldest segment.
+  uint64_t first_segment_id_ = 0;
+
+  StringDictionary dictionary_;
+
+  size_t num_rows_ = 0;
+  size_t num_bytes_ = 0;
+
+  /// The block decoded last.
+  mutable std::unique_ptr<DecodedBlock> decoded_block_;
+};
+
+}  // namespace gcs
+}  // namespace ray
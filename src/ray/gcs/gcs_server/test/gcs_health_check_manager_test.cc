@@ -234,6 +234,41 @@ TEST_F(GcsHealthCheckManagerTest, NodeRemoved) {
   ASSERT_EQ(0, health_check->GetAllNodes().size());
 }
 
+TEST_F(GcsHealthCheckManagerTest, SkipIfHeardFrom) {
+  auto node_id = AddServer();
+  Run(0);  // Initial run
+  ASSERT_TRUE(dead_nodes.empty());
+
+  // Run the first health check
+  Run();
+  Run(2);  // One for starting RPC and one for the RPC callback.
+  ASSERT_TRUE(dead_nodes.empty());
+
+  // The node is gone, but it's still heard from before every check, so the checks
+  // are skipped without any RPC.
+  DeleteServer(node_id);
+  for (auto i = 0; i < failure_threshold * 2; ++i) {
+    health_check->MarkNodeHealthy(node_id);
+    Run(1);  // The check is skipped and the next one is scheduled.
+  }
+  ASSERT_TRUE(dead_nodes.empty());
+
+  // Once it's not heard from anymore, the RPCs are sent and it's marked dead.
+  for (auto i = 0; i < failure_threshold; ++i) {
+    Run(2);  // One for starting RPC and one for the RPC callback.
+  }
+  ASSERT_EQ(1, dead_nodes.size());
+  ASSERT_TRUE(dead_nodes.count(node_id));
+}
+
+TEST_F(GcsHealthCheckManagerTest, MarkUnknownNodeHealthy) {
+  // Nodes not being monitored are ignored.
+  health_check->MarkNodeHealthy(NodeID::FromRandom());
+  Run(0);
+  ASSERT_EQ(0, health_check->GetAllNodes().size());
+  ASSERT_TRUE(dead_nodes.empty());
+}
+
 TEST_F(GcsHealthCheckManagerTest, NoRegister) {
   auto node_id = AddServer(false);
   for (auto i = 0; i < failure_threshold; ++i) {
@@ -0,0 +1,194 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of the task event queries of the GCS, which stores 10M task events and
+// gets them by filters and by pages.
+//
+// It's not run by default. Run it with
+//   bazel run -c opt //:gcs_task_manager_benchmark
+
+#include <future>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/gcs/gcs_server/gcs_task_manager.h"
+#include "ray/gcs/pb_util.h"
+
+namespace ray {
+
+namespace gcs {
+
+namespace {
+
+constexpr int kNumTaskEvents = 10 * 1000 * 1000;
+constexpr int kBatchSize = 10000;
+constexpr int kNumJobs = 10;
+constexpr int kNumNames = 1000;
+constexpr int kLimit = 100;
+
+class GcsTaskManagerBenchmark : public ::testing::Test {
+ public:
+  GcsTaskManagerBenchmark() {
+    RayConfig::instance().initialize(
+        R"(
+{
+  "task_events_max_num_task_in_gcs": 10000000
+}
+  )");
+  }
+
+  void SetUp() override { task_manager_ = std::make_unique<GcsTaskManager>(); }
+
+  void TearDown() override { task_manager_->Stop(); }
+
+  /// Generate the events of a task attempt. 90% of the tasks are finished, 5% are
+  /// failed and 5% are running.
+  static rpc::TaskEvents GenTaskEvents(int i) {
+    rpc::TaskEvents events;
+    const auto job_id = JobID::FromInt(i % kNumJobs);
+    events.set_task_id(TaskID::FromRandom(job_id).Binary());
+    events.set_job_id(job_id.Binary());
+    events.set_attempt_number(0);
+    auto *task_info = events.mutable_task_info();
+    task_info->set_job_id(job_id.Binary());
+    task_info->set_type(rpc::TaskType::NORMAL_TASK);
+    task_info->set_name("task_" + std::to_string(i % kNumNames));
+    auto *state_updates = events.mutable_state_updates();
+    FillTaskStatusUpdateTime(rpc::TaskStatus::RUNNING, i, state_updates);
+    if (i % 20 == 0) {
+      FillTaskStatusUpdateTime(rpc::TaskStatus::FAILED, i + 1, state_updates);
+    } else if (i % 20 != 1) {
+      FillTaskStatusUpdateTime(rpc::TaskStatus::FINISHED, i + 1, state_updates);
+    }
+    return events;
+  }
+
+  void AddTaskEvents(int begin, int end) {
+    rpc::AddTaskEventDataRequest request;
+    for (int i = begin; i < end; ++i) {
+      *request.mutable_data()->add_events_by_task() = GenTaskEvents(i);
+    }
+    rpc::AddTaskEventDataReply reply;
+    std::promise<bool> promise;
+    task_manager_->GetIoContext().dispatch(
+        [this, &promise, &request, &reply]() {
+          task_manager_->HandleAddTaskEventData(
+              request,
+              &reply,
+              [&promise](Status, std::function<void()>, std::function<void()>) {
+                promise.set_value(true);
+              });
+        },
+        "AddTaskEvents");
+    promise.get_future().get();
+  }
+
+  rpc::GetTaskEventsReply GetTaskEvents(const rpc::GetTaskEventsRequest &request) {
+    rpc::GetTaskEventsReply reply;
+    std::promise<bool> promise;
+    task_manager_->GetIoContext().dispatch(
+        [this, &promise, &request, &reply]() {
+          task_manager_->HandleGetTaskEvents(
+              request,
+              &reply,
+              [&promise](Status, std::function<void()>, std::function<void()>) {
+                promise.set_value(true);
+              });
+        },
+        "GetTaskEvents");
+    promise.get_future().get();
+    return reply;
+  }
+
+  /// Run a query several times, and print its average latency.
+  void TimeQuery(const std::string &description,
+                 const rpc::GetTaskEventsRequest &request,
+                 int num_runs = 10) {
+    const auto start = absl::GetCurrentTimeNanos();
+    rpc::GetTaskEventsReply reply;
+    for (int i = 0; i < num_runs; ++i) {
+      reply = GetTaskEvents(request);
+    }
+    const auto latency_ms = (absl::GetCurrentTimeNanos() - start) / 1e6 / num_runs;
+    std::cout << description << ": " << reply.events_by_task_size() << " of "
+              << reply.num_total_stored() << " task events in " << latency_ms << " ms"
+              << std::endl;
+  }
+
+ protected:
+  std::unique_ptr<GcsTaskManager> task_manager_;
+};
+
+TEST_F(GcsTaskManagerBenchmark, GetTaskEvents) {
+  const auto start = absl::GetCurrentTimeNanos();
+  for (int i = 0; i < kNumTaskEvents; i += kBatchSize) {
+    AddTaskEvents(i, i + kBatchSize);
+  }
+  std::cout << "Stored " << kNumTaskEvents << " task events in "
+            << (absl::GetCurrentTimeNanos() - start) / 1e6 << " ms" << std::endl;
+
+  {
+    rpc::GetTaskEventsRequest request;
+    request.set_limit(kLimit);
+    TimeQuery("All", request);
+  }
+  {
+    rpc::GetTaskEventsRequest request;
+    request.set_limit(kLimit);
+    request.mutable_filters()->set_job_id(JobID::FromInt(1).Binary());
+    TimeQuery("By job", request);
+  }
+  {
+    rpc::GetTaskEventsRequest request;
+    request.set_limit(kLimit);
+    request.mutable_filters()->set_state(rpc::TaskStatus::FAILED);
+    TimeQuery("By state", request);
+  }
+  {
+    rpc::GetTaskEventsRequest request;
+    request.set_limit(kLimit);
+    request.mutable_filters()->set_name("task_1");
+    TimeQuery("By name", request);
+  }
+  {
+    // The failed tasks are all of job 0, so this scans all of them without a match.
+    rpc::GetTaskEventsRequest request;
+    request.set_limit(kLimit);
+    request.mutable_filters()->set_job_id(JobID::FromInt(1).Binary());
+    request.mutable_filters()->set_state(rpc::TaskStatus::FAILED);
+    TimeQuery("By job and state", request);
+  }
+
+  // Page through the first 100k task events of a job.
+  rpc::GetTaskEventsRequest request;
+  request.set_limit(1000);
+  request.mutable_filters()->set_job_id(JobID::FromInt(2).Binary());
+  const auto paging_start = absl::GetCurrentTimeNanos();
+  int num_task_events = 0;
+  for (int page = 0; page < 100; ++page) {
+    auto reply = GetTaskEvents(request);
+    num_task_events += reply.events_by_task_size();
+    ASSERT_TRUE(reply.has_next_cursor());
+    request.set_cursor(reply.next_cursor());
+  }
+  ASSERT_EQ(num_task_events, 100 * 1000);
+  std::cout << "Paged " << num_task_events << " task events of a job in 100 pages in "
+            << (absl::GetCurrentTimeNanos() - paging_start) / 1e6 << " ms" << std::endl;
+}
+
+}  // namespace
+
+}  // namespace gcs
+
+}  // namespace ray
@@ -129,8 +129,6 @@ class GcsTaskManagerTest : public ::testing::Test {
                                             const std::string &name = "",
                                             const ActorID &actor_id = ActorID::Nil()) {
     rpc::GetTaskEventsRequest request;
-    rpc::GetTaskEventsReply reply;
-    std::promise<bool> promise;
 
     if (!task_ids.empty()) {
       for (const auto &task_id : task_ids) {
@@ -156,6 +154,14 @@ class GcsTaskManagerTest : public ::testing::Test {
 
     request.mutable_filters()->set_exclude_driver(exclude_driver);
 
+    return SyncHandleGetTaskEvents(request);
+  }
+
+  rpc::GetTaskEventsReply SyncHandleGetTaskEvents(
+      const rpc::GetTaskEventsRequest &request) {
+    rpc::GetTaskEventsReply reply;
+    std::promise<bool> promise;
+
     task_manager->GetIoContext().dispatch(
         [this, &promise, &request, &reply]() {
           task_manager->HandleGetTaskEvents(
@@ -284,6 +290,70 @@ class GcsTaskManagerMemoryLimitedTest : public GcsTaskManagerTest {
   }
 };
 
+class GcsTaskManagerCompressedTest : public GcsTaskManagerTest {
+ public:
+  GcsTaskManagerCompressedTest() : GcsTaskManagerTest() {
+    RayConfig::instance().initialize(
+        R"(
+{
+  "task_events_max_num_task_in_gcs": 12,
+  "task_events_compressed_segment_size_in_gcs": 4
+}
+  )");
+  }
+};
+
+class GcsTaskManagerCompressedBytesLimitedTest : public GcsTaskManagerTest {
+ public:
+  GcsTaskManagerCompressedBytesLimitedTest() : GcsTaskManagerTest() {
+    RayConfig::instance().initialize(
+        R"(
+{
+  "task_events_max_num_task_in_gcs": 10,
+  "task_events_compressed_segment_size_in_gcs": 4,
+  "task_events_max_compressed_bytes_in_gcs": 0
+}
+  )");
+  }
+};
+
+class GcsTaskManagerPaginatedTest : public GcsTaskManagerTest {
+ public:
+  GcsTaskManagerPaginatedTest() : GcsTaskManagerTest() {
+    RayConfig::instance().initialize(
+        R"(
+{
+  "task_events_max_num_returned_in_gcs": 4
+}
+  )");
+  }
+
+  /// Get the task events of a job by pages, and return the task ids of the pages.
+  std::vector<std::vector<TaskID>> GetPages(const JobID &job_id, int64_t limit) {
+    std::vector<std::vector<TaskID>> pages;
+    absl::optional<uint64_t> cursor;
+    do {
+      rpc::GetTaskEventsRequest request;
+      request.mutable_filters()->set_job_id(job_id.Binary());
+      if (limit >= 0) {
+        request.set_limit(limit);
+      }
+      if (cursor.has_value()) {
+        request.set_cursor(*cursor);
+      }
+      auto reply = SyncHandleGetTaskEvents(request);
+
+      pages.emplace_back();
+      for (const auto &events : reply.events_by_task()) {
+        pages.back().push_back(TaskID::FromBinary(events.task_id()));
+      }
+      cursor = reply.has_next_cursor() ? absl::make_optional(reply.next_cursor())
+                                       : absl::nullopt;
+    } while (cursor.has_value());
+    return pages;
+  }
+};
+
 class GcsTaskManagerDroppedTaskAttemptsLimit : public GcsTaskManagerTest {
  public:
   GcsTaskManagerDroppedTaskAttemptsLimit() : GcsTaskManagerTest() {
@@ -426,17 +496,21 @@ TEST_F(GcsTaskManagerTest, TestGetTaskEventsWithLimit) {
   }
 
   {
+    // The task events beyond the limit are truncated rather than dropped, and the
+    // next page starts from the cursor.
     auto reply = SyncGetTaskEvents(/* task_ids */ {}, /* job_id */ absl::nullopt, 10);
     EXPECT_EQ(reply.events_by_task_size(), 10);
-    EXPECT_EQ(reply.num_profile_task_events_dropped(), num_task_events - 10);
-    EXPECT_EQ(reply.num_status_task_events_dropped(), num_task_events - 10);
+    EXPECT_EQ(reply.num_profile_task_events_dropped(), 0);
+    EXPECT_EQ(reply.num_status_task_events_dropped(), 0);
+    EXPECT_EQ(reply.num_total_stored(), num_task_events);
+    EXPECT_TRUE(reply.has_next_cursor());
   }
 
   {
     auto reply = SyncGetTaskEvents(/* task_ids */ {}, /* job_id */ absl::nullopt, 0);
     EXPECT_EQ(reply.events_by_task_size(), 0);
-    EXPECT_EQ(reply.num_profile_task_events_dropped(), num_task_events);
-    EXPECT_EQ(reply.num_status_task_events_dropped(), num_task_events);
+    EXPECT_EQ(reply.num_profile_task_events_dropped(), 0);
+    EXPECT_EQ(reply.num_status_task_events_dropped(), 0);
   }
 
   {
@@ -588,6 +662,86 @@ TEST_F(GcsTaskManagerTest, TestGetTaskEventsFilters) {
   EXPECT_EQ(reply_both_and.events_by_task_size(), 0);
 }
 
+TEST_F(GcsTaskManagerTest, TestGetTaskEventsIndices) {
+  // Tasks alternating between two names, half of them running and the other half
+  // finished, and an actor task.
+  auto tasks = GenTaskIDs(10);
+  ActorID actor_id = ActorID::Of(JobID::FromInt(1), TaskID::Nil(), 1);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    auto events =
+        GenTaskEvents({tasks[i]},
+                      /* attempt_number */ 0,
+                      /* job_id */ 1,
+                      /* profile event */ absl::nullopt,
+                      GenStateUpdate({{i % 2 == 0 ? rpc::TaskStatus::RUNNING
+                                                  : rpc::TaskStatus::FINISHED,
+                                       1}}),
+                      GenTaskInfo(JobID::FromInt(1),
+                                  TaskID::Nil(),
+                                  rpc::NORMAL_TASK,
+                                  ActorID::Nil(),
+                                  i < 5 ? "task_a" : "task_b"));
+    SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+  }
+  auto actor_task = GenTaskIDs(1)[0];
+  SyncAddTaskEvent({actor_task},
+                   {{rpc::TaskStatus::PENDING_ARGS_AVAIL, 1}},
+                   TaskID::Nil(),
+                   /* job_id */ 1,
+                   absl::nullopt,
+                   actor_id);
+
+  auto get_by_state = [this](rpc::TaskStatus state, const std::string &name = "") {
+    rpc::GetTaskEventsRequest request;
+    request.mutable_filters()->set_state(state);
+    if (!name.empty()) {
+      request.mutable_filters()->set_name(name);
+    }
+    return SyncHandleGetTaskEvents(request);
+  };
+
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::RUNNING).events_by_task_size(), 5);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::FINISHED).events_by_task_size(), 5);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::PENDING_ARGS_AVAIL).events_by_task_size(), 1);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::FAILED).events_by_task_size(), 0);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::RUNNING, "task_a").events_by_task_size(), 3);
+
+  // The state index is updated as the task events are merged.
+  SyncAddTaskEvent({tasks[0]}, {{rpc::TaskStatus::FINISHED, 2}}, TaskID::Nil(), 1);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::RUNNING).events_by_task_size(), 4);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::FINISHED).events_by_task_size(), 6);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::FINISHED, "task_a").events_by_task_size(), 3);
+
+  // And as the running tasks are marked failed.
+  task_manager->task_event_storage_->MarkTasksFailedOnJobEnds(JobID::FromInt(1), 3);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::RUNNING).events_by_task_size(), 0);
+  EXPECT_EQ(get_by_state(rpc::TaskStatus::FAILED).events_by_task_size(), 5);
+
+  // The actor index only has the tasks of the actor.
+  auto reply = SyncGetTaskEvents({},
+                                 /* job_id */ absl::nullopt,
+                                 /* limit */ -1,
+                                 /* exclude_driver */ false,
+                                 /* name */ "",
+                                 actor_id);
+  ASSERT_EQ(reply.events_by_task_size(), 1);
+  EXPECT_EQ(TaskID::FromBinary(reply.events_by_task(0).task_id()), actor_task);
+
+  // The filters are ANDed with the task ids.
+  reply = SyncGetTaskEvents({tasks[0], tasks[1], tasks[5]}, JobID::FromInt(1), -1, true);
+  EXPECT_EQ(reply.events_by_task_size(), 3);
+  EXPECT_EQ(reply.num_total_stored(), 3);
+  reply = SyncGetTaskEvents({tasks[0], tasks[1], tasks[5]}, JobID::FromInt(2), -1, true);
+  EXPECT_EQ(reply.events_by_task_size(), 0);
+  reply = SyncGetTaskEvents({tasks[0], tasks[1], tasks[5]},
+                            absl::nullopt,
+                            -1,
+                            true,
+                            /* name */ "task_b");
+  ASSERT_EQ(reply.events_by_task_size(), 1);
+  EXPECT_EQ(TaskID::FromBinary(reply.events_by_task(0).task_id()), tasks[5]);
+}
+
 TEST_F(GcsTaskManagerTest, TestMarkTaskAttemptFailedIfNeeded) {
   auto tasks = GenTaskIDs(3);
   auto tasks_running = tasks[0];
@@ -776,6 +930,9 @@ TEST_F(GcsTaskManagerMemoryLimitedTest, TestIndexNoLeak) {
     EXPECT_EQ(task_manager->task_event_storage_->job_index_.size(), 1);
     EXPECT_EQ(task_manager->task_event_storage_->primary_index_.size(), num_limit);
     EXPECT_EQ(task_manager->task_event_storage_->worker_index_.size(), 0);
+    EXPECT_EQ(task_manager->task_event_storage_->state_index_.size(), 1);
+    EXPECT_EQ(task_manager->task_event_storage_->name_index_.size(), 1);
+    EXPECT_EQ(task_manager->task_event_storage_->actor_index_.size(), 1);
   }
 }
 
@@ -1025,6 +1182,131 @@ TEST_F(GcsTaskManagerDroppedTaskAttemptsLimit, TestDroppedTaskAttemptsLimit) {
   EXPECT_EQ(job_summary.NumTaskAttemptsDropped(), 10);
 }
 
+TEST_F(GcsTaskManagerCompressedTest, TestCompressFinishedTasks) {
+  auto &storage = *task_manager->task_event_storage_;
+  auto finished_tasks = GenTaskIDs(10);
+  auto running_tasks = GenTaskIDs(2);
+  auto worker_id = WorkerID::FromRandom();
+  std::vector<rpc::TaskEvents> expected_events;
+  for (int64_t i = 0; i < 10; ++i) {
+    auto events = GenTaskEvents(
+        {finished_tasks[i]},
+        /* attempt_number */ 0,
+        /* job_id */ 0,
+        GenProfileEvents("event", i, i),
+        GenStateUpdate({{rpc::TaskStatus::RUNNING, i}, {rpc::TaskStatus::FINISHED, i + 1}},
+                       worker_id),
+        GenTaskInfo(JobID::FromInt(0),
+                    TaskID::Nil(),
+                    rpc::TaskType::NORMAL_TASK,
+                    ActorID::Nil(),
+                    i % 2 == 0 ? "even" : "odd"));
+    SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+    expected_events.push_back(events[0]);
+  }
+  SyncAddTaskEvent(running_tasks, {{rpc::TaskStatus::RUNNING, 1}});
+
+  // The 8 oldest finished tasks are compressed by segments of 4.
+  EXPECT_EQ(storage.compressed_task_events_.NumRows(), 8);
+  EXPECT_EQ(storage.task_events_list_[0].size(), 2);
+  EXPECT_EQ(storage.GetTaskEvents().size(), 12);
+  EXPECT_EQ(task_manager->GetNumTaskEventsStored(), 12);
+
+  // Get all, by job, and by task ids.
+  {
+    auto reply = SyncGetTaskEvents({});
+    EXPECT_EQ(reply.events_by_task_size(), 12);
+    reply = SyncGetTaskEvents({}, JobID::FromInt(0));
+    EXPECT_EQ(reply.events_by_task_size(), 12);
+
+    reply = SyncGetTaskEvents({finished_tasks.begin(), finished_tasks.end()});
+    google::protobuf::RepeatedPtrField<rpc::TaskEvents> expected(expected_events.begin(),
+                                                                 expected_events.end());
+    ExpectTaskEventsEq(&expected, reply.mutable_events_by_task());
+  }
+
+  // Filters are evaluated on the compressed tasks.
+  {
+    auto reply = SyncGetTaskEvents({}, absl::nullopt, -1, true, "even");
+    EXPECT_EQ(reply.events_by_task_size(), 5);
+    for (const auto &events : reply.events_by_task()) {
+      EXPECT_EQ(events.task_info().name(), "even");
+    }
+
+    reply = SyncGetTaskEvents({}, JobID::FromInt(0), -1, true, "even");
+    EXPECT_EQ(reply.events_by_task_size(), 5);
+    EXPECT_EQ(reply.num_total_stored(), 12);
+
+    reply = SyncGetTaskEvents({}, absl::nullopt, /* limit */ 3, true, "odd");
+    EXPECT_EQ(reply.events_by_task_size(), 3);
+    EXPECT_TRUE(reply.has_next_cursor());
+  }
+
+  // Compressed tasks aren't marked failed, since they're terminated.
+  {
+    rpc::WorkerTableData worker_failure_data;
+    worker_failure_data.set_end_time_ms(100);
+    storage.MarkTasksFailedOnWorkerDead(worker_id, worker_failure_data);
+    auto reply = SyncGetTaskEvents({finished_tasks[0]});
+    EXPECT_EQ(reply.events_by_task_size(), 1);
+    EXPECT_FALSE(reply.events_by_task(0).state_updates().has_failed_ts());
+  }
+
+  // Updating a compressed task decompresses it.
+  {
+    auto events =
+        GenTaskEvents({finished_tasks[1]}, 0, 0, GenProfileEvents("event", 100, 100));
+    SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+    EXPECT_EQ(storage.compressed_task_events_.NumRows(), 7);
+    auto reply = SyncGetTaskEvents({finished_tasks[1]});
+    EXPECT_EQ(reply.events_by_task_size(), 1);
+    EXPECT_EQ(reply.events_by_task(0).profile_events().events_size(), 2);
+    EXPECT_EQ(reply.events_by_task(0).state_updates().finished_ts(), 2);
+  }
+
+  // The compressed tasks don't count against the max number of task events.
+  {
+    SyncAddTaskEvent(GenTaskIDs(1), {{rpc::TaskStatus::RUNNING, 1}});
+    EXPECT_EQ(storage.compressed_task_events_.NumRows(), 7);
+    EXPECT_EQ(SyncGetTaskEvents({}).events_by_task_size(), 13);
+    EXPECT_EQ(task_manager->GetTotalNumTaskAttemptsDropped(), 0);
+  }
+
+  // Data loss reported by workers removes the compressed tasks.
+  {
+    rpc::TaskEventData data;
+    auto dropped = data.add_dropped_task_attempts();
+    dropped->set_task_id(finished_tasks[2].Binary());
+    dropped->set_attempt_number(0);
+    data.set_job_id(JobID::FromInt(0).Binary());
+    SyncAddTaskEventData(data);
+    EXPECT_EQ(storage.compressed_task_events_.NumRows(), 6);
+    EXPECT_EQ(SyncGetTaskEvents({finished_tasks[2]}).events_by_task_size(), 0);
+    EXPECT_EQ(storage.primary_index_.size(), 12);
+    EXPECT_EQ(storage.task_index_.size(), 12);
+  }
+}
+
+TEST_F(GcsTaskManagerCompressedBytesLimitedTest, TestLimitCompressedBytes) {
+  auto &storage = *task_manager->task_event_storage_;
+  auto finished_tasks = GenTaskIDs(6);
+  for (const auto &task_id : finished_tasks) {
+    SyncAddTaskEvent({task_id},
+                     {{rpc::TaskStatus::RUNNING, 1}, {rpc::TaskStatus::FINISHED, 2}});
+  }
+
+  // The 4 oldest finished tasks are compressed, then evicted as a segment since the
+  // compressed task events can't take any byte.
+  EXPECT_EQ(storage.compressed_task_events_.NumRows(), 0);
+  EXPECT_EQ(task_manager->GetNumTaskEventsStored(), 2);
+  EXPECT_EQ(task_manager->GetTotalNumTaskAttemptsDropped(), 4);
+  for (size_t i = 0; i < finished_tasks.size(); ++i) {
+    EXPECT_EQ(SyncGetTaskEvents({finished_tasks[i]}).events_by_task_size(),
+              i < 4 ? 0 : 1);
+  }
+  EXPECT_EQ(storage.primary_index_.size(), 2);
+}
+
 TEST_F(GcsTaskManagerMemoryLimitedTest, TestLimitGcPriorityBased) {
   size_t num_limit = 10;  // sync with class config
   // For the default gc policy, we evict tasks based (first to last):
@@ -1095,5 +1377,51 @@ TEST_F(GcsTaskManagerMemoryLimitedTest, TestLimitGcPriorityBased) {
   }
 }
 
+TEST_F(GcsTaskManagerPaginatedTest, TestGetTaskEventsByPages) {
+  // Tasks of two jobs.
+  std::vector<TaskID> job1_tasks;
+  for (int i = 0; i < 10; ++i) {
+    auto task_id = GenTaskIDs(1)[0];
+    SyncAddTaskEvent({task_id}, {{rpc::TaskStatus::RUNNING, 1}}, TaskID::Nil(), i % 2);
+    if (i % 2 == 1) {
+      job1_tasks.push_back(task_id);
+    }
+  }
+
+  // The pages are returned from the most recently added task.
+  auto pages = GetPages(JobID::FromInt(1), /* limit */ 2);
+  ASSERT_EQ(pages.size(), 3);
+  EXPECT_THAT(pages[0], testing::ElementsAre(job1_tasks[4], job1_tasks[3]));
+  EXPECT_THAT(pages[1], testing::ElementsAre(job1_tasks[2], job1_tasks[1]));
+  EXPECT_THAT(pages[2], testing::ElementsAre(job1_tasks[0]));
+
+  // The limit is capped by the server.
+  pages = GetPages(JobID::FromInt(1), /* limit */ -1);
+  ASSERT_EQ(pages.size(), 2);
+  EXPECT_EQ(pages[0].size(), 4);
+  EXPECT_EQ(pages[1].size(), 1);
+
+  // Updating a task doesn't move it between the pages, and the tasks added after the
+  // first page aren't in the next pages.
+  {
+    rpc::GetTaskEventsRequest request;
+    request.mutable_filters()->set_job_id(JobID::FromInt(1).Binary());
+    request.set_limit(2);
+    auto reply = SyncHandleGetTaskEvents(request);
+    ASSERT_TRUE(reply.has_next_cursor());
+
+    SyncAddTaskEvent(
+        {job1_tasks[4]}, {{rpc::TaskStatus::FINISHED, 2}}, TaskID::Nil(), 1);
+    SyncAddTaskEvent(GenTaskIDs(1), {{rpc::TaskStatus::RUNNING, 1}}, TaskID::Nil(), 1);
+
+    request.clear_limit();
+    request.set_cursor(reply.next_cursor());
+    reply = SyncHandleGetTaskEvents(request);
+    ASSERT_EQ(reply.events_by_task_size(), 3);
+    EXPECT_EQ(TaskID::FromBinary(reply.events_by_task(0).task_id()), job1_tasks[2]);
+    EXPECT_FALSE(reply.has_next_cursor());
+  }
+}
+
 }  // namespace gcs
 }  // namespace ray
@@ -0,0 +1,190 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/task_event_column_store.h"
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace gcs {
+
+class TaskEventColumnStoreTest : public ::testing::Test {
+ public:
+  /// Generate the events of a finished task attempt.
+  static rpc::TaskEvents GenTaskEvents(int i) {
+    rpc::TaskEvents events;
+    const auto job_id = JobID::FromInt(i % 2);
+    const auto task_id = TaskID::ForDriverTask(JobID::FromInt(i));
+    events.set_task_id(task_id.Binary());
+    events.set_job_id(job_id.Binary());
+    events.set_attempt_number(i % 3);
+    auto *task_info = events.mutable_task_info();
+    task_info->set_name("task_" + std::to_string(i % 4));
+    task_info->set_func_or_class_name("module.task_" + std::to_string(i % 4));
+    task_info->set_type(rpc::TaskType::NORMAL_TASK);
+    task_info->set_job_id(job_id.Binary());
+    task_info->set_task_id(task_id.Binary());
+    (*task_info->mutable_required_resources())["CPU"] = 1;
+    auto *state_updates = events.mutable_state_updates();
+    state_updates->set_worker_id(WorkerID::FromRandom().Binary());
+    state_updates->set_pending_args_avail_ts(1000 * i);
+    state_updates->set_running_ts(1000 * i + 10);
+    state_updates->set_finished_ts(1000 * i + 20);
+    auto *profile_event = events.mutable_profile_events()->add_events();
+    profile_event->set_event_name("event");
+    profile_event->set_start_time(1000 * i);
+    return events;
+  }
+
+  static void ExpectEventsEq(const rpc::TaskEvents &expected,
+                             const rpc::TaskEvents &actual) {
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(expected, actual))
+        << "Expected: " << expected.DebugString() << "Actual: " << actual.DebugString();
+  }
+};
+
+TEST_F(TaskEventColumnStoreTest, TestRoundTrip) {
+  TaskEventColumnStore store;
+  std::vector<rpc::TaskEvents> expected;
+  for (int i = 0; i < 10; ++i) {
+    expected.push_back(GenTaskEvents(i));
+  }
+  // A task attempt without state updates nor task info.
+  rpc::TaskEvents profile_only;
+  profile_only.set_task_id(TaskID::ForDriverTask(JobID::FromInt(100)).Binary());
+  profile_only.set_job_id(JobID::FromInt(0).Binary());
+  profile_only.mutable_profile_events()->add_events()->set_event_name("event");
+  expected.push_back(profile_only);
+  // A failed actor task attempt, whose timestamps are decreasing.
+  rpc::TaskEvents actor_task = GenTaskEvents(10);
+  actor_task.mutable_task_info()->set_type(rpc::TaskType::ACTOR_TASK);
+  actor_task.mutable_task_info()->set_actor_id(
+      ActorID::Of(JobID::FromInt(0), TaskID::Nil(), 0).Binary());
+  actor_task.mutable_state_updates()->set_running_ts(5);
+  actor_task.mutable_state_updates()->clear_finished_ts();
+  actor_task.mutable_state_updates()->set_failed_ts(6);
+  actor_task.mutable_state_updates()->mutable_error_info()->set_error_message("error");
+  expected.push_back(actor_task);
+
+  auto ids = store.AddSegment(std::vector<rpc::TaskEvents>(expected));
+  ASSERT_EQ(ids.size(), expected.size());
+  ASSERT_EQ(store.NumRows(), expected.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    ExpectEventsEq(expected[i], store.Get(ids[i]));
+    ASSERT_EQ(store.GetTaskAttempt(ids[i]),
+              std::make_pair(TaskID::FromBinary(expected[i].task_id()),
+                             expected[i].attempt_number()));
+    ASSERT_EQ(store.GetJobId(ids[i]), JobID::FromBinary(expected[i].job_id()));
+    ASSERT_EQ(store.NumProfileEvents(ids[i]), 1);
+  }
+
+  // The columns.
+  ASSERT_EQ(store.GetName(ids[1]), "task_1");
+  ASSERT_EQ(store.GetState(ids[1]), rpc::TaskStatus::FINISHED);
+  ASSERT_FALSE(store.HasActorId(ids[1]));
+  ASSERT_EQ(store.GetWorkerId(ids[1]),
+            WorkerID::FromBinary(expected[1].state_updates().worker_id()));
+  ASSERT_FALSE(store.HasTaskInfo(ids[10]));
+  ASSERT_FALSE(store.HasStateUpdates(ids[10]));
+  ASSERT_EQ(store.GetState(ids[10]), rpc::TaskStatus::NIL);
+  ASSERT_TRUE(store.GetWorkerId(ids[10]).IsNil());
+  ASSERT_EQ(store.GetType(ids[11]), rpc::TaskType::ACTOR_TASK);
+  ASSERT_EQ(store.GetActorId(ids[11]), expected[11].task_info().actor_id());
+  ASSERT_EQ(store.GetState(ids[11]), rpc::TaskStatus::FAILED);
+}
+
+TEST_F(TaskEventColumnStoreTest, TestRemove) {
+  TaskEventColumnStore store;
+  std::vector<TaskEventColumnStore::RowId> ids;
+  std::vector<rpc::TaskEvents> expected;
+  for (int segment = 0; segment < 3; ++segment) {
+    std::vector<rpc::TaskEvents> task_events;
+    for (int i = 0; i < 4; ++i) {
+      task_events.push_back(GenTaskEvents(segment * 4 + i));
+      expected.push_back(task_events.back());
+    }
+    auto segment_ids = store.AddSegment(std::move(task_events));
+    ids.insert(ids.end(), segment_ids.begin(), segment_ids.end());
+  }
+  const size_t num_bytes = store.NumBytes();
+
+  // Remove the second segment, and the oldest task attempt.
+  for (int i = 4; i < 8; ++i) {
+    store.Remove(ids[i]);
+  }
+  store.Remove(ids[0]);
+  ASSERT_EQ(store.NumRows(), 7);
+  ASSERT_LT(store.NumBytes(), num_bytes);
+  ASSERT_EQ(store.Oldest().segment, ids[1].segment);
+  ASSERT_EQ(store.Oldest().row, ids[1].row);
+  auto all = store.GetAll();
+  ASSERT_EQ(all.size(), 7);
+  ExpectEventsEq(expected[1], store.Get(all[0]));
+  ExpectEventsEq(expected[8], store.Get(all[3]));
+  ExpectEventsEq(expected[11], store.Get(all[6]));
+
+  // Removing the first segment drops the segments whose task attempts are all removed.
+  for (int i = 1; i < 4; ++i) {
+    store.Remove(ids[i]);
+  }
+  ASSERT_EQ(store.Oldest().segment, ids[8].segment);
+  ExpectEventsEq(expected[9], store.Get(ids[9]));
+  for (int i = 8; i < 12; ++i) {
+    store.Remove(ids[i]);
+  }
+  ASSERT_TRUE(store.Empty());
+  ASSERT_TRUE(store.GetAll().empty());
+
+  // The segment ids keep increasing.
+  auto new_ids = store.AddSegment({expected[0]});
+  ASSERT_GT(new_ids[0].segment, ids[11].segment);
+  ExpectEventsEq(expected[0], store.Get(new_ids[0]));
+}
+
+TEST_F(TaskEventColumnStoreTest, TestStringDictionary) {
+  StringDictionary dictionary;
+  ASSERT_EQ(dictionary.Add(""), 0);
+  const auto a = dictionary.Add("a");
+  ASSERT_EQ(dictionary.Add("a"), a);
+  const auto b = dictionary.Add("b");
+  ASSERT_NE(a, b);
+  ASSERT_EQ(dictionary.Get(a), "a");
+  ASSERT_EQ(dictionary.Size(), 3);
+
+  dictionary.Release(a);
+  ASSERT_EQ(dictionary.Get(a), "a");
+  dictionary.Release(a);
+  ASSERT_EQ(dictionary.Size(), 2);
+  // The code is reused.
+  ASSERT_EQ(dictionary.Add("c"), a);
+  ASSERT_EQ(dictionary.Get(a), "c");
+  ASSERT_EQ(dictionary.Get(b), "b");
+}
+
+TEST_F(TaskEventColumnStoreTest, TestCompression) {
+  TaskEventColumnStore store;
+  std::vector<rpc::TaskEvents> task_events;
+  size_t num_protobuf_bytes = 0;
+  for (int i = 0; i < 1000; ++i) {
+    task_events.push_back(GenTaskEvents(i));
+    num_protobuf_bytes += task_events.back().SpaceUsedLong();
+  }
+  store.AddSegment(std::move(task_events));
+  ASSERT_LT(store.NumBytes() * 5, num_protobuf_bytes);
+}
+
+}  // namespace gcs
+}  // namespace ray
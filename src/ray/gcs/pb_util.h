@@ -338,6 +338,38 @@ inline bool IsTaskFinished(const rpc::TaskEvents &task_event) {
   return state_updates.has_finished_ts();
 }
 
+/// Return the latest status of a task attempt, i.e. the last one of the lifecycle of a
+/// task whose timestamp is set.
+///
+/// \param task_event Task event.
+/// \return The latest status, or NIL if the task has no state updates.
+inline rpc::TaskStatus GetLatestTaskStatus(const rpc::TaskEvents &task_event) {
+  if (!task_event.has_state_updates()) {
+    return rpc::TaskStatus::NIL;
+  }
+
+  const auto &state_updates = task_event.state_updates();
+  if (state_updates.has_failed_ts()) {
+    return rpc::TaskStatus::FAILED;
+  }
+  if (state_updates.has_finished_ts()) {
+    return rpc::TaskStatus::FINISHED;
+  }
+  if (state_updates.has_running_ts()) {
+    return rpc::TaskStatus::RUNNING;
+  }
+  if (state_updates.has_submitted_to_worker_ts()) {
+    return rpc::TaskStatus::SUBMITTED_TO_WORKER;
+  }
+  if (state_updates.has_pending_node_assignment_ts()) {
+    return rpc::TaskStatus::PENDING_NODE_ASSIGNMENT;
+  }
+  if (state_updates.has_pending_args_avail_ts()) {
+    return rpc::TaskStatus::PENDING_ARGS_AVAIL;
+  }
+  return rpc::TaskStatus::NIL;
+}
+
 /// Fill the rpc::TaskStateUpdate with the timestamps according to the status change.
 ///
 /// \param task_status The task status.
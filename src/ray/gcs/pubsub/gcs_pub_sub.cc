@@ -93,6 +93,14 @@ Status GcsPublisher::PublishError(const std::string &id,
 
 std::string GcsPublisher::DebugString() const { return "GcsPublisher {}"; }
 
+pubsub::Subscriber *GcsSubscriber::GetSubscriber(rpc::ChannelType channel_type) const {
+  if (streaming_subscriber_ != nullptr &&
+      streaming_subscriber_->HasChannel(channel_type)) {
+    return streaming_subscriber_.get();
+  }
+  return subscriber_.get();
+}
+
 Status GcsSubscriber::SubscribeAllJobs(
     const SubscribeCallback<JobID, rpc::JobTableData> &subscribe,
     const StatusCallback &done) {
@@ -106,7 +114,7 @@ Status GcsSubscriber::SubscribeAllJobs(
     RAY_LOG(WARNING) << "Subscription to Job channel failed: " << status.ToString();
   };
   // Ignore if the subscription already exists, because the resubscription is intentional.
-  RAY_UNUSED(subscriber_->SubscribeChannel(
+  RAY_UNUSED(GetSubscriber(rpc::ChannelType::GCS_JOB_CHANNEL)->SubscribeChannel(
       std::make_unique<rpc::SubMessage>(),
       rpc::ChannelType::GCS_JOB_CHANNEL,
       gcs_address_,
@@ -137,7 +145,7 @@ Status GcsSubscriber::SubscribeActor(
                      << " failed: " << status.ToString();
   };
   // Ignore if the subscription already exists, because the resubscription is intentional.
-  RAY_UNUSED(subscriber_->Subscribe(
+  RAY_UNUSED(GetSubscriber(rpc::ChannelType::GCS_ACTOR_CHANNEL)->Subscribe(
       std::make_unique<rpc::SubMessage>(),
       rpc::ChannelType::GCS_ACTOR_CHANNEL,
       gcs_address_,
@@ -153,14 +161,15 @@ Status GcsSubscriber::SubscribeActor(
 }
 
 Status GcsSubscriber::UnsubscribeActor(const ActorID &id) {
-  subscriber_->Unsubscribe(
-      rpc::ChannelType::GCS_ACTOR_CHANNEL, gcs_address_, id.Binary());
+  GetSubscriber(rpc::ChannelType::GCS_ACTOR_CHANNEL)
+      ->Unsubscribe(rpc::ChannelType::GCS_ACTOR_CHANNEL, gcs_address_, id.Binary());
   return Status::OK();
 }
 
 bool GcsSubscriber::IsActorUnsubscribed(const ActorID &id) {
-  return !subscriber_->IsSubscribed(
-      rpc::ChannelType::GCS_ACTOR_CHANNEL, gcs_address_, id.Binary());
+  return !GetSubscriber(rpc::ChannelType::GCS_ACTOR_CHANNEL)
+              ->IsSubscribed(
+                  rpc::ChannelType::GCS_ACTOR_CHANNEL, gcs_address_, id.Binary());
 }
 
 Status GcsSubscriber::SubscribeAllNodeInfo(
@@ -174,7 +183,7 @@ Status GcsSubscriber::SubscribeAllNodeInfo(
     RAY_LOG(WARNING) << "Subscription to NodeInfo channel failed: " << status.ToString();
   };
   // Ignore if the subscription already exists, because the resubscription is intentional.
-  RAY_UNUSED(subscriber_->SubscribeChannel(
+  RAY_UNUSED(GetSubscriber(rpc::ChannelType::GCS_NODE_INFO_CHANNEL)->SubscribeChannel(
       std::make_unique<rpc::SubMessage>(),
       rpc::ChannelType::GCS_NODE_INFO_CHANNEL,
       gcs_address_,
@@ -199,7 +208,7 @@ Status GcsSubscriber::SubscribeAllWorkerFailures(
                      << status.ToString();
   };
   // Ignore if the subscription already exists, because the resubscription is intentional.
-  RAY_UNUSED(subscriber_->SubscribeChannel(
+  RAY_UNUSED(GetSubscriber(rpc::ChannelType::GCS_WORKER_DELTA_CHANNEL)->SubscribeChannel(
       std::make_unique<rpc::SubMessage>(),
       rpc::ChannelType::GCS_WORKER_DELTA_CHANNEL,
       gcs_address_,
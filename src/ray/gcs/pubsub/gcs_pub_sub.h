@@ -101,9 +101,16 @@ class GcsSubscriber {
  public:
   /// Initializes GcsSubscriber with GCS based GcsSubscribers.
   // TODO: Support restarted GCS publisher, at the same or a different address.
+  ///
+  /// \param subscriber The subscriber which long polls GCS.
+  /// \param streaming_subscriber Optional subscriber which receives messages through a
+  /// stream. Channels it's created with are subscribed through it instead.
   GcsSubscriber(const rpc::Address &gcs_address,
-                std::unique_ptr<pubsub::Subscriber> subscriber)
-      : gcs_address_(gcs_address), subscriber_(std::move(subscriber)) {}
+                std::unique_ptr<pubsub::Subscriber> subscriber,
+                std::unique_ptr<pubsub::Subscriber> streaming_subscriber = nullptr)
+      : gcs_address_(gcs_address),
+        subscriber_(std::move(subscriber)),
+        streaming_subscriber_(std::move(streaming_subscriber)) {}
 
   /// Subscribe*() member functions below would be incrementally converted to use the GCS
   /// based subscriber, if available.
@@ -131,8 +138,12 @@ class GcsSubscriber {
   std::string DebugString() const;
 
  private:
+  /// Get the subscriber of the channel.
+  pubsub::Subscriber *GetSubscriber(rpc::ChannelType channel_type) const;
+
   const rpc::Address gcs_address_;
-  const std::unique_ptr<pubsub::SubscriberInterface> subscriber_;
+  const std::unique_ptr<pubsub::Subscriber> subscriber_;
+  const std::unique_ptr<pubsub::Subscriber> streaming_subscriber_;
 };
 
 // This client is only supposed to be used from Cython / Python
@@ -17,6 +17,7 @@
 #include <chrono>
 
 #include "ray/common/common_protocol.h"
+#include "ray/common/tracing.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/util.h"
 
@@ -121,8 +122,9 @@ ObjectManager::ObjectManager(
     return local_objects_.count(object_id) != 0;
   };
   const auto &send_pull_request = [this](const ObjectID &object_id,
-                                         const NodeID &client_id) {
-    SendPullRequest(object_id, client_id);
+                                         const NodeID &client_id,
+                                         const rpc::TraceContext &trace_context) {
+    SendPullRequest(object_id, client_id, trace_context);
   };
   const auto &cancel_pull_request = [this](const ObjectID &object_id) {
     // We must abort this object because it may have only been partially
@@ -232,9 +234,11 @@ void ObjectManager::HandleObjectDeleted(const ObjectID &object_id) {
 
 uint64_t ObjectManager::Pull(const std::vector<rpc::ObjectReference> &object_refs,
                              BundlePriority prio,
-                             const TaskMetricsKey &task_key) {
+                             const TaskMetricsKey &task_key,
+                             const rpc::TraceContext &trace_context) {
   std::vector<rpc::ObjectReference> objects_to_locate;
-  auto request_id = pull_manager_->Pull(object_refs, prio, task_key, &objects_to_locate);
+  auto request_id = pull_manager_->Pull(
+      object_refs, prio, task_key, &objects_to_locate, trace_context);
 
   const auto &callback = [this](const ObjectID &object_id,
                                 const std::unordered_set<NodeID> &client_ids,
@@ -271,15 +275,20 @@ void ObjectManager::CancelPull(uint64_t request_id) {
   }
 }
 
-void ObjectManager::SendPullRequest(const ObjectID &object_id, const NodeID &client_id) {
+void ObjectManager::SendPullRequest(const ObjectID &object_id,
+                                    const NodeID &client_id,
+                                    const rpc::TraceContext &trace_context) {
   auto rpc_client = GetRpcClient(client_id);
   if (rpc_client) {
     // Try pulling from the client.
     rpc_service_.post(
-        [this, object_id, client_id, rpc_client]() {
+        [this, object_id, client_id, rpc_client, trace_context]() {
           rpc::PullRequest pull_request;
           pull_request.set_object_id(object_id.Binary());
           pull_request.set_node_id(self_node_id_.Binary());
+          if (tracing::IsSampled(trace_context)) {
+            pull_request.mutable_trace_context()->CopyFrom(trace_context);
+          }
 
           rpc_client->Pull(
               pull_request,
@@ -336,19 +345,23 @@ void ObjectManager::HandleSendFinished(const ObjectID &object_id,
   }
 }
 
-void ObjectManager::Push(const ObjectID &object_id, const NodeID &node_id) {
+void ObjectManager::Push(const ObjectID &object_id,
+                         const NodeID &node_id,
+                         const rpc::TraceContext &trace_context) {
   RAY_LOG(DEBUG) << "Push on " << self_node_id_ << " to " << node_id << " of object "
                  << object_id;
   if (local_objects_.count(object_id) != 0) {
-    return PushLocalObject(object_id, node_id);
+    return PushLocalObject(object_id, node_id, trace_context);
   }
 
   // Push from spilled object directly if the object is on local disk.
   auto object_url = get_spilled_object_url_(object_id);
   if (!object_url.empty() && RayConfig::instance().is_external_storage_type_fs()) {
-    return PushFromFilesystem(object_id, node_id, object_url);
+    return PushFromFilesystem(object_id, node_id, object_url, trace_context);
   }
 
+  // The push waiting for the object to be local isn't traced.
+
   // Avoid setting duplicated timer for the same object and node pair.
   auto &nodes = unfulfilled_push_requests_[object_id];
 
@@ -380,7 +393,9 @@ void ObjectManager::Push(const ObjectID &object_id, const NodeID &node_id) {
   }
 }
 
-void ObjectManager::PushLocalObject(const ObjectID &object_id, const NodeID &node_id) {
+void ObjectManager::PushLocalObject(const ObjectID &object_id,
+                                    const NodeID &node_id,
+                                    const rpc::TraceContext &trace_context) {
   const ObjectInfo &object_info = local_objects_[object_id].object_info;
   uint64_t data_size = static_cast<uint64_t>(object_info.data_size);
   uint64_t metadata_size = static_cast<uint64_t>(object_info.metadata_size);
@@ -421,16 +436,23 @@ void ObjectManager::PushLocalObject(const ObjectID &object_id, const NodeID &nod
                      node_id,
                      std::make_shared<ChunkObjectReader>(std::move(object_reader),
                                                          config_.object_chunk_size),
-                     /*from_disk=*/false);
+                     /*from_disk=*/false,
+                     trace_context);
 }
 
 void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
                                        const NodeID &node_id,
-                                       const std::string &spilled_url) {
+                                       const std::string &spilled_url,
+                                       const rpc::TraceContext &trace_context) {
   // SpilledObjectReader::CreateSpilledObjectReader does synchronous IO; schedule it off
   // main thread.
   rpc_service_.post(
-      [this, object_id, node_id, spilled_url, chunk_size = config_.object_chunk_size]() {
+      [this,
+       object_id,
+       node_id,
+       spilled_url,
+       trace_context,
+       chunk_size = config_.object_chunk_size]() {
         auto optional_spilled_object =
             SpilledObjectReader::CreateSpilledObjectReader(spilled_url);
         if (!optional_spilled_object.has_value()) {
@@ -449,11 +471,13 @@ void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
             [this,
              object_id,
              node_id,
+             trace_context,
              chunk_object_reader = std::move(chunk_object_reader)]() {
               PushObjectInternal(object_id,
                                  node_id,
                                  std::move(chunk_object_reader),
-                                 /*from_disk=*/true);
+                                 /*from_disk=*/true,
+                                 trace_context);
             },
             "ObjectManager.PushLocalSpilledObjectInternal");
       },
@@ -463,7 +487,8 @@ void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
 void ObjectManager::PushObjectInternal(const ObjectID &object_id,
                                        const NodeID &node_id,
                                        std::shared_ptr<ChunkObjectReader> chunk_reader,
-                                       bool from_disk) {
+                                       bool from_disk,
+                                       const rpc::TraceContext &trace_context) {
   auto rpc_client = GetRpcClient(node_id);
   if (!rpc_client) {
     // Push is best effort, so do nothing here.
@@ -476,6 +501,16 @@ void ObjectManager::PushObjectInternal(const ObjectID &object_id,
                  << ", number of chunks: " << chunk_reader->GetNumChunks()
                  << ", total data size: " << chunk_reader->GetObject().GetObjectSize();
 
+  // The span is shared by the callbacks sending the chunks, so it ends when the last
+  // chunk is sent.
+  std::shared_ptr<tracing::Span> span;
+  if (tracing::IsSampled(trace_context)) {
+    span = std::make_shared<tracing::Span>(
+        tracing::Span::StartChild("ObjectManager.Push", trace_context));
+    span->SetAttribute("object_id", object_id.Hex());
+    span->SetAttribute("node_id", node_id.Hex());
+    span->SetAttribute("num_chunks", std::to_string(chunk_reader->GetNumChunks()));
+  }
   auto push_id = UniqueID::FromRandom();
   push_manager_->StartPush(
       node_id, object_id, chunk_reader->GetNumChunks(), [=](int64_t chunk_id) {
@@ -499,7 +534,9 @@ void ObjectManager::PushObjectInternal(const ObjectID &object_id,
                         "ObjectManager.Push");
                   },
                   chunk_reader,
-                  from_disk);
+                  from_disk,
+                  span != nullptr ? span->Context()
+                                  : rpc::TraceContext::default_instance());
             },
             "ObjectManager.Push");
       });
@@ -512,7 +549,8 @@ void ObjectManager::SendObjectChunk(const UniqueID &push_id,
                                     std::shared_ptr<rpc::ObjectManagerClient> rpc_client,
                                     std::function<void(const Status &)> on_complete,
                                     std::shared_ptr<ChunkObjectReader> chunk_reader,
-                                    bool from_disk) {
+                                    bool from_disk,
+                                    const rpc::TraceContext &trace_context) {
   double start_time = absl::GetCurrentTimeNanos() / 1e9;
   rpc::PushRequest push_request;
   // Set request header
@@ -524,6 +562,9 @@ void ObjectManager::SendObjectChunk(const UniqueID &push_id,
   push_request.set_data_size(chunk_reader->GetObject().GetObjectSize());
   push_request.set_metadata_size(chunk_reader->GetObject().GetMetadataSize());
   push_request.set_chunk_index(chunk_index);
+  if (tracing::IsSampled(trace_context)) {
+    push_request.mutable_trace_context()->CopyFrom(trace_context);
+  }
 
   // read a chunk into push_request and handle errors.
   auto optional_chunk = chunk_reader->GetChunk(chunk_index);
@@ -572,8 +613,14 @@ void ObjectManager::HandlePush(rpc::PushRequest request,
   const rpc::Address &owner_address = request.owner_address();
   const std::string &data = request.data();
 
+  auto span =
+      tracing::Span::StartChild("ObjectManager.ReceiveChunk", request.trace_context());
   bool success = ReceiveObjectChunk(
       node_id, object_id, owner_address, data_size, metadata_size, chunk_index, data);
+  if (span.IsRecording()) {
+    span.SetAttribute("chunk_index", std::to_string(chunk_index));
+    span.SetAttribute("success", success ? "true" : "false");
+  }
   num_chunks_received_total_++;
   if (!success) {
     num_chunks_received_total_failed_++;
@@ -640,8 +687,11 @@ void ObjectManager::HandlePull(rpc::PullRequest request,
   RAY_LOG(DEBUG) << "Received pull request from node " << node_id << " for object ["
                  << object_id << "].";
 
-  main_service_->post([this, object_id, node_id]() { Push(object_id, node_id); },
-                      "ObjectManager.HandlePull");
+  main_service_->post(
+      [this, object_id, node_id, trace_context = request.trace_context()]() {
+        Push(object_id, node_id, trace_context);
+      },
+      "ObjectManager.HandlePull");
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
@@ -105,7 +105,8 @@ class ObjectManagerInterface {
  public:
   virtual uint64_t Pull(const std::vector<rpc::ObjectReference> &object_refs,
                         BundlePriority prio,
-                        const TaskMetricsKey &task_key) = 0;
+                        const TaskMetricsKey &task_key,
+                        const rpc::TraceContext &trace_context) = 0;
   virtual void CancelPull(uint64_t request_id) = 0;
   virtual bool PullRequestActiveOrWaitingForMetadata(uint64_t request_id) const = 0;
   virtual int64_t PullManagerNumInactivePullsByTaskName(
@@ -202,18 +203,25 @@ class ObjectManager : public ObjectManagerInterface,
   ///
   /// \param object_id The object's object id.
   /// \param node_id The remote node's id.
+  /// \param trace_context The context of the span of the pull the object is pushed for,
+  /// if it's traced.
   /// \return Void.
-  void Push(const ObjectID &object_id, const NodeID &node_id);
+  void Push(const ObjectID &object_id,
+            const NodeID &node_id,
+            const rpc::TraceContext &trace_context = rpc::TraceContext());
 
   /// Pull a bundle of objects. This will attempt to make all objects in the
   /// bundle local until the request is canceled with the returned ID.
   ///
   /// \param object_refs The bundle of objects that must be made local.
   /// \param prio The bundle priority.
+  /// \param trace_context The context of the span the pulls of the objects are
+  /// children of, if they're traced.
   /// \return A request ID that can be used to cancel the request.
   uint64_t Pull(const std::vector<rpc::ObjectReference> &object_refs,
                 BundlePriority prio,
-                const TaskMetricsKey &task_key) override;
+                const TaskMetricsKey &task_key,
+                const rpc::TraceContext &trace_context) override;
 
   /// Cancels the pull request with the given ID. This cancels any fetches for
   /// objects that were passed to the original pull request, if no other pull
@@ -269,17 +277,22 @@ class ObjectManager : public ObjectManagerInterface,
   ///
   /// \param object_id The object's object id.
   /// \param node_id The remote node's id.
+  /// \param trace_context The context of the span of the pull, see Push.
   /// \return Void.
-  void PushLocalObject(const ObjectID &object_id, const NodeID &node_id);
+  void PushLocalObject(const ObjectID &object_id,
+                       const NodeID &node_id,
+                       const rpc::TraceContext &trace_context);
 
   /// Pushing a known spilled object to a remote object manager.
   /// \param object_id The object's object id.
   /// \param node_id The remote node's id.
   /// \param spilled_url The url of the spilled object.
+  /// \param trace_context The context of the span of the pull, see Push.
   /// \return Void.
   void PushFromFilesystem(const ObjectID &object_id,
                           const NodeID &node_id,
-                          const std::string &spilled_url);
+                          const std::string &spilled_url,
+                          const rpc::TraceContext &trace_context);
 
   /// The internal implementation of pushing an object.
   ///
@@ -288,11 +301,14 @@ class ObjectManager : public ObjectManagerInterface,
   /// \param chunk_reader Chunk reader used to read a chunk of the object
   /// \param from_disk Whether chunk is being read from disk or plasma. This is
   /// used only for metrics.
+  /// \param trace_context The context of the span of the pull, see Push. The span of
+  /// the push is its child, and ends when the last chunk is sent.
   /// Status::OK() if the read succeeded.
   void PushObjectInternal(const ObjectID &object_id,
                           const NodeID &node_id,
                           std::shared_ptr<ChunkObjectReader> chunk_reader,
-                          bool from_disk);
+                          bool from_disk,
+                          const rpc::TraceContext &trace_context);
 
   /// Send one chunk of the object to remote object manager
   ///
@@ -307,6 +323,7 @@ class ObjectManager : public ObjectManagerInterface,
   /// \param chunk_reader Chunk reader used to read a chunk of the object
   /// \param from_disk Whether chunk is being read from disk or plasma. This is
   /// used only for metrics.
+  /// \param trace_context The context of the span of the push, if it's traced.
   void SendObjectChunk(const UniqueID &push_id,
                        const ObjectID &object_id,
                        const NodeID &node_id,
@@ -314,7 +331,8 @@ class ObjectManager : public ObjectManagerInterface,
                        std::shared_ptr<rpc::ObjectManagerClient> rpc_client,
                        std::function<void(const Status &)> on_complete,
                        std::shared_ptr<ChunkObjectReader> chunk_reader,
-                       bool from_disk);
+                       bool from_disk,
+                       const rpc::TraceContext &trace_context);
 
   /// Handle starting, running, and stopping asio rpc_service.
   void StartRpcService();
@@ -385,7 +403,10 @@ class ObjectManager : public ObjectManagerInterface,
   ///
   /// \param object_id Object id
   /// \param client_id Remote server client id
-  void SendPullRequest(const ObjectID &object_id, const NodeID &client_id);
+  /// \param trace_context The context of the span of the pull, if it's traced
+  void SendPullRequest(const ObjectID &object_id,
+                       const NodeID &client_id,
+                       const rpc::TraceContext &trace_context);
 
   /// Get the rpc client according to the node ID
   ///
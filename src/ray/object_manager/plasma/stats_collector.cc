@@ -36,23 +36,27 @@ void ObjectStatsCollector::OnObjectCreated(const LocalObject &obj) {
   if (kSource == plasma::flatbuf::ObjectSource::CreatedByWorker) {
     num_objects_created_by_worker_++;
     num_bytes_created_by_worker_ += kObjectSize;
-    ray::stats::STATS_object_store_dist.Record(
-        kObjectSize, {{ray::stats::SourceKey, "CreatedByWorker"}});
+    static auto &object_size_dist = ray::stats::STATS_object_store_dist.Bind(
+        {{ray::stats::SourceKey, "CreatedByWorker"}});
+    object_size_dist.Record(kObjectSize);
   } else if (kSource == plasma::flatbuf::ObjectSource::RestoredFromStorage) {
     num_objects_restored_++;
     num_bytes_restored_ += kObjectSize;
-    ray::stats::STATS_object_store_dist.Record(
-        kObjectSize, {{ray::stats::SourceKey, "RestoredFromStorage"}});
+    static auto &object_size_dist = ray::stats::STATS_object_store_dist.Bind(
+        {{ray::stats::SourceKey, "RestoredFromStorage"}});
+    object_size_dist.Record(kObjectSize);
   } else if (kSource == plasma::flatbuf::ObjectSource::ReceivedFromRemoteRaylet) {
     num_objects_received_++;
     num_bytes_received_ += kObjectSize;
-    ray::stats::STATS_object_store_dist.Record(
-        kObjectSize, {{ray::stats::SourceKey, "ReceivedFromRemoteRaylet"}});
+    static auto &object_size_dist = ray::stats::STATS_object_store_dist.Bind(
+        {{ray::stats::SourceKey, "ReceivedFromRemoteRaylet"}});
+    object_size_dist.Record(kObjectSize);
   } else if (kSource == plasma::flatbuf::ObjectSource::ErrorStoredByRaylet) {
     num_objects_errored_++;
     num_bytes_errored_ += kObjectSize;
-    ray::stats::STATS_object_store_dist.Record(
-        kObjectSize, {{ray::stats::SourceKey, "ErrorStoredByRaylet"}});
+    static auto &object_size_dist = ray::stats::STATS_object_store_dist.Bind(
+        {{ray::stats::SourceKey, "ErrorStoredByRaylet"}});
+    object_size_dist.Record(kObjectSize);
   }
 
   RAY_CHECK(!obj.Sealed());
@@ -0,0 +1,155 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of a client of a plasma store running in the process, which is how the
+// workers put and get the large objects.
+
+#include <cstring>
+#include <thread>
+
+#include "ray/common/benchmark_util.h"
+#include "ray/object_manager/plasma/client.h"
+#include "ray/object_manager/plasma/store_runner.h"
+#include "ray/util/filesystem.h"
+#include "ray/util/util.h"
+
+namespace plasma {
+
+namespace {
+
+using ray::benchmark::State;
+
+/// The number of objects created between the deletes.
+constexpr size_t kNumObjects = 100;
+
+/// A plasma store running on a thread, and a client connected to it.
+class PlasmaFixture {
+ public:
+  PlasmaFixture()
+      : socket_name_(ray::JoinPaths(ray::GetUserTempDir(),
+                                    "plasma_benchmark_" + ray::GenerateUUIDV4())),
+        runner_(socket_name_,
+                /*system_memory=*/256 * 1024 * 1024,
+                /*hugepages_enabled=*/false,
+                /*plasma_directory=*/"",
+                /*fallback_directory=*/"") {
+    store_thread_ = std::thread([this]() {
+      runner_.Start(
+          /*spill_objects_callback=*/[]() { return false; },
+          /*object_store_full_callback=*/nullptr,
+          /*add_object_callback=*/[](const ray::ObjectInfo &) {},
+          /*delete_object_callback=*/[](const ray::ObjectID &) {});
+    });
+    RAY_CHECK_OK(client_.Connect(socket_name_,
+                                 /*manager_socket_name=*/"",
+                                 /*release_delay=*/0,
+                                 /*num_retries=*/50));
+  }
+
+  ~PlasmaFixture() {
+    RAY_CHECK_OK(client_.Disconnect());
+    runner_.Stop();
+    store_thread_.join();
+  }
+
+  PlasmaClient &client() { return client_; }
+
+  /// Create an object, copy the data into it and seal it.
+  void Put(const ObjectID &object_id, const std::string &data) {
+    std::shared_ptr<Buffer> buffer;
+    RAY_CHECK_OK(client_.CreateAndSpillIfNeeded(object_id,
+                                                owner_address_,
+                                                /*is_mutable=*/false,
+                                                data.size(),
+                                                /*metadata=*/nullptr,
+                                                /*metadata_size=*/0,
+                                                &buffer,
+                                                flatbuf::ObjectSource::CreatedByWorker));
+    std::memcpy(buffer->Data(), data.data(), data.size());
+    RAY_CHECK_OK(client_.Seal(object_id));
+  }
+
+ private:
+  const std::string socket_name_;
+  const ray::rpc::Address owner_address_;
+  PlasmaStoreRunner runner_;
+  std::thread store_thread_;
+  PlasmaClient client_;
+};
+
+std::vector<ObjectID> RandomObjectIds(size_t num_ids) {
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < num_ids; ++i) {
+    ids.push_back(ObjectID::FromRandom());
+  }
+  return ids;
+}
+
+/// Create, fill and seal objects of the given size. The objects are deleted in
+/// batches, untimed.
+void BM_PlasmaCreateSeal(State &state) {
+  PlasmaFixture fixture;
+  const std::string data(state.range(), 'x');
+  const auto ids = RandomObjectIds(kNumObjects);
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    fixture.Put(ids[i++], data);
+    if (i == ids.size()) {
+      state.PauseTiming();
+      RAY_CHECK_OK(fixture.client().Delete(ids));
+      i = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+RAY_BENCHMARK(BM_PlasmaCreateSeal)->Arg(1024)->Arg(1024 * 1024);
+
+/// Get a sealed object of the given size and release it.
+void BM_PlasmaGet(State &state) {
+  PlasmaFixture fixture;
+  const auto object_id = ObjectID::FromRandom();
+  fixture.Put(object_id, std::string(state.range(), 'x'));
+  while (state.KeepRunning()) {
+    std::vector<ObjectBuffer> buffers;
+    RAY_CHECK_OK(fixture.client().Get(
+        {object_id}, /*timeout_ms=*/-1, &buffers, /*is_from_worker=*/false));
+    ray::benchmark::DoNotOptimize(buffers[0].data->Data()[0]);
+  }
+}
+RAY_BENCHMARK(BM_PlasmaGet)->Arg(1024)->Arg(1024 * 1024);
+
+/// Create, seal, get and delete an object of the given size, the whole life of an
+/// object put by a worker and read by another one.
+void BM_PlasmaObjectLifecycle(State &state) {
+  PlasmaFixture fixture;
+  const std::string data(state.range(), 'x');
+  const auto ids = RandomObjectIds(kNumObjects);
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    const auto &object_id = ids[i++ % ids.size()];
+    fixture.Put(object_id, data);
+    {
+      std::vector<ObjectBuffer> buffers;
+      RAY_CHECK_OK(fixture.client().Get(
+          {object_id}, /*timeout_ms=*/-1, &buffers, /*is_from_worker=*/false));
+    }
+    RAY_CHECK_OK(fixture.client().Delete({object_id}));
+  }
+}
+RAY_BENCHMARK(BM_PlasmaObjectLifecycle)->Arg(1024)->Arg(1024 * 1024);
+
+}  // namespace
+
+}  // namespace plasma
@@ -23,7 +23,8 @@ namespace ray {
 PullManager::PullManager(
     NodeID &self_node_id,
     const std::function<bool(const ObjectID &)> object_is_local,
-    const std::function<void(const ObjectID &, const NodeID &)> send_pull_request,
+    const std::function<void(const ObjectID &, const NodeID &, const rpc::TraceContext &)>
+        send_pull_request,
     const std::function<void(const ObjectID &)> cancel_pull_request,
     const std::function<void(const ObjectID &, rpc::ErrorType)> fail_pull_request,
     const RestoreSpilledObjectCallback restore_spilled_object,
@@ -48,7 +49,8 @@ PullManager::PullManager(
 uint64_t PullManager::Pull(const std::vector<rpc::ObjectReference> &object_ref_bundle,
                            BundlePriority prio,
                            const TaskMetricsKey &task_key,
-                           std::vector<rpc::ObjectReference> *objects_to_locate) {
+                           std::vector<rpc::ObjectReference> *objects_to_locate,
+                           const rpc::TraceContext &trace_context) {
   // To avoid edge cases dealing with duplicated object ids in the bundle,
   // canonicalize the set up-front by dropping all duplicates.
   absl::flat_hash_set<ObjectID> seen;
@@ -78,6 +80,11 @@ uint64_t PullManager::Pull(const std::vector<rpc::ObjectReference> &object_ref_b
       // the retry timer fire immediately.
       it = object_pull_requests_.emplace(obj_id, ObjectPullRequest(get_time_seconds_()))
                .first;
+      if (tracing::IsSampled(trace_context)) {
+        it->second.span =
+            tracing::Span::StartChild("PullManager.PullObject", trace_context);
+        it->second.span.SetAttribute("object_id", obj_id.Hex());
+      }
     } else {
       if (it->second.IsPullable()) {
         bundle_pull_request.MarkObjectAsPullable(obj_id);
@@ -337,9 +344,10 @@ std::vector<ObjectID> PullManager::CancelPull(uint64_t request_id) {
       RAY_LOG(DEBUG) << "Removing an object pull request of id: " << obj_id;
       it->second.bundle_request_ids.erase(bundle_it->first);
       if (it->second.bundle_request_ids.empty()) {
-        ray::stats::STATS_pull_manager_object_request_time_ms.Record(
-            absl::GetCurrentTimeNanos() / 1e3 - it->second.request_start_time_ms,
-            "StartToCancel");
+        static auto &start_to_cancel_time_ms =
+            ray::stats::STATS_pull_manager_object_request_time_ms.Bind("StartToCancel");
+        start_to_cancel_time_ms.Record(absl::GetCurrentTimeNanos() / 1e3 -
+                                       it->second.request_start_time_ms);
         object_pull_requests_.erase(it);
         object_ids_to_cancel_subscription.push_back(obj_id);
       }
@@ -519,7 +527,7 @@ bool PullManager::PullFromRandomLocation(const ObjectID &object_id) {
       RAY_LOG(DEBUG) << "Sending pull request from " << self_node_id_
                      << " to spilled location at " << spilled_node_id << " of object "
                      << object_id;
-      send_pull_request_(object_id, spilled_node_id);
+      send_pull_request_(object_id, spilled_node_id, it->second.span.Context());
       return true;
     }
     // The timer should never fire if there are no expected client locations.
@@ -536,7 +544,7 @@ bool PullManager::PullFromRandomLocation(const ObjectID &object_id) {
   RAY_CHECK(node_id != self_node_id_);
   RAY_LOG(DEBUG) << "Sending pull request from " << self_node_id_
                  << " to in-memory location at " << node_id << " of object " << object_id;
-  send_pull_request_(object_id, node_id);
+  send_pull_request_(object_id, node_id, it->second.span.Context());
   return true;
 }
 
@@ -601,13 +609,21 @@ bool PullManager::TryPinObject(const ObjectID &object_id) {
 
       auto it = object_pull_requests_.find(object_id);
       RAY_CHECK(it != object_pull_requests_.end());
-      ray::stats::STATS_pull_manager_object_request_time_ms.Record(
-          absl::GetCurrentTimeNanos() / 1e3 - it->second.request_start_time_ms,
-          "StartToPin");
+      static auto &start_to_pin_time_ms =
+          ray::stats::STATS_pull_manager_object_request_time_ms.Bind("StartToPin");
+      start_to_pin_time_ms.Record(absl::GetCurrentTimeNanos() / 1e3 -
+                                  it->second.request_start_time_ms);
       if (it->second.activate_time_ms > 0) {
-        ray::stats::STATS_pull_manager_object_request_time_ms.Record(
-            absl::GetCurrentTimeNanos() / 1e3 - it->second.activate_time_ms,
-            "MemoryAvailableToPin");
+        static auto &memory_available_to_pin_time_ms =
+            ray::stats::STATS_pull_manager_object_request_time_ms.Bind(
+                "MemoryAvailableToPin");
+        memory_available_to_pin_time_ms.Record(absl::GetCurrentTimeNanos() / 1e3 -
+                                               it->second.activate_time_ms);
+      }
+      if (it->second.span.IsRecording()) {
+        it->second.span.SetAttribute("object_size",
+                                     std::to_string(it->second.object_size));
+        it->second.span.End();
       }
     } else {
       num_failed_pins_total_++;
@@ -26,6 +26,7 @@
 #include "ray/common/ray_config.h"
 #include "ray/common/ray_object.h"
 #include "ray/common/status.h"
+#include "ray/common/tracing.h"
 #include "ray/object_manager/common.h"
 #include "ray/object_manager/object_directory.h"
 #include "ray/object_manager/ownership_based_object_directory.h"
@@ -59,7 +60,7 @@ class PullManager {
   /// \param object_is_local A callback which should return true if a given object is
   /// already on the local node.
   /// \param send_pull_request A callback which should send a
-  /// pull request to the specified node.
+  /// pull request to the specified node, with the context of the span of the pull.
   /// \param cancel_pull_request A callback which should
   /// cancel pulling an object.
   /// \param restore_spilled_object A callback which should
@@ -67,7 +68,8 @@ class PullManager {
   PullManager(
       NodeID &self_node_id,
       const std::function<bool(const ObjectID &)> object_is_local,
-      const std::function<void(const ObjectID &, const NodeID &)> send_pull_request,
+      const std::function<void(
+          const ObjectID &, const NodeID &, const rpc::TraceContext &)> send_pull_request,
       const std::function<void(const ObjectID &)> cancel_pull_request,
       const std::function<void(const ObjectID &, rpc::ErrorType)> fail_pull_request,
       const RestoreSpilledObjectCallback restore_spilled_object,
@@ -88,11 +90,15 @@ class PullManager {
   /// \param task_key Task name and whether it is a retry.
   /// \param objects_to_locate The objects whose new locations the caller
   /// should subscribe to, and call OnLocationChange for.
+  /// \param trace_context The context of the span the pulls of the objects are
+  /// children of, if they're traced. An object is traced by the first request pulling
+  /// it.
   /// \return A request ID that can be used to cancel the request.
   uint64_t Pull(const std::vector<rpc::ObjectReference> &object_ref_bundle,
                 BundlePriority prio,
                 const TaskMetricsKey &task_key,
-                std::vector<rpc::ObjectReference> *objects_to_locate);
+                std::vector<rpc::ObjectReference> *objects_to_locate,
+                const rpc::TraceContext &trace_context = rpc::TraceContext());
 
   /// Update the pull requests that are currently being pulled, according to
   /// the current capacity. The PullManager will choose the objects to pull by
@@ -200,6 +206,9 @@ class PullManager {
     uint8_t num_retries;
     bool object_size_set = false;
     size_t object_size = 0;
+    // The span of the pull, which ends when the object is pinned or the pull is
+    // canceled. It's a no-op if the pull isn't traced.
+    tracing::Span span;
     // All bundle requests that haven't been canceled yet that require this
     // object. This includes bundle requests whose objects are not actively
     // being pulled.
@@ -436,7 +445,8 @@ class PullManager {
   /// See the constructor's arguments.
   NodeID self_node_id_;
   const std::function<bool(const ObjectID &)> object_is_local_;
-  const std::function<void(const ObjectID &, const NodeID &)> send_pull_request_;
+  const std::function<void(const ObjectID &, const NodeID &, const rpc::TraceContext &)>
+      send_pull_request_;
   const std::function<void(const ObjectID &)> cancel_pull_request_;
   const RestoreSpilledObjectCallback restore_spilled_object_;
   const std::function<double()> get_time_seconds_;
@@ -34,7 +34,9 @@ class PullManagerTestWithCapacity {
         pull_manager_(
             self_node_id_,
             [this](const ObjectID &object_id) { return object_is_local_; },
-            [this](const ObjectID &object_id, const NodeID &node_id) {
+            [this](const ObjectID &object_id,
+                   const NodeID &node_id,
+                   const rpc::TraceContext &trace_context) {
               num_send_pull_request_calls_++;
             },
             [this](const ObjectID &object_id) { num_abort_calls_[object_id]++; },
@@ -14,6 +14,13 @@
 
 #include "ray/pubsub/publisher.h"
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include <boost/asio/post.hpp>
+
+#include "absl/hash/hash.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "ray/common/ray_config.h"
 
 namespace ray {
@@ -22,7 +29,81 @@ namespace pubsub {
 
 namespace pub_internal {
 
-bool BasicEntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
+namespace {
+
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedOutputStream;
+
+/// Serialize a length delimited field header, i.e. its tag and length.
+uint8_t *WriteLengthDelimitedHeader(int field_number, size_t length, uint8_t *target) {
+  target = CodedOutputStream::WriteVarint32ToArray(
+      WireFormatLite::MakeTag(field_number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED),
+      target);
+  return CodedOutputStream::WriteVarint64ToArray(length, target);
+}
+
+/// Serialize the sequence id field of a PubMessage.
+grpc::Slice SerializeSequenceId(int64_t sequence_id) {
+  uint8_t buffer[5 + 10];
+  uint8_t *end = CodedOutputStream::WriteVarint32ToArray(
+      WireFormatLite::MakeTag(rpc::PubMessage::kSequenceIdFieldNumber,
+                              WireFormatLite::WIRETYPE_VARINT),
+      buffer);
+  end = CodedOutputStream::WriteVarint64ToArray(sequence_id, end);
+  // Small slices are inlined, so it doesn't allocate.
+  return grpc::Slice(buffer, end - buffer);
+}
+
+/// Append a PubMessage entry of a PubsubLongPollingReply, which consists of the field
+/// header, the serialized message shared by all subscribers, and the sequence id of
+/// the subscriber. The sequence id parses as a field of the message, and since it's
+/// the last one, it overrides the sequence id in the shared message if any.
+void AppendPubMessage(grpc::Slice serialized_message,
+                      int64_t sequence_id,
+                      std::vector<grpc::Slice> *slices) {
+  auto sequence_id_field = SerializeSequenceId(sequence_id);
+  uint8_t buffer[5 + 10];
+  uint8_t *end =
+      WriteLengthDelimitedHeader(rpc::PubsubLongPollingReply::kPubMessagesFieldNumber,
+                                 serialized_message.size() + sequence_id_field.size(),
+                                 buffer);
+  slices->emplace_back(buffer, end - buffer);
+  slices->push_back(std::move(serialized_message));
+  slices->push_back(std::move(sequence_id_field));
+}
+
+/// Serialize the publisher id field of a PubsubLongPollingReply.
+grpc::Slice SerializePublisherId(const PublisherID &publisher_id) {
+  const auto &binary = publisher_id.Binary();
+  uint8_t buffer[5 + 10];
+  uint8_t *end = WriteLengthDelimitedHeader(
+      rpc::PubsubLongPollingReply::kPublisherIdFieldNumber, binary.size(), buffer);
+  std::string field(reinterpret_cast<const char *>(buffer), end - buffer);
+  field.append(binary);
+  return grpc::Slice(field);
+}
+
+}  // namespace
+
+grpc::Slice SharedPubMessage::Serialized() const {
+  absl::MutexLock lock(&mutex_);
+  if (!serialized_.has_value()) {
+    const size_t size = message_.ByteSizeLong();
+    grpc_slice slice = grpc_slice_malloc(size);
+    message_.SerializeWithCachedSizesToArray(GRPC_SLICE_START_PTR(slice));
+    serialized_.emplace(slice, grpc::Slice::STEAL_REF);
+  }
+  // Copying a slice only takes a reference.
+  return *serialized_;
+}
+
+void SharedPubMessage::Clear() {
+  absl::MutexLock lock(&mutex_);
+  message_ = rpc::PubMessage();
+  serialized_.reset();
+}
+
+bool BasicEntityState::Publish(std::shared_ptr<SharedPubMessage> msg) {
   if (subscribers_.empty()) {
     return false;
   }
@@ -32,12 +113,9 @@ bool BasicEntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
   return true;
 }
 
-bool CappedEntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
-  if (subscribers_.empty()) {
-    return false;
-  }
-
-  const int64_t message_size = msg->ByteSizeLong();
+void CappedMessageBuffer::Add(const std::shared_ptr<SharedPubMessage> &msg) {
+  const int64_t message_size = msg->message().ByteSizeLong();
+  absl::MutexLock lock(&mutex_);
   while (!pending_messages_.empty()) {
     // NOTE: if atomic ref counting becomes too expensive, it should be possible
     // to implement inflight message tracking across subscribers with non-atomic
@@ -59,12 +137,13 @@ bool CappedEntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
                           total_size_,
                           "B")
           << ". Dropping the oldest message:\n"
-          << front_msg->DebugString();
+          << front_msg->message().DebugString();
       // Clear the oldest message first, because presumably newer messages are more
-      // useful. Clearing the shared message should be ok, since Publisher is single
-      // threaded. NOTE: calling Clear() does not release memory from the underlying
-      // protobuf message object.
-      *front_msg = rpc::PubMessage();
+      // useful. Subscribers copy messages under the reader lock, so it's safe to clear
+      // the shared message here. NOTE: calling Clear() does not release memory from
+      // the underlying protobuf message object.
+      absl::WriterMutexLock dropped_message_lock(dropped_message_mutex_);
+      front_msg->Clear();
     } else {
       // No message to drop.
       break;
@@ -78,7 +157,19 @@ bool CappedEntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
   pending_messages_.push(msg);
   total_size_ += message_size;
   message_sizes_.push(message_size);
+}
+
+int64_t CappedMessageBuffer::TotalSize() const {
+  absl::MutexLock lock(&mutex_);
+  return total_size_;
+}
+
+bool CappedEntityState::Publish(std::shared_ptr<SharedPubMessage> msg) {
+  if (subscribers_.empty()) {
+    return false;
+  }
 
+  buffer_->Add(msg);
   for (auto &[id, subscriber] : subscribers_) {
     subscriber->QueueMessage(msg);
   }
@@ -98,13 +189,21 @@ const absl::flat_hash_map<SubscriberID, SubscriberState *> &EntityState::Subscri
   return subscribers_;
 }
 
-SubscriptionIndex::SubscriptionIndex(rpc::ChannelType channel_type)
-    : channel_type_(channel_type), subscribers_to_all_(CreateEntityState()) {}
-
-bool SubscriptionIndex::Publish(std::shared_ptr<rpc::PubMessage> pub_message) {
+SubscriptionIndex::SubscriptionIndex(rpc::ChannelType channel_type,
+                                     absl::Mutex *dropped_message_mutex,
+                                     std::shared_ptr<CappedMessageBuffer> all_keys_buffer)
+    : channel_type_(channel_type),
+      local_dropped_message_mutex_(
+          dropped_message_mutex == nullptr ? std::make_unique<absl::Mutex>() : nullptr),
+      dropped_message_mutex_(dropped_message_mutex == nullptr
+                                 ? local_dropped_message_mutex_.get()
+                                 : dropped_message_mutex),
+      subscribers_to_all_(CreateEntityState(std::move(all_keys_buffer))) {}
+
+bool SubscriptionIndex::Publish(std::shared_ptr<SharedPubMessage> pub_message) {
   const bool publish_to_all = subscribers_to_all_->Publish(pub_message);
   bool publish_to_entity = false;
-  auto it = entities_.find(pub_message->key_id());
+  auto it = entities_.find(pub_message->message().key_id());
   if (it != entities_.end()) {
     publish_to_entity = it->second->Publish(pub_message);
   }
@@ -229,20 +328,23 @@ bool SubscriptionIndex::CheckNoLeaks() const {
   return entities_.empty() && subscribers_to_key_id_.empty();
 }
 
-std::unique_ptr<EntityState> SubscriptionIndex::CreateEntityState() {
+std::unique_ptr<EntityState> SubscriptionIndex::CreateEntityState(
+    std::shared_ptr<CappedMessageBuffer> buffer) {
   switch (channel_type_) {
   case rpc::ChannelType::RAY_ERROR_INFO_CHANNEL:
   case rpc::ChannelType::RAY_LOG_CHANNEL: {
-    return std::make_unique<CappedEntityState>();
+    if (buffer == nullptr) {
+      buffer = std::make_shared<CappedMessageBuffer>(dropped_message_mutex_);
+    }
+    return std::make_unique<CappedEntityState>(std::move(buffer));
   }
   default:
     return std::make_unique<BasicEntityState>();
   }
 }
 
-void SubscriberState::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request,
-                                          rpc::PubsubLongPollingReply *reply,
-                                          rpc::SendReplyCallback send_reply_callback) {
+void SubscriberState::RemoveProcessedMessages(
+    const rpc::PubsubLongPollingRequest &request) {
   auto max_processed_sequence_id = request.max_processed_sequence_id();
   if (request.publisher_id().empty() ||
       publisher_id_ != PublisherID::FromBinary(request.publisher_id())) {
@@ -252,17 +354,30 @@ void SubscriberState::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &r
   }
 
   // clean up messages that have already been processed.
-  while (!mailbox_.empty() &&
-         mailbox_.front()->sequence_id() <= max_processed_sequence_id) {
+  while (!mailbox_.empty() && mailbox_.front().first <= max_processed_sequence_id) {
     RAY_LOG(DEBUG) << "removing " << max_processed_sequence_id << " : "
-                   << mailbox_.front()->sequence_id();
+                   << mailbox_.front().first;
     mailbox_.pop_front();
   }
+}
+
+void SubscriberState::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request,
+                                          rpc::PubsubLongPollingReply *reply,
+                                          rpc::SendReplyCallback send_reply_callback) {
+  absl::MutexLock lock(&mutex_);
+  RemoveProcessedMessages(request);
+
+  if (stream_ != nullptr) {
+    // The subscriber switched to long polling.
+    stream_->Close();
+    stream_ = nullptr;
+    stream_write_inflight_ = false;
+  }
 
   if (long_polling_connection_) {
     // Because of the new long polling request, flush the current polling request with an
     // empty reply.
-    PublishIfPossible(/*force_noop=*/true);
+    PublishIfPossibleInternal(/*force_noop=*/true);
   }
   RAY_CHECK(!long_polling_connection_);
   RAY_CHECK(reply != nullptr);
@@ -270,19 +385,117 @@ void SubscriberState::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &r
   long_polling_connection_ =
       std::make_unique<LongPollConnection>(reply, std::move(send_reply_callback));
   last_connection_update_time_ms_ = get_time_ms_();
-  PublishIfPossible();
+  PublishIfPossibleInternal(/*force_noop=*/false);
+}
+
+void SubscriberState::ConnectToSubscriberStream(
+    const rpc::PubsubLongPollingRequest &request, SubscriberStream *stream) {
+  RAY_CHECK(stream != nullptr);
+  absl::MutexLock lock(&mutex_);
+  RemoveProcessedMessages(request);
+
+  if (long_polling_connection_) {
+    // The subscriber switched to streaming.
+    PublishIfPossibleInternal(/*force_noop=*/true);
+  }
+  if (stream_ != nullptr && stream_ != stream) {
+    // The subscriber reconnected, e.g. because the previous stream broke on its side.
+    stream_->Close();
+  }
+  stream_ = stream;
+  stream_write_inflight_ = false;
+  // Messages sent to the previous connection might be lost.
+  max_sent_sequence_id_ = 0;
+  last_connection_update_time_ms_ = get_time_ms_();
+  // Reply right away, so the subscriber knows the publisher is alive.
+  PublishToStream(/*force=*/true);
+}
+
+void SubscriberState::HandleStreamRequest(const rpc::PubsubLongPollingRequest &request) {
+  absl::MutexLock lock(&mutex_);
+  RemoveProcessedMessages(request);
+  last_connection_update_time_ms_ = get_time_ms_();
+}
+
+void SubscriberState::HandleStreamWriteDone(SubscriberStream *stream) {
+  absl::MutexLock lock(&mutex_);
+  if (stream_ != stream) {
+    return;
+  }
+  stream_write_inflight_ = false;
+  PublishToStream(/*force=*/false);
+}
+
+void SubscriberState::DisconnectStream(SubscriberStream *stream) {
+  absl::MutexLock lock(&mutex_);
+  if (stream_ != stream) {
+    return;
+  }
+  stream_ = nullptr;
+  stream_write_inflight_ = false;
+  // The subscriber is considered dead if it doesn't connect again before the timeout.
+  last_connection_update_time_ms_ = get_time_ms_();
+}
+
+bool SubscriberState::PublishToStream(bool force) {
+  if (stream_ == nullptr || stream_write_inflight_) {
+    return false;
+  }
+  if (!force && (mailbox_.empty() || mailbox_.back().first <= max_sent_sequence_id_)) {
+    return false;
+  }
+
+  // The reply is assembled from the serialized messages shared by all subscribers,
+  // so only the field headers and the sequence ids are serialized for this subscriber.
+  std::vector<grpc::Slice> slices;
+  slices.push_back(SerializePublisherId(publisher_id_));
+  {
+    absl::ReaderMutexLock dropped_message_lock(dropped_message_mutex_);
+    int num_messages = 0;
+    for (const auto &[sequence_id, msg] : mailbox_) {
+      if (num_messages >= publish_batch_size_) {
+        break;
+      }
+      if (sequence_id <= max_sent_sequence_id_) {
+        continue;
+      }
+      max_sent_sequence_id_ = sequence_id;
+      // Avoid sending empty message to the subscriber. The message might have been
+      // cleared because the subscribed entity's buffer was full.
+      if (msg->message().inner_message_case() != rpc::PubMessage::INNER_MESSAGE_NOT_SET) {
+        AppendPubMessage(msg->Serialized(), sequence_id, &slices);
+        num_messages++;
+      }
+    }
+  }
+  stream_write_inflight_ = true;
+  last_connection_update_time_ms_ = get_time_ms_();
+  stream_->Write(grpc::ByteBuffer(slices.data(), slices.size()));
+  return true;
 }
 
-void SubscriberState::QueueMessage(const std::shared_ptr<rpc::PubMessage> &pub_message,
+void SubscriberState::QueueMessage(const std::shared_ptr<SharedPubMessage> &pub_message,
                                    bool try_publish) {
-  RAY_LOG(DEBUG) << "enqueue: " << pub_message->sequence_id();
-  mailbox_.push_back(pub_message);
+  absl::MutexLock lock(&mutex_);
+  const int64_t sequence_id = ++(*next_sequence_id_);
+  RAY_LOG(DEBUG) << "enqueue: " << sequence_id;
+  mailbox_.emplace_back(sequence_id, pub_message);
   if (try_publish) {
-    PublishIfPossible();
+    PublishIfPossibleInternal(/*force_noop=*/false);
   }
 }
 
 bool SubscriberState::PublishIfPossible(bool force_noop) {
+  absl::MutexLock lock(&mutex_);
+  return PublishIfPossibleInternal(force_noop);
+}
+
+bool SubscriberState::PublishIfPossibleInternal(bool force_noop) {
+  if (stream_ != nullptr) {
+    // A stream doesn't need to be refreshed, so force_noop only matters for long
+    // polling.
+    return PublishToStream(/*force=*/false);
+  }
   if (!long_polling_connection_) {
     return false;
   }
@@ -294,15 +507,18 @@ bool SubscriberState::PublishIfPossible(bool force_noop) {
   RAY_CHECK(long_polling_connection_->reply->pub_messages().empty());
   *long_polling_connection_->reply->mutable_publisher_id() = publisher_id_.Binary();
   if (!force_noop) {
+    absl::ReaderMutexLock dropped_message_lock(dropped_message_mutex_);
     for (auto it = mailbox_.begin(); it != mailbox_.end(); it++) {
       if (long_polling_connection_->reply->pub_messages().size() >= publish_batch_size_) {
         break;
       }
-      const rpc::PubMessage &msg = **it;
+      const rpc::PubMessage &msg = it->second->message();
       // Avoid sending empty message to the subscriber. The message might have been
       // cleared because the subscribed entity's buffer was full.
       if (msg.inner_message_case() != rpc::PubMessage::INNER_MESSAGE_NOT_SET) {
-        *long_polling_connection_->reply->add_pub_messages() = msg;
+        auto *reply_msg = long_polling_connection_->reply->add_pub_messages();
+        *reply_msg = msg;
+        reply_msg->set_sequence_id(it->first);
       }
     }
   }
@@ -319,20 +535,102 @@ bool SubscriberState::PublishIfPossible(bool force_noop) {
 }
 
 bool SubscriberState::CheckNoLeaks() const {
+  absl::MutexLock lock(&mutex_);
   // If all message in the mailbox has been replied, consider there is no leak.
   return mailbox_.empty();
 }
 
 bool SubscriberState::ConnectionExists() const {
-  return long_polling_connection_ != nullptr;
+  absl::MutexLock lock(&mutex_);
+  return long_polling_connection_ != nullptr || stream_ != nullptr;
 }
 
 bool SubscriberState::IsActive() const {
-  return get_time_ms_() - last_connection_update_time_ms_ < connection_timeout_ms_;
+  absl::MutexLock lock(&mutex_);
+  return stream_ != nullptr ||
+         get_time_ms_() - last_connection_update_time_ms_ < connection_timeout_ms_;
 }
 
 }  // namespace pub_internal
 
+Publisher::Publisher(const std::vector<rpc::ChannelType> &channels,
+                     PeriodicalRunner *const periodical_runner,
+                     std::function<double()> get_time_ms,
+                     const uint64_t subscriber_timeout_ms,
+                     const int publish_batch_size,
+                     PublisherID publisher_id,
+                     size_t num_shards,
+                     size_t num_fanout_threads)
+    : periodical_runner_(periodical_runner),
+      get_time_ms_(std::move(get_time_ms)),
+      subscriber_timeout_ms_(subscriber_timeout_ms),
+      publish_batch_size_(publish_batch_size),
+      publisher_id_(publisher_id) {
+  RAY_CHECK_GT(num_shards, 0UL);
+  if (num_fanout_threads > 0) {
+    fanout_pool_ = std::make_unique<boost::asio::thread_pool>(num_fanout_threads);
+  }
+  // Subscribers to all keys are added to every shard, so the shards share the buffer
+  // of those subscribers to keep the cap of capped channels.
+  using pub_internal::CappedMessageBuffer;
+  absl::flat_hash_map<rpc::ChannelType, std::shared_ptr<CappedMessageBuffer>>
+      all_keys_buffers;
+  for (auto type : channels) {
+    all_keys_buffers[type] =
+        std::make_shared<CappedMessageBuffer>(&dropped_message_mutex_);
+  }
+  for (size_t i = 0; i < num_shards; i++) {
+    auto shard = std::make_unique<Shard>();
+    // Insert index map for each channel.
+    for (auto type : channels) {
+      shard->subscription_index_map.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(type),
+          std::forward_as_tuple(type, &dropped_message_mutex_, all_keys_buffers[type]));
+    }
+    // A single fanout thread runs the messages in order anyway. Strands would only
+    // reorder messages across shards.
+    if (num_fanout_threads > 1) {
+      shard->strand.emplace(boost::asio::make_strand(fanout_pool_->get_executor()));
+    }
+    shards_.push_back(std::move(shard));
+  }
+
+  periodical_runner_->RunFnPeriodically([this] { CheckDeadSubscribers(); },
+                                        subscriber_timeout_ms,
+                                        "Publisher.CheckDeadSubscribers");
+}
+
+Publisher::~Publisher() {
+  if (fanout_pool_) {
+    // Queue the pending messages before the subscribers are destroyed.
+    fanout_pool_->join();
+  }
+}
+
+Publisher::Shard &Publisher::GetShard(const rpc::ChannelType channel_type,
+                                      const std::string &key_id) const {
+  if (shards_.size() == 1) {
+    return *shards_.front();
+  }
+  return *shards_[absl::HashOf(channel_type, key_id) % shards_.size()];
+}
+
+pub_internal::SubscriberState *Publisher::GetOrCreateSubscriber(
+    const SubscriberID &subscriber_id) {
+  auto &subscriber = subscribers_[subscriber_id];
+  if (subscriber == nullptr) {
+    subscriber = std::make_unique<pub_internal::SubscriberState>(subscriber_id,
+                                                                 get_time_ms_,
+                                                                 subscriber_timeout_ms_,
+                                                                 publish_batch_size_,
+                                                                 publisher_id_,
+                                                                 &next_sequence_id_,
+                                                                 &dropped_message_mutex_);
+  }
+  return subscriber.get();
+}
+
 void Publisher::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request,
                                     rpc::PubsubLongPollingReply *reply,
                                     rpc::SendReplyCallback send_reply_callback) {
@@ -342,57 +640,154 @@ void Publisher::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request
   const auto subscriber_id = SubscriberID::FromBinary(request.subscriber_id());
   RAY_LOG(DEBUG) << "Long polling connection initiated by " << subscriber_id.Hex()
                  << ", publisher_id " << publisher_id_.Hex();
-  absl::MutexLock lock(&mutex_);
+  {
+    // The reader lock keeps the subscriber alive, while allowing other subscribers to
+    // connect concurrently.
+    absl::ReaderMutexLock lock(&subscribers_mutex_);
+    auto it = subscribers_.find(subscriber_id);
+    if (it != subscribers_.end()) {
+      // May flush the current long poll with an empty message, if a poll request
+      // exists.
+      it->second->ConnectToSubscriber(request, reply, std::move(send_reply_callback));
+      return;
+    }
+  }
+  absl::MutexLock lock(&subscribers_mutex_);
+  GetOrCreateSubscriber(subscriber_id)
+      ->ConnectToSubscriber(request, reply, std::move(send_reply_callback));
+}
+
+void Publisher::HandleSubscriberStreamRequest(
+    const rpc::PubsubLongPollingRequest &request,
+    SubscriberStream *stream,
+    bool first_request) {
+  const auto subscriber_id = SubscriberID::FromBinary(request.subscriber_id());
+  if (first_request) {
+    RAY_LOG(DEBUG) << "Stream connection initiated by " << subscriber_id.Hex()
+                   << ", publisher_id " << publisher_id_.Hex();
+    {
+      absl::ReaderMutexLock lock(&subscribers_mutex_);
+      auto it = subscribers_.find(subscriber_id);
+      if (it != subscribers_.end()) {
+        it->second->ConnectToSubscriberStream(request, stream);
+        return;
+      }
+    }
+    absl::MutexLock lock(&subscribers_mutex_);
+    GetOrCreateSubscriber(subscriber_id)->ConnectToSubscriberStream(request, stream);
+    return;
+  }
+  absl::ReaderMutexLock lock(&subscribers_mutex_);
   auto it = subscribers_.find(subscriber_id);
   if (it == subscribers_.end()) {
-    it = subscribers_
-             .emplace(
-                 subscriber_id,
-                 std::make_unique<pub_internal::SubscriberState>(subscriber_id,
-                                                                 get_time_ms_,
-                                                                 subscriber_timeout_ms_,
-                                                                 publish_batch_size_,
-                                                                 publisher_id_))
-             .first;
+    // The subscriber was removed, and the stream was closed with it.
+    return;
   }
-  auto &subscriber = it->second;
+  it->second->HandleStreamRequest(request);
+}
+
+void Publisher::HandleSubscriberStreamWriteDone(const SubscriberID &subscriber_id,
+                                                SubscriberStream *stream) {
+  absl::ReaderMutexLock lock(&subscribers_mutex_);
+  auto it = subscribers_.find(subscriber_id);
+  if (it != subscribers_.end()) {
+    it->second->HandleStreamWriteDone(stream);
+  }
+}
 
-  // May flush the current long poll with an empty message, if a poll request exists.
-  subscriber->ConnectToSubscriber(request, reply, std::move(send_reply_callback));
+void Publisher::DisconnectSubscriberStream(const SubscriberID &subscriber_id,
+                                           SubscriberStream *stream) {
+  absl::ReaderMutexLock lock(&subscribers_mutex_);
+  auto it = subscribers_.find(subscriber_id);
+  if (it != subscribers_.end()) {
+    it->second->DisconnectStream(stream);
+  }
 }
 
 bool Publisher::RegisterSubscription(const rpc::ChannelType channel_type,
                                      const SubscriberID &subscriber_id,
                                      const std::optional<std::string> &key_id) {
-  absl::MutexLock lock(&mutex_);
-  auto it = subscribers_.find(subscriber_id);
-  if (it == subscribers_.end()) {
-    it = subscribers_
-             .emplace(
-                 subscriber_id,
-                 std::make_unique<pub_internal::SubscriberState>(subscriber_id,
-                                                                 get_time_ms_,
-                                                                 subscriber_timeout_ms_,
-                                                                 publish_batch_size_,
-                                                                 publisher_id_))
-             .first;
+  {
+    absl::ReaderMutexLock lock(&subscribers_mutex_);
+    auto it = subscribers_.find(subscriber_id);
+    if (it != subscribers_.end()) {
+      return AddSubscriptionEntry(channel_type, it->second.get(), key_id);
+    }
   }
-  pub_internal::SubscriberState *subscriber = it->second.get();
-  auto subscription_index_it = subscription_index_map_.find(channel_type);
-  RAY_CHECK(subscription_index_it != subscription_index_map_.end());
-  return subscription_index_it->second.AddEntry(key_id.value_or(""), subscriber);
+  absl::MutexLock lock(&subscribers_mutex_);
+  return AddSubscriptionEntry(channel_type, GetOrCreateSubscriber(subscriber_id), key_id);
+}
+
+bool Publisher::AddSubscriptionEntry(const rpc::ChannelType channel_type,
+                                     pub_internal::SubscriberState *subscriber,
+                                     const std::optional<std::string> &key_id) {
+  const auto &key = key_id.value_or("");
+  if (!key.empty()) {
+    auto &shard = GetShard(channel_type, key);
+    absl::MutexLock shard_lock(&shard.mutex);
+    auto subscription_index_it = shard.subscription_index_map.find(channel_type);
+    RAY_CHECK(subscription_index_it != shard.subscription_index_map.end());
+    return subscription_index_it->second.AddEntry(key, subscriber);
+  }
+  // Subscribers to all keys receive messages from every shard.
+  bool added = false;
+  for (auto &shard : shards_) {
+    absl::MutexLock shard_lock(&shard->mutex);
+    auto subscription_index_it = shard->subscription_index_map.find(channel_type);
+    RAY_CHECK(subscription_index_it != shard->subscription_index_map.end());
+    added = subscription_index_it->second.AddEntry("", subscriber);
+  }
+  return added;
 }
 
 void Publisher::Publish(rpc::PubMessage pub_message) {
   RAY_CHECK_EQ(pub_message.sequence_id(), 0) << "sequence_id should not be set;";
   const auto channel_type = pub_message.channel_type();
-  absl::MutexLock lock(&mutex_);
-  auto &subscription_index = subscription_index_map_.at(channel_type);
+  auto &shard = GetShard(channel_type, pub_message.key_id());
+  auto message = std::make_shared<pub_internal::SharedPubMessage>(std::move(pub_message));
+  if (fanout_pool_ == nullptr) {
+    FanoutMessage(shard, std::move(message));
+  } else if (shard.strand.has_value()) {
+    boost::asio::post(*shard.strand,
+                      [this, &shard, message = std::move(message)]() mutable {
+                        FanoutMessage(shard, std::move(message));
+                      });
+  } else {
+    boost::asio::post(*fanout_pool_,
+                      [this, &shard, message = std::move(message)]() mutable {
+                        FanoutMessage(shard, std::move(message));
+                      });
+  }
+  absl::MutexLock lock(&stats_mutex_);
+  cum_pub_message_cnt_[channel_type]++;
+}
+
+void Publisher::FanoutMessage(Shard &shard,
+                              std::shared_ptr<pub_internal::SharedPubMessage> message) {
+  absl::MutexLock lock(&shard.mutex);
+  auto &subscription_index =
+      shard.subscription_index_map.at(message->message().channel_type());
   // TODO(sang): Currently messages are lost if publish happens
   // before there's any subscriber for the object.
-  pub_message.set_sequence_id(++next_sequence_id_);
-  subscription_index.Publish(std::make_shared<rpc::PubMessage>(std::move(pub_message)));
-  cum_pub_message_cnt_[channel_type]++;
+  subscription_index.Publish(std::move(message));
+}
+
+void Publisher::Flush() {
+  if (fanout_pool_ == nullptr) {
+    return;
+  }
+  // Messages of a shard are fanned out in order, so the fanout is done once a task
+  // posted after them runs.
+  absl::BlockingCounter pending(shards_.size());
+  for (auto &shard : shards_) {
+    auto done = [&pending]() { pending.DecrementCount(); };
+    if (shard->strand.has_value()) {
+      boost::asio::post(*shard->strand, done);
+    } else {
+      boost::asio::post(*fanout_pool_, done);
+    }
+  }
+  pending.Wait();
 }
 
 void Publisher::PublishFailure(const rpc::ChannelType channel_type,
@@ -407,19 +802,35 @@ void Publisher::PublishFailure(const rpc::ChannelType channel_type,
 bool Publisher::UnregisterSubscription(const rpc::ChannelType channel_type,
                                        const SubscriberID &subscriber_id,
                                        const std::optional<std::string> &key_id) {
-  absl::MutexLock lock(&mutex_);
-  auto subscription_index_it = subscription_index_map_.find(channel_type);
-  RAY_CHECK(subscription_index_it != subscription_index_map_.end());
-  return subscription_index_it->second.EraseEntry(key_id.value_or(""), subscriber_id);
+  // Messages published before the call are still queued to the subscriber.
+  Flush();
+  const auto &key = key_id.value_or("");
+  if (!key.empty()) {
+    auto &shard = GetShard(channel_type, key);
+    absl::MutexLock lock(&shard.mutex);
+    auto subscription_index_it = shard.subscription_index_map.find(channel_type);
+    RAY_CHECK(subscription_index_it != shard.subscription_index_map.end());
+    return subscription_index_it->second.EraseEntry(key, subscriber_id);
+  }
+  bool erased = false;
+  for (auto &shard : shards_) {
+    absl::MutexLock lock(&shard->mutex);
+    auto subscription_index_it = shard->subscription_index_map.find(channel_type);
+    RAY_CHECK(subscription_index_it != shard->subscription_index_map.end());
+    erased = subscription_index_it->second.EraseEntry("", subscriber_id);
+  }
+  return erased;
 }
 
 bool Publisher::UnregisterSubscriber(const SubscriberID &subscriber_id) {
-  absl::MutexLock lock(&mutex_);
+  Flush();
+  absl::MutexLock lock(&subscribers_mutex_);
   return UnregisterSubscriberInternal(subscriber_id);
 }
 
 void Publisher::UnregisterAll() {
-  absl::MutexLock lock(&mutex_);
+  Flush();
+  absl::MutexLock lock(&subscribers_mutex_);
   // Save the subscriber IDs to be removed, because UnregisterSubscriberInternal()
   // erases from subscribers_.
   std::vector<SubscriberID> ids;
@@ -432,12 +843,17 @@ void Publisher::UnregisterAll() {
 }
 
 int Publisher::UnregisterSubscriberInternal(const SubscriberID &subscriber_id) {
-  int erased = 0;
-  for (auto &index : subscription_index_map_) {
-    if (index.second.EraseSubscriber(subscriber_id)) {
-      erased += 1;
+  // Count the erased channels, regardless of how many shards the subscriber was in.
+  absl::flat_hash_set<rpc::ChannelType> erased_channels;
+  for (auto &shard : shards_) {
+    absl::MutexLock shard_lock(&shard->mutex);
+    for (auto &index : shard->subscription_index_map) {
+      if (index.second.EraseSubscriber(subscriber_id)) {
+        erased_channels.insert(index.first);
+      }
     }
   }
+  const int erased = erased_channels.size();
 
   auto it = subscribers_.find(subscriber_id);
   if (it == subscribers_.end()) {
@@ -451,7 +867,7 @@ int Publisher::UnregisterSubscriberInternal(const SubscriberID &subscriber_id) {
 }
 
 void Publisher::CheckDeadSubscribers() {
-  absl::MutexLock lock(&mutex_);
+  absl::MutexLock lock(&subscribers_mutex_);
   std::vector<SubscriberID> dead_subscribers;
 
   for (const auto &it : subscribers_) {
@@ -476,23 +892,26 @@ void Publisher::CheckDeadSubscribers() {
 }
 
 bool Publisher::CheckNoLeaks() const {
-  absl::MutexLock lock(&mutex_);
+  absl::MutexLock lock(&subscribers_mutex_);
   for (const auto &subscriber : subscribers_) {
     if (!subscriber.second->CheckNoLeaks()) {
       return false;
     }
   }
 
-  for (const auto &index : subscription_index_map_) {
-    if (!index.second.CheckNoLeaks()) {
-      return false;
+  for (const auto &shard : shards_) {
+    absl::MutexLock shard_lock(&shard->mutex);
+    for (const auto &index : shard->subscription_index_map) {
+      if (!index.second.CheckNoLeaks()) {
+        return false;
+      }
     }
   }
   return true;
 }
 
 std::string Publisher::DebugString() const {
-  absl::MutexLock lock(&mutex_);
+  absl::MutexLock lock(&stats_mutex_);
   std::stringstream result;
   result << "Publisher:";
   for (const auto &it : cum_pub_message_cnt_) {
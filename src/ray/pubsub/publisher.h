@@ -14,10 +14,16 @@
 
 #pragma once
 
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/slice.h>
 #include <gtest/gtest_prod.h>
 
+#include <atomic>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <deque>
 #include <functional>
+#include <optional>
 #include <queue>
 #include <string>
 #include <string_view>
@@ -38,10 +44,50 @@ namespace pubsub {
 using SubscriberID = UniqueID;
 using PublisherID = UniqueID;
 
+/// The server side of a PubsubStream RPC, which pushes published messages to the
+/// subscriber. Implementations must be thread safe.
+class SubscriberStream {
+ public:
+  virtual ~SubscriberStream() = default;
+
+  /// Send the reply to the subscriber. The reply is a serialized
+  /// PubsubLongPollingReply. The publisher doesn't write again until
+  /// Publisher::HandleSubscriberStreamWriteDone is called.
+  virtual void Write(grpc::ByteBuffer reply) = 0;
+
+  /// Finish the stream. The stream must call Publisher::DisconnectSubscriberStream
+  /// once it's done, whether it's closed by the publisher or not.
+  virtual void Close() = 0;
+};
+
 namespace pub_internal {
 
 class SubscriberState;
 
+/// A published message, shared by all the subscribers it's queued to.
+///
+/// The message is serialized when it's first sent through a stream, and the serialized
+/// bytes are shared by all the streams it's sent to. So a message is serialized once
+/// no matter how many subscribers receive it.
+class SharedPubMessage {
+ public:
+  explicit SharedPubMessage(rpc::PubMessage message) : message_(std::move(message)) {}
+
+  const rpc::PubMessage &message() const { return message_; }
+
+  /// Return the serialized message. It's serialized on the first call. Thread safe, but
+  /// it must not be called concurrently with Clear().
+  grpc::Slice Serialized() const;
+
+  /// Clear the message to release its memory.
+  void Clear();
+
+ private:
+  rpc::PubMessage message_;
+  mutable absl::Mutex mutex_;
+  mutable std::optional<grpc::Slice> serialized_ ABSL_GUARDED_BY(mutex_);
+};
+
 /// State for an entity / topic in a pub/sub channel.
 class EntityState {
  public:
@@ -49,7 +95,7 @@ class EntityState {
 
   /// Publishes the message to subscribers of the entity.
   /// Returns true if there are subscribers, returns false otherwise.
-  virtual bool Publish(std::shared_ptr<rpc::PubMessage> pub_message) = 0;
+  virtual bool Publish(std::shared_ptr<SharedPubMessage> pub_message) = 0;
 
   /// Manages the set of subscribers of this entity.
   bool AddSubscriber(SubscriberState *subscriber);
@@ -79,31 +125,64 @@ class EntityState {
 /// Publishes the message to all subscribers, without size cap on buffered messages.
 class BasicEntityState : public EntityState {
  public:
-  bool Publish(std::shared_ptr<rpc::PubMessage> pub_message) override;
+  bool Publish(std::shared_ptr<SharedPubMessage> pub_message) override;
 };
 
-/// Publishes the message to all subscribers, and enforce a total size cap on buffered
-/// messages.
-class CappedEntityState : public EntityState {
+/// Tracks the messages buffered by capped entities, and drops the oldest ones to stay
+/// under the total size cap. The subscribers to all keys of a channel are added to
+/// every shard of the publisher, so their entities share one buffer.
+class CappedMessageBuffer {
  public:
-  bool Publish(std::shared_ptr<rpc::PubMessage> pub_message) override;
+  /// \param dropped_message_mutex Taken for writing when a message is dropped, since
+  /// subscribers may be copying it under the reader lock.
+  explicit CappedMessageBuffer(absl::Mutex *dropped_message_mutex)
+      : dropped_message_mutex_(dropped_message_mutex) {}
+
+  /// Adds the message, after dropping the oldest messages that don't fit in the cap.
+  void Add(const std::shared_ptr<SharedPubMessage> &msg) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Returns the total size of the buffered messages.
+  int64_t TotalSize() const ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
+  absl::Mutex *const dropped_message_mutex_;
+  mutable absl::Mutex mutex_;
   // Tracks inflight messages. The messages have shared ownership by
   // individual subscribers, and get deleted after no subscriber has
   // the message in buffer.
-  std::queue<std::weak_ptr<rpc::PubMessage>> pending_messages_;
+  std::queue<std::weak_ptr<SharedPubMessage>> pending_messages_ ABSL_GUARDED_BY(mutex_);
   // Size of each inflight message.
-  std::queue<int64_t> message_sizes_;
+  std::queue<int64_t> message_sizes_ ABSL_GUARDED_BY(mutex_);
   // Total size of inflight messages.
-  int64_t total_size_ = 0;
+  int64_t total_size_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+/// Publishes the message to all subscribers, and enforce a total size cap on buffered
+/// messages.
+class CappedEntityState : public EntityState {
+ public:
+  explicit CappedEntityState(std::shared_ptr<CappedMessageBuffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  bool Publish(std::shared_ptr<SharedPubMessage> pub_message) override;
+
+ private:
+  const std::shared_ptr<CappedMessageBuffer> buffer_;
 };
 
 /// Per-channel two-way index for subscribers and the keys they subscribe to.
 /// Also supports subscribers to all keys in the channel.
 class SubscriptionIndex {
  public:
-  SubscriptionIndex(rpc::ChannelType channel_type);
+  /// \param dropped_message_mutex The lock of the messages dropped by the capped
+  /// entities, shared with the subscribers. If nullptr, the index uses its own lock.
+  /// \param all_keys_buffer The buffer of the subscribers to all keys, if the channel
+  /// is capped and the buffer is shared with other indexes. If nullptr, the index
+  /// creates its own.
+  explicit SubscriptionIndex(
+      rpc::ChannelType channel_type,
+      absl::Mutex *dropped_message_mutex = nullptr,
+      std::shared_ptr<CappedMessageBuffer> all_keys_buffer = nullptr);
   ~SubscriptionIndex() = default;
 
   SubscriptionIndex(SubscriptionIndex &&) noexcept = default;
@@ -112,7 +191,7 @@ class SubscriptionIndex {
   /// Publishes the message to relevant subscribers.
   /// Returns true if there are subscribers listening on the entity key of the message,
   /// returns false otherwise.
-  bool Publish(std::shared_ptr<rpc::PubMessage> pub_message);
+  bool Publish(std::shared_ptr<SharedPubMessage> pub_message);
 
   /// Adds a new subscriber and the key it subscribes to.
   /// When `key_id` is empty, the subscriber subscribes to all keys.
@@ -145,10 +224,15 @@ class SubscriptionIndex {
   bool CheckNoLeaks() const;
 
  private:
-  std::unique_ptr<EntityState> CreateEntityState();
+  /// Creates the state of an entity, capped by `buffer` if the channel is capped.
+  std::unique_ptr<EntityState> CreateEntityState(
+      std::shared_ptr<CappedMessageBuffer> buffer = nullptr);
 
   // Type of channel this index is for.
   rpc::ChannelType channel_type_;
+  // Used when the index doesn't share the publisher's lock of the dropped messages.
+  std::unique_ptr<absl::Mutex> local_dropped_message_mutex_;
+  absl::Mutex *dropped_message_mutex_;
   // Collection of subscribers that subscribe to all entities of the channel.
   std::unique_ptr<EntityState> subscribers_to_all_;
   // Mapping from subscribed entity id -> entity state.
@@ -169,24 +253,42 @@ struct LongPollConnection {
 };
 
 /// Keeps the state of each connected subscriber.
+///
+/// The state is thread safe, because messages can be queued from multiple publisher
+/// shards while the subscriber polls.
 class SubscriberState {
  public:
+  /// \param next_sequence_id The sequence id generator shared by all subscribers of a
+  /// publisher. If nullptr, the subscriber uses its own generator.
+  /// \param dropped_message_mutex The lock of the messages dropped by the capped
+  /// entities of the publisher. If nullptr, the subscriber uses its own lock.
   SubscriberState(SubscriberID subscriber_id,
                   std::function<double()> get_time_ms,
                   uint64_t connection_timeout_ms,
                   const int publish_batch_size,
-                  PublisherID publisher_id)
+                  PublisherID publisher_id,
+                  std::atomic<int64_t> *next_sequence_id = nullptr,
+                  absl::Mutex *dropped_message_mutex = nullptr)
       : subscriber_id_(subscriber_id),
         get_time_ms_(std::move(get_time_ms)),
         connection_timeout_ms_(connection_timeout_ms),
         publish_batch_size_(publish_batch_size),
         last_connection_update_time_ms_(get_time_ms_()),
-        publisher_id_(publisher_id) {}
+        publisher_id_(publisher_id),
+        next_sequence_id_(next_sequence_id == nullptr ? &local_next_sequence_id_
+                                                      : next_sequence_id),
+        dropped_message_mutex_(dropped_message_mutex == nullptr
+                                   ? &local_dropped_message_mutex_
+                                   : dropped_message_mutex) {}
 
   ~SubscriberState() {
     // Force a push to close the long-polling.
     // Otherwise, there will be a connection leak.
     PublishIfPossible(true);
+    absl::MutexLock lock(&mutex_);
+    if (stream_ != nullptr) {
+      stream_->Close();
+    }
   }
 
   /// Connect to the subscriber. Currently, it means we cache the long polling request to
@@ -198,12 +300,34 @@ class SubscriberState {
                            rpc::PubsubLongPollingReply *reply,
                            rpc::SendReplyCallback send_reply_callback);
 
-  /// Queue the pubsub message to publish to the subscriber.
+  /// Connect to the subscriber with a stream. The stream replaces the existing long
+  /// polling connection or stream. Unacknowledged messages are sent again, since
+  /// they might have been lost with the previous connection.
+  ///
+  /// \param request The first request of the stream.
+  /// \param stream The stream to push messages. It must stay valid until it's
+  /// disconnected.
+  void ConnectToSubscriberStream(const rpc::PubsubLongPollingRequest &request,
+                                 SubscriberStream *stream);
+
+  /// Handle a request received from the stream, which acknowledges the processed
+  /// messages.
+  void HandleStreamRequest(const rpc::PubsubLongPollingRequest &request);
+
+  /// Handle the completion of a stream write, and write the next batch if any.
+  void HandleStreamWriteDone(SubscriberStream *stream);
+
+  /// Forget the stream. No-op if the stream is not the current one.
+  void DisconnectStream(SubscriberStream *stream);
+
+  /// Queue the pubsub message to publish to the subscriber. The message is assigned a
+  /// sequence id which is only sent to this subscriber, so the message can be shared by
+  /// all subscribers.
   ///
   /// \param pub_message A message to publish.
   /// \param try_publish If true, try publishing the object id if there is a connection.
   ///     Currently only set to false in tests.
-  void QueueMessage(const std::shared_ptr<rpc::PubMessage> &pub_message,
+  void QueueMessage(const std::shared_ptr<SharedPubMessage> &pub_message,
                     bool try_publish = true);
 
   /// Publish all queued messages if possible.
@@ -212,28 +336,48 @@ class SubscriberState {
   /// of whethere there is any queued message. This is for cases where the current poll
   /// might have been cancelled, or the subscriber might be dead.
   /// \return True if it publishes. False otherwise.
-  bool PublishIfPossible(bool force_noop = false);
+  bool PublishIfPossible(bool force_noop = false) ABSL_LOCKS_EXCLUDED(mutex_);
 
   /// Testing only. Return true if there's no metadata remained in the private attribute.
   bool CheckNoLeaks() const;
 
-  /// Returns true if there is a long polling connection.
+  /// Returns true if there is a long polling connection or a stream.
   bool ConnectionExists() const;
 
   /// Returns true if there are recent activities (requests or replies) between the
-  /// subscriber and publisher.
+  /// subscriber and publisher, or the subscriber is connected with a stream.
   bool IsActive() const;
 
   /// Returns the ID of this subscriber.
   const SubscriberID &id() const { return subscriber_id_; }
 
  private:
+  bool PublishIfPossibleInternal(bool force_noop) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Write the messages which haven't been sent to the stream, if there's no write in
+  /// flight. If force is true, write even if there's no message.
+  bool PublishToStream(bool force) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Remove the messages which have been processed by the subscriber.
+  void RemoveProcessedMessages(const rpc::PubsubLongPollingRequest &request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Subscriber ID, for logging and debugging.
   const SubscriberID subscriber_id_;
+  /// Protects below fields.
+  mutable absl::Mutex mutex_;
   /// Inflight long polling reply callback, for replying to the subscriber.
-  std::unique_ptr<LongPollConnection> long_polling_connection_;
-  /// Queued messages to publish.
-  std::deque<std::shared_ptr<rpc::PubMessage>> mailbox_;
+  std::unique_ptr<LongPollConnection> long_polling_connection_ ABSL_GUARDED_BY(mutex_);
+  /// The stream connected to the subscriber, used instead of long polling. Not owned.
+  SubscriberStream *stream_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  /// Whether a write to stream_ is in flight.
+  bool stream_write_inflight_ ABSL_GUARDED_BY(mutex_) = false;
+  /// The max sequence id written to stream_. Messages up to it are kept in the mailbox
+  /// until acknowledged, but not sent again unless the stream reconnects.
+  int64_t max_sent_sequence_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  /// Queued messages to publish, with the sequence ids assigned to them.
+  std::deque<std::pair<int64_t, std::shared_ptr<SharedPubMessage>>> mailbox_
+      ABSL_GUARDED_BY(mutex_);
   /// Callback to get the current time.
   const std::function<double()> get_time_ms_;
   /// The time in which the connection is considered as timed out.
@@ -241,8 +385,19 @@ class SubscriberState {
   /// The maximum number of objects to publish for each publish calls.
   const int publish_batch_size_;
   /// The last time long polling was connected in milliseconds.
-  double last_connection_update_time_ms_;
+  double last_connection_update_time_ms_ ABSL_GUARDED_BY(mutex_);
   PublisherID publisher_id_;
+  /// Used when the subscriber doesn't share the publisher's sequence id generator.
+  std::atomic<int64_t> local_next_sequence_id_ = 0;
+  /// The last assigned sequence id. Sequence ids are assigned under mutex_, so they
+  /// are increasing in the mailbox even if messages are queued from multiple threads.
+  std::atomic<int64_t> *const next_sequence_id_;
+  /// Used when the subscriber doesn't share the publisher's lock of the dropped
+  /// messages.
+  absl::Mutex local_dropped_message_mutex_;
+  /// Taken for reading while the queued messages are copied, since a capped entity may
+  /// clear a message it drops.
+  absl::Mutex *const dropped_message_mutex_;
 };
 
 }  // namespace pub_internal
@@ -298,6 +453,22 @@ class PublisherInterface {
 /// messages.
 /// - Publishes messages are batched in order to avoid gRPC message limit.
 /// - Look at CheckDeadSubscribers for failure handling mechanism.
+/// - Alternatively, subscribers can connect with a PubsubStream. The stream stays open,
+/// and messages are pushed as soon as the previous write is done, without waiting for
+/// the next poll. Acknowledgements are received from the same stream.
+///
+/// Threading model
+///
+/// - Subscriptions are sharded by the hash of (channel type, key id), and each shard has
+/// its own lock. Subscriptions to all keys of a channel are added to every shard.
+/// - Every subscriber state has its own lock, so long polling requests don't contend
+/// with publishes to other subscribers.
+/// - If fanout threads are configured, Publish only posts the message to the thread
+/// pool, and queueing it to the subscribers happens there. Messages of the same shard
+/// are fanned out in order, so messages of the same key are always delivered in order.
+/// With a single fanout thread, all messages are delivered in order.
+///
+/// Lock order: subscribers_mutex_ -> Shard::mutex -> SubscriberState::mutex_.
 ///
 /// How to add new publisher channel?
 ///
@@ -316,28 +487,19 @@ class Publisher : public PublisherInterface {
   /// \param subscriber_timeout_ms The subscriber timeout in milliseconds.
   /// Check out CheckDeadSubscribers for more details.
   /// \param publish_batch_size The batch size of published messages.
+  /// \param num_shards The number of subscription shards, each with its own lock.
+  /// \param num_fanout_threads The number of threads to queue published messages to
+  /// subscribers. If 0, messages are queued in the thread calling Publish.
   Publisher(const std::vector<rpc::ChannelType> &channels,
             PeriodicalRunner *const periodical_runner,
             std::function<double()> get_time_ms,
             const uint64_t subscriber_timeout_ms,
             const int publish_batch_size,
-            PublisherID publisher_id = NodeID::FromRandom())
-      : periodical_runner_(periodical_runner),
-        get_time_ms_(std::move(get_time_ms)),
-        subscriber_timeout_ms_(subscriber_timeout_ms),
-        publish_batch_size_(publish_batch_size),
-        publisher_id_(publisher_id) {
-    // Insert index map for each channel.
-    for (auto type : channels) {
-      subscription_index_map_.emplace(type, type);
-    }
-
-    periodical_runner_->RunFnPeriodically([this] { CheckDeadSubscribers(); },
-                                          subscriber_timeout_ms,
-                                          "Publisher.CheckDeadSubscribers");
-  }
+            PublisherID publisher_id = NodeID::FromRandom(),
+            size_t num_shards = 1,
+            size_t num_fanout_threads = 0);
 
-  ~Publisher() override = default;
+  ~Publisher() override;
 
   /// Handle a long poll request from `subscriber_id`.
   ///
@@ -348,6 +510,25 @@ class Publisher : public PublisherInterface {
                            rpc::PubsubLongPollingReply *reply,
                            rpc::SendReplyCallback send_reply_callback);
 
+  /// Handle a request from a PubsubStream. The first request of a stream connects the
+  /// stream to the subscriber, and the following ones acknowledge processed messages.
+  ///
+  /// \param request The request received from the stream.
+  /// \param stream The stream. It must call DisconnectSubscriberStream when it's done.
+  /// \param first_request Whether it's the first request of the stream.
+  void HandleSubscriberStreamRequest(const rpc::PubsubLongPollingRequest &request,
+                                     SubscriberStream *stream,
+                                     bool first_request);
+
+  /// Handle the completion of a write to the stream.
+  void HandleSubscriberStreamWriteDone(const SubscriberID &subscriber_id,
+                                       SubscriberStream *stream);
+
+  /// Forget the stream, because it's done. After it returns, the publisher doesn't
+  /// access the stream anymore.
+  void DisconnectSubscriberStream(const SubscriberID &subscriber_id,
+                                  SubscriberStream *stream);
+
   /// Register the subscription.
   ///
   /// \param channel_type The type of the channel.
@@ -360,6 +541,11 @@ class Publisher : public PublisherInterface {
 
   /// Publish the given object id to subscribers.
   ///
+  /// With fanout threads, the message is queued to the subscribers after the call
+  /// returns. Subscriptions registered right after the call may then receive the
+  /// message. Unregistering a subscription waits for the messages published before it,
+  /// so they are still queued to the subscriber, as without fanout threads.
+  ///
   /// \param pub_message The message to publish.
   /// Required to contain channel_type and key_id fields.
   void Publish(rpc::PubMessage pub_message) override;
@@ -372,6 +558,10 @@ class Publisher : public PublisherInterface {
   void PublishFailure(const rpc::ChannelType channel_type,
                       const std::string &key_id) override;
 
+  /// Wait until all messages published so far are queued to the subscribers.
+  /// No-op if there's no fanout thread.
+  void Flush();
+
   /// Unregister subscription. It means the given object id won't be published to the
   /// subscriber anymore.
   ///
@@ -431,6 +621,8 @@ class Publisher : public PublisherInterface {
   FRIEND_TEST(PublisherTest, TestUnregisterSubscription);
   FRIEND_TEST(PublisherTest, TestUnregisterSubscriber);
   FRIEND_TEST(PublisherTest, TestRegistrationIdempotency);
+  FRIEND_TEST(PublisherTest, TestShardedPublisherWithFanoutThreads);
+  FRIEND_TEST(PublisherTest, TestUnregisterAfterPublishWithFanoutThreads);
   friend class MockPublisher;
   Publisher() {}
 
@@ -441,8 +633,36 @@ class Publisher : public PublisherInterface {
   /// Private fields
   ///
 
+  /// A partition of the subscription indexes.
+  struct Shard {
+    mutable absl::Mutex mutex;
+    /// Index that stores the mapping of messages <-> subscribers.
+    absl::flat_hash_map<rpc::ChannelType, pub_internal::SubscriptionIndex>
+        subscription_index_map ABSL_GUARDED_BY(mutex);
+    /// Serializes the fanout of messages of this shard, if there's more than one
+    /// fanout thread.
+    std::optional<boost::asio::strand<boost::asio::thread_pool::executor_type>> strand;
+  };
+
+  /// Get the shard of the key. Subscriptions to all keys are in every shard.
+  Shard &GetShard(const rpc::ChannelType channel_type, const std::string &key_id) const;
+
+  /// Queue the message to the subscribers of its shard.
+  void FanoutMessage(Shard &shard,
+                     std::shared_ptr<pub_internal::SharedPubMessage> pub_message);
+
+  pub_internal::SubscriberState *GetOrCreateSubscriber(const SubscriberID &subscriber_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(subscribers_mutex_);
+
+  /// Add the subscription to the shard of the key, or to all shards if key_id is not
+  /// set or empty.
+  bool AddSubscriptionEntry(const rpc::ChannelType channel_type,
+                            pub_internal::SubscriberState *subscriber,
+                            const std::optional<std::string> &key_id)
+      ABSL_SHARED_LOCKS_REQUIRED(subscribers_mutex_);
+
   int UnregisterSubscriberInternal(const SubscriberID &subscriber_id)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(subscribers_mutex_);
 
   // Periodic runner to invoke CheckDeadSubscribers.
   PeriodicalRunner *periodical_runner_;
@@ -453,26 +673,30 @@ class Publisher : public PublisherInterface {
   /// The timeout where subscriber is considered as dead.
   uint64_t subscriber_timeout_ms_;
 
-  /// Protects below fields. Since the coordinator runs in a core worker, it should be
-  /// thread safe.
-  mutable absl::Mutex mutex_;
+  /// Protects subscribers_. Since the coordinator runs in a core worker, it should be
+  /// thread safe. Subscriber states are only created and destroyed under the writer
+  /// lock, and they are removed from all shards before being destroyed.
+  mutable absl::Mutex subscribers_mutex_;
 
   /// Mapping of node id -> subscribers.
   absl::flat_hash_map<SubscriberID, std::unique_ptr<pub_internal::SubscriberState>>
-      subscribers_ ABSL_GUARDED_BY(mutex_);
+      subscribers_ ABSL_GUARDED_BY(subscribers_mutex_);
 
-  /// Index that stores the mapping of messages <-> subscribers.
-  absl::flat_hash_map<rpc::ChannelType, pub_internal::SubscriptionIndex>
-      subscription_index_map_ ABSL_GUARDED_BY(mutex_);
+  /// The subscription shards. The vector itself is immutable after construction.
+  std::vector<std::unique_ptr<Shard>> shards_;
 
   /// The maximum number of objects to publish for each publish calls.
   int publish_batch_size_;
 
+  /// Protects cum_pub_message_cnt_.
+  mutable absl::Mutex stats_mutex_;
+
   absl::flat_hash_map<rpc::ChannelType, uint64_t> cum_pub_message_cnt_
-      ABSL_GUARDED_BY(mutex_);
+      ABSL_GUARDED_BY(stats_mutex_);
 
   /// The monotonically increasing sequence_id for this publisher.
-  /// The publisher will add this sequence_id to every message to be published.
+  /// Subscribers assign sequence_ids from it when messages are queued, and add them to
+  /// the messages sent to the subscriber.
   /// The sequence_id is used for handling failures: the publisher will not delete
   /// a message from the sending queue until the subscriber has acknowledge
   /// it has processed beyond the message's sequence_id.
@@ -481,8 +705,17 @@ class Publisher : public PublisherInterface {
   ///  - a valide sequence_id starts from 1.
   ///  - the subscriber doesn't expect the sequences it receives are contiguous.
   ///    this is due the fact a subscriber can only subscribe a subset
-  ///    of a channel.
-  int64_t next_sequence_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  ///    of a channel, and the sequence_ids are shared by all subscribers.
+  std::atomic<int64_t> next_sequence_id_ = 0;
+
+  /// Capped entity states clear the messages they drop in place, while subscribers may
+  /// be copying them into a reply from another thread. The lock is only taken for
+  /// writing when a message is dropped.
+  absl::Mutex dropped_message_mutex_;
+
+  /// The threads to fan out published messages. nullptr if fanout happens in the
+  /// publishing thread.
+  std::unique_ptr<boost::asio::thread_pool> fanout_pool_;
 
   /// A unique identifier identifies the publisher_id.
   /// TODO(scv119) add docs about the semantics.
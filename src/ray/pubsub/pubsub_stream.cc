@@ -0,0 +1,199 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/pubsub/pubsub_stream.h"
+
+#include "ray/common/grpc_util.h"
+
+namespace ray {
+
+namespace pubsub {
+
+PublisherStreamReactor::PublisherStreamReactor(Publisher *publisher)
+    : publisher_(publisher) {
+  StartRead(&request_buffer_);
+}
+
+void PublisherStreamReactor::Write(grpc::ByteBuffer reply) {
+  absl::MutexLock lock(&mutex_);
+  if (closed_) {
+    return;
+  }
+  RAY_CHECK(!inflight_reply_.has_value()) << "The previous write is still in flight.";
+  inflight_reply_ = std::move(reply);
+  StartWrite(&*inflight_reply_);
+}
+
+void PublisherStreamReactor::Close() {
+  absl::MutexLock lock(&mutex_);
+  closed_ = true;
+  // Finish after the inflight write is done.
+  if (!inflight_reply_.has_value()) {
+    FinishIfNotFinished();
+  }
+}
+
+void PublisherStreamReactor::FinishIfNotFinished() {
+  if (!finished_) {
+    finished_ = true;
+    Finish(grpc::Status::OK);
+  }
+}
+
+void PublisherStreamReactor::OnReadDone(bool ok) {
+  if (!ok) {
+    // The subscriber closed the stream.
+    Close();
+    return;
+  }
+  if (!grpc::SerializationTraits<rpc::PubsubLongPollingRequest>::Deserialize(
+           &request_buffer_, &request_)
+           .ok()) {
+    RAY_LOG(WARNING) << "Failed to parse the pubsub stream request.";
+    Close();
+    return;
+  }
+  if (!connected_) {
+    connected_ = true;
+    subscriber_id_ = SubscriberID::FromBinary(request_.subscriber_id());
+    publisher_->HandleSubscriberStreamRequest(request_, this, /*first_request=*/true);
+  } else {
+    publisher_->HandleSubscriberStreamRequest(request_, this, /*first_request=*/false);
+  }
+  // Start the next read under the lock, so that it can't race with Finish().
+  absl::MutexLock lock(&mutex_);
+  if (closed_ || finished_) {
+    return;
+  }
+  StartRead(&request_buffer_);
+}
+
+void PublisherStreamReactor::OnWriteDone(bool ok) {
+  {
+    absl::MutexLock lock(&mutex_);
+    inflight_reply_.reset();
+    if (!ok) {
+      closed_ = true;
+    }
+    if (closed_) {
+      FinishIfNotFinished();
+      return;
+    }
+  }
+  publisher_->HandleSubscriberStreamWriteDone(subscriber_id_, this);
+}
+
+void PublisherStreamReactor::OnDone() {
+  if (connected_) {
+    publisher_->DisconnectSubscriberStream(subscriber_id_, this);
+  }
+  delete this;
+}
+
+grpc::ServerBidiReactor<grpc::ByteBuffer, grpc::ByteBuffer>
+    *PubsubStreamService::PubsubStream(grpc::CallbackServerContext *context) {
+  return new PublisherStreamReactor(publisher_);
+}
+
+SubscriberStreamClient::SubscriberStreamClient(
+    std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+    std::function<void(const Status &, bool)> done_callback)
+    : reply_callback_(std::move(reply_callback)),
+      done_callback_(std::move(done_callback)) {}
+
+std::shared_ptr<SubscriberStreamClient> SubscriberStreamClient::Start(
+    rpc::SubscriberService::Stub *stub,
+    const rpc::PubsubLongPollingRequest &request,
+    std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+    std::function<void(const Status &, bool)> done_callback,
+    bool wait_for_ready) {
+  std::shared_ptr<SubscriberStreamClient> stream(
+      new SubscriberStreamClient(std::move(reply_callback), std::move(done_callback)));
+  stream->self_ = stream;
+  stream->context_.set_wait_for_ready(wait_for_ready);
+  stub->async()->PubsubStream(&stream->context_, stream.get());
+  // Writes are started from outside of the reactions, so the stream must not be done
+  // until the reads are done, after which no write is started.
+  stream->AddHold();
+  stream->StartRead(&stream->reply_);
+  stream->Ack(request);
+  stream->StartCall();
+  return stream;
+}
+
+void SubscriberStreamClient::Ack(const rpc::PubsubLongPollingRequest &request) {
+  absl::MutexLock lock(&mutex_);
+  if (closed_) {
+    return;
+  }
+  if (write_inflight_) {
+    pending_request_ = request;
+    return;
+  }
+  write_inflight_ = true;
+  inflight_request_ = request;
+  StartWrite(&inflight_request_);
+}
+
+void SubscriberStreamClient::Close() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (closed_) {
+      return;
+    }
+  }
+  context_.TryCancel();
+}
+
+void SubscriberStreamClient::OnReadDone(bool ok) {
+  if (ok) {
+    received_reply_ = true;
+    reply_callback_(reply_);
+    StartRead(&reply_);
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    closed_ = true;
+  }
+  RemoveHold();
+}
+
+void SubscriberStreamClient::OnWriteDone(bool ok) {
+  absl::MutexLock lock(&mutex_);
+  write_inflight_ = false;
+  if (!ok || closed_ || !pending_request_.has_value()) {
+    // If the write failed, the stream is broken, and the read will fail too.
+    return;
+  }
+  write_inflight_ = true;
+  inflight_request_ = std::move(*pending_request_);
+  pending_request_.reset();
+  StartWrite(&inflight_request_);
+}
+
+void SubscriberStreamClient::OnDone(const grpc::Status &status) {
+  if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+    // The publisher doesn't serve streams.
+    done_callback_(Status::NotImplemented(status.error_message()), received_reply_);
+  } else {
+    done_callback_(GrpcStatusToRayStatus(status), received_reply_);
+  }
+  // Release the stream. It's deleted here if the caller has dropped it.
+  auto self = std::move(self_);
+}
+
+}  // namespace pubsub
+
+}  // namespace ray
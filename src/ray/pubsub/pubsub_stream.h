@@ -0,0 +1,173 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <optional>
+
+#include "absl/synchronization/mutex.h"
+#include "ray/pubsub/publisher.h"
+#include "ray/pubsub/subscriber.h"
+#include "src/ray/protobuf/pubsub.grpc.pb.h"
+#include "src/ray/protobuf/pubsub.pb.h"
+
+namespace ray {
+
+namespace pubsub {
+
+/// SubscriberService with the callback API. PubsubStream is a raw method, so that the
+/// publisher can assemble replies from serialized messages shared by all subscribers.
+using SubscriberCallbackService =
+    rpc::SubscriberService::WithCallbackMethod_PubsubLongPolling<
+        rpc::SubscriberService::WithCallbackMethod_PubsubCommandBatch<
+            rpc::SubscriberService::WithRawCallbackMethod_PubsubStream<
+                rpc::SubscriberService::Service>>>;
+
+/// The server side of a PubsubStream RPC. It connects the stream to the publisher
+/// once the first request is received, and deletes itself when the RPC is done.
+class PublisherStreamReactor
+    : public grpc::ServerBidiReactor<grpc::ByteBuffer, grpc::ByteBuffer>,
+      public SubscriberStream {
+ public:
+  explicit PublisherStreamReactor(Publisher *publisher);
+
+  void Write(grpc::ByteBuffer reply) override;
+
+  void Close() override;
+
+ private:
+  void OnReadDone(bool ok) override;
+
+  void OnWriteDone(bool ok) override;
+
+  void OnCancel() override { Close(); }
+
+  void OnDone() override;
+
+  /// Finish the RPC. No-op if it's already finished.
+  void FinishIfNotFinished() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Publisher *const publisher_;
+
+  /// The request being read. Reads are sequential, so it's only accessed by one
+  /// reaction at a time.
+  grpc::ByteBuffer request_buffer_;
+  rpc::PubsubLongPollingRequest request_;
+
+  /// Whether the first request has been received.
+  bool connected_ = false;
+
+  /// The subscriber id from the first request.
+  SubscriberID subscriber_id_;
+
+  absl::Mutex mutex_;
+
+  /// The reply being written, which must be kept alive until the write is done.
+  std::optional<grpc::ByteBuffer> inflight_reply_ ABSL_GUARDED_BY(mutex_);
+
+  /// Whether Close has been called.
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /// Whether Finish has been called.
+  bool finished_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+/// Serves PubsubStream RPCs of SubscriberService for the publisher. The other methods
+/// of the service are not implemented, because long polling is served by the owner of
+/// the publisher through its own service.
+class PubsubStreamService : public SubscriberCallbackService {
+ public:
+  explicit PubsubStreamService(Publisher *publisher) : publisher_(publisher) {}
+
+  grpc::ServerBidiReactor<grpc::ByteBuffer, grpc::ByteBuffer> *PubsubStream(
+      grpc::CallbackServerContext *context) override;
+
+ private:
+  Publisher *const publisher_;
+};
+
+/// The client side of a PubsubStream RPC. It's kept alive until the RPC is done, even
+/// if the caller drops it.
+class SubscriberStreamClient
+    : public grpc::ClientBidiReactor<rpc::PubsubLongPollingRequest,
+                                     rpc::PubsubLongPollingReply>,
+      public SubscriberStreamInterface {
+ public:
+  /// Start the stream.
+  ///
+  /// \param stub The stub of the publisher.
+  /// \param request The first request of the stream.
+  /// \param reply_callback Called with every reply of the stream.
+  /// \param done_callback Called once when the stream is done, with whether any reply
+  /// has been received.
+  /// \param wait_for_ready If true, the stream waits for the publisher to be reachable
+  /// instead of failing right away. Useful when the publisher is restarted, e.g. GCS.
+  static std::shared_ptr<SubscriberStreamClient> Start(
+      rpc::SubscriberService::Stub *stub,
+      const rpc::PubsubLongPollingRequest &request,
+      std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+      std::function<void(const Status &, bool)> done_callback,
+      bool wait_for_ready);
+
+  void Ack(const rpc::PubsubLongPollingRequest &request) override;
+
+  void Close() override;
+
+ private:
+  SubscriberStreamClient(
+      std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+      std::function<void(const Status &, bool)> done_callback);
+
+  void OnReadDone(bool ok) override;
+
+  void OnWriteDone(bool ok) override;
+
+  void OnDone(const grpc::Status &status) override;
+
+  const std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback_;
+
+  const std::function<void(const Status &, bool)> done_callback_;
+
+  grpc::ClientContext context_;
+
+  /// The reply being read. Only accessed by one reaction at a time.
+  rpc::PubsubLongPollingReply reply_;
+
+  /// Whether any reply has been received.
+  bool received_reply_ = false;
+
+  /// Keeps the stream alive until it's done.
+  std::shared_ptr<SubscriberStreamClient> self_;
+
+  absl::Mutex mutex_;
+
+  /// The request being written.
+  rpc::PubsubLongPollingRequest inflight_request_ ABSL_GUARDED_BY(mutex_);
+
+  /// Whether a write is in flight.
+  bool write_inflight_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /// The latest acknowledgement which is waiting for the inflight write.
+  std::optional<rpc::PubsubLongPollingRequest> pending_request_ ABSL_GUARDED_BY(mutex_);
+
+  /// Whether the stream is closed. No write is started after it's closed.
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace pubsub
+
+}  // namespace ray
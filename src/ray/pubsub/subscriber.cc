@@ -14,6 +14,9 @@
 
 #include "ray/pubsub/subscriber.h"
 
+#include "ray/common/asio/asio_util.h"
+#include "ray/common/ray_config.h"
+
 namespace ray {
 
 namespace pubsub {
@@ -228,6 +231,10 @@ std::string SubscriberChannel::DebugString() const {
 
 Subscriber::~Subscriber() {
   // TODO(mwtian): flush Subscriber and ensure there is no leak during destruction.
+  absl::MutexLock lock(&mutex_);
+  for (auto &[publisher_id, timer] : stream_reconnect_timers_) {
+    timer->cancel();
+  }
 }
 
 bool Subscriber::Subscribe(std::unique_ptr<rpc::SubMessage> sub_message,
@@ -276,7 +283,9 @@ bool Subscriber::Unsubscribe(const rpc::ChannelType channel_type,
   commands_[publisher_id].emplace(std::move(command));
   SendCommandBatchIfPossible(publisher_address);
 
-  return Channel(channel_type)->Unsubscribe(publisher_address, key_id);
+  const bool unsubscribed = Channel(channel_type)->Unsubscribe(publisher_address, key_id);
+  CloseStreamIfNotSubscribed(publisher_id);
+  return unsubscribed;
 }
 
 bool Subscriber::UnsubscribeChannel(const rpc::ChannelType channel_type,
@@ -291,7 +300,10 @@ bool Subscriber::UnsubscribeChannel(const rpc::ChannelType channel_type,
   commands_[publisher_id].emplace(std::move(command));
   SendCommandBatchIfPossible(publisher_address);
 
-  return Channel(channel_type)->Unsubscribe(publisher_address, std::nullopt);
+  const bool unsubscribed =
+      Channel(channel_type)->Unsubscribe(publisher_address, std::nullopt);
+  CloseStreamIfNotSubscribed(publisher_id);
+  return unsubscribed;
 }
 
 bool Subscriber::IsSubscribed(const rpc::ChannelType channel_type,
@@ -342,7 +354,126 @@ void Subscriber::MakeLongPollingConnectionIfNotConnected(
   auto publishers_connected_it = publishers_connected_.find(publisher_id);
   if (publishers_connected_it == publishers_connected_.end()) {
     publishers_connected_.emplace(publisher_id);
-    MakeLongPollingPubsubConnection(publisher_address);
+    if (use_streaming_ && !long_polling_fallback_publishers_.contains(publisher_id)) {
+      MakeStreamingPubsubConnection(publisher_address);
+    } else {
+      MakeLongPollingPubsubConnection(publisher_address);
+    }
+  }
+}
+
+void Subscriber::MakeStreamingPubsubConnection(const rpc::Address &publisher_address) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  RAY_LOG(DEBUG) << "Make a pubsub stream to " << publisher_id;
+  auto subscriber_client = get_client_(publisher_address);
+  rpc::PubsubLongPollingRequest request;
+  request.set_subscriber_id(subscriber_id_.Binary());
+  auto &processed_state = processed_sequences_[publisher_id];
+  request.set_publisher_id(processed_state.first.Binary());
+  request.set_max_processed_sequence_id(processed_state.second);
+  // The stream is only accessed under mutex_, and the callbacks check if it's still
+  // the current stream of the publisher.
+  auto stream = std::make_shared<std::weak_ptr<SubscriberStreamInterface>>();
+  streams_[publisher_id] = subscriber_client->PubsubStream(
+      request,
+      [this, publisher_address, publisher_id, stream](
+          const rpc::PubsubLongPollingReply &reply) {
+        absl::MutexLock lock(&mutex_);
+        auto it = streams_.find(publisher_id);
+        if (it == streams_.end() || it->second != stream->lock()) {
+          return;
+        }
+        stream_backoffs_.erase(publisher_id);
+        HandlePublishedMessages(publisher_address, reply);
+        if (!SubscriptionExists(publisher_id)) {
+          it->second->Close();
+          return;
+        }
+        rpc::PubsubLongPollingRequest ack;
+        ack.set_subscriber_id(subscriber_id_.Binary());
+        const auto &processed_state = processed_sequences_[publisher_id];
+        ack.set_publisher_id(processed_state.first.Binary());
+        ack.set_max_processed_sequence_id(processed_state.second);
+        it->second->Ack(ack);
+      },
+      [this, publisher_address, publisher_id, stream](const Status &status,
+                                                      bool received_reply) {
+        absl::MutexLock lock(&mutex_);
+        auto it = streams_.find(publisher_id);
+        if (it == streams_.end() || it->second != stream->lock()) {
+          return;
+        }
+        streams_.erase(it);
+        RAY_LOG(DEBUG) << "Pubsub stream to " << publisher_id
+                       << " is done, status: " << status;
+        if (status.IsNotImplemented()) {
+          RAY_LOG(INFO) << "Publisher " << publisher_id
+                        << " doesn't serve pubsub streams, long polling it instead.";
+          long_polling_fallback_publishers_.insert(publisher_id);
+          stream_backoffs_.erase(publisher_id);
+          if (SubscriptionExists(publisher_id)) {
+            MakeLongPollingPubsubConnection(publisher_address);
+          } else {
+            processed_sequences_.erase(publisher_id);
+            publishers_connected_.erase(publisher_id);
+          }
+          return;
+        }
+        uint64_t delay_ms = 0;
+        if (!received_reply) {
+          if (!status.ok()) {
+            // The publisher is not reachable, so it's considered dead.
+            HandlePublisherFailure(publisher_address, status);
+          }
+          auto backoff_it = stream_backoffs_.find(publisher_id);
+          if (backoff_it == stream_backoffs_.end()) {
+            backoff_it =
+                stream_backoffs_
+                    .emplace(publisher_id,
+                             ExponentialBackOff(
+                                 RayConfig::instance()
+                                     .pubsub_stream_reconnect_initial_backoff_ms(),
+                                 /*multiplier=*/2,
+                                 RayConfig::instance()
+                                     .pubsub_stream_reconnect_max_backoff_ms()))
+                    .first;
+          }
+          delay_ms = backoff_it->second.Next();
+        }
+        ReconnectStreamingPubsub(publisher_address, delay_ms);
+      });
+  *stream = streams_[publisher_id];
+}
+
+void Subscriber::ReconnectStreamingPubsub(const rpc::Address &publisher_address,
+                                          uint64_t delay_ms) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  if (!SubscriptionExists(publisher_id)) {
+    processed_sequences_.erase(publisher_id);
+    publishers_connected_.erase(publisher_id);
+    stream_backoffs_.erase(publisher_id);
+    return;
+  }
+  if (delay_ms == 0 || callback_service_ == nullptr) {
+    MakeStreamingPubsubConnection(publisher_address);
+    return;
+  }
+  RAY_LOG(DEBUG) << "Reconnect the pubsub stream to " << publisher_id << " in "
+                 << delay_ms << " ms";
+  stream_reconnect_timers_[publisher_id] = execute_after(
+      *callback_service_,
+      [this, publisher_address, publisher_id]() {
+        absl::MutexLock lock(&mutex_);
+        stream_reconnect_timers_.erase(publisher_id);
+        ReconnectStreamingPubsub(publisher_address, /*delay_ms=*/0);
+      },
+      std::chrono::milliseconds(delay_ms));
+}
+
+void Subscriber::CloseStreamIfNotSubscribed(const PublisherID &publisher_id) {
+  auto it = streams_.find(publisher_id);
+  if (it != streams_.end() && !SubscriptionExists(publisher_id)) {
+    it->second->Close();
   }
 }
 
@@ -372,61 +503,9 @@ void Subscriber::HandleLongPollingResponse(const rpc::Address &publisher_address
 
   if (!status.ok()) {
     // If status is not okay, we treat that the publisher is dead.
-    RAY_LOG(DEBUG) << "A worker is dead. subscription_failure_callback will be invoked. "
-                      "Publisher id: "
-                   << publisher_id;
-
-    for (const auto &channel_it : channels_) {
-      channel_it.second->HandlePublisherFailure(publisher_address, status);
-    }
-    // Empty the command queue because we cannot send commands anymore.
-    commands_.erase(publisher_id);
+    HandlePublisherFailure(publisher_address, status);
   } else {
-    RAY_CHECK(!reply.publisher_id().empty()) << "publisher_id is empty.";
-    auto reply_publisher_id = PublisherID::FromBinary(reply.publisher_id());
-    if (reply_publisher_id != processed_sequences_[publisher_id].first) {
-      if (processed_sequences_[publisher_id].first != kDefaultPublisherID) {
-        RAY_LOG(INFO) << "Received publisher_id " << reply_publisher_id.Hex()
-                      << " is different from last seen publisher_id "
-                      << processed_sequences_[publisher_id].first
-                      << ", this can only happen when gcs failsover.";
-      }
-      // reset publisher_id and processed_sequence
-      // if the publisher_id changes.
-      processed_sequences_[publisher_id].first = reply_publisher_id;
-      processed_sequences_[publisher_id].second = 0;
-    }
-
-    for (int i = 0; i < reply.pub_messages_size(); i++) {
-      const auto &msg = reply.pub_messages(i);
-      const auto channel_type = msg.channel_type();
-      const auto &key_id = msg.key_id();
-      RAY_CHECK_GT(msg.sequence_id(), 0)
-          << "message's sequence_id is invalid " << msg.sequence_id();
-
-      if (msg.sequence_id() <= processed_sequences_[publisher_id].second) {
-        RAY_LOG_EVERY_MS(WARNING, 10000)
-            << "Received message out of order, publisher_id: "
-            << processed_sequences_[publisher_id].first
-            << ", received message sequence_id "
-            << processed_sequences_[publisher_id].second
-            << ", received message sequence_id " << msg.sequence_id();
-        continue;
-      }
-      processed_sequences_[publisher_id].second = msg.sequence_id();
-      // If the published message is a failure message, the publisher indicates
-      // this key id is failed. Invoke the failure callback. At this time, we should not
-      // unsubscribe the publisher because there are other entries that subscribe from the
-      // publisher.
-      if (msg.has_failure_message()) {
-        RAY_LOG(DEBUG) << "Failure message has published from a channel " << channel_type;
-        Channel(channel_type)->HandlePublisherFailure(publisher_address, key_id);
-        continue;
-      }
-
-      // Otherwise, invoke the subscription callback.
-      Channel(channel_type)->HandlePublishedMessage(publisher_address, msg);
-    }
+    HandlePublishedMessages(publisher_address, reply);
   }
 
   if (SubscriptionExists(publisher_id)) {
@@ -437,6 +516,70 @@ void Subscriber::HandleLongPollingResponse(const rpc::Address &publisher_address
   }
 }
 
+void Subscriber::HandlePublisherFailure(const rpc::Address &publisher_address,
+                                        const Status &status) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  RAY_LOG(DEBUG) << "A worker is dead. subscription_failure_callback will be invoked. "
+                    "Publisher id: "
+                 << publisher_id;
+
+  for (const auto &channel_it : channels_) {
+    channel_it.second->HandlePublisherFailure(publisher_address, status);
+  }
+  // Empty the command queue because we cannot send commands anymore.
+  commands_.erase(publisher_id);
+}
+
+void Subscriber::HandlePublishedMessages(const rpc::Address &publisher_address,
+                                         const rpc::PubsubLongPollingReply &reply) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  RAY_CHECK(!reply.publisher_id().empty()) << "publisher_id is empty.";
+  auto reply_publisher_id = PublisherID::FromBinary(reply.publisher_id());
+  if (reply_publisher_id != processed_sequences_[publisher_id].first) {
+    if (processed_sequences_[publisher_id].first != kDefaultPublisherID) {
+      RAY_LOG(INFO) << "Received publisher_id " << reply_publisher_id.Hex()
+                    << " is different from last seen publisher_id "
+                    << processed_sequences_[publisher_id].first
+                    << ", this can only happen when gcs failsover.";
+    }
+    // reset publisher_id and processed_sequence
+    // if the publisher_id changes.
+    processed_sequences_[publisher_id].first = reply_publisher_id;
+    processed_sequences_[publisher_id].second = 0;
+  }
+
+  for (int i = 0; i < reply.pub_messages_size(); i++) {
+    const auto &msg = reply.pub_messages(i);
+    const auto channel_type = msg.channel_type();
+    const auto &key_id = msg.key_id();
+    RAY_CHECK_GT(msg.sequence_id(), 0)
+        << "message's sequence_id is invalid " << msg.sequence_id();
+
+    if (msg.sequence_id() <= processed_sequences_[publisher_id].second) {
+      RAY_LOG_EVERY_MS(WARNING, 10000)
+          << "Received message out of order, publisher_id: "
+          << processed_sequences_[publisher_id].first
+          << ", received message sequence_id "
+          << processed_sequences_[publisher_id].second
+          << ", received message sequence_id " << msg.sequence_id();
+      continue;
+    }
+    processed_sequences_[publisher_id].second = msg.sequence_id();
+    // If the published message is a failure message, the publisher indicates
+    // this key id is failed. Invoke the failure callback. At this time, we should not
+    // unsubscribe the publisher because there are other entries that subscribe from the
+    // publisher.
+    if (msg.has_failure_message()) {
+      RAY_LOG(DEBUG) << "Failure message has published from a channel " << channel_type;
+      Channel(channel_type)->HandlePublisherFailure(publisher_address, key_id);
+      continue;
+    }
+
+    // Otherwise, invoke the subscription callback.
+    Channel(channel_type)->HandlePublishedMessage(publisher_address, msg);
+  }
+}
+
 void Subscriber::SendCommandBatchIfPossible(const rpc::Address &publisher_address) {
   const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
   auto command_batch_sent_it = command_batch_sent_.find(publisher_id);
@@ -512,7 +655,7 @@ bool Subscriber::CheckNoLeaks() const {
     }
   }
   return !leaks && publishers_connected_.empty() && command_batch_sent_.empty() &&
-         commands_.empty() && processed_sequences_.empty();
+         commands_.empty() && processed_sequences_.empty() && streams_.empty();
 }
 
 std::string Subscriber::DebugString() const {
@@ -18,6 +18,7 @@
 #include <gtest/gtest_prod.h>
 
 #include <boost/any.hpp>
+#include <boost/asio/deadline_timer.hpp>
 #include <queue>
 
 #include "absl/container/flat_hash_map.h"
@@ -25,6 +26,8 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/id.h"
 #include "ray/rpc/client_call.h"
+#include "ray/util/logging.h"
+#include "ray/util/util.h"
 #include "src/ray/protobuf/common.pb.h"
 #include "src/ray/protobuf/pubsub.pb.h"
 
@@ -296,6 +299,19 @@ class SubscriberInterface {
   virtual ~SubscriberInterface() {}
 };
 
+/// The client side of a PubsubStream RPC. Thread safe.
+class SubscriberStreamInterface {
+ public:
+  virtual ~SubscriberStreamInterface() = default;
+
+  /// Acknowledge the processed messages to the publisher. Only the latest request is
+  /// sent if the previous one is still in flight.
+  virtual void Ack(const rpc::PubsubLongPollingRequest &request) = 0;
+
+  /// Cancel the stream. The done callback is still called.
+  virtual void Close() = 0;
+};
+
 /// The grpc client that the subscriber needs.
 class SubscriberClientInterface {
  public:
@@ -309,6 +325,23 @@ class SubscriberClientInterface {
       const rpc::PubsubCommandBatchRequest &request,
       const rpc::ClientCallback<rpc::PubsubCommandBatchReply> &callback) = 0;
 
+  /// Start a stream to receive published messages, instead of long polling. Only
+  /// clients of the subscribers which use streaming need to implement it.
+  ///
+  /// \param request The first request of the stream.
+  /// \param reply_callback Called with every reply of the stream, one at a time.
+  /// \param done_callback Called once when the stream is done. The bool is whether any
+  /// reply has been received. The status is NotImplemented if the publisher doesn't
+  /// serve streams.
+  /// \return The stream.
+  virtual std::shared_ptr<SubscriberStreamInterface> PubsubStream(
+      const rpc::PubsubLongPollingRequest &request,
+      std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+      std::function<void(const Status &, bool)> done_callback) {
+    RAY_LOG(FATAL) << "The subscriber client doesn't support streaming.";
+    return nullptr;
+  }
+
   virtual ~SubscriberClientInterface() = default;
 };
 
@@ -320,6 +353,12 @@ class SubscriberClientInterface {
 /// - Subscriber always try making reconnection as long as there are subscribed entries.
 /// - If long polling request is failed (if non-OK status is returned from the RPC),
 /// consider the publisher is dead.
+/// - If the subscriber uses streaming, it keeps a PubsubStream open instead of long
+/// polling, and acknowledges every reply on the stream. The publisher is considered
+/// dead if a stream fails before the first reply. Otherwise, the subscriber connects
+/// again when the stream breaks, with an exponential backoff while the streams fail
+/// before any reply. If the publisher doesn't serve streams, e.g. an older version,
+/// the subscriber falls back to long polling for it.
 ///
 /// How to extend new channels.
 ///
@@ -334,10 +373,13 @@ class Subscriber : public SubscriberInterface {
       const int64_t max_command_batch_size,
       std::function<std::shared_ptr<SubscriberClientInterface>(const rpc::Address &)>
           get_client,
-      instrumented_io_context *callback_service)
+      instrumented_io_context *callback_service,
+      bool use_streaming = false)
       : subscriber_id_(subscriber_id),
         max_command_batch_size_(max_command_batch_size),
-        get_client_(get_client) {
+        get_client_(get_client),
+        callback_service_(callback_service),
+        use_streaming_(use_streaming) {
     for (auto type : channels) {
       channels_.emplace(type,
                         std::make_unique<SubscriberChannel>(type, callback_service));
@@ -373,6 +415,12 @@ class Subscriber : public SubscriberInterface {
                     const rpc::Address &publisher_address,
                     const std::string &key_id) const override;
 
+  /// Return whether the subscriber is created with the channel.
+  bool HasChannel(const rpc::ChannelType channel_type) const {
+    absl::MutexLock lock(&mutex_);
+    return channels_.contains(channel_type);
+  }
+
   /// Return the Channel of the given channel type. Subscriber keeps ownership.
   SubscriberChannel *Channel(const rpc::ChannelType channel_type) const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
@@ -435,11 +483,37 @@ class Subscriber : public SubscriberInterface {
                                  const rpc::PubsubLongPollingReply &reply)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Process the published messages of a long polling or stream reply.
+  void HandlePublishedMessages(const rpc::Address &publisher_address,
+                               const rpc::PubsubLongPollingReply &reply)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Invoke the failure callbacks of all subscriptions to the dead publisher.
+  void HandlePublisherFailure(const rpc::Address &publisher_address,
+                              const Status &status) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Make a long polling connection if it never made the one with this publisher for
   /// pubsub operations.
   void MakeLongPollingConnectionIfNotConnected(const rpc::Address &publisher_address)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Start a stream to the publisher, which is used instead of long polling if
+  /// use_streaming_ is set.
+  void MakeStreamingPubsubConnection(const rpc::Address &publisher_address)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Close the stream to the publisher if there's no subscription to it anymore.
+  void CloseStreamIfNotSubscribed(const PublisherID &publisher_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Connect to the publisher again after its stream is done, or forget it if there's
+  /// no subscription to it anymore.
+  ///
+  /// \param publisher_address The publisher.
+  /// \param delay_ms The time to wait before connecting.
+  void ReconnectStreamingPubsub(const rpc::Address &publisher_address, uint64_t delay_ms)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Send a command batch to the publisher. To ensure the FIFO order with unary GRPC
   /// requests (which don't guarantee ordering), the subscriber module only allows to have
   /// 1-flight GRPC request per the publisher. Since we batch all commands into a single
@@ -468,6 +542,12 @@ class Subscriber : public SubscriberInterface {
   const std::function<std::shared_ptr<SubscriberClientInterface>(const rpc::Address &)>
       get_client_;
 
+  /// Runs the subscription callbacks, and the delayed stream reconnections.
+  instrumented_io_context *const callback_service_;
+
+  /// Whether to receive published messages with a stream instead of long polling.
+  const bool use_streaming_;
+
   /// Protects below fields. Since the coordinator runs in a core worker, it should be
   /// thread safe.
   mutable absl::Mutex mutex_;
@@ -483,9 +563,26 @@ class Subscriber : public SubscriberInterface {
   absl::flat_hash_map<PublisherID, CommandQueue> commands_ ABSL_GUARDED_BY(mutex_);
 
   /// A set to cache the connected publisher ids. "Connected" means the long polling
-  /// request is in flight.
+  /// request or the stream is in flight.
   absl::flat_hash_set<PublisherID> publishers_connected_ ABSL_GUARDED_BY(mutex_);
 
+  /// The open streams to publishers, if use_streaming_ is set.
+  absl::flat_hash_map<PublisherID, std::shared_ptr<SubscriberStreamInterface>> streams_
+      ABSL_GUARDED_BY(mutex_);
+
+  /// The backoff of the streams to publishers which fail before any reply. Reset when a
+  /// stream receives a reply.
+  absl::flat_hash_map<PublisherID, ExponentialBackOff> stream_backoffs_
+      ABSL_GUARDED_BY(mutex_);
+
+  /// The timers of the delayed stream reconnections.
+  absl::flat_hash_map<PublisherID, std::shared_ptr<boost::asio::deadline_timer>>
+      stream_reconnect_timers_ ABSL_GUARDED_BY(mutex_);
+
+  /// The publishers which don't serve streams, and are long polled instead.
+  absl::flat_hash_set<PublisherID> long_polling_fallback_publishers_
+      ABSL_GUARDED_BY(mutex_);
+
   /// A set to keep track of in-flight command batch requests
   absl::flat_hash_set<PublisherID> command_batch_sent_ ABSL_GUARDED_BY(mutex_);
 
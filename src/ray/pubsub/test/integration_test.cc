@@ -12,11 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <ctime>
 #include <memory>
 #include <string>
 
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -25,6 +28,7 @@
 #include "ray/common/asio/periodical_runner.h"
 #include "ray/common/grpc_util.h"
 #include "ray/pubsub/publisher.h"
+#include "ray/pubsub/pubsub_stream.h"
 #include "ray/pubsub/subscriber.h"
 #include "src/ray/protobuf/pubsub.grpc.pb.h"
 #include "src/ray/protobuf/pubsub.pb.h"
@@ -33,7 +37,7 @@ namespace ray {
 namespace pubsub {
 
 // Implements SubscriberService for handling subscriber polling.
-class SubscriberServiceImpl final : public rpc::SubscriberService::CallbackService {
+class SubscriberServiceImpl final : public SubscriberCallbackService {
  public:
   explicit SubscriberServiceImpl(std::unique_ptr<Publisher> publisher)
       : publisher_(std::move(publisher)) {}
@@ -86,6 +90,11 @@ class SubscriberServiceImpl final : public rpc::SubscriberService::CallbackServi
     return reactor;
   }
 
+  grpc::ServerBidiReactor<grpc::ByteBuffer, grpc::ByteBuffer> *PubsubStream(
+      grpc::CallbackServerContext *context) override {
+    return new PublisherStreamReactor(publisher_.get());
+  }
+
   Publisher &GetPublisher() { return *publisher_; }
 
  private:
@@ -128,6 +137,17 @@ class CallbackSubscriberClient final : public pubsub::SubscriberClientInterface
         });
   }
 
+  std::shared_ptr<SubscriberStreamInterface> PubsubStream(
+      const rpc::PubsubLongPollingRequest &request,
+      std::function<void(const rpc::PubsubLongPollingReply &)> reply_callback,
+      std::function<void(const Status &, bool)> done_callback) final {
+    return SubscriberStreamClient::Start(stub_.get(),
+                                         request,
+                                         std::move(reply_callback),
+                                         std::move(done_callback),
+                                         /*wait_for_ready=*/false);
+  }
+
  private:
   std::unique_ptr<rpc::SubscriberService::Stub> stub_;
 };
@@ -181,7 +201,7 @@ class IntegrationTest : public ::testing::Test {
 
   void RestartServer() { SetupServer(); }
 
-  std::unique_ptr<Subscriber> CreateSubscriber() {
+  std::unique_ptr<Subscriber> CreateSubscriber(bool use_streaming = false) {
     return std::make_unique<Subscriber>(
         UniqueID::FromRandom(),
         /*channels=*/
@@ -194,7 +214,30 @@ class IntegrationTest : public ::testing::Test {
           return std::make_shared<CallbackSubscriberClient>(
               absl::StrCat(address.ip_address(), ":", address.port()));
         },
-        io_service_.Get());
+        io_service_.Get(),
+        use_streaming);
+  }
+
+  void PublishActor(const std::string &actor_id, const std::string &name) {
+    rpc::PubMessage msg;
+    msg.set_channel_type(rpc::ChannelType::GCS_ACTOR_CHANNEL);
+    msg.set_key_id(actor_id);
+    msg.mutable_actor_message()->set_actor_id(actor_id);
+    msg.mutable_actor_message()->set_name(name);
+    subscriber_service_->GetPublisher().Publish(msg);
+  }
+
+  void WaitForNoLeaks(const std::vector<Subscriber *> &subscribers) {
+    int wait_count = 0;
+    while (!std::all_of(subscribers.begin(), subscribers.end(), [](auto *subscriber) {
+      return subscriber->CheckNoLeaks();
+    })) {
+      // Flush all the inflight long polling.
+      subscriber_service_->GetPublisher().UnregisterAll();
+      ASSERT_LT(wait_count, 60) << "Subscribers still have inflight operations after 60s";
+      ++wait_count;
+      absl::SleepFor(absl::Seconds(1));
+    }
   }
 
   std::string address_;
@@ -292,13 +335,114 @@ TEST_F(IntegrationTest, SubscribersToOneIDAndAllIDs) {
   // Waiting here is necessary to avoid invalid memory access during shutdown.
   // TODO(mwtian): cancel inflight polls during subscriber shutdown, and remove the
   // logic below.
-  int wait_count = 0;
-  while (!(subscriber_1->CheckNoLeaks() && subscriber_2->CheckNoLeaks())) {
-    // Flush all the inflight long polling.
-    subscriber_service_->GetPublisher().UnregisterAll();
-    ASSERT_LT(wait_count, 60) << "Subscribers still have inflight operations after 60s";
-    ++wait_count;
-    absl::SleepFor(absl::Seconds(1));
+  WaitForNoLeaks({subscriber_1.get(), subscriber_2.get()});
+}
+
+TEST_F(IntegrationTest, StreamingSubscriber) {
+  const std::string subscribed_actor =
+      ActorID::Of(JobID::FromInt(1), TaskID::Nil(), 1).Binary();
+  const int kNumMessages = 1000;
+  absl::Notification subscribed;
+  absl::Mutex mu;
+  std::vector<std::string> names;
+
+  auto subscriber = CreateSubscriber(/*use_streaming=*/true);
+  subscriber->Subscribe(
+      std::make_unique<rpc::SubMessage>(),
+      rpc::ChannelType::GCS_ACTOR_CHANNEL,
+      address_proto_,
+      subscribed_actor,
+      /*subscribe_done_callback=*/
+      [&subscribed](Status status) {
+        RAY_CHECK_OK(status);
+        subscribed.Notify();
+      },
+      /*subscribe_item_callback=*/
+      [&mu, &names](const rpc::PubMessage &msg) {
+        absl::MutexLock lock(&mu);
+        names.push_back(msg.actor_message().name());
+      },
+      /*subscription_failure_callback=*/
+      [](const std::string &, const Status &status) { RAY_CHECK_OK(status); });
+  subscribed.WaitForNotification();
+
+  // More messages than the publish batch size, so they are sent in multiple replies
+  // over the same stream.
+  for (int i = 0; i < kNumMessages; i++) {
+    PublishActor(subscribed_actor, std::to_string(i));
+  }
+
+  {
+    absl::MutexLock lock(&mu);
+    auto received_all = [&mu, &names]() {
+      mu.AssertReaderHeld();  // For annotalysis.
+      return names.size() == static_cast<size_t>(kNumMessages);
+    };
+    ASSERT_TRUE(mu.AwaitWithTimeout(absl::Condition(&received_all), absl::Seconds(10)))
+        << "Received " << names.size() << " messages.";
+    for (int i = 0; i < kNumMessages; i++) {
+      ASSERT_EQ(names[i], std::to_string(i));
+    }
+  }
+
+  // Unsubscribing closes the stream.
+  subscriber->Unsubscribe(
+      rpc::ChannelType::GCS_ACTOR_CHANNEL, address_proto_, subscribed_actor);
+  WaitForNoLeaks({subscriber.get()});
+}
+
+// Compares the latency and the CPU time of long polling and streaming, by publishing
+// messages one at a time and waiting for each of them to be received. It's not run by
+// default. Run it with
+//   bazel run -c opt //:pubsub_integration_test -- \
+//     --gtest_also_run_disabled_tests --gtest_filter=*LongPollingVsStreaming*
+TEST_F(IntegrationTest, DISABLED_LongPollingVsStreaming) {
+  const std::string subscribed_actor =
+      ActorID::Of(JobID::FromInt(1), TaskID::Nil(), 1).Binary();
+  const int kNumMessages = 10000;
+  for (bool use_streaming : {false, true}) {
+    absl::Notification subscribed;
+    absl::Mutex mu;
+    int num_received = 0;
+    auto subscriber = CreateSubscriber(use_streaming);
+    subscriber->Subscribe(
+        std::make_unique<rpc::SubMessage>(),
+        rpc::ChannelType::GCS_ACTOR_CHANNEL,
+        address_proto_,
+        subscribed_actor,
+        /*subscribe_done_callback=*/
+        [&subscribed](Status status) { subscribed.Notify(); },
+        /*subscribe_item_callback=*/
+        [&mu, &num_received](const rpc::PubMessage &msg) {
+          absl::MutexLock lock(&mu);
+          num_received++;
+        },
+        /*subscription_failure_callback=*/
+        [](const std::string &, const Status &status) { RAY_CHECK_OK(status); });
+    subscribed.WaitForNotification();
+
+    const auto start = absl::Now();
+    const auto cpu_start = std::clock();
+    for (int i = 0; i < kNumMessages; i++) {
+      PublishActor(subscribed_actor, std::to_string(i));
+      absl::MutexLock lock(&mu);
+      auto received = [&mu, &num_received, i]() {
+        mu.AssertReaderHeld();  // For annotalysis.
+        return num_received == i + 1;
+      };
+      mu.Await(absl::Condition(&received));
+    }
+    const auto elapsed = absl::Now() - start;
+    const double cpu_seconds =
+        static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    std::cout << (use_streaming ? "streaming" : "long polling") << ": "
+              << absl::ToDoubleMicroseconds(elapsed) / kNumMessages
+              << " us per message, " << cpu_seconds * 1e6 / kNumMessages
+              << " us of CPU time per message" << std::endl;
+
+    subscriber->Unsubscribe(
+        rpc::ChannelType::GCS_ACTOR_CHANNEL, address_proto_, subscribed_actor);
+    WaitForNoLeaks({subscriber.get()});
   }
 }
 }  // namespace pubsub
@@ -0,0 +1,201 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the publisher:
+//  - BM_PublishFromThreads measures the throughput of many threads publishing to
+//    their own keys, with the shards and fanout threads of the publisher as
+//    arguments, while the subscribers keep long polling.
+//  - BM_PublishToSubscribers times a single message from Publish to the long poll
+//    replies of all the subscribers of its key and their acknowledgements, e.g. the
+//    workers borrowing an object whose owner publishes its eviction.
+
+#include <atomic>
+#include <thread>
+
+#include "absl/time/clock.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/asio/periodical_runner.h"
+#include "ray/common/benchmark_util.h"
+#include "ray/pubsub/publisher.h"
+
+namespace ray {
+
+namespace pubsub {
+
+namespace {
+
+using benchmark::State;
+
+constexpr int kNumSubscribers = 1000;
+constexpr int kNumKeysPerSubscriber = 10;
+constexpr int kNumKeys = kNumSubscribers * kNumKeysPerSubscriber;
+constexpr int kNumPublishThreads = 4;
+
+/// Publish a message to every key from several threads per iteration. The arguments
+/// are the number of shards and fanout threads of the publisher.
+void BM_PublishFromThreads(State &state) {
+  const auto num_shards = static_cast<size_t>(state.range(0));
+  const auto num_fanout_threads = static_cast<size_t>(state.range(1));
+  instrumented_io_context io_service;
+  PeriodicalRunner periodical_runner(io_service);
+  const auto publisher_id = NodeID::FromRandom();
+  Publisher publisher(
+      /*channels=*/{rpc::ChannelType::WORKER_OBJECT_EVICTION},
+      /*periodical_runner=*/&periodical_runner,
+      /*get_time_ms=*/[]() { return absl::GetCurrentTimeNanos() / 1e6; },
+      /*subscriber_timeout_ms=*/300 * 1000,
+      /*publish_batch_size=*/5000,
+      publisher_id,
+      num_shards,
+      num_fanout_threads);
+
+  // Every subscriber subscribes to its own keys.
+  std::vector<SubscriberID> subscriber_ids;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumSubscribers; i++) {
+    subscriber_ids.push_back(SubscriberID::FromRandom());
+    for (int j = 0; j < kNumKeysPerSubscriber; j++) {
+      keys.push_back(ObjectID::FromRandom().Binary());
+      publisher.RegisterSubscription(
+          rpc::ChannelType::WORKER_OBJECT_EVICTION, subscriber_ids.back(), keys.back());
+    }
+  }
+
+  // Subscribers keep polling and acknowledging the received messages. Replies are
+  // handled in the reply callbacks, which run under the lock of the subscriber state.
+  std::vector<rpc::PubsubLongPollingReply> replies(kNumSubscribers);
+  std::vector<std::atomic<int64_t>> max_processed_sequence_ids(kNumSubscribers);
+  std::atomic<bool> stopped = false;
+  std::thread poller([&]() {
+    while (!stopped) {
+      for (int i = 0; i < kNumSubscribers; i++) {
+        rpc::PubsubLongPollingRequest request;
+        request.set_subscriber_id(subscriber_ids[i].Binary());
+        request.set_publisher_id(publisher_id.Binary());
+        request.set_max_processed_sequence_id(max_processed_sequence_ids[i]);
+        publisher.ConnectToSubscriber(
+            request,
+            &replies[i],
+            [&, i](Status, std::function<void()>, std::function<void()>) {
+              for (const auto &msg : replies[i].pub_messages()) {
+                max_processed_sequence_ids[i] = msg.sequence_id();
+              }
+              replies[i].Clear();
+            });
+      }
+    }
+  });
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> publish_threads;
+    for (int t = 0; t < kNumPublishThreads; t++) {
+      publish_threads.emplace_back([&, t]() {
+        for (int i = t; i < kNumKeys; i += kNumPublishThreads) {
+          rpc::PubMessage pub_message;
+          pub_message.set_channel_type(rpc::ChannelType::WORKER_OBJECT_EVICTION);
+          pub_message.set_key_id(keys[i]);
+          pub_message.mutable_worker_object_eviction_message()->set_object_id(keys[i]);
+          publisher.Publish(std::move(pub_message));
+        }
+      });
+    }
+    for (auto &thread : publish_threads) {
+      thread.join();
+    }
+    publisher.Flush();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumKeys);
+  stopped = true;
+  poller.join();
+  // Flush the inflight polls before the replies are destroyed.
+  publisher.UnregisterAll();
+}
+RAY_BENCHMARK(BM_PublishFromThreads)
+    ->Args({1, 0})
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->Args({16, 4});
+
+/// Publish to the given number of subscribers of a key, which keep long polling.
+void BM_PublishToSubscribers(State &state) {
+  const int64_t num_subscribers = state.range();
+  instrumented_io_context io_service;
+  PeriodicalRunner periodical_runner(io_service);
+  const auto publisher_id = NodeID::FromRandom();
+  Publisher publisher(
+      /*channels=*/{rpc::ChannelType::WORKER_OBJECT_EVICTION},
+      /*periodical_runner=*/&periodical_runner,
+      /*get_time_ms=*/[]() { return absl::GetCurrentTimeNanos() / 1e6; },
+      /*subscriber_timeout_ms=*/300 * 1000,
+      /*publish_batch_size=*/5000,
+      publisher_id);
+
+  const auto key = ObjectID::FromRandom().Binary();
+  std::vector<SubscriberID> subscriber_ids;
+  for (int64_t i = 0; i < num_subscribers; i++) {
+    subscriber_ids.push_back(SubscriberID::FromRandom());
+    publisher.RegisterSubscription(
+        rpc::ChannelType::WORKER_OBJECT_EVICTION, subscriber_ids.back(), key);
+  }
+
+  // The message is sent in the reply of the pending poll of every subscriber, which
+  // then polls again to acknowledge it.
+  std::vector<rpc::PubsubLongPollingReply> replies(num_subscribers);
+  std::vector<int64_t> max_processed_sequence_ids(num_subscribers);
+  std::vector<int64_t> num_received(num_subscribers);
+  auto poll = [&](int64_t i) {
+    rpc::PubsubLongPollingRequest request;
+    request.set_subscriber_id(subscriber_ids[i].Binary());
+    request.set_publisher_id(publisher_id.Binary());
+    request.set_max_processed_sequence_id(max_processed_sequence_ids[i]);
+    publisher.ConnectToSubscriber(
+        request,
+        &replies[i],
+        [&replies, &max_processed_sequence_ids, &num_received, i](
+            Status, std::function<void()>, std::function<void()>) {
+          for (const auto &message : replies[i].pub_messages()) {
+            max_processed_sequence_ids[i] = message.sequence_id();
+            num_received[i]++;
+          }
+          replies[i].Clear();
+        });
+  };
+  for (int64_t i = 0; i < num_subscribers; i++) {
+    poll(i);
+  }
+
+  rpc::PubMessage pub_message;
+  pub_message.set_channel_type(rpc::ChannelType::WORKER_OBJECT_EVICTION);
+  pub_message.set_key_id(key);
+  pub_message.mutable_worker_object_eviction_message()->set_object_id(key);
+  while (state.KeepRunning()) {
+    publisher.Publish(pub_message);
+    for (int64_t i = 0; i < num_subscribers; i++) {
+      poll(i);
+    }
+  }
+  for (const auto received : num_received) {
+    RAY_CHECK_EQ(received, state.iterations());
+  }
+  state.SetItemsProcessed(state.iterations() * num_subscribers);
+  // Flush the inflight polls before the replies are destroyed.
+  publisher.UnregisterAll();
+}
+RAY_BENCHMARK(BM_PublishToSubscribers)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace
+
+}  // namespace pubsub
+
+}  // namespace ray
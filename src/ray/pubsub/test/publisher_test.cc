@@ -19,6 +19,7 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/asio/periodical_runner.h"
 #include "ray/common/ray_config.h"
+#include "src/ray/protobuf/pubsub.grpc.pb.h"
 
 namespace ray {
 
@@ -361,7 +362,7 @@ TEST_F(PublisherTest, TestSubscriber) {
   // Make sure publishing one object works as expected.
   auto oid = ObjectID::FromRandom();
   subscriber->QueueMessage(
-      std::make_shared<rpc::PubMessage>(GeneratePubMessage(oid, GetNextSequenceId())),
+      std::make_shared<SharedPubMessage>(GeneratePubMessage(oid, GetNextSequenceId())),
       /*try_publish=*/false);
   published_objects.emplace(oid);
   ASSERT_TRUE(subscriber->PublishIfPossible());
@@ -373,7 +374,7 @@ TEST_F(PublisherTest, TestSubscriber) {
   for (int i = 0; i < 3; i++) {
     oid = ObjectID::FromRandom();
     subscriber->QueueMessage(
-        std::make_shared<rpc::PubMessage>(GeneratePubMessage(oid, GetNextSequenceId())),
+        std::make_shared<SharedPubMessage>(GeneratePubMessage(oid, GetNextSequenceId())),
         /*try_publish=*/false);
     published_objects.emplace(oid);
   }
@@ -436,7 +437,7 @@ TEST_F(PublisherTest, TestSubscriberBatchSize) {
     auto oid = ObjectID::FromRandom();
     oids.push_back(oid);
     subscriber->QueueMessage(
-        std::make_shared<rpc::PubMessage>(GeneratePubMessage(oid, GetNextSequenceId())),
+        std::make_shared<SharedPubMessage>(GeneratePubMessage(oid, GetNextSequenceId())),
         /*try_publish=*/false);
     published_objects.emplace(oid);
   }
@@ -511,7 +512,7 @@ TEST_F(PublisherTest, TestSubscriberActiveTimeout) {
   // A message is published, so the connection is refreshed.
   auto oid = ObjectID::FromRandom();
   subscriber->QueueMessage(
-      std::make_shared<rpc::PubMessage>(GeneratePubMessage(oid, GetNextSequenceId())));
+      std::make_shared<SharedPubMessage>(GeneratePubMessage(oid, GetNextSequenceId())));
   ASSERT_TRUE(subscriber->IsActive());
   ASSERT_FALSE(subscriber->ConnectionExists());
   ASSERT_EQ(reply_cnt, 2);
@@ -1078,6 +1079,162 @@ TEST_F(PublisherTest, TestPublishFailure) {
   ASSERT_EQ(failed_ids[0], oid);
 }
 
+TEST_F(PublisherTest, TestShardedPublisherWithFanoutThreads) {
+  // Messages are queued from multiple threads, but every subscriber should still receive
+  // them with increasing sequence ids, and messages of a key in order.
+  Publisher publisher(
+      /*channels=*/{rpc::ChannelType::WORKER_OBJECT_EVICTION},
+      /*periodic_runner=*/periodic_runner_.get(),
+      /*get_time_ms=*/[this]() { return current_time_; },
+      /*subscriber_timeout_ms=*/subscriber_timeout_ms_,
+      /*batch_size*/ 1000,
+      kDefaultPublisherId,
+      /*num_shards=*/4,
+      /*num_fanout_threads=*/4);
+
+  std::vector<ObjectID> oids;
+  for (int i = 0; i < 10; i++) {
+    oids.push_back(ObjectID::FromRandom());
+  }
+  const auto all_subscriber_id = SubscriberID::FromRandom();
+  publisher.RegisterSubscription(
+      rpc::ChannelType::WORKER_OBJECT_EVICTION, all_subscriber_id, std::nullopt);
+  for (const auto &oid : oids) {
+    publisher.RegisterSubscription(
+        rpc::ChannelType::WORKER_OBJECT_EVICTION, subscriber_id_, oid.Binary());
+  }
+
+  const int num_rounds = 100;
+  for (int round = 0; round < num_rounds; round++) {
+    for (const auto &oid : oids) {
+      publisher.Publish(GeneratePubMessage(oid));
+    }
+  }
+  publisher.Flush();
+
+  for (const auto &subscriber_id : {subscriber_id_, all_subscriber_id}) {
+    rpc::PubsubLongPollingRequest request;
+    request.set_subscriber_id(subscriber_id.Binary());
+    request.set_publisher_id(kDefaultPublisherId.Binary());
+    rpc::PubsubLongPollingReply reply;
+    publisher.ConnectToSubscriber(
+        request, &reply, [](Status, std::function<void()>, std::function<void()>) {});
+
+    ASSERT_EQ(reply.pub_messages_size(), num_rounds * static_cast<int>(oids.size()));
+    int64_t prev_sequence_id = 0;
+    absl::flat_hash_map<ObjectID, int> num_received;
+    for (const auto &msg : reply.pub_messages()) {
+      ASSERT_GT(msg.sequence_id(), prev_sequence_id);
+      prev_sequence_id = msg.sequence_id();
+      num_received[ObjectID::FromBinary(msg.key_id())]++;
+    }
+    for (const auto &oid : oids) {
+      ASSERT_EQ(num_received[oid], num_rounds);
+    }
+  }
+
+  // Subscriptions to all keys are removed from every shard.
+  ASSERT_EQ(publisher.UnregisterSubscriber(all_subscriber_id), 1);
+  ASSERT_EQ(publisher.UnregisterSubscriber(subscriber_id_), 1);
+  ASSERT_TRUE(publisher.CheckNoLeaks());
+}
+
+TEST_F(PublisherTest, TestUnregisterAfterPublishWithFanoutThreads) {
+  // Messages published before a subscription is unregistered are still queued to the
+  // subscriber, even though the fanout threads queue them after Publish returns.
+  Publisher publisher(
+      /*channels=*/{rpc::ChannelType::WORKER_OBJECT_EVICTION},
+      /*periodic_runner=*/periodic_runner_.get(),
+      /*get_time_ms=*/[this]() { return current_time_; },
+      /*subscriber_timeout_ms=*/subscriber_timeout_ms_,
+      /*batch_size*/ 1000,
+      kDefaultPublisherId,
+      /*num_shards=*/4,
+      /*num_fanout_threads=*/4);
+
+  std::vector<ObjectID> oids;
+  for (int i = 0; i < 100; i++) {
+    oids.push_back(ObjectID::FromRandom());
+    publisher.RegisterSubscription(
+        rpc::ChannelType::WORKER_OBJECT_EVICTION, subscriber_id_, oids.back().Binary());
+  }
+  for (const auto &oid : oids) {
+    publisher.Publish(GeneratePubMessage(oid));
+    ASSERT_TRUE(publisher.UnregisterSubscription(
+        rpc::ChannelType::WORKER_OBJECT_EVICTION, subscriber_id_, oid.Binary()));
+  }
+
+  rpc::PubsubLongPollingReply reply;
+  publisher.ConnectToSubscriber(
+      request_, &reply, [](Status, std::function<void()>, std::function<void()>) {});
+  ASSERT_EQ(reply.pub_messages_size(), static_cast<int>(oids.size()));
+  for (size_t i = 0; i < oids.size(); i++) {
+    ASSERT_EQ(reply.pub_messages(i).key_id(), oids[i].Binary());
+  }
+  ASSERT_EQ(publisher.UnregisterSubscriber(subscriber_id_), 0);
+  ASSERT_TRUE(publisher.CheckNoLeaks());
+}
+
+/// Records the replies written to it.
+class FakeSubscriberStream : public SubscriberStream {
+ public:
+  void Write(grpc::ByteBuffer reply) override { replies.push_back(std::move(reply)); }
+
+  void Close() override {}
+
+  std::vector<grpc::ByteBuffer> replies;
+};
+
+TEST_F(PublisherTest, TestStreamRepliesShareSerializedMessages) {
+  const auto oid = ObjectID::FromRandom();
+  std::vector<SubscriberID> subscriber_ids{SubscriberID::FromRandom(),
+                                           SubscriberID::FromRandom()};
+  std::vector<FakeSubscriberStream> streams(subscriber_ids.size());
+  for (size_t i = 0; i < subscriber_ids.size(); i++) {
+    publisher_->RegisterSubscription(
+        rpc::ChannelType::WORKER_OBJECT_EVICTION, subscriber_ids[i], oid.Binary());
+    rpc::PubsubLongPollingRequest request;
+    request.set_subscriber_id(subscriber_ids[i].Binary());
+    request.set_publisher_id(kDefaultPublisherId.Binary());
+    publisher_->HandleSubscriberStreamRequest(
+        request, &streams[i], /*first_request=*/true);
+    // The publisher replies right away once connected.
+    ASSERT_EQ(streams[i].replies.size(), 1);
+    publisher_->HandleSubscriberStreamWriteDone(subscriber_ids[i], &streams[i]);
+  }
+
+  publisher_->Publish(GeneratePubMessage(oid));
+
+  std::vector<std::vector<grpc::Slice>> slices(subscriber_ids.size());
+  absl::flat_hash_set<int64_t> sequence_ids;
+  for (size_t i = 0; i < subscriber_ids.size(); i++) {
+    ASSERT_EQ(streams[i].replies.size(), 2);
+    ASSERT_TRUE(streams[i].replies[1].Dump(&slices[i]).ok());
+    // The reply parses like a protobuf reply, with the subscriber's own sequence id.
+    grpc::ByteBuffer buffer(slices[i].data(), slices[i].size());
+    rpc::PubsubLongPollingReply reply;
+    ASSERT_TRUE(grpc::SerializationTraits<rpc::PubsubLongPollingReply>::Deserialize(
+                    &buffer, &reply)
+                    .ok());
+    ASSERT_EQ(reply.publisher_id(), kDefaultPublisherId.Binary());
+    ASSERT_EQ(reply.pub_messages_size(), 1);
+    ASSERT_EQ(reply.pub_messages(0).worker_object_eviction_message().object_id(),
+              oid.Binary());
+    ASSERT_GT(reply.pub_messages(0).sequence_id(), 0);
+    sequence_ids.insert(reply.pub_messages(0).sequence_id());
+  }
+  ASSERT_EQ(sequence_ids.size(), subscriber_ids.size());
+
+  // The serialized message, which follows the publisher id and the field header, is
+  // the same buffer in both replies.
+  ASSERT_EQ(slices[0].size(), slices[1].size());
+  ASSERT_EQ(slices[0][2].begin(), slices[1][2].begin());
+
+  for (size_t i = 0; i < subscriber_ids.size(); i++) {
+    publisher_->DisconnectSubscriberStream(subscriber_ids[i], &streams[i]);
+  }
+}
+
 class ScopedEntityBufferMaxBytes {
  public:
   ScopedEntityBufferMaxBytes(int64_t max_bytes)
@@ -1109,17 +1266,20 @@ TEST_F(PublisherTest, TestMaxBufferSizePerEntity) {
   pub_message.mutable_error_info_message()->set_error_message(std::string(4000, 'a'));
 
   // Buffer is available.
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
 
   // Buffer is still available.
   pub_message.mutable_error_info_message()->set_error_message(std::string(4000, 'b'));
   pub_message.set_sequence_id(GetNextSequenceId());
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
 
   // Buffer is full.
   pub_message.mutable_error_info_message()->set_error_message(std::string(4000, 'c'));
   pub_message.set_sequence_id(GetNextSequenceId());
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
 
   // Subscriber receives the last two messages. 1st message is dropped.
   auto reply = FlushSubscriber(subscriber);
@@ -1132,7 +1292,8 @@ TEST_F(PublisherTest, TestMaxBufferSizePerEntity) {
   // A message larger than the buffer limit can still be published.
   pub_message.mutable_error_info_message()->set_error_message(std::string(14000, 'd'));
   pub_message.set_sequence_id(GetNextSequenceId());
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
   reply = FlushSubscriber(subscriber);
   ASSERT_EQ(reply.pub_messages().size(), 1);
   EXPECT_EQ(reply.pub_messages(0).error_info_message().error_message(),
@@ -1154,19 +1315,22 @@ TEST_F(PublisherTest, TestMaxBufferSizeAllEntities) {
   pub_message.set_sequence_id(GetNextSequenceId());
 
   // Buffer is available.
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
 
   // Buffer is still available.
   pub_message.set_key_id("bbb");
   pub_message.mutable_error_info_message()->set_error_message(std::string(4000, 'b'));
   pub_message.set_sequence_id(GetNextSequenceId());
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
 
   // Buffer is full.
   pub_message.set_key_id("ccc");
   pub_message.mutable_error_info_message()->set_error_message(std::string(4000, 'c'));
   pub_message.set_sequence_id(GetNextSequenceId());
-  EXPECT_TRUE(subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  EXPECT_TRUE(
+      subscription_index.Publish(std::make_shared<SharedPubMessage>(pub_message)));
 
   auto reply = FlushSubscriber(subscriber);
   ASSERT_EQ(reply.pub_messages().size(), 2);
@@ -1176,6 +1340,43 @@ TEST_F(PublisherTest, TestMaxBufferSizeAllEntities) {
             std::string(4000, 'c'));
 }
 
+TEST_F(PublisherTest, TestMaxBufferSizeAllEntitiesAcrossShards) {
+  const int64_t kMaxBytes = 10000;
+  ScopedEntityBufferMaxBytes max_bytes(kMaxBytes);
+  // The subscriber to all keys is added to every shard, but the messages buffered for
+  // it still stay under the cap.
+  Publisher publisher(
+      /*channels=*/{rpc::ChannelType::RAY_ERROR_INFO_CHANNEL},
+      /*periodic_runner=*/periodic_runner_.get(),
+      /*get_time_ms=*/[this]() { return current_time_; },
+      /*subscriber_timeout_ms=*/subscriber_timeout_ms_,
+      /*batch_size*/ 1000,
+      kDefaultPublisherId,
+      /*num_shards=*/16,
+      /*num_fanout_threads=*/4);
+  publisher.RegisterSubscription(
+      rpc::ChannelType::RAY_ERROR_INFO_CHANNEL, subscriber_id_, std::nullopt);
+
+  const int num_messages = 100;
+  for (int i = 0; i < num_messages; i++) {
+    publisher.Publish(
+        GenerateErrorInfoMessage(absl::StrCat("key", i), std::string(4000, 'a')));
+  }
+  publisher.Flush();
+
+  rpc::PubsubLongPollingReply reply;
+  publisher.ConnectToSubscriber(
+      request_, &reply, [](Status, std::function<void()>, std::function<void()>) {});
+  ASSERT_GT(reply.pub_messages_size(), 0);
+  int64_t total_bytes = 0;
+  for (auto msg : reply.pub_messages()) {
+    msg.clear_sequence_id();
+    total_bytes += msg.ByteSizeLong();
+  }
+  ASSERT_LE(total_bytes, kMaxBytes);
+  ASSERT_EQ(publisher.UnregisterSubscriber(subscriber_id_), 1);
+}
+
 }  // namespace pubsub
 
 }  // namespace ray
@@ -33,7 +33,8 @@ class TaskDependencyManagerInterface {
   virtual bool RequestTaskDependencies(
       const TaskID &task_id,
       const std::vector<rpc::ObjectReference> &required_objects,
-      const TaskMetricsKey &task_key) = 0;
+      const TaskMetricsKey &task_key,
+      const rpc::TraceContext &trace_context) = 0;
   virtual void RemoveTaskDependencies(const TaskID &task_id) = 0;
   virtual bool TaskDependenciesBlocked(const TaskID &task_id) const = 0;
   virtual bool CheckObjectLocal(const ObjectID &object_id) const = 0;
@@ -154,10 +155,13 @@ class DependencyManager : public TaskDependencyManagerInterface {
   ///
   /// \param task_id The task that requires the objects.
   /// \param required_objects The objects required by the task.
+  /// \param trace_context The context of the span the pulls of the objects are
+  /// children of, if the task is traced.
   /// \return Void.
   bool RequestTaskDependencies(const TaskID &task_id,
                                const std::vector<rpc::ObjectReference> &required_objects,
-                               const TaskMetricsKey &task_key);
+                               const TaskMetricsKey &task_key,
+                               const rpc::TraceContext &trace_context);
 
   /// Cancel a task's dependencies. We will no longer attempt to fetch any
   /// remote dependencies, if no other task or worker requires them.
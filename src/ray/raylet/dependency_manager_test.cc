@@ -33,7 +33,8 @@ class MockObjectManager : public ObjectManagerInterface {
  public:
   uint64_t Pull(const std::vector<rpc::ObjectReference> &object_refs,
                 BundlePriority prio,
-                const TaskMetricsKey &task_key) {
+                const TaskMetricsKey &task_key,
+                const rpc::TraceContext &trace_context) {
     if (prio == BundlePriority::GET_REQUEST) {
       active_get_requests.insert(req_id);
     } else if (prio == BundlePriority::WAIT_REQUEST) {
@@ -104,7 +105,7 @@ TEST_F(DependencyManagerTest, TestSimpleTask) {
   }
   TaskID task_id = RandomTaskId();
   bool ready = dependency_manager_.RequestTaskDependencies(
-      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+      task_id, ObjectIdsToRefs(arguments), {"foo", false}, rpc::TraceContext());
   ASSERT_FALSE(ready);
   ASSERT_EQ(NumWaiting("bar"), 0);
   ASSERT_EQ(NumWaiting("foo"), 1);
@@ -140,7 +141,7 @@ TEST_F(DependencyManagerTest, TestMultipleTasks) {
     TaskID task_id = RandomTaskId();
     dependent_tasks.push_back(task_id);
     bool ready = dependency_manager_.RequestTaskDependencies(
-        task_id, ObjectIdsToRefs({argument_id}), {"foo", false});
+        task_id, ObjectIdsToRefs({argument_id}), {"foo", false}, rpc::TraceContext());
     ASSERT_FALSE(ready);
     // The object should be requested from the object manager once for each task.
     ASSERT_EQ(object_manager_mock_.active_task_requests.size(), i + 1);
@@ -176,7 +177,7 @@ TEST_F(DependencyManagerTest, TestTaskArgEviction) {
   }
   TaskID task_id = RandomTaskId();
   bool ready = dependency_manager_.RequestTaskDependencies(
-      task_id, ObjectIdsToRefs(arguments), {"", false});
+      task_id, ObjectIdsToRefs(arguments), {"", false}, rpc::TraceContext());
   ASSERT_FALSE(ready);
 
   // Tell the task dependency manager that each of the arguments is now
@@ -346,7 +347,7 @@ TEST_F(DependencyManagerTest, TestDuplicateTaskArgs) {
   }
   TaskID task_id = RandomTaskId();
   bool ready = dependency_manager_.RequestTaskDependencies(
-      task_id, ObjectIdsToRefs(arguments), {"", false});
+      task_id, ObjectIdsToRefs(arguments), {"", false}, rpc::TraceContext());
   ASSERT_FALSE(ready);
   ASSERT_EQ(object_manager_mock_.active_task_requests.size(), 1);
 
@@ -357,7 +358,7 @@ TEST_F(DependencyManagerTest, TestDuplicateTaskArgs) {
 
   TaskID task_id2 = RandomTaskId();
   ready = dependency_manager_.RequestTaskDependencies(
-      task_id2, ObjectIdsToRefs(arguments), {"", false});
+      task_id2, ObjectIdsToRefs(arguments), {"", false}, rpc::TraceContext());
   ASSERT_TRUE(ready);
   ASSERT_EQ(object_manager_mock_.active_task_requests.size(), 1);
   dependency_manager_.RemoveTaskDependencies(task_id2);
@@ -73,7 +73,8 @@ bool LocalTaskManager::WaitForTaskArgsRequests(std::shared_ptr<internal::Work> w
     bool args_ready = task_dependency_manager_.RequestTaskDependencies(
         task_id,
         task.GetDependencies(),
-        {task.GetTaskSpecification().GetName(), task.GetTaskSpecification().IsRetry()});
+        {task.GetTaskSpecification().GetName(), task.GetTaskSpecification().IsRetry()},
+        work->span.Context());
     if (args_ready) {
       RAY_LOG(DEBUG) << "Args already ready, task can be dispatched " << task_id;
       tasks_to_dispatch_[scheduling_key].push_back(work);
@@ -81,6 +82,8 @@ bool LocalTaskManager::WaitForTaskArgsRequests(std::shared_ptr<internal::Work> w
       RAY_LOG(DEBUG) << "Waiting for args for task: "
                      << task.GetTaskSpecification().TaskId();
       can_dispatch = false;
+      work->args_span =
+          tracing::Span::StartChild("Raylet.WaitForTaskArgs", work->span.Context());
       auto it = waiting_task_queue_.insert(waiting_task_queue_.end(), work);
       RAY_CHECK(waiting_tasks_index_.emplace(task_id, it).second);
     }
@@ -536,6 +539,11 @@ bool LocalTaskManager::PoppedWorkerHandler(
     RAY_LOG(DEBUG) << "Dispatching task " << task_id << " to worker "
                    << worker->WorkerId();
 
+    if (work->span.IsRecording()) {
+      work->span.SetAttribute("result", "granted");
+      work->span.SetAttribute("worker_id", worker->WorkerId().Hex());
+      work->span.End();
+    }
     Dispatch(worker, leased_workers_, work->allocated_instances, task, reply, callback);
     erase_from_dispatch_queue_fn(work, scheduling_class);
     dispatched = true;
@@ -554,6 +562,10 @@ void LocalTaskManager::Spillback(const NodeID &spillback_to,
   auto send_reply_callback = work->callback;
 
   if (work->grant_or_reject) {
+    if (work->span.IsRecording()) {
+      work->span.SetAttribute("result", "rejected");
+      work->span.End();
+    }
     work->reply->set_rejected(true);
     send_reply_callback();
     return;
@@ -581,6 +593,11 @@ void LocalTaskManager::Spillback(const NodeID &spillback_to,
   reply->mutable_retry_at_raylet_address()->set_port(node_info_ptr->node_manager_port());
   reply->mutable_retry_at_raylet_address()->set_raylet_id(spillback_to.Binary());
 
+  if (work->span.IsRecording()) {
+    work->span.SetAttribute("result", "spillback");
+    work->span.SetAttribute("spillback_to", spillback_to.Hex());
+    work->span.End();
+  }
   send_reply_callback();
 }
 
@@ -597,6 +614,7 @@ void LocalTaskManager::TasksUnblocked(const std::vector<TaskID> &ready_ids) {
       const auto &scheduling_key = task.GetTaskSpecification().GetSchedulingClass();
       RAY_LOG(DEBUG) << "Args ready, task can be dispatched "
                      << task.GetTaskSpecification().TaskId();
+      work->args_span.End();
       tasks_to_dispatch_[scheduling_key].push_back(work);
       waiting_task_queue_.erase(it->second);
       waiting_tasks_index_.erase(it);
@@ -25,10 +25,12 @@
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/common/task/task_common.h"
+#include "ray/common/tracing.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/raylet/raylet.h"
 #include "ray/stats/stats.h"
 #include "ray/util/event.h"
+#include "ray/util/sampling_profiler.h"
 
 using json = nlohmann::json;
 
@@ -324,6 +326,12 @@ int main(int argc, char *argv[]) {
             {ray::stats::NodeAddressKey, node_ip_address},
             {ray::stats::SessionNameKey, session_name}};
         ray::stats::Init(global_tags, metrics_agent_port, WorkerID::Nil());
+        ray::tracing::Init("raylet", log_dir);
+
+        // Profile the main thread, which runs this callback.
+        ray::SamplingProfiler::Instance().Start(
+            RayConfig::instance().sampling_profiler_frequency_hz());
+        ray::SamplingProfiler::Instance().AddCurrentThread();
 
         ray::NodeID raylet_node_id{
             (!RayConfig::instance().OVERRIDE_NODE_ID_FOR_TESTING().empty())
@@ -374,6 +382,7 @@ int main(int argc, char *argv[]) {
     raylet->Stop();
     gcs_client->Disconnect();
     ray::stats::Shutdown();
+    ray::tracing::Shutdown();
     main_service.stop();
     remove(raylet_socket_name.c_str());
   };
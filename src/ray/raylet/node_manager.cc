@@ -38,6 +38,7 @@
 #include "ray/util/event.h"
 #include "ray/util/event_label.h"
 #include "ray/util/sample.h"
+#include "ray/util/sampling_profiler.h"
 #include "ray/util/util.h"
 
 namespace {
@@ -51,6 +52,22 @@ struct ActorStats {
   int restarting_actors = 0;
 };
 
+/// The leases of the workers requested beyond the first one by a RequestWorkerLease
+/// request. They're resolved together with the first lease.
+struct AdditionalWorkerLeases {
+  struct Lease {
+    ray::TaskID task_id;
+    ray::rpc::RequestWorkerLeaseReply reply;
+    bool resolved = false;
+  };
+  /// The leases are never moved, since the raylet holds pointers to their replies.
+  std::vector<std::unique_ptr<Lease>> leases;
+  /// Whether the first lease has been resolved, after which no more leases are queued.
+  bool first_lease_resolved = false;
+  /// Whether the request has been replied.
+  bool replied = false;
+};
+
 inline ray::rpc::ObjectReference FlatbufferToSingleObjectReference(
     const flatbuffers::String &object_id, const ray::protocol::Address &address) {
   ray::rpc::ObjectReference ref;
@@ -257,6 +274,7 @@ NodeManager::NodeManager(instrumented_io_context &io_service,
             MarkObjectsAsFailed(error_type, {ref}, JobID::Nil());
           }),
       periodical_runner_(io_service),
+      io_context_watchdog_(IoContextWatchdog::Create(io_service, "raylet")),
       report_resources_period_ms_(config.report_resources_period_ms),
       temp_dir_(config.temp_dir),
       initial_config_(config),
@@ -308,6 +326,11 @@ NodeManager::NodeManager(instrumented_io_context &io_service,
       next_resource_seq_no_(0),
       ray_syncer_(io_service_, self_node_id_.Binary()),
       ray_syncer_service_(ray_syncer_),
+      ray_syncer_topology_(
+          RayConfig::instance().ray_syncer_relay_group_size() > 0
+              ? std::make_unique<syncer::RelayTopology>(
+                    RayConfig::instance().ray_syncer_relay_group_size())
+              : nullptr),
       worker_killing_policy_(
           CreateWorkerKillingPolicy(RayConfig::instance().worker_killing_policy())),
       memory_monitor_(std::make_unique<MemoryMonitor>(
@@ -457,8 +480,10 @@ ray::Status NodeManager::RegisterGcs() {
         /* receiver */ this,
         /* pull_from_reporter_interval_ms */ 0);
 
-    auto gcs_channel = gcs_client_->GetGcsRpcClient().GetChannel();
-    ray_syncer_.Connect(kGCSNodeID.Binary(), gcs_channel);
+    // All the alive nodes have been added by now. Picking the parent of ray syncer
+    // before that would switch it back and forth while the node table is loaded.
+    node_table_loaded_ = true;
+    UpdateRaySyncerParent();
     periodical_runner_.RunFnPeriodically(
         [this] {
           auto triggered_by_global_gc = TryLocalGC();
@@ -972,6 +997,10 @@ void NodeManager::NodeAdded(const GcsNodeInfo &node_info) {
 
   RAY_LOG(DEBUG) << "[NodeAdded] Received callback from node id " << node_id;
   if (node_id == self_node_id_) {
+    if (ray_syncer_topology_ != nullptr) {
+      ray_syncer_topology_->AddNode(node_id.Binary());
+      UpdateRaySyncerParent();
+    }
     return;
   }
 
@@ -979,6 +1008,11 @@ void NodeManager::NodeAdded(const GcsNodeInfo &node_info) {
   remote_node_manager_addresses_[node_id] =
       std::make_pair(node_info.node_manager_address(), node_info.node_manager_port());
 
+  if (ray_syncer_topology_ != nullptr) {
+    ray_syncer_topology_->AddNode(node_id.Binary());
+    UpdateRaySyncerParent();
+  }
+
   // Set node labels when node added.
   absl::flat_hash_map<std::string, std::string> labels(node_info.labels().begin(),
                                                        node_info.labels().end());
@@ -1045,6 +1079,13 @@ void NodeManager::NodeRemoved(const NodeID &node_id) {
     remote_node_manager_addresses_.erase(node_entry);
   }
 
+  // Fail over to another relay if the removed node is the relay of this node.
+  if (ray_syncer_topology_ != nullptr) {
+    ray_syncer_topology_->RemoveNode(node_id.Binary());
+    UpdateRaySyncerParent();
+  }
+  ray_syncer_.RemoveNode(node_id.Binary());
+
   // Notify the object directory that the node has been removed so that it
   // can remove it from any cached locations.
   object_directory_->HandleNodeRemoved(node_id);
@@ -1056,6 +1097,59 @@ void NodeManager::NodeRemoved(const NodeID &node_id) {
   HandleUnexpectedWorkerFailure(data);
 }
 
+void NodeManager::UpdateRaySyncerParent() {
+  if (!node_table_loaded_) {
+    return;
+  }
+  NodeID parent = kGCSNodeID;
+  if (ray_syncer_topology_ != nullptr) {
+    if (auto relay = ray_syncer_topology_->GetParent(self_node_id_.Binary())) {
+      parent = NodeID::FromBinary(*relay);
+    }
+  }
+  if (parent == ray_syncer_parent_) {
+    return;
+  }
+
+  RAY_LOG(INFO) << "Switching ray syncer from " << ray_syncer_parent_ << " to "
+                << parent;
+  if (!ray_syncer_parent_.IsNil()) {
+    ray_syncer_.Disconnect(ray_syncer_parent_.Binary());
+  }
+  ray_syncer_parent_ = parent;
+  if (parent == kGCSNodeID) {
+    ray_syncer_.Connect(kGCSNodeID.Binary(),
+                        gcs_client_->GetGcsRpcClient().GetChannel());
+    return;
+  }
+
+  const auto &address = remote_node_manager_addresses_.at(parent);
+  ray_syncer_.Connect(
+      parent.Binary(),
+      rpc::BuildChannel(address.first, address.second),
+      /* on_connection_failure */ [this](const std::string &node_id) {
+        // The relay might be dead or partitioned from this node. Don't wait for GCS to
+        // mark it dead, but pick another relay or sync with GCS directly instead.
+        RAY_LOG(WARNING) << "Ray syncer lost the connection to relay "
+                         << NodeID::FromBinary(node_id);
+        ray_syncer_topology_->MarkUnreachable(node_id);
+        if (ray_syncer_parent_.Binary() == node_id) {
+          ray_syncer_parent_ = NodeID::Nil();
+          UpdateRaySyncerParent();
+        }
+        // Try the relay again later, since the connection might be broken only for a
+        // while. If it's still unreachable, it'll be marked again.
+        RAY_UNUSED(execute_after(
+            io_service_,
+            [this, node_id]() {
+              ray_syncer_topology_->MarkReachable(node_id);
+              UpdateRaySyncerParent();
+            },
+            std::chrono::milliseconds(
+                RayConfig::instance().ray_syncer_relay_retry_interval_ms())));
+      });
+}
+
 void NodeManager::HandleUnexpectedWorkerFailure(const rpc::WorkerDeltaData &data) {
   const WorkerID worker_id = WorkerID::FromBinary(data.worker_id());
   const NodeID node_id = NodeID::FromBinary(data.raylet_id());
@@ -1811,11 +1905,102 @@ void NodeManager::HandleRequestWorkerLease(rpc::RequestWorkerLeaseRequest reques
         send_reply_callback(status, success, failure);
       };
 
+  const int64_t num_additional_workers =
+      is_actor_creation_task ? 0 : std::max<int64_t>(request.num_workers() - 1, 0);
+  if (num_additional_workers == 0) {
+    cluster_task_manager_->QueueAndScheduleTask(task,
+                                                request.grant_or_reject(),
+                                                request.is_selected_based_on_locality(),
+                                                reply,
+                                                send_reply_callback_wrapper);
+    return;
+  }
+
+  // The additional workers are leased like the first one, except that they're never
+  // spilled back. Once the first lease is resolved, the request is replied with the
+  // additional leases granted so far, and the rest are canceled, so that the caller
+  // gets the workers which are available right away without waiting for the others.
+  auto additional_leases = std::make_shared<AdditionalWorkerLeases>();
+  auto first_lease_callback = [this,
+                               additional_leases,
+                               reply,
+                               send_reply_callback_wrapper](
+                                  Status status,
+                                  std::function<void()> success,
+                                  std::function<void()> failure) {
+    additional_leases->first_lease_resolved = true;
+    // Post the reply, so that the additional leases whose workers have just been popped
+    // are granted first.
+    io_service_.post(
+        [this,
+         additional_leases,
+         reply,
+         send_reply_callback_wrapper,
+         status,
+         success,
+         failure]() {
+          for (auto &lease : additional_leases->leases) {
+            if (!lease->resolved) {
+              RAY_UNUSED(cluster_task_manager_->CancelTask(lease->task_id));
+            }
+          }
+          additional_leases->replied = true;
+          for (auto &lease : additional_leases->leases) {
+            if (!lease->resolved) {
+              // The worker is returned if the lease is granted after the reply.
+              RAY_LOG(WARNING) << "Additional lease " << lease->task_id
+                               << " isn't resolved after being canceled.";
+              continue;
+            }
+            if (lease->reply.worker_address().raylet_id().empty()) {
+              continue;
+            }
+            auto *additional_lease = reply->add_additional_leases();
+            additional_lease->set_task_id(lease->task_id.Binary());
+            additional_lease->mutable_worker_address()->Swap(
+                lease->reply.mutable_worker_address());
+            additional_lease->mutable_resource_mapping()->Swap(
+                lease->reply.mutable_resource_mapping());
+            additional_lease->set_worker_pid(lease->reply.worker_pid());
+          }
+          send_reply_callback_wrapper(status, success, failure);
+        },
+        "NodeManager.HandleRequestWorkerLease.ReplyAdditionalLeases");
+  };
   cluster_task_manager_->QueueAndScheduleTask(task,
                                               request.grant_or_reject(),
                                               request.is_selected_based_on_locality(),
                                               reply,
-                                              send_reply_callback_wrapper);
+                                              std::move(first_lease_callback));
+  for (int64_t i = 0; i < num_additional_workers; i++) {
+    if (additional_leases->first_lease_resolved) {
+      // E.g., the first lease is spilled back, so the others can't be granted either.
+      break;
+    }
+    auto lease = std::make_unique<AdditionalWorkerLeases::Lease>();
+    lease->task_id = TaskID::FromRandom(task_spec.JobId());
+    rpc::Task additional_task_message = task_message;
+    additional_task_message.mutable_task_spec()->set_task_id(lease->task_id.Binary());
+    auto *lease_ptr = lease.get();
+    additional_leases->leases.push_back(std::move(lease));
+    cluster_task_manager_->QueueAndScheduleTask(
+        RayTask(additional_task_message),
+        /*grant_or_reject=*/true,
+        request.is_selected_based_on_locality(),
+        &lease_ptr->reply,
+        [this, additional_leases, lease_ptr](Status status,
+                                             std::function<void()> success,
+                                             std::function<void()> failure) {
+          lease_ptr->resolved = true;
+          const auto &worker_address = lease_ptr->reply.worker_address();
+          if (additional_leases->replied && !worker_address.raylet_id().empty()) {
+            // The caller doesn't know about the worker, so nobody else returns it.
+            RAY_LOG(WARNING) << "Additional lease " << lease_ptr->task_id
+                             << " is granted after the reply, returning the worker.";
+            ReturnUnrepliedWorker(WorkerID::FromBinary(worker_address.worker_id()));
+          }
+        });
+  }
 }
 
 void NodeManager::HandlePrepareBundleResources(
@@ -1890,6 +2075,17 @@ void NodeManager::HandleCancelResourceReserve(
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
+void NodeManager::ReturnUnrepliedWorker(const WorkerID &worker_id) {
+  auto it = leased_workers_.find(worker_id);
+  if (it == leased_workers_.end()) {
+    return;
+  }
+  std::shared_ptr<WorkerInterface> worker = it->second;
+  ReleaseWorker(worker_id);
+  local_task_manager_->ReleaseWorkerResources(worker);
+  HandleWorkerAvailable(worker);
+}
+
 void NodeManager::HandleReturnWorker(rpc::ReturnWorkerRequest request,
                                      rpc::ReturnWorkerReply *reply,
                                      rpc::SendReplyCallback send_reply_callback) {
@@ -2355,6 +2551,9 @@ std::string NodeManager::DebugString() const {
 
   // Event stats.
   result << "\nEvent stats:" << io_service_.stats().StatsString();
+  if (io_context_watchdog_ != nullptr) {
+    result << "\n" << io_context_watchdog_->DebugString();
+  }
 
   result << "\nDebugString() time ms: " << (current_time_ms() - now_ms);
   return result.str();
@@ -2460,6 +2659,9 @@ void NodeManager::HandleGetNodeStats(rpc::GetNodeStatsRequest node_stats_request
   local_object_manager_.FillObjectStoreStats(reply);
   // Report object store stats.
   object_manager_.FillObjectStoreStats(reply);
+  if (node_stats_request.include_profile()) {
+    reply->set_profile(SamplingProfiler::Instance().GetFoldedStacks());
+  }
   // As a result of the HandleGetNodeStats, we are collecting information from all
   // workers on this node. This is done by calling GetCoreWorkerStats on each worker. In
   // order to send up-to-date information back, we wait until all workers have replied,
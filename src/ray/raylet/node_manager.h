@@ -23,6 +23,7 @@
 #include "ray/common/task/task.h"
 #include "ray/common/ray_object.h"
 #include "ray/common/ray_syncer/ray_syncer.h"
+#include "ray/common/ray_syncer/relay_topology.h"
 #include "ray/common/client_connection.h"
 #include "ray/common/task/task_common.h"
 #include "ray/common/task/task_util.h"
@@ -45,6 +46,7 @@
 #include "ray/util/ordered_set.h"
 #include "ray/util/throttler.h"
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/asio/io_context_watchdog.h"
 #include "ray/common/bundle_spec.h"
 #include "ray/raylet/placement_group_resource_manager.h"
 #include "ray/raylet/worker_killing_policy.h"
@@ -266,6 +268,12 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
   /// \return Void.
   void NodeRemoved(const NodeID &node_id);
 
+  /// Connect ray syncer to the node it should sync with. It's GCS unless the
+  /// hierarchical topology is enabled, in which case it's the relay of this node's
+  /// group. It's a no-op if the parent doesn't change, or if the node table hasn't
+  /// been loaded yet.
+  void UpdateRaySyncerParent();
+
   /// Handler for the addition or updation of a resource in the GCS
   /// \param node_id ID of the node that created or updated resources.
   /// \param createUpdatedResources Created or updated resources.
@@ -538,6 +546,12 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
                                  rpc::ReportWorkerBacklogReply *reply,
                                  rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Return a worker whose lease was granted after its request was replied, i.e. whose
+  /// lease isn't known by any caller.
+  ///
+  /// \param worker_id The ID of the leased worker.
+  void ReturnUnrepliedWorker(const WorkerID &worker_id);
+
   /// Handle a `ReturnWorker` request.
   void HandleReturnWorker(rpc::ReturnWorkerRequest request,
                           rpc::ReturnWorkerReply *reply,
@@ -735,6 +749,8 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
   plasma::PlasmaClient store_client_;
   /// The runner to run function periodically.
   PeriodicalRunner periodical_runner_;
+  /// The watchdog of the event loop, or null if it's disabled.
+  std::unique_ptr<IoContextWatchdog> io_context_watchdog_;
   /// The period used for the resources report timer.
   uint64_t report_resources_period_ms_;
   /// Incremented each time we encounter a potential resource deadlock condition.
@@ -874,6 +890,16 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
   /// RaySyncerService for gRPC
   syncer::RaySyncerService ray_syncer_service_;
 
+  /// The topology of ray syncer when `ray_syncer_relay_group_size` is set,
+  /// nullptr otherwise.
+  std::unique_ptr<syncer::RelayTopology> ray_syncer_topology_;
+
+  /// The node ray syncer is connected to. It's nil before ray syncer starts.
+  NodeID ray_syncer_parent_;
+
+  /// Whether the alive nodes have been loaded from GCS. Ray syncer starts after that.
+  bool node_table_loaded_ = false;
+
   /// The Policy for selecting the worker to kill when the node runs out of memory.
   std::shared_ptr<WorkerKillingPolicy> worker_killing_policy_;
 
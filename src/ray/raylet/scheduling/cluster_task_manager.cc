@@ -432,6 +432,10 @@ void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
   auto send_reply_callback = work->callback;
 
   if (work->grant_or_reject) {
+    if (work->span.IsRecording()) {
+      work->span.SetAttribute("result", "rejected");
+      work->span.End();
+    }
     work->reply->set_rejected(true);
     send_reply_callback();
     return;
@@ -460,6 +464,11 @@ void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
   reply->mutable_retry_at_raylet_address()->set_port(node_info_ptr->node_manager_port());
   reply->mutable_retry_at_raylet_address()->set_raylet_id(spillback_to.Binary());
 
+  if (work->span.IsRecording()) {
+    work->span.SetAttribute("result", "spillback");
+    work->span.SetAttribute("spillback_to", spillback_to.Hex());
+    work->span.End();
+  }
   send_reply_callback();
 }
 
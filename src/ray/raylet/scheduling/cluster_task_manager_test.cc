@@ -197,7 +197,8 @@ class MockTaskDependencyManager : public TaskDependencyManagerInterface {
 
   bool RequestTaskDependencies(const TaskID &task_id,
                                const std::vector<rpc::ObjectReference> &required_objects,
-                               const TaskMetricsKey &task_key) {
+                               const TaskMetricsKey &task_key,
+                               const rpc::TraceContext &trace_context) {
     RAY_CHECK(subscribed_tasks.insert(task_id).second);
     for (auto &obj_ref : required_objects) {
       if (missing_objects_.find(ObjectRefToId(obj_ref)) != missing_objects_.end()) {
@@ -1189,6 +1190,66 @@ TEST_F(ClusterTaskManagerTest, TaskCancellationTest) {
   AssertNoLeaks();
 }
 
+TEST_F(ClusterTaskManagerTest, CancelAdditionalLeaseWaitingForWorkerTest) {
+  /*
+    The additional leases of a lease request are canceled once its first lease is
+    resolved. A lease waiting on a worker pop is resolved by the cancellation, and the
+    worker popped afterwards isn't leased.
+   */
+  RayTask first_task = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+  RayTask additional_task = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+  rpc::RequestWorkerLeaseReply first_reply;
+  rpc::RequestWorkerLeaseReply additional_reply;
+  bool first_resolved = false;
+  bool additional_resolved = false;
+  task_manager_.QueueAndScheduleTask(
+      first_task,
+      false,
+      false,
+      &first_reply,
+      [&first_resolved](Status, std::function<void()>, std::function<void()>) {
+        first_resolved = true;
+      });
+  task_manager_.QueueAndScheduleTask(
+      additional_task,
+      /*grant_or_reject=*/true,
+      false,
+      &additional_reply,
+      [&additional_resolved](Status, std::function<void()>, std::function<void()>) {
+        additional_resolved = true;
+      });
+  ASSERT_EQ(pool_.num_pops, 2);
+
+  // Only the first lease gets a worker.
+  std::shared_ptr<MockWorker> worker =
+      std::make_shared<MockWorker>(WorkerID::FromRandom(), 1234);
+  pool_.PushWorker(std::static_pointer_cast<WorkerInterface>(worker));
+  pool_.TriggerCallbacks();
+  ASSERT_TRUE(first_resolved);
+  ASSERT_FALSE(additional_resolved);
+  ASSERT_EQ(leased_workers_.size(), 1);
+
+  ASSERT_TRUE(task_manager_.CancelTask(additional_task.GetTaskSpecification().TaskId()));
+  ASSERT_TRUE(additional_resolved);
+  ASSERT_TRUE(additional_reply.canceled());
+
+  // The worker popped for the canceled lease stays in the pool.
+  additional_resolved = false;
+  std::shared_ptr<MockWorker> late_worker =
+      std::make_shared<MockWorker>(WorkerID::FromRandom(), 1235);
+  pool_.PushWorker(std::static_pointer_cast<WorkerInterface>(late_worker));
+  pool_.TriggerCallbacks();
+  ASSERT_FALSE(additional_resolved);
+  ASSERT_EQ(leased_workers_.size(), 1);
+  ASSERT_EQ(pool_.workers.size(), 1);
+
+  RayTask finished_task;
+  local_task_manager_->TaskFinished(leased_workers_.begin()->second, &finished_task);
+  ASSERT_EQ(finished_task.GetTaskSpecification().TaskId(),
+            first_task.GetTaskSpecification().TaskId());
+  AssertNoLeaks();
+}
+
 TEST_F(ClusterTaskManagerTest, TaskCancelInfeasibleTask) {
   /* Make sure cancelTask works for infeasible tasks */
   std::shared_ptr<MockWorker> worker =
@@ -18,6 +18,7 @@
 #include "ray/common/scheduling/cluster_resource_data.h"
 #include "ray/common/task/task.h"
 #include "ray/common/task/task_common.h"
+#include "ray/common/tracing.h"
 #include "src/ray/protobuf/node_manager.pb.h"
 
 namespace ray {
@@ -61,6 +62,11 @@ class Work {
   rpc::RequestWorkerLeaseReply *reply;
   std::function<void(void)> callback;
   std::shared_ptr<TaskResourceInstances> allocated_instances;
+  /// The span of the lease request on this node, which ends when the work is dispatched,
+  /// spilled back or cancelled. It's a no-op if the task isn't traced.
+  tracing::Span span;
+  /// The span of waiting for the arguments of the task to be local.
+  tracing::Span args_span;
   Work(RayTask task,
        bool grant_or_reject,
        bool is_selected_based_on_locality,
@@ -73,6 +79,8 @@ class Work {
         reply(reply),
         callback(callback),
         allocated_instances(nullptr),
+        span(tracing::Span::StartChild(
+            "Raylet.LeaseWorker", this->task.GetTaskSpecification().GetTraceContext())),
         status_(status){};
   Work(const Work &Work) = delete;
   Work &operator=(const Work &work) = delete;
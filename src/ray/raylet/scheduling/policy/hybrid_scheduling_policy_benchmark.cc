@@ -0,0 +1,61 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of picking a node for a task, which the raylet does for every task it
+// can't run locally.
+
+#include "ray/common/benchmark_util.h"
+#include "ray/raylet/scheduling/policy/hybrid_scheduling_policy.h"
+
+namespace ray {
+namespace raylet_scheduling_policy {
+
+namespace {
+
+using benchmark::State;
+
+NodeResources CreateNodeResources(double available_cpu, double total_cpu) {
+  NodeResources resources;
+  resources.available.Set(ResourceID::CPU(), available_cpu)
+      .Set(ResourceID::Memory(), 1024);
+  resources.total.Set(ResourceID::CPU(), total_cpu).Set(ResourceID::Memory(), 1024);
+  return resources;
+}
+
+/// Schedule a task requiring 1 CPU in a cluster of the given number of nodes, whose
+/// local node is full, so that every node is scored.
+void BM_HybridSchedule(State &state) {
+  const scheduling::NodeID local_node(0);
+  absl::flat_hash_map<scheduling::NodeID, Node> nodes;
+  nodes.emplace(local_node, Node(CreateNodeResources(0, 16)));
+  for (int64_t i = 1; i < state.range(); ++i) {
+    // Vary the utilization so that the nodes don't all have the same score.
+    nodes.emplace(scheduling::NodeID(i), Node(CreateNodeResources(i % 16 + 1, 16)));
+  }
+  HybridSchedulingPolicy policy(local_node, nodes, [](auto) { return true; });
+  const auto resource_request = ResourceMapToResourceRequest(
+      absl::flat_hash_map<ResourceID, double>{{ResourceID::CPU(), 1}},
+      /*requires_object_store_memory=*/false);
+  const auto options = SchedulingOptions::Hybrid(/*avoid_local_node=*/false,
+                                                  /*require_node_available=*/false);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(policy.Schedule(resource_request, options));
+  }
+}
+RAY_BENCHMARK(BM_HybridSchedule)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+}  // namespace
+
+}  // namespace raylet_scheduling_policy
+}  // namespace ray
@@ -67,12 +67,15 @@ class WorkerLeaseInterface {
   ///                         but no spillback.
   /// \param callback: The callback to call when the request finishes.
   /// \param backlog_size The queue length for the given shape on the CoreWorker.
+  /// \param num_workers The number of workers to lease. The workers beyond the first
+  ///                    one are returned in the additional leases of the reply.
   virtual void RequestWorkerLease(
       const rpc::TaskSpec &task_spec,
       bool grant_or_reject,
       const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
       const int64_t backlog_size = -1,
-      const bool is_selected_based_on_locality = false) = 0;
+      const bool is_selected_based_on_locality = false,
+      const int64_t num_workers = 1) = 0;
 
   /// Returns a worker to the raylet.
   /// \param worker_port The local port of the worker on the raylet node.
@@ -404,7 +407,8 @@ class RayletClient : public RayletClientInterface {
       bool grant_or_reject,
       const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
       const int64_t backlog_size,
-      const bool is_selected_based_on_locality) override;
+      const bool is_selected_based_on_locality,
+      const int64_t num_workers) override;
 
   /// Implements WorkerLeaseInterface.
   ray::Status ReturnWorker(int worker_port,
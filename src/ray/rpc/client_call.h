@@ -14,11 +14,13 @@
 
 #pragma once
 
+#include <google/protobuf/arena.h>
 #include <grpcpp/grpcpp.h>
 
 #include <atomic>
 #include <boost/asio.hpp>
 #include <chrono>
+#include <type_traits>
 
 #include "absl/synchronization/mutex.h"
 #include "ray/common/asio/asio_chaos.h"
@@ -59,6 +61,41 @@ class ClientCallManager;
 template <class Reply>
 using ClientCallback = std::function<void(const Status &status, const Reply &reply)>;
 
+/// Whether the replies of type `Reply` are parsed into an arena owned by the call.
+/// The arena only pays off for replies with many submessages, e.g. the return objects
+/// of pushed tasks, so it's enabled by specializing this for their types.
+template <class Reply>
+struct ParseReplyIntoArena : std::false_type {};
+
+namespace internal {
+
+/// A reply parsed into an arena, so that its submessages are freed at once with the
+/// arena instead of one by one.
+template <class Reply>
+class ArenaReply {
+ public:
+  ArenaReply() : reply_(google::protobuf::Arena::CreateMessage<Reply>(&arena_)) {}
+
+  Reply *Get() { return reply_; }
+
+ private:
+  google::protobuf::Arena arena_;
+  /// Owned by the arena.
+  Reply *const reply_;
+};
+
+/// A reply allocated on the heap as usual.
+template <class Reply>
+class HeapReply {
+ public:
+  Reply *Get() { return &reply_; }
+
+ private:
+  Reply reply_;
+};
+
+}  // namespace internal
+
 /// Implementation of the `ClientCall`. It represents a `ClientCall` for a particular
 /// RPC method.
 ///
@@ -102,15 +139,20 @@ class ClientCallImpl : public ClientCall {
       status = return_status_;
     }
     if (callback_ != nullptr) {
-      callback_(status, reply_);
+      callback_(status, *reply_.Get());
     }
   }
 
   std::shared_ptr<StatsHandle> GetStatsHandle() override { return stats_handle_; }
 
  private:
-  /// The reply message.
-  Reply reply_;
+  /// The reply message, parsed into the arena of this call if
+  /// `ParseReplyIntoArena<Reply>` is set. It's not valid beyond the life-cycle of this
+  /// call.
+  std::conditional_t<ParseReplyIntoArena<Reply>::value,
+                     internal::ArenaReply<Reply>,
+                     internal::HeapReply<Reply>>
+      reply_;
 
   /// The callback function to handle the reply.
   ClientCallback<Reply> callback_;
@@ -265,7 +307,7 @@ class ClientCallManager {
     // `ClientCall` is safe to use. But `response_reader_->Finish` only accepts a raw
     // pointer.
     auto tag = new ClientCallTag(call);
-    call->response_reader_->Finish(&call->reply_, &call->status_, (void *)tag);
+    call->response_reader_->Finish(call->reply_.Get(), &call->status_, (void *)tag);
     return call;
   }
 
@@ -149,6 +149,22 @@ using HandleRequestFunction = void (ServiceHandler::*)(Request,
                                                        Reply *,
                                                        SendReplyCallback);
 
+/// The events of an RPC method recorded on the event loop. They're registered once by
+/// the factory of the method, so that the calls don't look them up by name, and shared
+/// with the calls, which may outlive the factory during shutdown.
+struct ServerCallEvents {
+  ServerCallEvents(EventTracker &event_tracker, const std::string &call_name)
+      : call(event_tracker.RegisterEvent(call_name)),
+        handle_request(event_tracker.RegisterEvent(call_name + ".HandleRequestImpl")),
+        success_callback(event_tracker.RegisterEvent(call_name + ".success_callback")),
+        failure_callback(event_tracker.RegisterEvent(call_name + ".failure_callback")) {}
+
+  const EventHandle call;
+  const EventHandle handle_request;
+  const EventHandle success_callback;
+  const EventHandle failure_callback;
+};
+
 /// Implementation of `ServerCall`. It represents `ServerCall` for a particular
 /// RPC method.
 ///
@@ -168,6 +184,7 @@ class ServerCallImpl : public ServerCall {
   /// \param[in] handle_request_function Pointer to the service handler function.
   /// \param[in] io_service The event loop.
   /// \param[in] call_name The name of the RPC call.
+  /// \param[in] events The registered events of the RPC call.
   /// \param[in] record_metrics If true, it records and exports the gRPC server metrics.
   /// \param[in] preprocess_function If not nullptr, it will be called before handling
   /// request.
@@ -177,6 +194,7 @@ class ServerCallImpl : public ServerCall {
       HandleRequestFunction<ServiceHandler, Request, Reply> handle_request_function,
       instrumented_io_context &io_service,
       std::string call_name,
+      std::shared_ptr<const ServerCallEvents> events,
       const ClusterID &cluster_id,
       bool record_metrics,
       std::function<void()> preprocess_function = nullptr)
@@ -187,6 +205,7 @@ class ServerCallImpl : public ServerCall {
         response_writer_(&context_),
         io_service_(io_service),
         call_name_(std::move(call_name)),
+        events_(std::move(events)),
         cluster_id_(cluster_id),
         start_time_(0),
         record_metrics_(record_metrics) {
@@ -205,7 +224,7 @@ class ServerCallImpl : public ServerCall {
   void SetState(const ServerCallState &new_state) override { state_ = new_state; }
 
   void HandleRequest() override {
-    stats_handle_ = io_service_.stats().RecordStart(call_name_);
+    stats_handle_ = io_service_.stats().RecordStart(events_->call);
     bool auth_success = true;
     if (::RayConfig::instance().enable_cluster_auth()) {
       if constexpr (EnableAuth == AuthType::LAZY_AUTH) {
@@ -235,7 +254,7 @@ class ServerCallImpl : public ServerCall {
     }
     if (!io_service_.stopped()) {
       io_service_.post([this, auth_success] { HandleRequestImpl(auth_success); },
-                       call_name_ + ".HandleRequestImpl",
+                       events_->handle_request,
                        // Implement the delay of the rpc server call as the
                        // delay of HandleRequestImpl().
                        ray::asio::testing::get_delay_us(call_name_));
@@ -295,7 +314,7 @@ class ServerCallImpl : public ServerCall {
     }
     if (send_reply_success_callback_ && !io_service_.stopped()) {
       auto callback = std::move(send_reply_success_callback_);
-      io_service_.post([callback]() { callback(); }, call_name_ + ".success_callback");
+      io_service_.post([callback]() { callback(); }, events_->success_callback);
     }
     LogProcessTime();
   }
@@ -306,7 +325,7 @@ class ServerCallImpl : public ServerCall {
     }
     if (send_reply_failure_callback_ && !io_service_.stopped()) {
       auto callback = std::move(send_reply_failure_callback_);
-      io_service_.post([callback]() { callback(); }, call_name_ + ".failure_callback");
+      io_service_.post([callback]() { callback(); }, events_->failure_callback);
     }
     LogProcessTime();
   }
@@ -371,6 +390,9 @@ class ServerCallImpl : public ServerCall {
   /// Human-readable name for this RPC call.
   std::string call_name_;
 
+  /// The registered events of this RPC call, shared with the factory.
+  const std::shared_ptr<const ServerCallEvents> events_;
+
   /// The stats handle tracking this RPC call.
   std::shared_ptr<StatsHandle> stats_handle_;
 
@@ -454,6 +476,7 @@ class ServerCallFactoryImpl : public ServerCallFactory {
         cq_(cq),
         io_service_(io_service),
         call_name_(std::move(call_name)),
+        events_(std::make_shared<const ServerCallEvents>(io_service.stats(), call_name_)),
         cluster_id_(cluster_id),
         max_active_rpcs_(max_active_rpcs),
         record_metrics_(record_metrics) {}
@@ -467,6 +490,7 @@ class ServerCallFactoryImpl : public ServerCallFactory {
         handle_request_function_,
         io_service_,
         call_name_,
+        events_,
         cluster_id_,
         record_metrics_);
     /// Request gRPC runtime to starting accepting this kind of request, using the call as
@@ -503,6 +527,9 @@ class ServerCallFactoryImpl : public ServerCallFactory {
   /// Human-readable name for this RPC call.
   std::string call_name_;
 
+  /// The registered events of this RPC call.
+  const std::shared_ptr<const ServerCallEvents> events_;
+
   /// ID of the cluster to check incoming RPC calls against.
   /// Check skipped if empty.
   const ClusterID cluster_id_;
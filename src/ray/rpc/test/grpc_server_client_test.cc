@@ -21,6 +21,11 @@
 
 namespace ray {
 namespace rpc {
+
+/// Parse the ping replies into the arena of the call, like the replies of pushed tasks.
+template <>
+struct ParseReplyIntoArena<PingReply> : std::true_type {};
+
 class TestServiceHandler {
  public:
   void HandlePing(PingRequest request,
@@ -37,6 +42,9 @@ class TestServiceHandler {
       RAY_LOG(INFO) << "No reply!";
       return;
     }
+    for (int i = 0; i < request.num_payloads(); i++) {
+      reply->add_payloads()->set_data(std::string(i + 1, 'x'));
+    }
     send_reply_callback(
         ray::Status::OK(),
         /*reply_success=*/[]() { RAY_LOG(INFO) << "Reply success."; },
@@ -187,6 +195,39 @@ TEST_F(TestGrpcServerClientFixture, TestBasic) {
   }
 }
 
+TEST_F(TestGrpcServerClientFixture, TestReplyWithSubmessages) {
+  PingRequest request;
+  request.set_num_payloads(3);
+  std::atomic<bool> done(false);
+  Status reply_status;
+  bool reply_on_arena = false;
+  bool payloads_on_arena = true;
+  PingReply reply_copy;
+  Ping(request, [&](const Status &status, const PingReply &reply) {
+    reply_status = status;
+    // The reply is parsed into the arena of the call, together with its submessages.
+    reply_on_arena = reply.GetArena() != nullptr;
+    for (const auto &payload : reply.payloads()) {
+      payloads_on_arena &= payload.GetArena() == reply.GetArena();
+    }
+    // Copies don't depend on the arena, so they can outlive the call.
+    reply_copy = reply;
+    done = true;
+  });
+  while (!done) {
+    RAY_LOG(INFO) << "waiting";
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_TRUE(reply_status.ok());
+  ASSERT_TRUE(reply_on_arena);
+  ASSERT_TRUE(payloads_on_arena);
+  ASSERT_EQ(reply_copy.GetArena(), nullptr);
+  ASSERT_EQ(reply_copy.payloads_size(), 3);
+  for (int i = 0; i < reply_copy.payloads_size(); i++) {
+    ASSERT_EQ(reply_copy.payloads(i).data(), std::string(i + 1, 'x'));
+  }
+}
+
 TEST_F(TestGrpcServerClientFixture, TestBackpressure) {
   // Send a request which won't be replied to.
   PingRequest request;
@@ -0,0 +1,64 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of parsing a reply on the heap vs. on the arena of its call, which is
+// what `ClientCallImpl` does with the replies of pushed tasks.
+
+#include <google/protobuf/arena.h>
+
+#include "ray/common/benchmark_util.h"
+#include "ray/common/id.h"
+#include "src/ray/protobuf/core_worker.pb.h"
+
+namespace ray {
+namespace benchmark {
+
+namespace {
+
+/// A serialized reply of a task with the given number of small inlined returns.
+std::string SerializedPushTaskReply(int64_t num_returns) {
+  rpc::PushTaskReply reply;
+  for (int64_t i = 0; i < num_returns; ++i) {
+    auto *return_object = reply.add_return_objects();
+    return_object->set_object_id(ObjectID::FromRandom().Binary());
+    return_object->set_data(std::string(64, 'x'));
+    return_object->set_metadata("RAW");
+    return_object->set_size(64);
+  }
+  return reply.SerializeAsString();
+}
+
+void BM_ParseReplyOnHeap(State &state) {
+  const auto serialized = SerializedPushTaskReply(state.range());
+  while (state.KeepRunning()) {
+    rpc::PushTaskReply reply;
+    DoNotOptimize(reply.ParseFromString(serialized));
+  }
+}
+RAY_BENCHMARK(BM_ParseReplyOnHeap)->Arg(1)->Arg(16)->Arg(256);
+
+void BM_ParseReplyOnArena(State &state) {
+  const auto serialized = SerializedPushTaskReply(state.range());
+  while (state.KeepRunning()) {
+    google::protobuf::Arena arena;
+    auto *reply = google::protobuf::Arena::CreateMessage<rpc::PushTaskReply>(&arena);
+    DoNotOptimize(reply->ParseFromString(serialized));
+  }
+}
+RAY_BENCHMARK(BM_ParseReplyOnArena)->Arg(1)->Arg(16)->Arg(256);
+
+}  // namespace
+
+}  // namespace benchmark
+}  // namespace ray
@@ -26,9 +26,14 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
+#include "boost/asio/steady_timer.hpp"
+#include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/pubsub/subscriber.h"
 #include "ray/rpc/grpc_client.h"
@@ -52,12 +57,22 @@ struct hash<ray::rpc::Address> {
 namespace ray {
 namespace rpc {
 
+/// Pushed tasks reply with their return objects, which are parsed into the arena of the
+/// call.
+template <>
+struct ParseReplyIntoArena<PushTaskReply> : std::true_type {};
+template <>
+struct ParseReplyIntoArena<PushTaskBatchReply> : std::true_type {};
+
 /// The maximum number of requests in flight per client.
 const int64_t kMaxBytesInFlight = 16 * 1024 * 1024;
 
 /// The base size in bytes per request.
 const int64_t kBaseRequestSize = 1024;
 
+/// The maximum size in bytes of the tasks in one PushActorTaskBatch request.
+const int64_t kMaxBytesPerBatch = 1024 * 1024;
+
 /// Get the estimated size in bytes of the given task.
 const static int64_t RequestSizeInBytes(const PushTaskRequest &request) {
   int64_t size = kBaseRequestSize;
@@ -100,6 +115,13 @@ class CoreWorkerClientInterface : public pubsub::SubscriberClientInterface {
   virtual void PushNormalTask(std::unique_ptr<PushTaskRequest> request,
                               const ClientCallback<PushTaskReply> &callback) {}
 
+  /// Similar to PushNormalTask, but pushes multiple tasks in one request. It's replied
+  /// as soon as any task of the caller finishes, and a request without tasks waits for
+  /// the replies of the tasks pushed earlier.
+  virtual void PushNormalTaskBatch(
+      std::unique_ptr<PushTaskBatchRequest> request,
+      const ClientCallback<PushTaskBatchReply> &callback) {}
+
   /// Get the number of pending tasks for this worker.
   ///
   /// \param[in] request The request message.
@@ -209,7 +231,11 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   /// \param[in] address Address of the worker server.
   /// \param[in] client_call_manager The `ClientCallManager` used for managing requests.
   CoreWorkerClient(const rpc::Address &address, ClientCallManager &client_call_manager)
-      : addr_(address) {
+      : addr_(address),
+        max_actor_tasks_per_batch_(
+            ::RayConfig::instance().max_actor_tasks_per_push_batch()),
+        batch_window_us_(::RayConfig::instance().actor_task_push_batch_window_us()),
+        batch_timer_(client_call_manager.GetMainService()) {
     grpc_client_ = std::make_unique<GrpcClient<CoreWorkerService>>(
         addr_.ip_address(), addr_.port(), client_call_manager);
   };
@@ -381,6 +407,20 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
                     /*method_timeout_ms*/ -1);
   }
 
+  void PushNormalTaskBatch(std::unique_ptr<PushTaskBatchRequest> request,
+                           const ClientCallback<PushTaskBatchReply> &callback) override {
+    for (auto &task_request : *request->mutable_requests()) {
+      task_request.set_sequence_number(-1);
+      task_request.set_client_processed_up_to(-1);
+    }
+    INVOKE_RPC_CALL(CoreWorkerService,
+                    PushTaskBatch,
+                    *request,
+                    callback,
+                    grpc_client_,
+                    /*method_timeout_ms*/ -1);
+  }
+
   void NumPendingTasks(std::unique_ptr<NumPendingTasksRequest> request,
                        const ClientCallback<NumPendingTasksReply> &callback) override {
     INVOKE_RPC_CALL(CoreWorkerService,
@@ -398,6 +438,10 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   /// See direct_actor.proto for a description of the ordering protocol.
   void SendRequests() {
     absl::MutexLock lock(&mutex_);
+    if (max_actor_tasks_per_batch_ > 1) {
+      SendBatchedRequests(/*flush=*/false);
+      return;
+    }
     auto this_ptr = this->shared_from_this();
 
     while (!send_queue_.empty() && rpc_bytes_in_flight_ < kMaxBytesInFlight) {
@@ -445,6 +489,126 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   }
 
  private:
+  /// A task pushed in a PushActorTaskBatch request, which is waiting for its reply.
+  struct BatchedTask {
+    int64_t seq_no;
+    int64_t task_size;
+    ClientCallback<PushTaskReply> callback;
+  };
+
+  /// Send the queued tasks in PushActorTaskBatch requests, under the same limit of
+  /// bytes in flight as SendRequests.
+  ///
+  /// A batch is sent right away if it's full or no batch is in flight. Otherwise, it
+  /// waits up to the batch window for more tasks, unless `flush` is set. The replies
+  /// of the tasks can be returned by any later request, so a request that only waits
+  /// for replies is sent if there are pending tasks but no request in flight.
+  void SendBatchedRequests(bool flush) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    while (!send_queue_.empty() && rpc_bytes_in_flight_ < kMaxBytesInFlight) {
+      if (!flush && num_batches_in_flight_ > 0 &&
+          static_cast<int64_t>(send_queue_.size()) < max_actor_tasks_per_batch_) {
+        if (!batch_timer_armed_) {
+          batch_timer_armed_ = true;
+          batch_timer_.expires_after(std::chrono::microseconds(batch_window_us_));
+          batch_timer_.async_wait(
+              [this, this_ptr = shared_from_this()](const boost::system::error_code &) {
+                absl::MutexLock lock(&mutex_);
+                batch_timer_armed_ = false;
+                SendBatchedRequests(/*flush=*/true);
+              });
+        }
+        return;
+      }
+
+      auto request = std::make_unique<PushActorTaskBatchRequest>();
+      int64_t batch_bytes = 0;
+      while (!send_queue_.empty() &&
+             request->requests_size() < max_actor_tasks_per_batch_ &&
+             batch_bytes < kMaxBytesPerBatch &&
+             rpc_bytes_in_flight_ < kMaxBytesInFlight) {
+        auto task_request = std::move(send_queue_.front().first);
+        auto callback = std::move(send_queue_.front().second);
+        send_queue_.pop_front();
+        const int64_t task_size = RequestSizeInBytes(*task_request);
+        task_request->set_client_processed_up_to(max_finished_seq_no_);
+        rpc_bytes_in_flight_ += task_size;
+        batch_bytes += task_size;
+        caller_worker_id_ = task_request->task_spec().caller_address().worker_id();
+        batched_tasks_.emplace(
+            task_request->task_spec().task_id(),
+            BatchedTask{task_request->sequence_number(), task_size, std::move(callback)});
+        request->mutable_requests()->Add(std::move(*task_request));
+      }
+      SendBatch(std::move(request));
+    }
+
+    if (num_batches_in_flight_ == 0 && !batched_tasks_.empty()) {
+      SendBatch(std::make_unique<PushActorTaskBatchRequest>());
+    }
+  }
+
+  /// Send a PushActorTaskBatch request, and run the callbacks of the tasks whose
+  /// replies are returned.
+  void SendBatch(std::unique_ptr<PushActorTaskBatchRequest> request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    request->set_intended_worker_id(addr_.worker_id());
+    request->set_caller_worker_id(caller_worker_id_);
+    num_batches_in_flight_++;
+    auto rpc_callback = [this, this_ptr = shared_from_this()](
+                            Status status, const PushActorTaskBatchReply &reply) {
+      const PushTaskReply empty_reply;
+      std::vector<
+          std::tuple<ClientCallback<PushTaskReply>, Status, const PushTaskReply *>>
+          callbacks;
+      {
+        absl::MutexLock lock(&mutex_);
+        num_batches_in_flight_--;
+        if (status.ok()) {
+          for (const auto &task_reply : reply.task_replies()) {
+            auto it = batched_tasks_.find(task_reply.task_id());
+            if (it == batched_tasks_.end()) {
+              // The task has already been failed.
+              continue;
+            }
+            OnBatchedTaskDone(it->second);
+            callbacks.emplace_back(
+                std::move(it->second.callback),
+                Status::FromCode(static_cast<StatusCode>(task_reply.status_code()),
+                                 task_reply.status_message()),
+                &task_reply.reply());
+            batched_tasks_.erase(it);
+          }
+        } else {
+          // Fail all of the tasks waiting for replies, as their own PushTask RPCs
+          // would fail if the actor is unreachable.
+          for (auto &[_, task] : batched_tasks_) {
+            OnBatchedTaskDone(task);
+            callbacks.emplace_back(std::move(task.callback), status, &empty_reply);
+          }
+          batched_tasks_.clear();
+        }
+      }
+      SendRequests();
+      for (const auto &[callback, task_status, task_reply] : callbacks) {
+        callback(task_status, *task_reply);
+      }
+    };
+    RAY_UNUSED(INVOKE_RPC_CALL(CoreWorkerService,
+                               PushActorTaskBatch,
+                               *request,
+                               std::move(rpc_callback),
+                               grpc_client_,
+                               /*method_timeout_ms*/ -1));
+  }
+
+  void OnBatchedTaskDone(const BatchedTask &task) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (task.seq_no > max_finished_seq_no_) {
+      max_finished_seq_no_ = task.seq_no;
+    }
+    rpc_bytes_in_flight_ -= task.task_size;
+    RAY_CHECK(rpc_bytes_in_flight_ >= 0);
+  }
+
   /// Protects against unsafe concurrent access from the callback thread.
   absl::Mutex mutex_;
 
@@ -463,6 +627,29 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
 
   /// The max sequence number we have processed responses for.
   int64_t max_finished_seq_no_ ABSL_GUARDED_BY(mutex_) = -1;
+
+  /// The maximum number of actor tasks in one PushActorTaskBatch request. Actor tasks
+  /// are pushed one per PushTask request if it's 1.
+  const int64_t max_actor_tasks_per_batch_;
+
+  /// How long a partial batch waits for more tasks while another batch is in flight.
+  const int64_t batch_window_us_;
+
+  /// Sends the partial batch when the batch window is over.
+  boost::asio::steady_timer batch_timer_ ABSL_GUARDED_BY(mutex_);
+
+  /// Whether the batch timer is waiting.
+  bool batch_timer_armed_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /// The tasks pushed in PushActorTaskBatch requests which are waiting for replies,
+  /// keyed by task ID.
+  absl::flat_hash_map<std::string, BatchedTask> batched_tasks_ ABSL_GUARDED_BY(mutex_);
+
+  /// The number of PushActorTaskBatch requests in flight.
+  int64_t num_batches_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// The ID of the worker which pushes the tasks.
+  std::string caller_worker_id_ ABSL_GUARDED_BY(mutex_);
 };
 
 typedef std::function<std::shared_ptr<CoreWorkerClientInterface>(const rpc::Address &)>
@@ -0,0 +1,99 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/stats/bound_metric.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace stats {
+
+namespace {
+
+/// A helper for getting the index of the shards of the calling thread.
+size_t GetThreadShardIndex() {
+  static std::atomic<size_t> next_index{0};
+  thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+}  // namespace
+
+BoundMetric::BoundMetric(std::vector<double> boundaries)
+    : boundaries_(std::move(boundaries)), harvested_(boundaries_.size() + 1) {
+  RAY_CHECK(std::is_sorted(boundaries_.begin(), boundaries_.end()));
+  for (auto &shard : shards_) {
+    shard.buckets.reset(new Bucket[boundaries_.size() + 1]);
+  }
+}
+
+BoundMetric::Shard &BoundMetric::LocalShard() {
+  return shards_[GetThreadShardIndex() % kNumShards];
+}
+
+void BoundMetric::Record(double value) {
+  // Bucket i holds the values in [boundaries_[i - 1], boundaries_[i]), like the
+  // opencensus distributions.
+  const size_t index =
+      std::upper_bound(boundaries_.begin(), boundaries_.end(), value) -
+      boundaries_.begin();
+  auto &bucket = LocalShard().buckets[index];
+  bucket.count.fetch_add(1, std::memory_order_relaxed);
+  // std::atomic<double> has no fetch_add before C++20. The shard is mostly used by a
+  // single thread, so the exchange rarely fails.
+  double sum = bucket.sum.load(std::memory_order_relaxed);
+  while (!bucket.sum.compare_exchange_weak(
+      sum, sum + value, std::memory_order_relaxed, std::memory_order_relaxed)) {
+  }
+}
+
+void BoundMetric::Harvest(const std::function<void(double mean, int64_t count)> &record) {
+  for (size_t i = 0; i < harvested_.size(); i++) {
+    int64_t count = 0;
+    double sum = 0;
+    for (const auto &shard : shards_) {
+      count += shard.buckets[i].count.load(std::memory_order_relaxed);
+      sum += shard.buckets[i].sum.load(std::memory_order_relaxed);
+    }
+    auto &harvested = harvested_[i];
+    const int64_t new_count = count - harvested.count;
+    if (new_count == 0) {
+      // The sum of a value being recorded is left to the next harvest with its count.
+      continue;
+    }
+    double mean = (sum - harvested.sum) / new_count;
+    harvested.count = count;
+    harvested.sum = sum;
+    // The count and the sum of a value being recorded may be harvested separately, so
+    // the mean is kept in the bucket.
+    if (i > 0) {
+      mean = std::max(mean, boundaries_[i - 1]);
+    }
+    if (i < boundaries_.size()) {
+      mean = std::min(
+          mean,
+          std::nextafter(boundaries_[i], -std::numeric_limits<double>::infinity()));
+    }
+    record(mean, new_count);
+  }
+}
+
+}  // namespace stats
+
+}  // namespace ray
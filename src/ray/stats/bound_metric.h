@@ -0,0 +1,85 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ray {
+
+namespace stats {
+
+/// The values recorded for a metric with a fixed set of tag values, see
+/// internal::Stats::Bind.
+///
+/// Recording a value is an atomic add into the shard of the calling thread, without
+/// building a tag map or taking the opencensus locks. Every shard keeps the count and
+/// the sum of the values in each histogram bucket, and the shards are folded together
+/// when the metric is harvested, once per harvest interval.
+///
+/// Record is thread-safe. Harvest must not be called concurrently with itself.
+class BoundMetric {
+ public:
+  /// \param boundaries The sorted boundaries of the histogram buckets. The values of
+  /// a metric without buckets are kept in a single bucket.
+  explicit BoundMetric(std::vector<double> boundaries);
+
+  BoundMetric(const BoundMetric &) = delete;
+  BoundMetric &operator=(const BoundMetric &) = delete;
+
+  /// Record a value.
+  void Record(double value);
+
+  /// Fold the values recorded since the last harvest.
+  ///
+  /// \param record Called for every bucket which got values, with the mean of the
+  /// values and their count. The mean is within the bucket, so recording it count
+  /// times keeps the bucket counts, the count and the sum of a view.
+  void Harvest(const std::function<void(double mean, int64_t count)> &record);
+
+ private:
+  struct Bucket {
+    std::atomic<int64_t> count{0};
+    std::atomic<double> sum{0};
+  };
+
+  struct alignas(64) Shard {
+    std::unique_ptr<Bucket[]> buckets;
+  };
+
+  /// The count and the sum of a bucket as of the last harvest.
+  struct HarvestedBucket {
+    int64_t count = 0;
+    double sum = 0;
+  };
+
+  static constexpr size_t kNumShards = 8;
+
+  /// Get the shard of the calling thread.
+  Shard &LocalShard();
+
+  const std::vector<double> boundaries_;
+
+  std::array<Shard, kNumShards> shards_;
+
+  std::vector<HarvestedBucket> harvested_;
+};
+
+}  // namespace stats
+
+}  // namespace ray
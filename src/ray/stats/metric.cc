@@ -14,9 +14,12 @@
 
 #include "ray/stats/metric.h"
 
+#include <algorithm>
+
 #include "opencensus/stats/internal/aggregation_window.h"
 #include "opencensus/stats/internal/set_aggregation_window.h"
 #include "opencensus/stats/measure_registry.h"
+#include "opencensus/tags/tag_map.h"
 
 namespace ray {
 
@@ -41,6 +44,82 @@ void RegisterAsView(opencensus::stats::ViewDescriptor view_descriptor,
   view_descriptor.RegisterForExport();
 }
 
+namespace {
+
+/// Protects the stats which have bound metrics. It's never destroyed, since the stats
+/// are globals which unregister themselves when they're destroyed.
+ABSL_CONST_INIT absl::Mutex bound_stats_mutex(absl::kConstInit);
+
+std::vector<Stats *> &BoundStats() ABSL_EXCLUSIVE_LOCKS_REQUIRED(bound_stats_mutex) {
+  static auto *bound_stats = new std::vector<Stats *>();
+  return *bound_stats;
+}
+
+}  // namespace
+
+Stats::~Stats() {
+  absl::MutexLock lock(&bound_stats_mutex);
+  auto &bound_stats = BoundStats();
+  bound_stats.erase(std::remove(bound_stats.begin(), bound_stats.end(), this),
+                    bound_stats.end());
+}
+
+BoundMetric &Stats::Bind(
+    const std::vector<std::pair<opencensus::tags::TagKey, std::string>> &tags) {
+  RAY_CHECK(!is_gauge_) << "A gauge can't be bound, since its last value would be lost.";
+  BoundMetric *metric;
+  bool first_bound_metric;
+  {
+    absl::MutexLock lock(&bound_metrics_mutex_);
+    for (const auto &[bound_tags, bound_metric] : bound_metrics_) {
+      if (bound_tags == tags) {
+        return *bound_metric;
+      }
+    }
+    for (const auto &[tag_key, tag_val] : tags) {
+      CheckPrintableChar(tag_val);
+    }
+    first_bound_metric = bound_metrics_.empty();
+    bound_metrics_.emplace_back(tags, std::make_unique<BoundMetric>(buckets_));
+    metric = bound_metrics_.back().second.get();
+  }
+  // The stats are registered without holding the lock of the bound metrics, which is
+  // taken under bound_stats_mutex when they're harvested.
+  if (first_bound_metric) {
+    absl::MutexLock lock(&bound_stats_mutex);
+    BoundStats().push_back(this);
+  }
+  return *metric;
+}
+
+void Stats::HarvestBoundMetrics() {
+  if (StatsConfig::instance().IsStatsDisabled() || !measure_) {
+    return;
+  }
+  absl::MutexLock lock(&bound_metrics_mutex_);
+  for (auto &bound_metric : bound_metrics_) {
+    const auto &tags = bound_metric.first;
+    std::unique_ptr<opencensus::tags::TagMap> tag_map;
+    bound_metric.second->Harvest([&](double mean, int64_t count) {
+      if (tag_map == nullptr) {
+        TagsType combined_tags = StatsConfig::instance().GetGlobalTags();
+        combined_tags.insert(combined_tags.end(), tags.begin(), tags.end());
+        tag_map = std::make_unique<opencensus::tags::TagMap>(std::move(combined_tags));
+      }
+      for (int64_t i = 0; i < count; i++) {
+        opencensus::stats::Record({{*measure_, mean}}, *tag_map);
+      }
+    });
+  }
+}
+
+void HarvestBoundMetrics() {
+  absl::MutexLock lock(&bound_stats_mutex);
+  for (auto *stats : BoundStats()) {
+    stats->HarvestBoundMetrics();
+  }
+}
+
 }  // namespace internal
 ///
 /// Stats Config
@@ -22,10 +22,13 @@
 #include <unordered_map>
 #include <utility>  // std::pair
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "gtest/gtest_prod.h"
 #include "opencensus/stats/stats.h"
 #include "opencensus/stats/stats_exporter.h"
 #include "opencensus/tags/tag_key.h"
+#include "ray/stats/bound_metric.h"
 #include "ray/util/logging.h"
 namespace ray {
 
@@ -283,6 +286,12 @@ void RegisterViewWithTagList(const std::string &name,
   RegisterViewWithTagList<Ts...>(name, description, tag_keys, buckets);
 }
 
+/// Whether a metric of the given types is a gauge.
+template <StatsType... Ts>
+constexpr bool IsGauge() {
+  return ((Ts == GAUGE) || ...);
+}
+
 inline std::vector<opencensus::tags::TagKey> convert_tags(
     const std::vector<std::string> &names) {
   std::vector<opencensus::tags::TagKey> ret;
@@ -306,6 +315,7 @@ class Stats {
   /// \param measure The name for the metric
   /// \description The description for the metric
   /// \register_func The function to register the metric
+  /// \is_gauge Whether the metric is a gauge, which can't be bound
   Stats(const std::string &measure,
         const std::string &description,
         std::vector<std::string> tag_keys,
@@ -313,8 +323,9 @@ class Stats {
         std::function<void(const std::string &,
                            const std::string,
                            const std::vector<opencensus::tags::TagKey>,
-                           const std::vector<double> &buckets)> register_func)
-      : tag_keys_(convert_tags(tag_keys)) {
+                           const std::vector<double> &buckets)> register_func,
+        bool is_gauge = false)
+      : tag_keys_(convert_tags(tag_keys)), buckets_(buckets), is_gauge_(is_gauge) {
     auto stats_init = [register_func, measure, description, buckets, this]() {
       measure_ = std::make_unique<Measure>(Measure::Register(measure, description, ""));
       register_func(measure, description, tag_keys_, buckets);
@@ -377,6 +388,31 @@ class Stats {
     opencensus::stats::Record({{*measure_, val}}, std::move(combined_tags));
   }
 
+  ~Stats();
+
+  /// Bind tag values to get a metric that records values for them. Recording with the
+  /// bound metric doesn't build the tags or take the opencensus locks. The values are
+  /// folded into this metric every harvest interval, see BoundMetric.
+  ///
+  /// Binding the same tag values again returns the same metric, which lives as long
+  /// as this.
+  ///
+  /// A gauge can't be bound: the harvest replays the count and the mean of the values,
+  /// while a gauge must keep the last one.
+  ///
+  /// \param tags Registered tags and corresponding tag values.
+  BoundMetric &Bind(
+      const std::vector<std::pair<opencensus::tags::TagKey, std::string>> &tags);
+
+  /// Bind a tag value. This method will assume we only have one tag for this metric.
+  BoundMetric &Bind(std::string tag_val) {
+    RAY_CHECK(tag_keys_.size() == 1);
+    return Bind({{tag_keys_[0], std::move(tag_val)}});
+  }
+
+  /// Fold the values recorded with the bound metrics into this metric.
+  void HarvestBoundMetrics();
+
  private:
   void CheckPrintableChar(const std::string &val) {
 #ifndef NDEBUG
@@ -389,9 +425,20 @@ class Stats {
   }
 
   const std::vector<opencensus::tags::TagKey> tag_keys_;
+  const std::vector<double> buckets_;
+  const bool is_gauge_;
   std::unique_ptr<opencensus::stats::Measure<double>> measure_;
+
+  absl::Mutex bound_metrics_mutex_;
+  /// The bound metrics, and their tags.
+  std::vector<std::pair<TagsType, std::unique_ptr<BoundMetric>>> bound_metrics_
+      ABSL_GUARDED_BY(bound_metrics_mutex_);
 };
 
+/// Fold the values recorded with the bound metrics of all the stats. It's called every
+/// harvest interval by the stats module.
+void HarvestBoundMetrics();
+
 }  // namespace internal
 
 }  // namespace stats
@@ -429,10 +476,11 @@ class Stats {
           (), ray::stats::GAUGE);
       STATS_async_pool_req_execution_time_ms.record(1, "method");
 */
-#define DEFINE_stats(name, description, tags, buckets, ...) \
-  ray::stats::internal::Stats STATS_##name(                 \
-      #name,                                                \
-      description,                                          \
-      {STATS_DEPAREN(tags)},                                \
-      {STATS_DEPAREN(buckets)},                             \
-      ray::stats::internal::RegisterViewWithTagList<__VA_ARGS__>)
+#define DEFINE_stats(name, description, tags, buckets, ...)       \
+  ray::stats::internal::Stats STATS_##name(                       \
+      #name,                                                      \
+      description,                                                \
+      {STATS_DEPAREN(tags)},                                      \
+      {STATS_DEPAREN(buckets)},                                   \
+      ray::stats::internal::RegisterViewWithTagList<__VA_ARGS__>, \
+      ray::stats::internal::IsGauge<__VA_ARGS__>())
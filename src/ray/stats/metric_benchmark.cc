@@ -0,0 +1,90 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of recording a histogram metric with a tag value from many threads, with
+// Stats::Record and with a metric bound to the tag value.
+//
+// It's not run by default. Run it with
+//   bazel run -c opt //:metric_benchmark
+
+#include <thread>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/stats/stats.h"
+
+DEFINE_stats(benchmark_hist,
+             "The histogram recorded by the benchmark.",
+             ("Type"),
+             (1, 10, 100, 1000, 10000),
+             ray::stats::HISTOGRAM);
+
+namespace ray {
+
+namespace {
+
+constexpr int kNumRecordsPerThread = 1000 * 1000;
+
+class MetricBenchmark : public ::testing::TestWithParam<int> {
+ public:
+  void SetUp() override {
+    std::shared_ptr<stats::MetricExporterClient> exporter(
+        new stats::StdoutExporterClient());
+    ray::stats::Init({}, /*metrics_agent_port=*/10054, WorkerID::Nil(), exporter);
+  }
+
+  void TearDown() override { ray::stats::Shutdown(); }
+
+  void Run(const std::string &name, const std::function<void(double)> &record) {
+    const int num_threads = GetParam();
+    const auto start = absl::GetCurrentTimeNanos();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([&record]() {
+        for (int j = 0; j < kNumRecordsPerThread; j++) {
+          record(j % 20000);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const auto end = absl::GetCurrentTimeNanos();
+    std::cout << name << " with " << num_threads << " threads: "
+              << (end - start) / static_cast<double>(kNumRecordsPerThread) << " ns/record"
+              << ", " << num_threads * kNumRecordsPerThread / ((end - start) / 1e9)
+              << " records/s" << std::endl;
+  }
+};
+
+TEST_P(MetricBenchmark, Record) {
+  Run("Record", [](double value) { STATS_benchmark_hist.Record(value, "Benchmark"); });
+}
+
+TEST_P(MetricBenchmark, BoundRecord) {
+  auto &metric = STATS_benchmark_hist.Bind("Benchmark");
+  Run("BoundRecord", [&metric](double value) { metric.Record(value); });
+}
+
+INSTANTIATE_TEST_SUITE_P(MetricBenchmark, MetricBenchmark, ::testing::Values(1, 4, 16));
+
+}  // namespace
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -141,6 +141,18 @@ DEFINE_stats(operation_active_count,
              (),
              ray::stats::GAUGE);
 
+/// Event loop watchdog
+DEFINE_stats(io_context_lag_ms,
+             "The lag of an event loop, i.e. the queueing time of its heartbeats.",
+             ("Name"),
+             (1, 10, 100, 1000, 10000),
+             ray::stats::HISTOGRAM);
+DEFINE_stats(io_context_stalls,
+             "The number of times an event loop was stalled.",
+             ("Name"),
+             (),
+             ray::stats::COUNT);
+
 /// GRPC server
 DEFINE_stats(grpc_server_req_process_time_ms,
              "Request latency in grpc server",
@@ -356,6 +368,47 @@ DEFINE_stats(
     ("Type", "Name"),
     (),
     ray::stats::COUNT);
+
+/// Ray Syncer
+DEFINE_stats(ray_syncer_propagation_latency_ms,
+             "Time between a sync message being created by its reporter and being "
+             "consumed by a node, broken down by message type.",
+             ("Type"),
+             ({1, 10, 100, 1000, 10000}),
+             ray::stats::HISTOGRAM);
+
+/// Lease Request Rate Limiter
+DEFINE_stats(lease_request_rate_limit,
+             "The max number of pending lease requests per scheduling category set by "
+             "the adaptive lease request rate limiter of the worker.",
+             (),
+             (),
+             ray::stats::GAUGE);
+
+DEFINE_stats(lease_request_replies_total,
+             "Number of lease request replies seen by the adaptive lease request rate "
+             "limiter, broken down by outcome {Granted, SpilledBack, Rejected, Canceled, "
+             "Failed}.",
+             ("Outcome"),
+             (),
+             ray::stats::COUNT);
+
+DEFINE_stats(lease_request_latency_ms,
+             "Time between a worker sending a lease request and receiving the reply, "
+             "broken down by outcome.",
+             ("Outcome"),
+             ({1, 10, 100, 1000, 10000}),
+             ray::stats::HISTOGRAM);
+
+/// Worker Leases
+DEFINE_stats(worker_lease_reuse_total,
+             "Number of times a worker needed for a scheduling key is taken from the "
+             "idle workers leased for other scheduling keys of the same resource shape "
+             "(Hit), or leased from a raylet (Miss). Only recorded when leases are "
+             "reused across scheduling keys.",
+             ("Result"),
+             (),
+             ray::stats::COUNT);
 }  // namespace stats
 
 }  // namespace ray
@@ -57,6 +57,10 @@ DECLARE_stats(operation_run_time_ms);
 DECLARE_stats(operation_queue_time_ms);
 DECLARE_stats(operation_active_count);
 
+/// Event loop watchdog
+DECLARE_stats(io_context_lag_ms);
+DECLARE_stats(io_context_stalls);
+
 /// GRPC server
 DECLARE_stats(grpc_server_req_process_time_ms);
 DECLARE_stats(grpc_server_req_new);
@@ -119,6 +123,17 @@ DECLARE_stats(gcs_actors_count);
 /// Memory Manager
 DECLARE_stats(memory_manager_worker_eviction_total);
 
+/// Ray Syncer
+DECLARE_stats(ray_syncer_propagation_latency_ms);
+
+/// Lease Request Rate Limiter
+DECLARE_stats(lease_request_rate_limit);
+DECLARE_stats(lease_request_replies_total);
+DECLARE_stats(lease_request_latency_ms);
+
+/// Worker Leases
+DECLARE_stats(worker_lease_reuse_total);
+
 /// The below items are legacy implementation of metrics.
 /// TODO(sang): Use DEFINE_stats instead.
 
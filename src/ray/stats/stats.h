@@ -26,6 +26,7 @@
 #include "opencensus/tags/tag_key.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/asio/io_service_pool.h"
+#include "ray/common/asio/periodical_runner.h"
 #include "ray/common/id.h"
 #include "ray/common/ray_config.h"
 #include "ray/stats/metric.h"
@@ -42,6 +43,7 @@ namespace stats {
 // TODO(sang) Put all states and logic into a singleton class Stats.
 static std::shared_ptr<IOServicePool> metrics_io_service_pool;
 static std::shared_ptr<MetricExporterClient> exporter;
+static std::shared_ptr<PeriodicalRunner> bound_metrics_harvester;
 static absl::Mutex stats_mutex;
 
 /// Initialize stats for a process.
@@ -116,6 +118,13 @@ static inline void Init(
   for (auto &f : StatsConfig::instance().PopInitializers()) {
     f();
   }
+
+  // Fold the values of the bound metrics into opencensus before it harvests them.
+  bound_metrics_harvester = std::make_shared<PeriodicalRunner>(*metrics_io_service);
+  bound_metrics_harvester->RunFnPeriodically(
+      []() { internal::HarvestBoundMetrics(); },
+      absl::ToInt64Milliseconds(StatsConfig::instance().GetHarvestInterval()),
+      "Stats.HarvestBoundMetrics");
   StatsConfig::instance().SetIsInitialized(true);
 }
 
@@ -127,7 +136,10 @@ static inline void Shutdown() {
     // Return if stats had never been initialized.
     return;
   }
+  bound_metrics_harvester = nullptr;
   metrics_io_service_pool->Stop();
+  // Flush the values recorded since the last harvest.
+  internal::HarvestBoundMetrics();
   opencensus::stats::DeltaProducer::Get()->Shutdown();
   opencensus::stats::StatsExporter::Shutdown();
   metrics_io_service_pool = nullptr;
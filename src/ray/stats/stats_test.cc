@@ -39,6 +39,7 @@ DEFINE_stats(test, "TestStats", ("method"), (1.0), ray::stats::COUNT, ray::stats
 DEFINE_stats(
     test_declare, "TestStats2", ("tag1"), (1.0), ray::stats::COUNT, ray::stats::SUM);
 DECLARE_stats(test_declare);
+DEFINE_stats(test_gauge, "TestStats", ("tag1"), (), ray::stats::GAUGE);
 
 namespace ray {
 
@@ -239,6 +240,60 @@ TEST_F(StatsTest, STAT_DEF) {
   STATS_test_declare.Record(1.0, "Test");
 }
 
+TEST(BoundMetricTest, TestHarvest) {
+  stats::BoundMetric metric({1.0, 2.0, 3.0});
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&metric]() {
+      for (int j = 0; j < 1000; j++) {
+        metric.Record(0.5);
+        metric.Record(2.0);
+        metric.Record(2.5);
+        metric.Record(10.0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<std::pair<double, int64_t>> harvested;
+  auto record = [&harvested](double mean, int64_t count) {
+    harvested.emplace_back(mean, count);
+  };
+  metric.Harvest(record);
+  std::vector<std::pair<double, int64_t>> expected{
+      {0.5, 4000}, {2.25, 8000}, {10.0, 4000}};
+  ASSERT_EQ(harvested, expected);
+
+  // Only the values recorded since the last harvest are folded.
+  harvested.clear();
+  metric.Harvest(record);
+  ASSERT_TRUE(harvested.empty());
+  metric.Record(1.0);
+  metric.Record(1.5);
+  metric.Harvest(record);
+  expected = {{1.25, 2}};
+  ASSERT_EQ(harvested, expected);
+}
+
+TEST_F(StatsTest, TestBind) {
+  auto &metric = STATS_test_declare.Bind("Test");
+  ASSERT_EQ(&metric, &STATS_test_declare.Bind("Test"));
+  ASSERT_NE(&metric, &STATS_test_declare.Bind("Test2"));
+  auto &hist_metric =
+      STATS_test_hist.Bind({{stats::TagKeyType::Register("method"), "Test"},
+                            {stats::TagKeyType::Register("method2"), "Test"}});
+  for (size_t i = 0; i < 100; ++i) {
+    metric.Record(1.0);
+    hist_metric.Record(i % 5);
+  }
+  stats::internal::HarvestBoundMetrics();
+
+  // The last value of a gauge would be lost by the bound metric.
+  ASSERT_DEATH(STATS_test_gauge.Bind("Test"), "gauge");
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
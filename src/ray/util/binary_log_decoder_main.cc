@@ -0,0 +1,39 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Render the binary logs written with RAY_BACKEND_LOG_BINARY=1 as text, e.g.
+//   binary_log_decoder /tmp/ray/session_latest/logs/raylet_1234.binlog
+
+#include <fstream>
+#include <iostream>
+
+#include "ray/util/binary_logging.h"
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <binary log file>" << std::endl;
+    return 1;
+  }
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "Failed to open " << argv[1] << std::endl;
+    return 1;
+  }
+  if (!ray::DecodeBinaryLog(in, std::cout)) {
+    std::cerr << "The binary log " << argv[1] << " is malformed or truncated."
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,606 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/binary_logging.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ray/util/stack_trace.h"
+#include "ray/util/util.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ray {
+
+namespace {
+
+/// The file starts with the magic and the pid, followed by the records, each starting
+/// with its kind:
+///   kEntry: size (uint32), timestamp in ns (int64), file id (uint32), line (int32),
+///     severity (int8), and the arguments, each starting with its BinaryLogArgType.
+///   kFileName: file id (uint32), size (uint32) and the base name of the file.
+///   kThread: thread id (int64) of the entries that follow.
+///   kDropped: thread id (int64) and the number of entries dropped (uint64).
+///   kChunkEnd: the end of the records drained together, which are written thread by
+///     thread.
+constexpr char kMagic[] = "RAYBLOG1";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+
+enum RecordKind : uint8_t {
+  kEntry = 0,
+  kFileName = 1,
+  kThread = 2,
+  kDropped = 3,
+  kChunkEnd = 4,
+};
+
+/// The size of the buffer of every thread that logs, which must be a power of 2.
+constexpr uint64_t kThreadBufferSize = 256 * 1024;
+
+/// How often the background thread writes the records.
+constexpr absl::Duration kWriteInterval = absl::Milliseconds(10);
+
+template <typename V>
+void AppendRaw(std::string *buffer, V value) {
+  buffer->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+const char *ConstBasename(const char *filepath) {
+  const char *base = strrchr(filepath, '/');
+#ifdef _WIN32
+  if (!base) base = strrchr(filepath, '\\');
+#endif
+  return base ? (base + 1) : filepath;
+}
+
+/// The buffer of the records being built by the current thread.
+struct RecordScratch {
+  std::string buffer;
+  bool in_use = false;
+};
+
+thread_local RecordScratch record_scratch;
+
+}  // namespace
+
+BinaryLogRecord::BinaryLogRecord(const char *file_name, int line_number, int severity) {
+  if (!record_scratch.in_use) {
+    record_scratch.in_use = true;
+    buffer_ = &record_scratch.buffer;
+  } else {
+    nested_buffer_ = std::make_unique<std::string>();
+    buffer_ = nested_buffer_.get();
+  }
+  buffer_->clear();
+  buffer_->push_back(static_cast<char>(kEntry));
+  // The size is filled in once the record is complete.
+  AppendRaw(buffer_, static_cast<uint32_t>(0));
+  AppendRaw(buffer_, absl::GetCurrentTimeNanos());
+  AppendRaw(buffer_, BinaryLogWriter::Instance().GetFileId(file_name));
+  AppendRaw(buffer_, static_cast<int32_t>(line_number));
+  AppendRaw(buffer_, static_cast<int8_t>(severity));
+}
+
+BinaryLogRecord::~BinaryLogRecord() {
+  const auto size = static_cast<uint32_t>(buffer_->size() - 1 - sizeof(uint32_t));
+  memcpy(&(*buffer_)[1], &size, sizeof(size));
+  BinaryLogWriter::Instance().Submit(*buffer_);
+  if (nested_buffer_ == nullptr) {
+    record_scratch.in_use = false;
+  }
+}
+
+/// A single-producer single-consumer ring of the bytes of the records of a thread.
+/// The thread is the producer and the background thread is the consumer.
+struct BinaryLogWriter::ThreadBuffer {
+  explicit ThreadBuffer(int64_t thread_id)
+      : thread_id(thread_id), data(new char[kThreadBufferSize]) {}
+
+  const int64_t thread_id;
+  const std::unique_ptr<char[]> data;
+  alignas(64) std::atomic<uint64_t> write_position{0};
+  alignas(64) std::atomic<uint64_t> read_position{0};
+  std::atomic<uint64_t> num_dropped{0};
+  /// Set once the thread exits. The buffer is freed once it's drained.
+  std::atomic<bool> is_retired{false};
+};
+
+struct BinaryLogWriter::State {
+  /// Serializes Start and Stop.
+  absl::Mutex lifecycle_mutex;
+  std::atomic<bool> is_started{false};
+  std::unique_ptr<absl::Notification> stop_writing;
+  std::unique_ptr<std::thread> writer_thread;
+
+  /// Guards the file, so that one thread drains the buffers at a time. It's acquired
+  /// before `mutex`.
+  absl::Mutex write_mutex;
+  std::ofstream file ABSL_GUARDED_BY(write_mutex);
+  /// The records written in a round.
+  std::string chunk ABSL_GUARDED_BY(write_mutex);
+
+  absl::Mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_map<std::string, uint32_t> file_ids ABSL_GUARDED_BY(mutex);
+  std::vector<std::string> file_names ABSL_GUARDED_BY(mutex);
+  /// The number of file names written to the file, which are the first ones.
+  size_t num_file_names_written ABSL_GUARDED_BY(mutex) = 0;
+
+  std::atomic<uint64_t> num_records_dropped{0};
+};
+
+BinaryLogWriter &BinaryLogWriter::Instance() {
+  // It's never destroyed, since the threads may log until the process exits.
+  static auto *instance = new BinaryLogWriter();
+  return *instance;
+}
+
+BinaryLogWriter::BinaryLogWriter() : state_(std::make_unique<State>()) {}
+
+bool BinaryLogWriter::Start(const std::string &file_path) {
+  Stop();
+  absl::MutexLock lifecycle_lock(&state_->lifecycle_mutex);
+  {
+    absl::MutexLock lock(&state_->write_mutex);
+    state_->file.open(file_path, std::ios::binary | std::ios::trunc);
+    if (!state_->file) {
+      return false;
+    }
+#ifdef _WIN32
+    const auto pid = static_cast<uint32_t>(_getpid());
+#else
+    const auto pid = static_cast<uint32_t>(getpid());
+#endif
+    state_->file.write(kMagic, kMagicSize);
+    state_->file.write(reinterpret_cast<const char *>(&pid), sizeof(pid));
+    // The file names are written again to the new file.
+    absl::MutexLock names_lock(&state_->mutex);
+    state_->num_file_names_written = 0;
+  }
+  state_->stop_writing = std::make_unique<absl::Notification>();
+  state_->writer_thread =
+      std::make_unique<std::thread>([this, stop = state_->stop_writing.get()]() {
+        SetThreadName("binary_log");
+        while (!stop->WaitForNotificationWithTimeout(kWriteInterval)) {
+          WriteRecords();
+        }
+      });
+  state_->is_started.store(true, std::memory_order_release);
+  return true;
+}
+
+void BinaryLogWriter::Stop() {
+  absl::MutexLock lifecycle_lock(&state_->lifecycle_mutex);
+  if (!state_->is_started.load(std::memory_order_acquire)) {
+    return;
+  }
+  state_->is_started.store(false, std::memory_order_release);
+  state_->stop_writing->Notify();
+  state_->writer_thread->join();
+  state_->writer_thread.reset();
+  WriteRecords();
+  absl::MutexLock lock(&state_->write_mutex);
+  state_->file.close();
+}
+
+bool BinaryLogWriter::IsStarted() const {
+  return state_->is_started.load(std::memory_order_acquire);
+}
+
+void BinaryLogWriter::Flush() { WriteRecords(); }
+
+bool BinaryLogWriter::TryFlush() {
+  if (!state_->write_mutex.TryLock()) {
+    return false;
+  }
+  WriteRecordsLocked();
+  state_->write_mutex.Unlock();
+  return true;
+}
+
+uint64_t BinaryLogWriter::NumRecordsDropped() const {
+  return state_->num_records_dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t BinaryLogWriter::GetFileId(const char *file_name) {
+  // The file names are literals, so the ids are cached by their addresses.
+  thread_local absl::flat_hash_map<const char *, uint32_t> cached_file_ids;
+  auto it = cached_file_ids.find(file_name);
+  if (it != cached_file_ids.end()) {
+    return it->second;
+  }
+  uint32_t file_id;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    auto [file_id_it, inserted] = state_->file_ids.emplace(
+        ConstBasename(file_name), static_cast<uint32_t>(state_->file_names.size()));
+    if (inserted) {
+      state_->file_names.push_back(file_id_it->first);
+    }
+    file_id = file_id_it->second;
+  }
+  cached_file_ids.emplace(file_name, file_id);
+  return file_id;
+}
+
+BinaryLogWriter::ThreadBuffer &BinaryLogWriter::GetThreadBuffer() {
+  struct ThreadBufferHolder {
+    ~ThreadBufferHolder() {
+      if (buffer != nullptr) {
+        buffer->is_retired.store(true, std::memory_order_release);
+      }
+    }
+    std::shared_ptr<ThreadBuffer> buffer;
+  };
+  thread_local ThreadBufferHolder holder;
+  if (holder.buffer == nullptr) {
+    holder.buffer = std::make_shared<ThreadBuffer>(GetNativeThreadId());
+    absl::MutexLock lock(&state_->mutex);
+    state_->thread_buffers.push_back(holder.buffer);
+  }
+  return *holder.buffer;
+}
+
+void BinaryLogWriter::Submit(const std::string &record) {
+  auto &buffer = GetThreadBuffer();
+  const uint64_t write_position = buffer.write_position.load(std::memory_order_relaxed);
+  const uint64_t read_position = buffer.read_position.load(std::memory_order_acquire);
+  if (kThreadBufferSize - (write_position - read_position) < record.size()) {
+    buffer.num_dropped.fetch_add(1, std::memory_order_relaxed);
+    state_->num_records_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const uint64_t offset = write_position & (kThreadBufferSize - 1);
+  const size_t first_part = std::min<uint64_t>(record.size(), kThreadBufferSize - offset);
+  memcpy(buffer.data.get() + offset, record.data(), first_part);
+  memcpy(buffer.data.get(), record.data() + first_part, record.size() - first_part);
+  buffer.write_position.store(write_position + record.size(), std::memory_order_release);
+}
+
+void BinaryLogWriter::WriteRecords() {
+  absl::MutexLock write_lock(&state_->write_mutex);
+  WriteRecordsLocked();
+}
+
+void BinaryLogWriter::WriteRecordsLocked() {
+  state_->write_mutex.AssertHeld();
+  if (!state_->file.is_open()) {
+    return;
+  }
+  std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    thread_buffers = state_->thread_buffers;
+  }
+
+  auto &chunk = state_->chunk;
+  chunk.clear();
+  std::vector<ThreadBuffer *> drained_retired_buffers;
+  for (const auto &buffer : thread_buffers) {
+    const bool is_retired = buffer->is_retired.load(std::memory_order_acquire);
+    const uint64_t read_position = buffer->read_position.load(std::memory_order_relaxed);
+    const uint64_t write_position =
+        buffer->write_position.load(std::memory_order_acquire);
+    if (write_position != read_position) {
+      chunk.push_back(static_cast<char>(kThread));
+      AppendRaw(&chunk, buffer->thread_id);
+      const uint64_t offset = read_position & (kThreadBufferSize - 1);
+      const uint64_t size = write_position - read_position;
+      const uint64_t first_part = std::min(size, kThreadBufferSize - offset);
+      chunk.append(buffer->data.get() + offset, first_part);
+      chunk.append(buffer->data.get(), size - first_part);
+      buffer->read_position.store(write_position, std::memory_order_release);
+    }
+    const uint64_t num_dropped =
+        buffer->num_dropped.exchange(0, std::memory_order_relaxed);
+    if (num_dropped > 0) {
+      chunk.push_back(static_cast<char>(kDropped));
+      AppendRaw(&chunk, buffer->thread_id);
+      AppendRaw(&chunk, num_dropped);
+    }
+    if (is_retired) {
+      drained_retired_buffers.push_back(buffer.get());
+    }
+  }
+
+  // The file names are written before the entries. They are taken after draining the
+  // buffers, so that they include the names of all the entries drained.
+  std::vector<std::string> new_file_names;
+  size_t first_new_file_id;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    first_new_file_id = state_->num_file_names_written;
+    new_file_names.assign(state_->file_names.begin() + first_new_file_id,
+                          state_->file_names.end());
+    state_->num_file_names_written = state_->file_names.size();
+    auto &buffers = state_->thread_buffers;
+    buffers.erase(std::remove_if(buffers.begin(),
+                                 buffers.end(),
+                                 [&drained_retired_buffers](const auto &buffer) {
+                                   return std::find(drained_retired_buffers.begin(),
+                                                    drained_retired_buffers.end(),
+                                                    buffer.get()) !=
+                                          drained_retired_buffers.end();
+                                 }),
+                  buffers.end());
+  }
+  std::string file_name_records;
+  for (size_t i = 0; i < new_file_names.size(); ++i) {
+    file_name_records.push_back(static_cast<char>(kFileName));
+    AppendRaw(&file_name_records, static_cast<uint32_t>(first_new_file_id + i));
+    AppendRaw(&file_name_records, static_cast<uint32_t>(new_file_names[i].size()));
+    file_name_records.append(new_file_names[i]);
+  }
+
+  if (file_name_records.empty() && chunk.empty()) {
+    return;
+  }
+  if (!chunk.empty()) {
+    chunk.push_back(static_cast<char>(kChunkEnd));
+  }
+  state_->file.write(file_name_records.data(), file_name_records.size());
+  state_->file.write(chunk.data(), chunk.size());
+  state_->file.flush();
+}
+
+namespace {
+
+template <typename V>
+bool ReadRaw(std::istream &in, V *value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(value), sizeof(V)));
+}
+
+/// Reads the fields of an entry.
+class EntryReader {
+ public:
+  explicit EntryReader(const std::string &entry) : entry_(entry) {}
+
+  template <typename V>
+  bool Read(V *value) {
+    if (entry_.size() - position_ < sizeof(V)) {
+      return false;
+    }
+    memcpy(value, entry_.data() + position_, sizeof(V));
+    position_ += sizeof(V);
+    return true;
+  }
+
+  bool ReadString(uint32_t size, std::string_view *value) {
+    if (entry_.size() - position_ < size) {
+      return false;
+    }
+    *value = std::string_view(entry_.data() + position_, size);
+    position_ += size;
+    return true;
+  }
+
+  bool AtEnd() const { return position_ == entry_.size(); }
+
+ private:
+  const std::string &entry_;
+  size_t position_ = 0;
+};
+
+/// The letters of the severities, which are the same as in the text logs.
+char SeverityLetter(int8_t severity) {
+  switch (severity) {
+  case -2:
+    return 'T';
+  case -1:
+    return 'D';
+  case 0:
+    return 'I';
+  case 1:
+    return 'W';
+  case 2:
+    return 'E';
+  case 3:
+    return 'C';
+  default:
+    return '?';
+  }
+}
+
+/// Render an entry in the format of the text logs, i.e.
+/// [2020-08-21 17:00:00,000 I 100 1001] file.cc:10: message
+bool RenderEntry(const std::string &entry,
+                 uint32_t pid,
+                 int64_t thread_id,
+                 const std::vector<std::string> &file_names,
+                 std::ostream &out) {
+  EntryReader reader(entry);
+  int64_t timestamp_ns;
+  uint32_t file_id;
+  int32_t line;
+  int8_t severity;
+  if (!reader.Read(&timestamp_ns) || !reader.Read(&file_id) || !reader.Read(&line) ||
+      !reader.Read(&severity)) {
+    return false;
+  }
+  const auto time = absl::FromUnixNanos(timestamp_ns);
+  const int64_t milliseconds = (timestamp_ns / 1000000) % 1000;
+  out << "[" << absl::FormatTime("%Y-%m-%d %H:%M:%S", time, absl::LocalTimeZone())
+      << "," << std::setfill('0') << std::setw(3) << milliseconds << std::setfill(' ')
+      << " " << SeverityLetter(severity) << " " << pid << " " << thread_id << "] "
+      << (file_id < file_names.size() ? file_names[file_id] : "unknown") << ":"
+      << line << ": ";
+
+  while (!reader.AtEnd()) {
+    uint8_t type;
+    if (!reader.Read(&type)) {
+      return false;
+    }
+    switch (static_cast<BinaryLogArgType>(type)) {
+    case BinaryLogArgType::kInt: {
+      int64_t value;
+      if (!reader.Read(&value)) return false;
+      out << value;
+      break;
+    }
+    case BinaryLogArgType::kUInt: {
+      uint64_t value;
+      if (!reader.Read(&value)) return false;
+      out << value;
+      break;
+    }
+    case BinaryLogArgType::kDouble: {
+      double value;
+      if (!reader.Read(&value)) return false;
+      out << value;
+      break;
+    }
+    case BinaryLogArgType::kBool: {
+      uint8_t value;
+      if (!reader.Read(&value)) return false;
+      out << (value != 0);
+      break;
+    }
+    case BinaryLogArgType::kChar: {
+      char value;
+      if (!reader.Read(&value)) return false;
+      out << value;
+      break;
+    }
+    case BinaryLogArgType::kString: {
+      uint32_t size;
+      std::string_view value;
+      if (!reader.Read(&size) || !reader.ReadString(size, &value)) return false;
+      out << value;
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  out << "\n";
+  return true;
+}
+
+}  // namespace
+
+bool DecodeBinaryLog(std::istream &in, std::ostream &out) {
+  char magic[kMagicSize];
+  uint32_t pid;
+  if (!in.read(magic, kMagicSize) || memcmp(magic, kMagic, kMagicSize) != 0 ||
+      !ReadRaw(in, &pid)) {
+    return false;
+  }
+
+  /// An entry of the chunk being read.
+  struct PendingEntry {
+    int64_t timestamp_ns;
+    int64_t thread_id;
+    std::string entry;
+  };
+  std::vector<PendingEntry> chunk;
+  std::vector<std::string> file_names;
+  int64_t thread_id = 0;
+  // The entries of a chunk are grouped by thread, so they're rendered in the order of
+  // their timestamps once the chunk is read.
+  auto render_chunk = [&]() {
+    std::stable_sort(chunk.begin(), chunk.end(), [](const auto &a, const auto &b) {
+      return a.timestamp_ns < b.timestamp_ns;
+    });
+    bool ok = true;
+    for (const auto &pending : chunk) {
+      if (!RenderEntry(pending.entry, pid, pending.thread_id, file_names, out)) {
+        ok = false;
+        break;
+      }
+    }
+    chunk.clear();
+    return ok;
+  };
+  while (true) {
+    const auto kind = in.get();
+    if (kind == std::char_traits<char>::eof()) {
+      return render_chunk();
+    }
+    bool ok = false;
+    switch (kind) {
+    case kEntry: {
+      uint32_t size;
+      PendingEntry pending{0, thread_id, std::string()};
+      if (ReadRaw(in, &size) && size >= sizeof(pending.timestamp_ns)) {
+        pending.entry.resize(size);
+        if (in.read(pending.entry.data(), size)) {
+          memcpy(&pending.timestamp_ns,
+                 pending.entry.data(),
+                 sizeof(pending.timestamp_ns));
+          chunk.push_back(std::move(pending));
+          ok = true;
+        }
+      }
+      break;
+    }
+    case kFileName: {
+      uint32_t file_id;
+      uint32_t size;
+      if (ReadRaw(in, &file_id) && ReadRaw(in, &size)) {
+        std::string file_name(size, '\0');
+        if (in.read(file_name.data(), size)) {
+          if (file_names.size() <= file_id) {
+            file_names.resize(file_id + 1);
+          }
+          file_names[file_id] = std::move(file_name);
+          ok = true;
+        }
+      }
+      break;
+    }
+    case kThread: {
+      ok = ReadRaw(in, &thread_id);
+      break;
+    }
+    case kDropped: {
+      int64_t dropped_thread_id;
+      uint64_t num_dropped;
+      if (ReadRaw(in, &dropped_thread_id) && ReadRaw(in, &num_dropped)) {
+        out << "*** " << num_dropped << " log records of thread " << dropped_thread_id
+            << " were dropped because its buffer was full ***\n";
+        ok = true;
+      }
+      break;
+    }
+    case kChunkEnd: {
+      if (!render_chunk()) return false;
+      ok = true;
+      break;
+    }
+    default:
+      break;
+    }
+    if (!ok) {
+      // The records before are still rendered.
+      render_chunk();
+      return false;
+    }
+  }
+}
+
+}  // namespace ray
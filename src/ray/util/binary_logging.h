@@ -0,0 +1,192 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ray {
+
+/// Binary logging
+/// ==============
+/// When `RAY_BACKEND_LOG_BINARY=1` is set and the logs are written to files, the
+/// messages of RAY_LOG below ERROR aren't formatted into text. Instead:
+///   1. The call site encodes its file, line and the raw arguments of the stream
+///      operators into a binary record. Strings and arithmetic values are copied as is,
+///      and only the other types are formatted with their operator<<.
+///   2. The record is copied to a lock-free buffer of the thread.
+///   3. A background thread drains the buffers of all the threads to
+///      `<log_dir>/<app>_<pid>.binlog`.
+/// The file is rendered to text offline by `binary_log_decoder`, which sorts the
+/// records drained together by their timestamps. The stream state, like std::hex or
+/// std::setprecision, doesn't carry over between the arguments.
+///
+/// If the buffer of a thread is full, its records are dropped until the background
+/// thread drains it, and the number of dropped records is written to the file.
+///
+/// On a fatal signal, the failure signal handler drains the buffers on a best-effort
+/// basis: they aren't drained if the background thread is writing them, e.g. when it's
+/// the one crashing, and the last record of a thread crashing in the middle of
+/// submitting it is lost.
+
+/// The types of the arguments in a binary log record.
+enum class BinaryLogArgType : uint8_t {
+  kInt = 0,
+  kUInt = 1,
+  kDouble = 2,
+  kBool = 3,
+  kChar = 4,
+  kString = 5,
+};
+
+/// A binary log record being built by a RAY_LOG call site.
+class BinaryLogRecord {
+ public:
+  /// \param file_name The source file of the call site, which must be a literal.
+  /// \param line_number The line of the call site.
+  /// \param severity The RayLogLevel of the record.
+  BinaryLogRecord(const char *file_name, int line_number, int severity);
+
+  /// Submit the record to the buffer of the thread.
+  ~BinaryLogRecord();
+
+  BinaryLogRecord(const BinaryLogRecord &) = delete;
+  BinaryLogRecord &operator=(const BinaryLogRecord &) = delete;
+
+  /// Append an argument of the stream operator.
+  template <typename T>
+  void Append(const T &value) {
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_same_v<Type, bool>) {
+      AppendValue(BinaryLogArgType::kBool, static_cast<uint8_t>(value));
+    } else if constexpr (std::is_same_v<Type, char> ||
+                         std::is_same_v<Type, signed char> ||
+                         std::is_same_v<Type, unsigned char>) {
+      // The ostream prints them as characters, including int8_t and uint8_t.
+      AppendValue(BinaryLogArgType::kChar, static_cast<char>(value));
+    } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+      AppendValue(BinaryLogArgType::kInt, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<Type>) {
+      AppendValue(BinaryLogArgType::kUInt, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<Type>) {
+      AppendValue(BinaryLogArgType::kDouble, static_cast<double>(value));
+    } else if constexpr (std::is_same_v<Type, const char *> ||
+                         std::is_same_v<Type, char *>) {
+      // Also the char arrays, which decay to pointers.
+      if (value == nullptr) {
+        AppendString("(null)");
+      } else {
+        AppendString(std::string_view(value));
+      }
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      AppendString(std::string_view(value));
+    } else {
+      std::ostringstream stream;
+      stream << value;
+      AppendString(stream.str());
+    }
+  }
+
+ private:
+  template <typename V>
+  void AppendValue(BinaryLogArgType type, V value) {
+    buffer_->push_back(static_cast<char>(type));
+    buffer_->append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  void AppendString(std::string_view value) {
+    buffer_->push_back(static_cast<char>(BinaryLogArgType::kString));
+    const auto size = static_cast<uint32_t>(value.size());
+    buffer_->append(reinterpret_cast<const char *>(&size), sizeof(size));
+    buffer_->append(value.data(), value.size());
+  }
+
+  /// The bytes of the record, which reuses the buffer of the thread unless the record
+  /// is built while another one is, e.g. when an operator<< logs.
+  std::string *buffer_;
+  std::unique_ptr<std::string> nested_buffer_;
+};
+
+/// The background writer of the binary log records.
+///
+/// This class is thread-safe.
+class BinaryLogWriter {
+ public:
+  static BinaryLogWriter &Instance();
+
+  /// Start writing the records to a file, replacing the file written so far if any.
+  ///
+  /// \return False if the file can't be opened.
+  bool Start(const std::string &file_path);
+
+  /// Write the buffered records and close the file.
+  void Stop();
+
+  /// Whether the records are written to a file.
+  bool IsStarted() const;
+
+  /// Write the buffered records synchronously, e.g. before the process exits.
+  void Flush();
+
+  /// Write the buffered records synchronously unless they're being written, e.g. from a
+  /// signal handler which may interrupt the writing thread.
+  ///
+  /// \return False if the records were being written.
+  bool TryFlush();
+
+  /// The number of records dropped because the buffer of their thread was full.
+  uint64_t NumRecordsDropped() const;
+
+ private:
+  friend class BinaryLogRecord;
+
+  struct ThreadBuffer;
+  struct State;
+
+  BinaryLogWriter();
+
+  /// Get the id of a source file, which is written to the file once.
+  uint32_t GetFileId(const char *file_name);
+
+  /// Copy a record to the buffer of the current thread.
+  void Submit(const std::string &record);
+
+  /// Get the buffer of the current thread, registering it if it's the first record of
+  /// the thread.
+  ThreadBuffer &GetThreadBuffer();
+
+  /// Write the records of all the threads to the file.
+  void WriteRecords();
+
+  /// Same as WriteRecords, with the write mutex of the state held.
+  void WriteRecordsLocked();
+
+  std::unique_ptr<State> state_;
+};
+
+/// Render a binary log file as text, one line per record.
+///
+/// \param in The binary log.
+/// \param out The text.
+/// \return False if the binary log is malformed. The records before are rendered.
+bool DecodeBinaryLog(std::istream &in, std::ostream &out);
+
+}  // namespace ray
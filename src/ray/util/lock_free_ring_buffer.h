@@ -0,0 +1,124 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+/// \class LockFreeRingBuffer
+/// A bounded lock-free FIFO queue, which many threads push to and pop from, based on
+/// Dmitry Vyukov's bounded MPMC queue.
+///
+/// Every slot has a sequence number, which tells whether the slot is free to push to
+/// or ready to pop from at the position of a thread. A push or a pop claims its
+/// position with a compare-and-swap, so it costs a few atomic operations when the
+/// threads don't contend on the same end of the buffer.
+///
+/// This class is thread safe.
+template <typename T>
+class LockFreeRingBuffer {
+ public:
+  /// \param capacity The max number of elements in the buffer, which must be positive.
+  explicit LockFreeRingBuffer(size_t capacity)
+      : capacity_(capacity), slots_(new Slot[capacity]) {
+    RAY_CHECK(capacity > 0);
+    for (size_t i = 0; i < capacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  LockFreeRingBuffer(const LockFreeRingBuffer &) = delete;
+  LockFreeRingBuffer &operator=(const LockFreeRingBuffer &) = delete;
+
+  /// Push an element to the back of the buffer.
+  ///
+  /// \param value The element, which is moved from only if it's pushed.
+  /// \return False if the buffer is full.
+  bool TryPush(T &&value) {
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[position % capacity_];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (push_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        // The slot still holds the element pushed one round before.
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Pop the element at the front of the buffer.
+  ///
+  /// \param[out] value The element popped.
+  /// \return False if the buffer is empty.
+  bool TryPop(T *value) {
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[position % capacity_];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence == position + 1) {
+        if (pop_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          *value = std::move(slot.value);
+          slot.value = T();
+          slot.sequence.store(position + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position + 1) {
+        // The element of the slot hasn't been pushed yet.
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// The number of elements in the buffer. It's approximate while other threads push
+  /// or pop.
+  size_t Size() const {
+    const size_t pop_position = pop_position_.load(std::memory_order_acquire);
+    const size_t push_position = push_position_.load(std::memory_order_acquire);
+    return push_position > pop_position ? push_position - pop_position : 0;
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  const size_t capacity_;
+  const std::unique_ptr<Slot[]> slots_;
+  /// The positions are on separate cache lines, so that the pushing threads and the
+  /// popping threads don't invalidate each other's.
+  alignas(64) std::atomic<size_t> push_position_{0};
+  alignas(64) std::atomic<size_t> pop_position_{0};
+};
+
+}  // namespace ray
@@ -236,6 +236,7 @@ void RayLog::StartRayLog(const std::string &app_name,
 
   // All the logging sinks to add.
   std::vector<spdlog::sink_ptr> sinks;
+  std::string binary_log_path;
   auto level = static_cast<spdlog::level::level_enum>(severity_threshold_);
   std::string app_name_without_path = app_name;
   if (app_name.empty()) {
@@ -286,6 +287,21 @@ void RayLog::StartRayLog(const std::string &app_name,
         log_rotation_max_size_,
         log_rotation_file_num_);
     sinks.push_back(file_sink);
+
+    // The messages below ERROR may be written to a binary log instead, which is
+    // decoded by binary_log_decoder. See binary_logging.h.
+    const char *binary_log = std::getenv("RAY_BACKEND_LOG_BINARY");
+    if (binary_log != nullptr && std::string(binary_log) == "1") {
+      binary_log_path = JoinPaths(
+          log_dir_, app_name_without_path + "_" + std::to_string(pid) + ".binlog");
+      if (!BinaryLogWriter::Instance().Start(binary_log_path)) {
+        RAY_LOG(WARNING) << "Failed to open the binary log " << binary_log_path
+                         << ", the messages are logged as text.";
+        binary_log_path.clear();
+      }
+    } else {
+      BinaryLogWriter::Instance().Stop();
+    }
   } else {
     // Format pattern is 2020-08-21 17:00:00,000 I 100 1001 msg.
     // %L is loglevel, %P is process id, %t for thread id.
@@ -312,6 +328,9 @@ void RayLog::StartRayLog(const std::string &app_name,
   spdlog::set_level(static_cast<spdlog::level::level_enum>(severity_threshold_));
   spdlog::set_pattern(log_format_pattern_);
   spdlog::set_default_logger(logger);
+  if (!binary_log_path.empty()) {
+    logger->warn("The messages below ERROR are written to {}.", binary_log_path);
+  }
 
   initialized_ = true;
 }
@@ -345,6 +364,7 @@ void RayLog::ShutDownRayLog() {
     return;
   }
   UninstallSignalAction();
+  BinaryLogWriter::Instance().Stop();
   if (spdlog::default_logger()) {
     spdlog::default_logger()->flush();
   }
@@ -367,6 +387,9 @@ void WriteFailureMessage(const char *data) {
   if (spdlog::default_logger()) {
     spdlog::default_logger()->flush();
   }
+  // The binary log records are drained on a best-effort basis, since the crashing
+  // thread may be the one writing them.
+  BinaryLogWriter::Instance().TryFlush();
 }
 
 bool RayLog::IsFailureSignalHandlerEnabled() {
@@ -418,8 +441,14 @@ RayLog::RayLog(const char *file_name, int line_number, RayLogLevel severity)
     *expose_osstream_ << file_name << ":" << line_number << ":";
   }
   if (is_enabled_) {
-    logging_provider_ = new LoggingProvider(
-        file_name, line_number, GetMappedSeverity(severity), expose_osstream_);
+    // The errors are always logged as text, so that they're also printed to stderr.
+    if (severity < RayLogLevel::ERROR && BinaryLogWriter::Instance().IsStarted()) {
+      binary_record_ = &binary_record_storage_.emplace(
+          file_name, line_number, static_cast<int>(severity));
+    } else {
+      logging_provider_ = new LoggingProvider(
+          file_name, line_number, GetMappedSeverity(severity), expose_osstream_);
+    }
   }
 }
 
@@ -447,6 +476,7 @@ RayLog::~RayLog() {
     }
   }
   if (severity_ == RayLogLevel::FATAL) {
+    BinaryLogWriter::Instance().Flush();
     std::_Exit(EXIT_FAILURE);
   }
 }
@@ -55,10 +55,13 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "ray/util/binary_logging.h"
+
 #if defined(_WIN32)
 #ifndef _WINDOWS_
 #ifndef WIN32_LEAN_AND_MEAN  // Sorry for the inconvenience. Please include any related
@@ -222,7 +225,11 @@ class RayLogBase {
   template <typename T>
   RayLogBase &operator<<(const T &t) {
     if (IsEnabled()) {
-      Stream() << t;
+      if (binary_record_ != nullptr) {
+        binary_record_->Append(t);
+      } else {
+        Stream() << t;
+      }
     }
     if (IsFatal()) {
       ExposeStream() << t;
@@ -233,6 +240,9 @@ class RayLogBase {
  protected:
   virtual std::ostream &Stream() { return std::cerr; };
   virtual std::ostream &ExposeStream() { return std::cerr; };
+
+  /// The binary record of the message if it's logged by the binary logging.
+  BinaryLogRecord *binary_record_ = nullptr;
 };
 
 /// Callback function which will be triggered to expose fatal log.
@@ -321,6 +331,8 @@ class RayLog : public RayLogBase {
   bool is_fatal_ = false;
   /// String stream of exposed log content.
   std::shared_ptr<std::ostringstream> expose_osstream_ = nullptr;
+  /// The storage of `binary_record_`, which is submitted when the message is destroyed.
+  std::optional<BinaryLogRecord> binary_record_storage_;
   /// Whether or not the log is initialized.
   static std::atomic<bool> initialized_;
   /// Callback functions which will be triggered to expose fatal log.
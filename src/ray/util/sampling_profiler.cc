@@ -0,0 +1,258 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/sampling_profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+#include "absl/time/time.h"
+#include "ray/util/logging.h"
+#include "ray/util/stack_trace.h"
+#include "ray/util/util.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+
+// Older glibc versions don't define it.
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace ray {
+
+SamplingProfiler &SamplingProfiler::Instance() {
+  static SamplingProfiler instance;
+  return instance;
+}
+
+void SamplingProfiler::Start(uint64_t frequency_hz) {
+#if defined(__linux__)
+  absl::MutexLock lock(&mutex_);
+  if (frequency_hz == 0 || frequency_hz_ != 0) {
+    return;
+  }
+  if (!InstallStackTraceSignalHandler(
+          SIGPROF, [](void *ucontext) { Instance().RecordSample(ucontext); })) {
+    return;
+  }
+  frequency_hz_ = frequency_hz;
+  stop_draining_ = std::make_unique<absl::Notification>();
+  drain_thread_ = std::make_unique<std::thread>([this, stop = stop_draining_.get()]() {
+    SetThreadName("profiler.drain");
+    while (!stop->WaitForNotificationWithTimeout(absl::Milliseconds(100))) {
+      {
+        absl::MutexLock lock(&mutex_);
+        DrainSamples();
+      }
+      SymbolizeNewStacks();
+    }
+  });
+  RAY_LOG(INFO) << "Started the sampling profiler at " << frequency_hz << " Hz.";
+#endif
+}
+
+void SamplingProfiler::AddCurrentThread() {
+#if defined(__linux__)
+  static_assert(std::is_same_v<timer_t, void *>);
+  absl::MutexLock lock(&mutex_);
+  if (frequency_hz_ == 0) {
+    return;
+  }
+  // The timer counts the CPU time of the thread, so a thread waiting for events isn't
+  // sampled.
+  clockid_t clock;
+  RAY_CHECK(pthread_getcpuclockid(pthread_self(), &clock) == 0);
+  struct sigevent event;
+  memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = GetNativeThreadId();
+  timer_t timer;
+  if (timer_create(clock, &event, &timer) != 0) {
+    RAY_LOG(WARNING) << "Failed to create the profiling timer of a thread: "
+                     << strerror(errno);
+    return;
+  }
+  const int64_t period_ns = 1000 * 1000 * 1000 / frequency_hz_;
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = period_ns / (1000 * 1000 * 1000);
+  spec.it_interval.tv_nsec = period_ns % (1000 * 1000 * 1000);
+  spec.it_value = spec.it_interval;
+  RAY_CHECK(timer_settime(timer, 0, &spec, nullptr) == 0)
+      << "Failed to start the profiling timer: " << strerror(errno);
+  timers_.push_back(timer);
+#endif
+}
+
+void SamplingProfiler::Stop() {
+  std::unique_ptr<std::thread> drain_thread;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (frequency_hz_ == 0) {
+      return;
+    }
+    frequency_hz_ = 0;
+#if defined(__linux__)
+    for (auto timer : timers_) {
+      timer_delete(timer);
+    }
+#endif
+    timers_.clear();
+    // The SIGPROF handler is kept, since a signal may still be pending.
+    stop_draining_->Notify();
+    drain_thread = std::move(drain_thread_);
+  }
+  drain_thread->join();
+  absl::MutexLock lock(&mutex_);
+  DrainSamples();
+}
+
+bool SamplingProfiler::IsStarted() const {
+  absl::MutexLock lock(&mutex_);
+  return frequency_hz_ != 0;
+}
+
+void SamplingProfiler::RecordSample(void *ucontext) {
+  auto &slot = slots_[next_slot_.fetch_add(1, std::memory_order_relaxed) % kNumSlots];
+  int expected = Slot::kEmpty;
+  if (slot.state.compare_exchange_strong(
+          expected, Slot::kWriting, std::memory_order_acquire)) {
+    slot.depth = GetSignalStackTrace(ucontext, slot.frames, kMaxFrames);
+    slot.state.store(Slot::kFull, std::memory_order_release);
+  } else {
+    // The samples aren't drained fast enough.
+    num_dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void SamplingProfiler::DrainSamples() {
+  for (auto &slot : slots_) {
+    if (slot.state.load(std::memory_order_acquire) != Slot::kFull) {
+      continue;
+    }
+    std::vector<void *> stack(slot.frames, slot.frames + slot.depth);
+    slot.state.store(Slot::kEmpty, std::memory_order_release);
+    auto it = profile_.find(stack);
+    if (it != profile_.end()) {
+      it->second++;
+    } else if (profile_.size() < kMaxNumStacks) {
+      new_stacks_.push_back(stack);
+      profile_.emplace(std::move(stack), 1);
+    } else {
+      num_dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    num_samples_++;
+  }
+}
+
+namespace {
+
+std::string SymbolizeProfiledFrame(void *pc, bool is_return_address) {
+  auto symbol = SymbolizeFrame(pc, is_return_address);
+  // ';' separates the frames.
+  std::replace(symbol.begin(), symbol.end(), ';', ':');
+  return symbol;
+}
+
+}  // namespace
+
+void SamplingProfiler::SymbolizeNewStacks() {
+  std::vector<std::vector<void *>> new_stacks;
+  {
+    absl::MutexLock lock(&mutex_);
+    new_stacks.swap(new_stacks_);
+  }
+  for (const auto &frames : new_stacks) {
+    // The frames are from the leaf, and all but the leaf are return addresses.
+    for (size_t i = 0; i < frames.size(); i++) {
+      const auto key = std::make_pair(frames[i], /*is_return_address=*/i > 0);
+      {
+        absl::MutexLock lock(&symbols_mutex_);
+        if (symbols_.contains(key)) {
+          continue;
+        }
+      }
+      // The symbolization is slow, so it's done without holding the lock.
+      auto symbol = SymbolizeProfiledFrame(key.first, key.second);
+      absl::MutexLock lock(&symbols_mutex_);
+      symbols_.emplace(key, std::move(symbol));
+    }
+  }
+}
+
+std::string SamplingProfiler::GetFoldedStacks() {
+  std::vector<std::pair<std::vector<void *>, int64_t>> stacks;
+  {
+    absl::MutexLock lock(&mutex_);
+    DrainSamples();
+    stacks.assign(profile_.begin(), profile_.end());
+  }
+
+  // The stacks are sampled at different instructions of the same functions, so they're
+  // aggregated again once symbolized.
+  absl::flat_hash_map<std::string, int64_t> folded_stacks;
+  {
+    absl::MutexLock lock(&symbols_mutex_);
+    for (const auto &[frames, count] : stacks) {
+      std::string folded_stack;
+      for (size_t i = frames.size(); i > 0; i--) {
+        // The frames are from the leaf, and all but the leaf are return addresses. Only
+        // the ones sampled since the last round of the background thread aren't
+        // symbolized yet.
+        const auto key = std::make_pair(frames[i - 1], /*is_return_address=*/i > 1);
+        auto it = symbols_.find(key);
+        if (it == symbols_.end()) {
+          it = symbols_.emplace(key, SymbolizeProfiledFrame(key.first, key.second))
+                   .first;
+        }
+        folded_stack += it->second;
+        if (i > 1) {
+          folded_stack += ";";
+        }
+      }
+      folded_stacks[folded_stack] += count;
+    }
+  }
+
+  std::vector<std::pair<std::string, int64_t>> sorted_stacks(folded_stacks.begin(),
+                                                             folded_stacks.end());
+  std::sort(sorted_stacks.begin(),
+            sorted_stacks.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.second > rhs.second; });
+  std::ostringstream result;
+  for (const auto &[folded_stack, count] : sorted_stacks) {
+    result << folded_stack << " " << count << "\n";
+  }
+  return result.str();
+}
+
+int64_t SamplingProfiler::NumSamples() {
+  absl::MutexLock lock(&mutex_);
+  DrainSamples();
+  return num_samples_;
+}
+
+int64_t SamplingProfiler::NumDroppedSamples() const {
+  return num_dropped_samples_.load(std::memory_order_relaxed);
+}
+
+}  // namespace ray
@@ -0,0 +1,225 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/stack_trace.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "absl/debugging/stacktrace.h"
+#include "absl/debugging/symbolize.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "ray/util/logging.h"
+
+#if defined(__linux__)
+#include <signal.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+namespace ray {
+
+namespace {
+
+#if defined(__linux__)
+
+/// The maximum number of frames walked in a signal handler, including the frames of
+/// the handler.
+constexpr int kMaxSignalFrames = 128;
+
+/// The handlers installed with InstallStackTraceSignalHandler, by signal.
+std::atomic<void (*)(void *)> signal_handlers[NSIG];
+
+/// The address the signal handlers return to, i.e. the restorer set by libc, which
+/// returns from the signal.
+std::atomic<void *> signal_return_address{nullptr};
+
+void DispatchSignal(int signal, siginfo_t *info, void *ucontext) {
+  const int saved_errno = errno;
+  auto handler = signal_handlers[signal].load(std::memory_order_acquire);
+  if (handler != nullptr) {
+    handler(ucontext);
+  }
+  errno = saved_errno;
+}
+
+/// Get the program counter of the thread interrupted by a signal.
+void *GetInterruptedPc(void *ucontext) {
+#if defined(__x86_64__)
+  return reinterpret_cast<void *>(
+      static_cast<ucontext_t *>(ucontext)->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+  return reinterpret_cast<void *>(static_cast<ucontext_t *>(ucontext)->uc_mcontext.pc);
+#else
+  return nullptr;
+#endif
+}
+
+/// The signal GetThreadStackTrace interrupts the threads with. It's a real-time signal,
+/// which isn't used by Ray or the language runtimes of the workers.
+int GetStackTraceSignal() { return SIGRTMIN + 1; }
+
+/// The stack trace requested by GetThreadStackTrace.
+enum CaptureState : int { kIdle, kRequested, kCapturing, kCaptured };
+std::atomic<int> capture_state{kIdle};
+std::atomic<int64_t> capture_thread_id{0};
+void *capture_frames[kMaxSignalFrames];
+int capture_depth = 0;
+
+/// Only one stack trace is requested at a time.
+ABSL_CONST_INIT absl::Mutex capture_mutex(absl::kConstInit);
+
+void HandleStackTraceSignal(void *ucontext) {
+  if (capture_thread_id.load(std::memory_order_relaxed) != GetNativeThreadId()) {
+    return;
+  }
+  int expected = kRequested;
+  if (!capture_state.compare_exchange_strong(
+          expected, kCapturing, std::memory_order_acquire)) {
+    // The request timed out.
+    return;
+  }
+  capture_depth = GetSignalStackTrace(ucontext, capture_frames, kMaxSignalFrames);
+  capture_state.store(kCaptured, std::memory_order_release);
+}
+
+#endif
+
+}  // namespace
+
+bool InstallStackTraceSignalHandler(int signal, void (*handler)(void *ucontext)) {
+#if defined(__linux__)
+  RAY_CHECK(signal > 0 && signal < NSIG);
+  signal_handlers[signal].store(handler, std::memory_order_release);
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = DispatchSignal;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(signal, &action, nullptr) != 0) {
+    RAY_LOG(WARNING) << "Failed to install the handler of signal " << signal << ": "
+                     << strerror(errno);
+    return false;
+  }
+  struct sigaction installed;
+  RAY_CHECK(sigaction(signal, nullptr, &installed) == 0);
+  signal_return_address.store(reinterpret_cast<void *>(installed.sa_restorer),
+                              std::memory_order_relaxed);
+  return true;
+#else
+  return false;
+#endif
+}
+
+int GetSignalStackTrace(void *ucontext, void **frames, int max_depth) {
+#if defined(__linux__)
+  void *pc = GetInterruptedPc(ucontext);
+  if (pc == nullptr || max_depth <= 0) {
+    return 0;
+  }
+  // The stack starts with the frames of the signal handler, and the caller of the
+  // interrupted function is after the return address of the handler. The interrupted
+  // function itself is found from the context. If the handler's frame isn't found,
+  // e.g. because the frame pointers are omitted, only the interrupted function is
+  // returned.
+  void *stack[kMaxSignalFrames];
+  const int depth = absl::GetStackTraceWithContext(
+      stack, kMaxSignalFrames, /*skip_count=*/0, ucontext, nullptr);
+  const void *return_address = signal_return_address.load(std::memory_order_relaxed);
+  int first_frame = depth;
+  for (int i = 0; i < depth; i++) {
+    if (stack[i] == return_address) {
+      first_frame = i + 1;
+      break;
+    }
+  }
+  int num_frames = 0;
+  frames[num_frames++] = pc;
+  for (int i = first_frame; i < depth && num_frames < max_depth; i++) {
+    frames[num_frames++] = stack[i];
+  }
+  return num_frames;
+#else
+  return 0;
+#endif
+}
+
+std::vector<void *> GetThreadStackTrace(int64_t thread_id, absl::Duration timeout) {
+#if defined(__linux__)
+  static const bool installed =
+      InstallStackTraceSignalHandler(GetStackTraceSignal(), HandleStackTraceSignal);
+  if (!installed) {
+    return {};
+  }
+  absl::MutexLock lock(&capture_mutex);
+  capture_thread_id.store(thread_id, std::memory_order_relaxed);
+  capture_state.store(kRequested, std::memory_order_release);
+  if (syscall(SYS_tgkill, getpid(), thread_id, GetStackTraceSignal()) != 0) {
+    capture_state.store(kIdle, std::memory_order_relaxed);
+    return {};
+  }
+  const auto deadline = absl::Now() + timeout;
+  while (capture_state.load(std::memory_order_acquire) != kCaptured) {
+    if (absl::Now() > deadline) {
+      int expected = kRequested;
+      if (capture_state.compare_exchange_strong(expected, kIdle)) {
+        return {};
+      }
+      // The thread is getting its stack trace.
+    }
+    absl::SleepFor(absl::Microseconds(100));
+  }
+  std::vector<void *> frames(capture_frames, capture_frames + capture_depth);
+  capture_state.store(kIdle, std::memory_order_relaxed);
+  return frames;
+#else
+  return {};
+#endif
+}
+
+int64_t GetNativeThreadId() {
+#if defined(__linux__)
+  return syscall(SYS_gettid);
+#else
+  return 0;
+#endif
+}
+
+std::string SymbolizeFrame(void *pc, bool is_return_address) {
+  if (is_return_address) {
+    pc = static_cast<char *>(pc) - 1;
+  }
+  char buffer[1024];
+  if (absl::Symbolize(pc, buffer, sizeof(buffer))) {
+    return buffer;
+  }
+  std::ostringstream address;
+  address << pc;
+  return address.str();
+}
+
+std::string FormatStackTrace(const std::vector<void *> &frames) {
+  std::ostringstream result;
+  for (size_t i = 0; i < frames.size(); i++) {
+    result << "    @ " << frames[i] << " "
+           << SymbolizeFrame(frames[i], /*is_return_address=*/i > 0) << "\n";
+  }
+  return result.str();
+}
+
+}  // namespace ray
@@ -0,0 +1,64 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace ray {
+
+/// Helpers to get the stack traces of the threads of this process by interrupting them
+/// with signals. They're only supported on Linux, and the callers of the interrupted
+/// function are only found in the code built with frame pointers.
+
+/// Install the handler of a signal, which may get the stack trace of the interrupted
+/// thread with GetSignalStackTrace. It's called with the ucontext of the signal.
+///
+/// \return Whether the handler is installed.
+bool InstallStackTraceSignalHandler(int signal, void (*handler)(void *ucontext));
+
+/// Get the stack trace of the thread interrupted by a signal, from the interrupted
+/// function. It must be called by a handler installed with
+/// InstallStackTraceSignalHandler, and it's async-signal-safe.
+///
+/// \return The number of frames. All but the first one are return addresses.
+int GetSignalStackTrace(void *ucontext, void **frames, int max_depth);
+
+/// Get the stack trace of a thread of this process. The thread is interrupted by a
+/// signal to get it.
+///
+/// \param thread_id The ID of the thread given by GetNativeThreadId.
+/// \param timeout How long to wait for the thread to handle the signal.
+/// \return The frames like GetSignalStackTrace, or nothing if the thread didn't handle
+/// the signal in time or if it isn't supported.
+std::vector<void *> GetThreadStackTrace(int64_t thread_id, absl::Duration timeout);
+
+/// Get the ID of the calling thread, which may be given to GetThreadStackTrace.
+int64_t GetNativeThreadId();
+
+/// Get the name of the function of a frame, or its address if it's unknown.
+///
+/// \param pc The address of the frame.
+/// \param is_return_address Whether the address is a return address, which is
+/// symbolized as the call instruction before it.
+std::string SymbolizeFrame(void *pc, bool is_return_address);
+
+/// Format a stack trace, with a line per frame from the innermost one.
+std::string FormatStackTrace(const std::vector<void *> &frames);
+
+}  // namespace ray
@@ -0,0 +1,179 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/binary_logging.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ray/util/filesystem.h"
+#include "ray/util/logging.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+namespace ray {
+
+namespace {
+
+struct Point {
+  int x;
+  int y;
+};
+
+std::ostream &operator<<(std::ostream &os, const Point &point) {
+  return os << "(" << point.x << ", " << point.y << ")";
+}
+
+/// A type which logs while it's formatted.
+struct Noisy {};
+
+std::ostream &operator<<(std::ostream &os, const Noisy &) {
+  RAY_LOG(INFO) << "Formatting a noisy value";
+  return os << "noisy";
+}
+
+class BinaryLoggingTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    setenv("RAY_BACKEND_LOG_BINARY", "1", /*overwrite=*/1);
+    RayLog::StartRayLog("binary_logging_test", RayLogLevel::INFO, GetUserTempDir());
+    ASSERT_TRUE(BinaryLogWriter::Instance().IsStarted());
+  }
+
+  void TearDown() override {
+    RayLog::ShutDownRayLog();
+    unsetenv("RAY_BACKEND_LOG_BINARY");
+    std::remove(BinaryLogPath().c_str());
+  }
+
+  static std::string BinaryLogPath() {
+    return JoinPaths(GetUserTempDir(),
+                     "binary_logging_test_" + std::to_string(getpid()) + ".binlog");
+  }
+
+  /// Stop the logging and decode the binary log.
+  static std::string Decode() {
+    RayLog::ShutDownRayLog();
+    std::ifstream in(BinaryLogPath(), std::ios::binary);
+    std::ostringstream out;
+    EXPECT_TRUE(DecodeBinaryLog(in, out));
+    return out.str();
+  }
+};
+
+TEST_F(BinaryLoggingTest, TestRoundTrip) {
+  const int line = __LINE__ + 1;
+  RAY_LOG(INFO) << "int " << -42 << ", uint " << 42u << ", int8 " << int8_t{'a'}
+                << ", double " << 1.5 << ", bool " << true << ", char " << 'c'
+                << ", string " << std::string("str") << ", null "
+                << static_cast<const char *>(nullptr) << ", point " << Point{1, 2};
+  RAY_LOG(WARNING) << "A warning";
+  RAY_LOG(DEBUG) << "A debug message";
+  RAY_LOG(INFO) << "A " << Noisy{} << " value";
+  std::thread([]() { RAY_LOG(INFO) << "From another thread"; }).join();
+
+  const auto text = Decode();
+  EXPECT_THAT(text,
+              HasSubstr("binary_logging_test.cc:" + std::to_string(line) +
+                        ": int -42, uint 42, int8 a, double 1.5, bool 1, char c, "
+                        "string str, null (null), point (1, 2)\n"));
+  EXPECT_THAT(text, HasSubstr(" W " + std::to_string(getpid()) + " "));
+  EXPECT_THAT(text, HasSubstr("A warning\n"));
+  EXPECT_THAT(text, Not(HasSubstr("A debug message")));
+  EXPECT_THAT(text, HasSubstr("Formatting a noisy value\n"));
+  EXPECT_THAT(text, HasSubstr("A noisy value\n"));
+  EXPECT_THAT(text, HasSubstr("From another thread\n"));
+}
+
+TEST_F(BinaryLoggingTest, TestSortedByTime) {
+  // The entries drained together are written thread by thread.
+  RAY_LOG(INFO) << "First message";
+  std::thread([]() { RAY_LOG(INFO) << "Second message"; }).join();
+  RAY_LOG(INFO) << "Third message";
+
+  const auto text = Decode();
+  const auto first = text.find("First message");
+  const auto second = text.find("Second message");
+  const auto third = text.find("Third message");
+  ASSERT_NE(third, std::string::npos);
+  EXPECT_LT(first, second);
+  EXPECT_LT(second, third);
+}
+
+TEST_F(BinaryLoggingTest, TestTryFlush) {
+  RAY_LOG(INFO) << "A flushed message";
+  ASSERT_TRUE(BinaryLogWriter::Instance().TryFlush());
+
+  // The message is written before the logging stops.
+  std::ifstream in(BinaryLogPath(), std::ios::binary);
+  std::string binary_log((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  EXPECT_THAT(binary_log, HasSubstr("A flushed message"));
+}
+
+TEST_F(BinaryLoggingTest, TestTruncatedLog) {
+  RAY_LOG(INFO) << "A message long enough to be truncated";
+  RayLog::ShutDownRayLog();
+
+  std::ifstream in(BinaryLogPath(), std::ios::binary);
+  std::string binary_log((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  binary_log.resize(binary_log.size() - 10);
+  std::istringstream truncated(binary_log);
+  std::ostringstream out;
+  ASSERT_FALSE(DecodeBinaryLog(truncated, out));
+
+  std::istringstream not_binary_log("[2023-01-01 00:00:00,000 I 1 1] text");
+  ASSERT_FALSE(DecodeBinaryLog(not_binary_log, out));
+}
+
+// This test only prints the time per message.
+TEST_F(BinaryLoggingTest, PerfTest) {
+  // The binary messages fit in the buffer of the thread, so that none is dropped.
+  const int rounds = 2000;
+  auto time_messages = [rounds]() {
+    const auto start = absl::GetCurrentTimeNanos();
+    for (int i = 0; i < rounds; ++i) {
+      RAY_LOG(INFO) << "Message " << i << " of task " << 3.14 << " on node "
+                    << "abcdef0123456789";
+    }
+    return (absl::GetCurrentTimeNanos() - start) / rounds;
+  };
+
+  const auto binary_ns = time_messages();
+  ASSERT_EQ(BinaryLogWriter::Instance().NumRecordsDropped(), 0);
+  RayLog::ShutDownRayLog();
+  unsetenv("RAY_BACKEND_LOG_BINARY");
+  RayLog::StartRayLog("binary_logging_test", RayLogLevel::INFO, GetUserTempDir());
+  const auto text_ns = time_messages();
+  std::cout << "A binary message takes " << binary_ns << " ns, and a text message "
+            << text_ns << " ns." << std::endl;
+  std::remove(JoinPaths(GetUserTempDir(),
+                        "binary_logging_test_" + std::to_string(getpid()) + ".log")
+                  .c_str());
+}
+
+}  // namespace
+
+}  // namespace ray
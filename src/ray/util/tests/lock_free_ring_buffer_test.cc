@@ -0,0 +1,89 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/lock_free_ring_buffer.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace ray {
+
+TEST(LockFreeRingBufferTest, TestPushPop) {
+  LockFreeRingBuffer<std::unique_ptr<int>> buffer(3);
+  std::unique_ptr<int> value;
+  ASSERT_FALSE(buffer.TryPop(&value));
+
+  // The buffer wraps around several times.
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(buffer.TryPush(std::make_unique<int>(i)));
+    }
+    ASSERT_EQ(buffer.Size(), 3);
+    auto rejected = std::make_unique<int>(3);
+    ASSERT_FALSE(buffer.TryPush(std::move(rejected)));
+    // The rejected element isn't moved from.
+    ASSERT_NE(rejected, nullptr);
+
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(buffer.TryPop(&value));
+      ASSERT_EQ(*value, i);
+    }
+    ASSERT_FALSE(buffer.TryPop(&value));
+    ASSERT_EQ(buffer.Size(), 0);
+  }
+}
+
+TEST(LockFreeRingBufferTest, TestConcurrentPushPop) {
+  const int num_producers = 4;
+  const int num_values_per_producer = 10000;
+  LockFreeRingBuffer<int> buffer(1024);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&buffer, p]() {
+      for (int i = 0; i < num_values_per_producer; ++i) {
+        int value = p * num_values_per_producer + i;
+        while (!buffer.TryPush(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Every value is popped once, and the values of a producer are popped in order.
+  std::vector<int> last_values(num_producers, -1);
+  int num_popped = 0;
+  while (num_popped < num_producers * num_values_per_producer) {
+    int value;
+    if (!buffer.TryPop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    const int producer = value / num_values_per_producer;
+    ASSERT_GT(value, last_values[producer]);
+    last_values[producer] = value;
+    num_popped++;
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  for (int p = 0; p < num_producers; ++p) {
+    ASSERT_EQ(last_values[p], (p + 1) * num_values_per_producer - 1);
+  }
+  ASSERT_EQ(buffer.Size(), 0);
+}
+
+}  // namespace ray
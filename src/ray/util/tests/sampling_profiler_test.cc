@@ -0,0 +1,82 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/sampling_profiler.h"
+
+#include <thread>
+
+#include "absl/debugging/symbolize.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+
+namespace ray {
+
+#if defined(__linux__)
+
+/// Burn CPU for the given duration.
+__attribute__((noinline)) double BurnCpu(absl::Duration duration) {
+  volatile double result = 0;
+  const auto end = absl::Now() + duration;
+  while (absl::Now() < end) {
+    for (int i = 0; i < 1000; i++) {
+      result = result + i;
+    }
+  }
+  return result;
+}
+
+TEST(SamplingProfilerTest, TestProfile) {
+  auto &profiler = SamplingProfiler::Instance();
+  // Threads aren't profiled before the profiler is started.
+  profiler.AddCurrentThread();
+  profiler.Start(/*frequency_hz=*/1000);
+  ASSERT_TRUE(profiler.IsStarted());
+
+  std::thread thread([&profiler]() {
+    profiler.AddCurrentThread();
+    BurnCpu(absl::Milliseconds(500));
+  });
+  // A thread which isn't profiled.
+  std::thread other_thread([]() { BurnCpu(absl::Milliseconds(500)); });
+  thread.join();
+  other_thread.join();
+  // The stacks are symbolized by the background thread while the profiler runs.
+  absl::SleepFor(absl::Milliseconds(200));
+  ASSERT_NE(profiler.GetFoldedStacks().find("BurnCpu"), std::string::npos);
+  profiler.Stop();
+  ASSERT_FALSE(profiler.IsStarted());
+
+  // The timers have a resolution of a scheduler tick, so there are fewer samples than
+  // the frequency.
+  const int64_t num_samples = profiler.NumSamples();
+  ASSERT_GT(num_samples, 10);
+  ASSERT_LT(num_samples, 1000);
+  ASSERT_EQ(profiler.NumDroppedSamples(), 0);
+  const auto profile = profiler.GetFoldedStacks();
+  ASSERT_NE(profile.find("BurnCpu"), std::string::npos) << profile;
+
+  // The profile is kept after the profiler is stopped.
+  BurnCpu(absl::Milliseconds(100));
+  ASSERT_EQ(profiler.NumSamples(), num_samples);
+}
+
+#endif
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  absl::InitializeSymbolizer(argv[0]);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}